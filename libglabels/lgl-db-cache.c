@@ -0,0 +1,889 @@
+/*
+ *  lgl-db-cache.c
+ *  Copyright (C) 2026  agent <agent@local>.
+ *
+ *  This file is part of libglabels.
+ *
+ *  libglabels is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU Lesser General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  libglabels is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU Lesser General Public License for more details.
+ *
+ *  You should have received a copy of the GNU Lesser General Public License
+ *  along with libglabels.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <config.h>
+
+#include "lgl-db-cache.h"
+
+#include <glib.h>
+#include <glib/gstdio.h>
+#include <string.h>
+
+#include "libglabels-private.h"
+
+#include "lgl-paper.h"
+#include "lgl-category.h"
+#include "lgl-vendor.h"
+#include "lgl-template.h"
+
+
+/*===========================================*/
+/* Private macros and constants.             */
+/*===========================================*/
+
+/* Cache file location.  (must free w/ g_free()) */
+#define CACHE_DIR        g_build_filename (g_get_user_cache_dir (), "libglabels", NULL)
+#define CACHE_FILENAME   "templates-3.0.cache"
+
+/* Bump whenever the layout of the cache file changes. */
+#define CACHE_VERSION    1
+
+#define CACHE_MAGIC      "LGLDBC\r\n"
+#define CACHE_MAGIC_LEN  8
+
+/* Written in native byte order, used to reject caches from other hosts. */
+#define CACHE_BOM        0x01020304
+
+#define NULL_STRING      G_MAXUINT32
+
+
+/*===========================================*/
+/* Private types                             */
+/*===========================================*/
+
+typedef struct {
+        const guchar *p;
+        const guchar *end;
+        gboolean      error;
+} Reader;
+
+
+/*===========================================*/
+/* Private globals                           */
+/*===========================================*/
+
+
+/*===========================================*/
+/* Local function prototypes                 */
+/*===========================================*/
+
+static void               put_u32         (GString                 *s,
+                                           guint32                  value);
+static void               put_double      (GString                 *s,
+                                           gdouble                  value);
+static void               put_string      (GString                 *s,
+                                           const gchar             *value);
+
+static void               put_paper       (GString                 *s,
+                                           const lglPaper          *paper);
+static void               put_category    (GString                 *s,
+                                           const lglCategory       *category);
+static void               put_vendor      (GString                 *s,
+                                           const lglVendor         *vendor);
+static void               put_template    (GString                 *s,
+                                           const lglTemplate       *template);
+static void               put_frame       (GString                 *s,
+                                           const lglTemplateFrame  *frame);
+static void               put_markup      (GString                 *s,
+                                           const lglTemplateMarkup *markup);
+
+static guint32            get_u32         (Reader                  *r);
+static gdouble            get_double      (Reader                  *r);
+static gchar             *get_string      (Reader                  *r);
+
+static lglPaper          *get_paper       (Reader                  *r);
+static lglCategory       *get_category    (Reader                  *r);
+static lglVendor         *get_vendor      (Reader                  *r);
+static lglTemplate       *get_template    (Reader                  *r);
+static lglTemplateFrame  *get_frame       (Reader                  *r);
+static lglTemplateMarkup *get_markup      (Reader                  *r);
+
+static void               stamp_dir       (GChecksum               *checksum,
+                                           const gchar             *dirname);
+
+
+/****************************************************************************/
+/* Compute stamp of the given NULL terminated list of data directories.     */
+/* The stamp changes whenever a file in one of the directories is added,    */
+/* removed or modified, or when the user's language changes (paper and      */
+/* category names are localized when parsed).                               */
+/****************************************************************************/
+gchar *
+_lgl_db_cache_stamp (const gchar * const *dirs)
+{
+        GChecksum           *checksum;
+        const gchar * const *langs;
+        gchar               *stamp;
+        gint                 i;
+
+        checksum = g_checksum_new (G_CHECKSUM_SHA1);
+
+        langs = g_get_language_names ();
+        for ( i = 0; langs[i] != NULL; i++ )
+        {
+                g_checksum_update (checksum, (const guchar *)langs[i], -1);
+                g_checksum_update (checksum, (const guchar *)"\n", 1);
+        }
+
+        for ( i = 0; dirs[i] != NULL; i++ )
+        {
+                stamp_dir (checksum, dirs[i]);
+        }
+
+        stamp = g_strdup (g_checksum_get_string (checksum));
+        g_checksum_free (checksum);
+
+        return stamp;
+}
+
+
+/****************************************************************************/
+/* Read database from cache.  Returns FALSE, and leaves lists untouched, if */
+/* there is no cache, or it is stale or invalid.                            */
+/****************************************************************************/
+gboolean
+_lgl_db_cache_read (const gchar  *stamp,
+                    GList       **papers,
+                    GList       **categories,
+                    GList       **vendors,
+                    GList       **templates)
+{
+        gchar       *dir, *filename;
+        GMappedFile *mfile;
+        Reader       r;
+        gchar       *file_stamp;
+        guint32      n, i;
+        GList       *new_papers     = NULL;
+        GList       *new_categories = NULL;
+        GList       *new_vendors    = NULL;
+        GList       *new_templates  = NULL;
+        GList       *p;
+
+        if ( g_getenv ("LIBGLABELS_NO_CACHE") )
+        {
+                return FALSE;
+        }
+
+        dir      = CACHE_DIR;
+        filename = g_build_filename (dir, CACHE_FILENAME, NULL);
+        mfile    = g_mapped_file_new (filename, FALSE, NULL);
+        g_free (dir);
+        g_free (filename);
+
+        if ( mfile == NULL )
+        {
+                return FALSE;
+        }
+
+        r.p     = (const guchar *)g_mapped_file_get_contents (mfile);
+        r.end   = r.p + g_mapped_file_get_length (mfile);
+        r.error = FALSE;
+
+        /*
+         * Header
+         */
+        if ( ((r.end - r.p) < CACHE_MAGIC_LEN) || memcmp (r.p, CACHE_MAGIC, CACHE_MAGIC_LEN) )
+        {
+                g_mapped_file_unref (mfile);
+                return FALSE;
+        }
+        r.p += CACHE_MAGIC_LEN;
+
+        if ( (get_u32 (&r) != CACHE_VERSION) || (get_u32 (&r) != CACHE_BOM) )
+        {
+                g_mapped_file_unref (mfile);
+                return FALSE;
+        }
+
+        file_stamp = get_string (&r);
+        if ( r.error || (file_stamp == NULL) || strcmp (file_stamp, stamp) )
+        {
+                g_free (file_stamp);
+                g_mapped_file_unref (mfile);
+                return FALSE;
+        }
+        g_free (file_stamp);
+
+        /*
+         * Contents
+         */
+        n = get_u32 (&r);
+        for ( i = 0; (i < n) && !r.error; i++ )
+        {
+                new_papers = g_list_prepend (new_papers, get_paper (&r));
+        }
+
+        n = get_u32 (&r);
+        for ( i = 0; (i < n) && !r.error; i++ )
+        {
+                new_categories = g_list_prepend (new_categories, get_category (&r));
+        }
+
+        n = get_u32 (&r);
+        for ( i = 0; (i < n) && !r.error; i++ )
+        {
+                new_vendors = g_list_prepend (new_vendors, get_vendor (&r));
+        }
+
+        n = get_u32 (&r);
+        for ( i = 0; (i < n) && !r.error; i++ )
+        {
+                new_templates = g_list_prepend (new_templates, get_template (&r));
+        }
+
+        g_mapped_file_unref (mfile);
+
+        if ( r.error )
+        {
+                g_message ("Ignoring corrupt template database cache.");
+
+                for ( p = new_papers; p != NULL; p = p->next )
+                {
+                        lgl_paper_free (p->data);
+                }
+                g_list_free (new_papers);
+                for ( p = new_categories; p != NULL; p = p->next )
+                {
+                        lgl_category_free (p->data);
+                }
+                g_list_free (new_categories);
+                for ( p = new_vendors; p != NULL; p = p->next )
+                {
+                        lgl_vendor_free (p->data);
+                }
+                g_list_free (new_vendors);
+                for ( p = new_templates; p != NULL; p = p->next )
+                {
+                        lgl_template_free (p->data);
+                }
+                g_list_free (new_templates);
+
+                return FALSE;
+        }
+
+        *papers     = g_list_reverse (new_papers);
+        *categories = g_list_reverse (new_categories);
+        *vendors    = g_list_reverse (new_vendors);
+        *templates  = g_list_reverse (new_templates);
+
+        return TRUE;
+}
+
+
+/****************************************************************************/
+/* Write database to cache.  Failure is not fatal, the database will simply */
+/* be parsed again next time.                                               */
+/****************************************************************************/
+void
+_lgl_db_cache_write (const gchar *stamp,
+                     GList       *papers,
+                     GList       *categories,
+                     GList       *vendors,
+                     GList       *templates)
+{
+        GString     *s;
+        gchar       *dir, *filename;
+        GList       *p;
+        GError      *gerror = NULL;
+
+        if ( g_getenv ("LIBGLABELS_NO_CACHE") )
+        {
+                return;
+        }
+
+        s = g_string_sized_new (256 * 1024);
+
+        g_string_append_len (s, CACHE_MAGIC, CACHE_MAGIC_LEN);
+        put_u32 (s, CACHE_VERSION);
+        put_u32 (s, CACHE_BOM);
+        put_string (s, stamp);
+
+        put_u32 (s, g_list_length (papers));
+        for ( p = papers; p != NULL; p = p->next )
+        {
+                put_paper (s, p->data);
+        }
+
+        put_u32 (s, g_list_length (categories));
+        for ( p = categories; p != NULL; p = p->next )
+        {
+                put_category (s, p->data);
+        }
+
+        put_u32 (s, g_list_length (vendors));
+        for ( p = vendors; p != NULL; p = p->next )
+        {
+                put_vendor (s, p->data);
+        }
+
+        put_u32 (s, g_list_length (templates));
+        for ( p = templates; p != NULL; p = p->next )
+        {
+                put_template (s, p->data);
+        }
+
+        dir = CACHE_DIR;
+        g_mkdir_with_parents (dir, 0775);
+        filename = g_build_filename (dir, CACHE_FILENAME, NULL);
+
+        /* Written to a temporary file and renamed, so readers never see a partial cache. */
+        if ( !g_file_set_contents (filename, s->str, s->len, &gerror) )
+        {
+                g_message ("Cannot write template database cache: %s", gerror->message);
+                g_error_free (gerror);
+        }
+
+        g_free (dir);
+        g_free (filename);
+        g_string_free (s, TRUE);
+}
+
+
+/*--------------------------------------------------------------------------*/
+/* PRIVATE.  Add names, sizes and modification times of directory entries.  */
+/*--------------------------------------------------------------------------*/
+static void
+stamp_dir (GChecksum   *checksum,
+           const gchar *dirname)
+{
+        GDir        *dp;
+        const gchar *filename;
+        gchar       *full_filename;
+        GStatBuf     st;
+        gchar       *entry;
+
+        g_checksum_update (checksum, (const guchar *)dirname, -1);
+        g_checksum_update (checksum, (const guchar *)"\n", 1);
+
+        dp = g_dir_open (dirname, 0, NULL);
+        if ( dp == NULL )
+        {
+                return;
+        }
+
+        /* Entries are hashed in directory order, which is also the order they are parsed in. */
+        while ((filename = g_dir_read_name (dp)) != NULL)
+        {
+                full_filename = g_build_filename (dirname, filename, NULL);
+                if ( g_stat (full_filename, &st) == 0 )
+                {
+                        entry = g_strdup_printf ("%s %" G_GINT64_FORMAT " %" G_GINT64_FORMAT "\n",
+                                                 filename,
+                                                 (gint64)st.st_size,
+                                                 (gint64)st.st_mtime);
+                        g_checksum_update (checksum, (const guchar *)entry, -1);
+                        g_free (entry);
+                }
+                g_free (full_filename);
+        }
+
+        g_dir_close (dp);
+}
+
+
+/*--------------------------------------------------------------------------*/
+/* PRIVATE.  Primitive writers.                                             */
+/*--------------------------------------------------------------------------*/
+static void
+put_u32 (GString *s,
+         guint32  value)
+{
+        g_string_append_len (s, (const gchar *)&value, sizeof (value));
+}
+
+
+static void
+put_double (GString *s,
+            gdouble  value)
+{
+        g_string_append_len (s, (const gchar *)&value, sizeof (value));
+}
+
+
+static void
+put_string (GString     *s,
+            const gchar *value)
+{
+        guint32 len;
+
+        if ( value == NULL )
+        {
+                put_u32 (s, NULL_STRING);
+                return;
+        }
+
+        len = strlen (value);
+        put_u32 (s, len);
+        g_string_append_len (s, value, len);
+}
+
+
+/*--------------------------------------------------------------------------*/
+/* PRIVATE.  Primitive readers.  On overrun, set error and return zero/NULL. */
+/*--------------------------------------------------------------------------*/
+static guint32
+get_u32 (Reader *r)
+{
+        guint32 value;
+
+        if ( r->error || ((r->end - r->p) < (gssize)sizeof (value)) )
+        {
+                r->error = TRUE;
+                return 0;
+        }
+
+        memcpy (&value, r->p, sizeof (value));
+        r->p += sizeof (value);
+
+        return value;
+}
+
+
+static gdouble
+get_double (Reader *r)
+{
+        gdouble value;
+
+        if ( r->error || ((r->end - r->p) < (gssize)sizeof (value)) )
+        {
+                r->error = TRUE;
+                return 0.0;
+        }
+
+        memcpy (&value, r->p, sizeof (value));
+        r->p += sizeof (value);
+
+        return value;
+}
+
+
+static gchar *
+get_string (Reader *r)
+{
+        guint32  len;
+        gchar   *value;
+
+        len = get_u32 (r);
+        if ( r->error || (len == NULL_STRING) )
+        {
+                return NULL;
+        }
+
+        if ( (guint32)(r->end - r->p) < len )
+        {
+                r->error = TRUE;
+                return NULL;
+        }
+
+        value = g_strndup ((const gchar *)r->p, len);
+        r->p += len;
+
+        return value;
+}
+
+
+/*--------------------------------------------------------------------------*/
+/* PRIVATE.  Papers, categories and vendors.                                */
+/*--------------------------------------------------------------------------*/
+static void
+put_paper (GString        *s,
+           const lglPaper *paper)
+{
+        put_string (s, paper->id);
+        put_string (s, paper->name);
+        put_double (s, paper->width);
+        put_double (s, paper->height);
+        put_string (s, paper->pwg_size);
+}
+
+
+static lglPaper *
+get_paper (Reader *r)
+{
+        lglPaper *paper;
+
+        paper = g_new0 (lglPaper, 1);
+
+        paper->id       = get_string (r);
+        paper->name     = get_string (r);
+        paper->width    = get_double (r);
+        paper->height   = get_double (r);
+        paper->pwg_size = get_string (r);
+
+        return paper;
+}
+
+
+static void
+put_category (GString           *s,
+              const lglCategory *category)
+{
+        put_string (s, category->id);
+        put_string (s, category->name);
+}
+
+
+static lglCategory *
+get_category (Reader *r)
+{
+        lglCategory *category;
+
+        category = g_new0 (lglCategory, 1);
+
+        category->id   = get_string (r);
+        category->name = get_string (r);
+
+        return category;
+}
+
+
+static void
+put_vendor (GString         *s,
+            const lglVendor *vendor)
+{
+        put_string (s, vendor->name);
+        put_string (s, vendor->url);
+}
+
+
+static lglVendor *
+get_vendor (Reader *r)
+{
+        lglVendor *vendor;
+
+        vendor = g_new0 (lglVendor, 1);
+
+        vendor->name = get_string (r);
+        vendor->url  = get_string (r);
+
+        return vendor;
+}
+
+
+/*--------------------------------------------------------------------------*/
+/* PRIVATE.  Templates.                                                     */
+/*--------------------------------------------------------------------------*/
+static void
+put_template (GString           *s,
+              const lglTemplate *template)
+{
+        GList *p;
+
+        put_string (s, template->brand);
+        put_string (s, template->part);
+        put_string (s, template->equiv_part);
+        put_string (s, template->description);
+        put_string (s, template->paper_id);
+        put_double (s, template->page_width);
+        put_double (s, template->page_height);
+        put_string (s, template->product_url);
+
+        put_u32 (s, g_list_length (template->category_ids));
+        for ( p = template->category_ids; p != NULL; p = p->next )
+        {
+                put_string (s, p->data);
+        }
+
+        put_u32 (s, g_list_length (template->frames));
+        for ( p = template->frames; p != NULL; p = p->next )
+        {
+                put_frame (s, p->data);
+        }
+}
+
+
+static lglTemplate *
+get_template (Reader *r)
+{
+        lglTemplate *template;
+        guint32      n, i;
+
+        template = g_new0 (lglTemplate, 1);
+
+        template->brand       = get_string (r);
+        template->part        = get_string (r);
+        template->equiv_part  = get_string (r);
+        template->description = get_string (r);
+        template->paper_id    = get_string (r);
+        template->page_width  = get_double (r);
+        template->page_height = get_double (r);
+        template->product_url = get_string (r);
+
+        n = get_u32 (r);
+        for ( i = 0; (i < n) && !r->error; i++ )
+        {
+                template->category_ids = g_list_prepend (template->category_ids, get_string (r));
+        }
+        template->category_ids = g_list_reverse (template->category_ids);
+
+        n = get_u32 (r);
+        for ( i = 0; (i < n) && !r->error; i++ )
+        {
+                template->frames = g_list_prepend (template->frames, get_frame (r));
+        }
+        template->frames = g_list_reverse (template->frames);
+
+        return template;
+}
+
+
+static void
+put_frame (GString                *s,
+           const lglTemplateFrame *frame)
+{
+        GList             *p;
+        lglTemplateLayout *layout;
+
+        put_u32 (s, frame->shape);
+        put_string (s, frame->all.id);
+
+        switch (frame->shape)
+        {
+
+        case LGL_TEMPLATE_FRAME_SHAPE_RECT:
+                put_double (s, frame->rect.w);
+                put_double (s, frame->rect.h);
+                put_double (s, frame->rect.r);
+                put_double (s, frame->rect.x_waste);
+                put_double (s, frame->rect.y_waste);
+                break;
+
+        case LGL_TEMPLATE_FRAME_SHAPE_ELLIPSE:
+                put_double (s, frame->ellipse.w);
+                put_double (s, frame->ellipse.h);
+                put_double (s, frame->ellipse.waste);
+                break;
+
+        case LGL_TEMPLATE_FRAME_SHAPE_ROUND:
+                put_double (s, frame->round.r);
+                put_double (s, frame->round.waste);
+                break;
+
+        case LGL_TEMPLATE_FRAME_SHAPE_CD:
+                put_double (s, frame->cd.r1);
+                put_double (s, frame->cd.r2);
+                put_double (s, frame->cd.w);
+                put_double (s, frame->cd.h);
+                put_double (s, frame->cd.waste);
+                break;
+
+        default:
+                g_assert_not_reached ();
+                break;
+        }
+
+        put_u32 (s, g_list_length (frame->all.layouts));
+        for ( p = frame->all.layouts; p != NULL; p = p->next )
+        {
+                layout = (lglTemplateLayout *)p->data;
+
+                put_u32 (s, layout->nx);
+                put_u32 (s, layout->ny);
+                put_double (s, layout->x0);
+                put_double (s, layout->y0);
+                put_double (s, layout->dx);
+                put_double (s, layout->dy);
+        }
+
+        put_u32 (s, g_list_length (frame->all.markups));
+        for ( p = frame->all.markups; p != NULL; p = p->next )
+        {
+                put_markup (s, p->data);
+        }
+}
+
+
+static lglTemplateFrame *
+get_frame (Reader *r)
+{
+        lglTemplateFrame  *frame;
+        lglTemplateLayout *layout;
+        guint32            n, i;
+
+        frame = g_new0 (lglTemplateFrame, 1);
+
+        frame->shape  = get_u32 (r);
+        frame->all.id = get_string (r);
+
+        switch (frame->shape)
+        {
+
+        case LGL_TEMPLATE_FRAME_SHAPE_RECT:
+                frame->rect.w       = get_double (r);
+                frame->rect.h       = get_double (r);
+                frame->rect.r       = get_double (r);
+                frame->rect.x_waste = get_double (r);
+                frame->rect.y_waste = get_double (r);
+                break;
+
+        case LGL_TEMPLATE_FRAME_SHAPE_ELLIPSE:
+                frame->ellipse.w     = get_double (r);
+                frame->ellipse.h     = get_double (r);
+                frame->ellipse.waste = get_double (r);
+                break;
+
+        case LGL_TEMPLATE_FRAME_SHAPE_ROUND:
+                frame->round.r     = get_double (r);
+                frame->round.waste = get_double (r);
+                break;
+
+        case LGL_TEMPLATE_FRAME_SHAPE_CD:
+                frame->cd.r1    = get_double (r);
+                frame->cd.r2    = get_double (r);
+                frame->cd.w     = get_double (r);
+                frame->cd.h     = get_double (r);
+                frame->cd.waste = get_double (r);
+                break;
+
+        default:
+                /* Keep frame freeable. */
+                frame->shape = LGL_TEMPLATE_FRAME_SHAPE_RECT;
+                r->error = TRUE;
+                return frame;
+        }
+
+        n = get_u32 (r);
+        for ( i = 0; (i < n) && !r->error; i++ )
+        {
+                layout = g_new0 (lglTemplateLayout, 1);
+
+                layout->nx = get_u32 (r);
+                layout->ny = get_u32 (r);
+                layout->x0 = get_double (r);
+                layout->y0 = get_double (r);
+                layout->dx = get_double (r);
+                layout->dy = get_double (r);
+
+                frame->all.layouts = g_list_prepend (frame->all.layouts, layout);
+        }
+        frame->all.layouts = g_list_reverse (frame->all.layouts);
+
+        n = get_u32 (r);
+        for ( i = 0; (i < n) && !r->error; i++ )
+        {
+                frame->all.markups = g_list_prepend (frame->all.markups, get_markup (r));
+        }
+        frame->all.markups = g_list_reverse (frame->all.markups);
+
+        return frame;
+}
+
+
+static void
+put_markup (GString                 *s,
+            const lglTemplateMarkup *markup)
+{
+        put_u32 (s, markup->type);
+
+        switch (markup->type)
+        {
+
+        case LGL_TEMPLATE_MARKUP_MARGIN:
+                put_double (s, markup->margin.size);
+                break;
+
+        case LGL_TEMPLATE_MARKUP_LINE:
+                put_double (s, markup->line.x1);
+                put_double (s, markup->line.y1);
+                put_double (s, markup->line.x2);
+                put_double (s, markup->line.y2);
+                break;
+
+        case LGL_TEMPLATE_MARKUP_CIRCLE:
+                put_double (s, markup->circle.x0);
+                put_double (s, markup->circle.y0);
+                put_double (s, markup->circle.r);
+                break;
+
+        case LGL_TEMPLATE_MARKUP_RECT:
+                put_double (s, markup->rect.x1);
+                put_double (s, markup->rect.y1);
+                put_double (s, markup->rect.w);
+                put_double (s, markup->rect.h);
+                put_double (s, markup->rect.r);
+                break;
+
+        case LGL_TEMPLATE_MARKUP_ELLIPSE:
+                put_double (s, markup->ellipse.x1);
+                put_double (s, markup->ellipse.y1);
+                put_double (s, markup->ellipse.w);
+                put_double (s, markup->ellipse.h);
+                break;
+
+        default:
+                g_assert_not_reached ();
+                break;
+        }
+}
+
+
+static lglTemplateMarkup *
+get_markup (Reader *r)
+{
+        lglTemplateMarkup *markup;
+
+        markup = g_new0 (lglTemplateMarkup, 1);
+
+        markup->type = get_u32 (r);
+
+        switch (markup->type)
+        {
+
+        case LGL_TEMPLATE_MARKUP_MARGIN:
+                markup->margin.size = get_double (r);
+                break;
+
+        case LGL_TEMPLATE_MARKUP_LINE:
+                markup->line.x1 = get_double (r);
+                markup->line.y1 = get_double (r);
+                markup->line.x2 = get_double (r);
+                markup->line.y2 = get_double (r);
+                break;
+
+        case LGL_TEMPLATE_MARKUP_CIRCLE:
+                markup->circle.x0 = get_double (r);
+                markup->circle.y0 = get_double (r);
+                markup->circle.r  = get_double (r);
+                break;
+
+        case LGL_TEMPLATE_MARKUP_RECT:
+                markup->rect.x1 = get_double (r);
+                markup->rect.y1 = get_double (r);
+                markup->rect.w  = get_double (r);
+                markup->rect.h  = get_double (r);
+                markup->rect.r  = get_double (r);
+                break;
+
+        case LGL_TEMPLATE_MARKUP_ELLIPSE:
+                markup->ellipse.x1 = get_double (r);
+                markup->ellipse.y1 = get_double (r);
+                markup->ellipse.w  = get_double (r);
+                markup->ellipse.h  = get_double (r);
+                break;
+
+        default:
+                r->error = TRUE;
+                break;
+        }
+
+        return markup;
+}
+
+
+
+
+/*
+ * Local Variables:       -- emacs
+ * mode: C                -- emacs
+ * c-basic-offset: 8      -- emacs
+ * tab-width: 8           -- emacs
+ * indent-tabs-mode: nil  -- emacs
+ * End:                   -- emacs
+ */
@@ -32,6 +32,7 @@
 
 #include "libglabels-private.h"
 
+#include "lgl-db-cache.h"
 #include "lgl-xml-paper.h"
 #include "lgl-xml-category.h"
 #include "lgl-xml-vendor.h"
@@ -70,8 +71,24 @@ struct _lglDbModel {
         GList      *categories;
         GList      *vendors;
         GList      *templates;
+        GList      *templates_tail;
 
-        GHashTable *template_cache;
+        /*
+         * Indices.  Keys are folded with utf8_key() or ascii_key() to match the
+         * case-insensitive comparisons used throughout libglabels.  Values are
+         * borrowed from the lists above.
+         */
+        GHashTable *paper_id_index;          /* id -> lglPaper */
+        GHashTable *paper_name_index;        /* name -> lglPaper */
+        GHashTable *category_id_index;       /* id -> lglCategory */
+        GHashTable *category_name_index;     /* name -> lglCategory */
+        GHashTable *vendor_name_index;       /* name -> lglVendor */
+
+        GHashTable *template_index;          /* brand+part -> lglTemplate */
+        GHashTable *template_name_index;     /* "brand part" -> lglTemplate */
+        GHashTable *brand_templates;         /* brand -> GList of lglTemplate */
+        GHashTable *paper_templates;         /* paper id -> GList of lglTemplate */
+        GHashTable *category_templates;      /* category id -> GList of lglTemplate */
 };
 
 
@@ -93,6 +110,19 @@ enum {
 };
 
 
+/* Template file being parsed by the template reader thread pool. */
+typedef struct {
+        gchar              *filename;
+        lglXmlTemplateFile *file;
+        gboolean            done;
+} TemplateFileJob;
+
+typedef struct {
+        GMutex              mutex;
+        GCond               cond;
+} TemplateFileQueue;
+
+
 /*===========================================*/
 /* Private globals                           */
 /*===========================================*/
@@ -108,7 +138,31 @@ static lglDbModel *model = NULL;
 
 static void   lgl_db_model_finalize        (GObject     *object);
 
-static void   add_to_template_cache        (lglTemplate *template);
+static gchar *utf8_key                     (const gchar *s);
+static gchar *ascii_key                    (const gchar *s);
+static gchar *brand_part_key               (const gchar *brand,
+                                            const gchar *part);
+
+static void   multi_index_add              (GHashTable  *index,
+                                            gchar       *key,
+                                            lglTemplate *template);
+static void   multi_index_remove           (GHashTable  *index,
+                                            const gchar *key,
+                                            lglTemplate *template);
+
+static void   index_papers                 (void);
+static void   index_categories             (void);
+static void   index_vendors                (void);
+
+static void   add_template                 (lglTemplate *template);
+static void   remove_template              (GList       *link);
+static void   add_template_category        (lglTemplate *template,
+                                            const gchar *category_id);
+static GList *get_template_candidates      (const gchar *brand,
+                                            const gchar *paper_id,
+                                            const gchar *category_id);
+
+static gchar *cache_stamp                  (void);
 
 static GList *read_papers                  (void);
 static GList *read_paper_files_from_dir    (GList       *papers,
@@ -123,7 +177,10 @@ static GList *read_vendor_files_from_dir   (GList       *vendors,
                                             const gchar *dirname);
 
 static void   read_templates               (void);
-static void   read_template_files_from_dir (const gchar *dirname);
+static GList *find_template_files_in_dir   (GList       *filenames,
+                                            const gchar *dirname);
+static void   template_file_job_func       (TemplateFileJob   *job,
+                                            TemplateFileQueue *queue);
 
 static lglTemplate *template_full_page     (const gchar *page_size);
 
@@ -164,7 +221,17 @@ lgl_db_model_class_init (lglDbModelClass *class)
 static void
 lgl_db_model_init (lglDbModel *this)
 {
-        this->template_cache = g_hash_table_new_full (g_str_hash, g_str_equal, g_free, (GDestroyNotify)lgl_template_free);
+        this->paper_id_index      = g_hash_table_new_full (g_str_hash, g_str_equal, g_free, NULL);
+        this->paper_name_index    = g_hash_table_new_full (g_str_hash, g_str_equal, g_free, NULL);
+        this->category_id_index   = g_hash_table_new_full (g_str_hash, g_str_equal, g_free, NULL);
+        this->category_name_index = g_hash_table_new_full (g_str_hash, g_str_equal, g_free, NULL);
+        this->vendor_name_index   = g_hash_table_new_full (g_str_hash, g_str_equal, g_free, NULL);
+
+        this->template_index      = g_hash_table_new_full (g_str_hash, g_str_equal, g_free, NULL);
+        this->template_name_index = g_hash_table_new_full (g_str_hash, g_str_equal, g_free, NULL);
+        this->brand_templates     = g_hash_table_new_full (g_str_hash, g_str_equal, g_free, (GDestroyNotify)g_list_free);
+        this->paper_templates     = g_hash_table_new_full (g_str_hash, g_str_equal, g_free, (GDestroyNotify)g_list_free);
+        this->category_templates  = g_hash_table_new_full (g_str_hash, g_str_equal, g_free, (GDestroyNotify)g_list_free);
 }
 
 
@@ -180,7 +247,17 @@ lgl_db_model_finalize (GObject *object)
         g_return_if_fail (object && IS_LGL_DB_MODEL (object));
         this = LGL_DB_MODEL (object);
 
-        g_hash_table_unref (this->template_cache);
+        g_hash_table_unref (this->paper_id_index);
+        g_hash_table_unref (this->paper_name_index);
+        g_hash_table_unref (this->category_id_index);
+        g_hash_table_unref (this->category_name_index);
+        g_hash_table_unref (this->vendor_name_index);
+
+        g_hash_table_unref (this->template_index);
+        g_hash_table_unref (this->template_name_index);
+        g_hash_table_unref (this->brand_templates);
+        g_hash_table_unref (this->paper_templates);
+        g_hash_table_unref (this->category_templates);
 
         for (p = this->papers; p != NULL; p = p->next)
         {
@@ -252,9 +329,30 @@ lgl_db_init (void)
         lglTemplate *template;
         GList       *page_sizes;
         GList       *p;
+        gchar       *stamp;
+        GList       *templates = NULL;
 
         model = lgl_db_model_new ();
 
+        /*
+         * Try the binary cache first, it is much faster than parsing XML.
+         */
+        stamp = cache_stamp ();
+        if ( _lgl_db_cache_read (stamp, &model->papers, &model->categories,
+                                 &model->vendors, &templates) )
+        {
+                index_papers ();
+                index_categories ();
+                index_vendors ();
+                for ( p = templates; p != NULL; p = p->next )
+                {
+                        add_template ((lglTemplate *)p->data);
+                }
+                g_list_free (templates);
+                g_free (stamp);
+                return;
+        }
+
         /*
          * Paper definitions
          */
@@ -266,6 +364,7 @@ lgl_db_init (void)
          * "letter", "A4", etc. */
         paper_other = lgl_paper_new ("Other", _("Other"), 0.0, 0.0, NULL);
         model->papers = g_list_append (model->papers, paper_other);
+        index_papers ();
 
         /*
          * Categories
@@ -275,11 +374,13 @@ lgl_db_init (void)
         /* Create and append a "User defined" entry. */
         category_user_defined = lgl_category_new ("user-defined", _("User defined"));
         model->categories = g_list_append (model->categories, category_user_defined);
+        index_categories ();
 
         /*
          * Vendors
          */
         model->vendors = read_vendors ();
+        index_vendors ();
 
         /*
          * Templates
@@ -299,6 +400,9 @@ lgl_db_init (void)
         }
         lgl_db_free_paper_id_list (page_sizes);
 
+        _lgl_db_cache_write (stamp, model->papers, model->categories,
+                             model->vendors, model->templates);
+        g_free (stamp);
 }
 
 
@@ -459,7 +563,7 @@ lgl_db_free_paper_name_list (GList *names)
 lglPaper *
 lgl_db_lookup_paper_from_name (const gchar *name)
 {
-        GList       *p;
+        gchar       *key;
         lglPaper    *paper;
 
         if (!model)
@@ -473,16 +577,11 @@ lgl_db_lookup_paper_from_name (const gchar *name)
                 return lgl_paper_dup ((lglPaper *) model->papers->data);
         }
 
-        for (p = model->papers; p != NULL; p = p->next)
-        {
-                paper = (lglPaper *) p->data;
-                if (UTF8_EQUAL (paper->name, name))
-                {
-                        return lgl_paper_dup (paper);
-                }
-        }
+        key = utf8_key (name);
+        paper = g_hash_table_lookup (model->paper_name_index, key);
+        g_free (key);
 
-        return NULL;
+        return paper ? lgl_paper_dup (paper) : NULL;
 }
 
 
@@ -498,7 +597,7 @@ lgl_db_lookup_paper_from_name (const gchar *name)
 lglPaper *
 lgl_db_lookup_paper_from_id (const gchar *id)
 {
-        GList       *p;
+        gchar       *key;
         lglPaper    *paper;
 
         if (!model)
@@ -512,16 +611,11 @@ lgl_db_lookup_paper_from_id (const gchar *id)
                 return lgl_paper_dup ((lglPaper *) model->papers->data);
         }
 
-        for (p = model->papers; p != NULL; p = p->next)
-        {
-                paper = (lglPaper *) p->data;
-                if (ASCII_EQUAL (paper->id, id))
-                {
-                        return lgl_paper_dup (paper);
-                }
-        }
+        key = ascii_key (id);
+        paper = g_hash_table_lookup (model->paper_id_index, key);
+        g_free (key);
 
-        return NULL;
+        return paper ? lgl_paper_dup (paper) : NULL;
 }
 
 
@@ -597,8 +691,8 @@ lgl_db_lookup_paper_name_from_id (const gchar         *id)
 gboolean
 lgl_db_is_paper_id_known (const gchar *id)
 {
-        GList       *p;
-        lglPaper    *paper;
+        gchar       *key;
+        gboolean     known;
 
         if (!model)
         {
@@ -610,16 +704,11 @@ lgl_db_is_paper_id_known (const gchar *id)
                 return FALSE;
         }
 
-        for (p = model->papers; p != NULL; p = p->next)
-        {
-                paper = (lglPaper *) p->data;
-                if (ASCII_EQUAL (paper->id, id))
-                {
-                        return TRUE;
-                }
-        }
+        key = ascii_key (id);
+        known = g_hash_table_lookup (model->paper_id_index, key) != NULL;
+        g_free (key);
 
-        return FALSE;
+        return known;
 }
 
 
@@ -879,7 +968,7 @@ lgl_db_free_category_name_list (GList *names)
 lglCategory *
 lgl_db_lookup_category_from_name (const gchar *name)
 {
-        GList       *p;
+        gchar       *key;
         lglCategory *category;
 
         if (!model)
@@ -893,16 +982,11 @@ lgl_db_lookup_category_from_name (const gchar *name)
                 return lgl_category_dup ((lglCategory *) model->categories->data);
         }
 
-        for (p = model->categories; p != NULL; p = p->next)
-        {
-                category = (lglCategory *) p->data;
-                if (UTF8_EQUAL (category->name, name))
-                {
-                        return lgl_category_dup (category);
-                }
-        }
+        key = utf8_key (name);
+        category = g_hash_table_lookup (model->category_name_index, key);
+        g_free (key);
 
-        return NULL;
+        return category ? lgl_category_dup (category) : NULL;
 }
 
 
@@ -918,7 +1002,7 @@ lgl_db_lookup_category_from_name (const gchar *name)
 lglCategory *
 lgl_db_lookup_category_from_id (const gchar *id)
 {
-        GList       *p;
+        gchar       *key;
         lglCategory *category;
 
         if (!model)
@@ -932,16 +1016,11 @@ lgl_db_lookup_category_from_id (const gchar *id)
                 return lgl_category_dup ((lglCategory *) model->categories->data);
         }
 
-        for (p = model->categories; p != NULL; p = p->next)
-        {
-                category = (lglCategory *) p->data;
-                if (ASCII_EQUAL (category->id, id))
-                {
-                        return lgl_category_dup (category);
-                }
-        }
+        key = ascii_key (id);
+        category = g_hash_table_lookup (model->category_id_index, key);
+        g_free (key);
 
-        return NULL;
+        return category ? lgl_category_dup (category) : NULL;
 }
 
 
@@ -1017,8 +1096,8 @@ lgl_db_lookup_category_name_from_id (const gchar         *id)
 gboolean
 lgl_db_is_category_id_known (const gchar *id)
 {
-        GList       *p;
-        lglCategory *category;
+        gchar       *key;
+        gboolean     known;
 
         if (!model)
         {
@@ -1030,16 +1109,11 @@ lgl_db_is_category_id_known (const gchar *id)
                 return FALSE;
         }
 
-        for (p = model->categories; p != NULL; p = p->next)
-        {
-                category = (lglCategory *) p->data;
-                if (ASCII_EQUAL (category->id, id))
-                {
-                        return TRUE;
-                }
-        }
+        key = ascii_key (id);
+        known = g_hash_table_lookup (model->category_id_index, key) != NULL;
+        g_free (key);
 
-        return FALSE;
+        return known;
 }
 
 
@@ -1224,7 +1298,7 @@ lgl_db_free_vendor_name_list (GList *names)
 lglVendor *
 lgl_db_lookup_vendor_from_name (const gchar *name)
 {
-        GList       *p;
+        gchar       *key;
         lglVendor   *vendor;
 
         if (!model)
@@ -1238,16 +1312,11 @@ lgl_db_lookup_vendor_from_name (const gchar *name)
                 return lgl_vendor_dup ((lglVendor *) model->vendors->data);
         }
 
-        for (p = model->vendors; p != NULL; p = p->next)
-        {
-                vendor = (lglVendor *) p->data;
-                if (UTF8_EQUAL (vendor->name, name))
-                {
-                        return lgl_vendor_dup (vendor);
-                }
-        }
+        key = utf8_key (name);
+        vendor = g_hash_table_lookup (model->vendor_name_index, key);
+        g_free (key);
 
-        return NULL;
+        return vendor ? lgl_vendor_dup (vendor) : NULL;
 }
 
 
@@ -1263,8 +1332,8 @@ lgl_db_lookup_vendor_from_name (const gchar *name)
 gboolean
 lgl_db_is_vendor_name_known (const gchar *name)
 {
-        GList       *p;
-        lglVendor   *vendor;
+        gchar       *key;
+        gboolean     known;
 
         if (!model)
         {
@@ -1276,16 +1345,11 @@ lgl_db_is_vendor_name_known (const gchar *name)
                 return FALSE;
         }
 
-        for (p = model->vendors; p != NULL; p = p->next)
-        {
-                vendor = (lglVendor *) p->data;
-                if (UTF8_EQUAL (vendor->name, name))
-                {
-                        return TRUE;
-                }
-        }
+        key = utf8_key (name);
+        known = g_hash_table_lookup (model->vendor_name_index, key) != NULL;
+        g_free (key);
 
-        return FALSE;
+        return known;
 }
 
 
@@ -1419,6 +1483,8 @@ lgl_db_get_brand_list (const gchar *paper_id,
 {
         GList            *p_tmplt;
         lglTemplate      *template;
+        GHashTable       *seen;
+        gchar            *key;
         GList            *brands = NULL;
 
         if (!model)
@@ -1426,24 +1492,31 @@ lgl_db_get_brand_list (const gchar *paper_id,
                 lgl_db_init ();
         }
 
-        for (p_tmplt = model->templates; p_tmplt != NULL; p_tmplt = p_tmplt->next)
+        seen = g_hash_table_new_full (g_str_hash, g_str_equal, g_free, NULL);
+
+        p_tmplt = get_template_candidates (NULL, paper_id, category_id);
+        for ( ; p_tmplt != NULL; p_tmplt = p_tmplt->next)
         {
                 template = (lglTemplate *) p_tmplt->data;
                 if (lgl_template_does_page_size_match (template, paper_id) &&
                     lgl_template_does_category_match (template, category_id))
                 {
-
-                        if ( !g_list_find_custom (brands, template->brand,
-                                                  (GCompareFunc)lgl_str_utf8_casecmp) )
+                        key = utf8_key (template->brand);
+                        if ( !g_hash_table_lookup (seen, key) )
                         {
-                                brands = g_list_insert_sorted (brands,
-                                                               g_strdup (template->brand),
-                                                               (GCompareFunc)lgl_str_utf8_casecmp);
+                                g_hash_table_insert (seen, key, template);
+                                brands = g_list_prepend (brands, g_strdup (template->brand));
+                        }
+                        else
+                        {
+                                g_free (key);
                         }
                 }
         }
 
-        return brands;
+        g_hash_table_unref (seen);
+
+        return g_list_sort (brands, (GCompareFunc)lgl_str_utf8_casecmp);
 }
 
 
@@ -1482,8 +1555,7 @@ _lgl_db_register_template_internal (const lglTemplate   *template)
         if (!lgl_db_does_template_exist (template->brand, template->part))
         {
                 template_copy = lgl_template_dup (template);
-                model->templates = g_list_append (model->templates, template_copy);
-                add_to_template_cache (template_copy);
+                add_template (template_copy);
         }
         else
         {
@@ -1533,8 +1605,7 @@ lgl_db_register_template (const lglTemplate *template)
                 {
                         template_copy = lgl_template_dup (template);
                         lgl_template_add_category (template_copy, "user-defined");
-                        model->templates = g_list_append (model->templates, template_copy);
-                        add_to_template_cache (template_copy);
+                        add_template (template_copy);
                         g_signal_emit (G_OBJECT (model), signals[CHANGED], 0);
                         return LGL_DB_REG_OK;
                 }
@@ -1567,6 +1638,7 @@ lgl_db_delete_template_by_name (const gchar *name)
 {
         lglTemplate *template, *template1;
         gchar       *dir, *filename, *abs_filename;
+        gchar       *key;
         GList       *p;
 
         if (!model)
@@ -1598,16 +1670,14 @@ lgl_db_delete_template_by_name (const gchar *name)
                 g_free (filename);
                 g_free (abs_filename);
 
-                for ( p=model->templates; p != NULL; p=p->next )
-                {
-                        template1 = (lglTemplate *)p->data;
+                key = brand_part_key (template->brand, template->part);
+                template1 = g_hash_table_lookup (model->template_index, key);
+                g_free (key);
 
-                        if ( lgl_template_do_templates_match (template, template1) )
-                        {
-                                model->templates = g_list_delete_link (model->templates, p);
-                                g_hash_table_remove (model->template_cache, name);
-                                break;
-                        }
+                p = g_list_find (model->templates, template1);
+                if ( p != NULL )
+                {
+                        remove_template (p);
                 }
 
                 lgl_template_free (template);
@@ -1664,8 +1734,8 @@ gboolean
 lgl_db_does_template_exist (const gchar *brand,
                             const gchar *part)
 {
-        GList            *p_tmplt;
-        lglTemplate      *template;
+        gchar            *key;
+        gboolean          exists;
 
         if (!model)
         {
@@ -1677,18 +1747,11 @@ lgl_db_does_template_exist (const gchar *brand,
                 return FALSE;
         }
 
-        for (p_tmplt = model->templates; p_tmplt != NULL; p_tmplt = p_tmplt->next)
-        {
-                template = (lglTemplate *) p_tmplt->data;
+        key = brand_part_key (brand, part);
+        exists = g_hash_table_lookup (model->template_index, key) != NULL;
+        g_free (key);
 
-                if ( UTF8_EQUAL (brand, template->brand) &&
-                     UTF8_EQUAL (part, template->part) )
-                {
-                        return TRUE;
-                }
-        }
-
-        return FALSE;
+        return exists;
 }
 
 
@@ -1704,9 +1767,8 @@ lgl_db_does_template_exist (const gchar *brand,
 gboolean
 lgl_db_does_template_name_exist (const gchar *name)
 {
-        GList            *p_tmplt;
-        lglTemplate      *template;
-        gchar            *candidate_name;
+        gchar            *key;
+        gboolean          exists;
 
         if (!model)
         {
@@ -1718,20 +1780,11 @@ lgl_db_does_template_name_exist (const gchar *name)
                 return FALSE;
         }
 
-        for (p_tmplt = model->templates; p_tmplt != NULL; p_tmplt = p_tmplt->next)
-        {
-                template = (lglTemplate *) p_tmplt->data;
-                candidate_name = g_strdup_printf ("%s %s", template->brand, template->part);
-
-                if ( UTF8_EQUAL (candidate_name, name) )
-                {
-                        g_free (candidate_name);
-                        return TRUE;
-                }
-                g_free (candidate_name);
-        }
+        key = utf8_key (name);
+        exists = g_hash_table_lookup (model->template_name_index, key) != NULL;
+        g_free (key);
 
-        return FALSE;
+        return exists;
 }
 
 
@@ -1763,7 +1816,8 @@ lgl_db_get_template_name_list_all (const gchar *brand,
                 lgl_db_init ();
         }
 
-        for (p_tmplt = model->templates; p_tmplt != NULL; p_tmplt = p_tmplt->next)
+        p_tmplt = get_template_candidates (brand, paper_id, category_id);
+        for ( ; p_tmplt != NULL; p_tmplt = p_tmplt->next)
         {
                 template = (lglTemplate *) p_tmplt->data;
                 if (lgl_template_does_brand_match (template, brand) &&
@@ -1771,11 +1825,11 @@ lgl_db_get_template_name_list_all (const gchar *brand,
                     lgl_template_does_category_match (template, category_id))
                 {
                         name = g_strdup_printf ("%s %s", template->brand, template->part);
-                        names = g_list_insert_sorted (names, name, (GCompareFunc)lgl_str_part_name_cmp);
+                        names = g_list_prepend (names, name);
                 }
         }
 
-        return names;
+        return g_list_sort (names, (GCompareFunc)lgl_str_part_name_cmp);
 }
 
 
@@ -1813,7 +1867,9 @@ lgl_db_get_similar_template_name_list (const gchar  *name)
                 return NULL;
         }
 
-        for (p_tmplt = model->templates; p_tmplt != NULL; p_tmplt = p_tmplt->next)
+        /* Identical templates always share the same page size. */
+        p_tmplt = get_template_candidates (NULL, template1->paper_id, NULL);
+        for ( ; p_tmplt != NULL; p_tmplt = p_tmplt->next)
         {
                 template2 = (lglTemplate *) p_tmplt->data;
 
@@ -1823,14 +1879,19 @@ lgl_db_get_similar_template_name_list (const gchar  *name)
                         name2 = g_strdup_printf ("%s %s", template2->brand, template2->part);
                         if ( !UTF8_EQUAL (name2, name) )
                         {
-                                names = g_list_insert_sorted (names, name2,
-                                                              (GCompareFunc)lgl_str_part_name_cmp);
+                                names = g_list_prepend (names, name2);
+                        }
+                        else
+                        {
+                                g_free (name2);
                         }
 
                 }
         }
 
-        return names;
+        lgl_template_free (template1);
+
+        return g_list_sort (names, (GCompareFunc)lgl_str_part_name_cmp);
 }
 
 
@@ -1869,6 +1930,7 @@ lgl_db_free_template_name_list (GList *names)
 lglTemplate *
 lgl_db_lookup_template_from_name (const gchar *name)
 {
+        gchar            *key;
         lglTemplate      *template;
         lglTemplate      *new_template;
 
@@ -1883,7 +1945,9 @@ lgl_db_lookup_template_from_name (const gchar *name)
                 return lgl_template_dup ((lglTemplate *) model->templates->data);
         }
 
-        template = g_hash_table_lookup (model->template_cache, name);
+        key = utf8_key (name);
+        template = g_hash_table_lookup (model->template_name_index, key);
+        g_free (key);
 
         if (template)
         {
@@ -1910,7 +1974,7 @@ lglTemplate *
 lgl_db_lookup_template_from_brand_part(const gchar *brand,
                                        const gchar *part)
 {
-        gchar            *name;
+        gchar            *key;
         lglTemplate      *template;
         lglTemplate      *new_template;
 
@@ -1925,8 +1989,9 @@ lgl_db_lookup_template_from_brand_part(const gchar *brand,
                 return lgl_template_dup ((lglTemplate *) model->templates->data);
         }
 
-        name = g_strdup_printf ("%s %s", brand, part);
-        template = g_hash_table_lookup (model->template_cache, name);
+        key = brand_part_key (brand, part);
+        template = g_hash_table_lookup (model->template_index, key);
+        g_free (key);
 
         if (template)
         {
@@ -1935,55 +2000,494 @@ lgl_db_lookup_template_from_brand_part(const gchar *brand,
         }
 
         /* No matching template has been found so return the first template */
-        g_free (name);
         return lgl_template_dup ((lglTemplate *) model->templates->data);
 }
 
 
+/*--------------------------------------------------------------------------*/
+/* PRIVATE.  Index key for UTF-8 strings compared with UTF8_EQUAL().        */
+/*--------------------------------------------------------------------------*/
+static gchar *
+utf8_key (const gchar *s)
+{
+        gchar *normalized;
+        gchar *key;
+
+        normalized = g_utf8_normalize (s, -1, G_NORMALIZE_ALL);
+        key = g_utf8_casefold (normalized ? normalized : s, -1);
+        g_free (normalized);
+
+        return key;
+}
+
+
+/*--------------------------------------------------------------------------*/
+/* PRIVATE.  Index key for ASCII ids compared with ASCII_EQUAL().           */
+/*--------------------------------------------------------------------------*/
+static gchar *
+ascii_key (const gchar *s)
+{
+        return g_ascii_strdown (s, -1);
+}
+
+
+/*--------------------------------------------------------------------------*/
+/* PRIVATE.  Index key for brand/part pairs.                                */
+/*--------------------------------------------------------------------------*/
+static gchar *
+brand_part_key (const gchar *brand,
+                const gchar *part)
+{
+        gchar *brand_key, *part_key, *key;
+
+        brand_key = utf8_key (brand);
+        part_key  = utf8_key (part);
+
+        /* Unit separator cannot be confused with part of a brand or part name. */
+        key = g_strconcat (brand_key, "\037", part_key, NULL);
+
+        g_free (brand_key);
+        g_free (part_key);
+
+        return key;
+}
+
+
+/*--------------------------------------------------------------------------*/
+/* PRIVATE.  Add template to a key -> template list index.  Takes ownership */
+/* of key.                                                                  */
+/*--------------------------------------------------------------------------*/
 static void
-add_to_template_cache (lglTemplate *template)
+multi_index_add (GHashTable  *index,
+                 gchar       *key,
+                 lglTemplate *template)
 {
-        gchar            *name;
+        GList *list;
+
+        if ( key == NULL )
+        {
+                return;
+        }
+
+        list = g_hash_table_lookup (index, key);
+        if ( list == NULL )
+        {
+                g_hash_table_insert (index, key, g_list_prepend (NULL, template));
+        }
+        else
+        {
+                /* Insert after head, so that the stored list pointer stays valid. */
+                g_list_insert (list, template, 1);
+                g_free (key);
+        }
+}
+
+
+/*--------------------------------------------------------------------------*/
+/* PRIVATE.  Remove template from a key -> template list index.             */
+/*--------------------------------------------------------------------------*/
+static void
+multi_index_remove (GHashTable  *index,
+                    const gchar *key,
+                    lglTemplate *template)
+{
+        gpointer  orig_key;
+        gpointer  list;
+
+        if ( !g_hash_table_lookup_extended (index, key, &orig_key, &list) )
+        {
+                return;
+        }
+
+        g_hash_table_steal (index, key);
+        list = g_list_remove ((GList *)list, template);
+        if ( list != NULL )
+        {
+                g_hash_table_insert (index, orig_key, list);
+        }
+        else
+        {
+                g_free (orig_key);
+        }
+}
+
+
+/*--------------------------------------------------------------------------*/
+/* PRIVATE.  Build paper indices.  First definition of an id or name wins.  */
+/*--------------------------------------------------------------------------*/
+static void
+index_papers (void)
+{
+        GList    *p;
+        lglPaper *paper;
+        gchar    *key;
+
+        for ( p = model->papers; p != NULL; p = p->next )
+        {
+                paper = (lglPaper *)p->data;
+
+                key = ascii_key (paper->id);
+                if ( !g_hash_table_lookup (model->paper_id_index, key) )
+                {
+                        g_hash_table_insert (model->paper_id_index, key, paper);
+                }
+                else
+                {
+                        g_free (key);
+                }
+
+                key = utf8_key (paper->name);
+                if ( !g_hash_table_lookup (model->paper_name_index, key) )
+                {
+                        g_hash_table_insert (model->paper_name_index, key, paper);
+                }
+                else
+                {
+                        g_free (key);
+                }
+        }
+}
+
+
+/*--------------------------------------------------------------------------*/
+/* PRIVATE.  Build category indices.  First definition of an id or name     */
+/* wins.                                                                    */
+/*--------------------------------------------------------------------------*/
+static void
+index_categories (void)
+{
+        GList       *p;
+        lglCategory *category;
+        gchar       *key;
+
+        for ( p = model->categories; p != NULL; p = p->next )
+        {
+                category = (lglCategory *)p->data;
+
+                key = ascii_key (category->id);
+                if ( !g_hash_table_lookup (model->category_id_index, key) )
+                {
+                        g_hash_table_insert (model->category_id_index, key, category);
+                }
+                else
+                {
+                        g_free (key);
+                }
+
+                key = utf8_key (category->name);
+                if ( !g_hash_table_lookup (model->category_name_index, key) )
+                {
+                        g_hash_table_insert (model->category_name_index, key, category);
+                }
+                else
+                {
+                        g_free (key);
+                }
+        }
+}
+
+
+/*--------------------------------------------------------------------------*/
+/* PRIVATE.  Build vendor index.  First definition of a name wins.          */
+/*--------------------------------------------------------------------------*/
+static void
+index_vendors (void)
+{
+        GList     *p;
+        lglVendor *vendor;
+        gchar     *key;
+
+        for ( p = model->vendors; p != NULL; p = p->next )
+        {
+                vendor = (lglVendor *)p->data;
+
+                key = utf8_key (vendor->name);
+                if ( !g_hash_table_lookup (model->vendor_name_index, key) )
+                {
+                        g_hash_table_insert (model->vendor_name_index, key, vendor);
+                }
+                else
+                {
+                        g_free (key);
+                }
+        }
+}
+
+
+/*--------------------------------------------------------------------------*/
+/* PRIVATE.  Append template to database and add it to all indices.         */
+/* Database takes ownership of template.                                    */
+/*--------------------------------------------------------------------------*/
+static void
+add_template (lglTemplate *template)
+{
+        gchar *name;
+        GList *p;
+
+        /* Keep a tail pointer, so that appending is not O(n). */
+        if ( model->templates == NULL )
+        {
+                model->templates = model->templates_tail = g_list_append (NULL, template);
+        }
+        else
+        {
+                model->templates_tail = g_list_append (model->templates_tail, template)->next;
+        }
+
+        g_hash_table_insert (model->template_index,
+                             brand_part_key (template->brand, template->part), template);
 
         name = g_strdup_printf ("%s %s", template->brand, template->part);
+        g_hash_table_insert (model->template_name_index, utf8_key (name), template);
+        g_free (name);
+
+        multi_index_add (model->brand_templates, utf8_key (template->brand), template);
+        multi_index_add (model->paper_templates, ascii_key (template->paper_id), template);
+
+        for ( p = template->category_ids; p != NULL; p = p->next )
+        {
+                multi_index_add (model->category_templates, ascii_key (p->data), template);
+        }
+}
+
+
+/*--------------------------------------------------------------------------*/
+/* PRIVATE.  Remove template from database and all indices, and free it.    */
+/*--------------------------------------------------------------------------*/
+static void
+remove_template (GList *link)
+{
+        lglTemplate *template = (lglTemplate *)link->data;
+        gchar       *key, *name;
+        GList       *p;
+
+        key = brand_part_key (template->brand, template->part);
+        g_hash_table_remove (model->template_index, key);
+        g_free (key);
+
+        name = g_strdup_printf ("%s %s", template->brand, template->part);
+        key = utf8_key (name);
+        g_hash_table_remove (model->template_name_index, key);
+        g_free (key);
+        g_free (name);
+
+        key = utf8_key (template->brand);
+        multi_index_remove (model->brand_templates, key, template);
+        g_free (key);
+
+        key = ascii_key (template->paper_id);
+        multi_index_remove (model->paper_templates, key, template);
+        g_free (key);
+
+        for ( p = template->category_ids; p != NULL; p = p->next )
+        {
+                key = ascii_key (p->data);
+                multi_index_remove (model->category_templates, key, template);
+                g_free (key);
+        }
+
+        if ( link == model->templates_tail )
+        {
+                model->templates_tail = link->prev;
+        }
+        model->templates = g_list_delete_link (model->templates, link);
+
+        lgl_template_free (template);
+}
+
+
+/*--------------------------------------------------------------------------*/
+/* PRIVATE.  Add category to template already in database.                 */
+/*--------------------------------------------------------------------------*/
+static void
+add_template_category (lglTemplate *template,
+                       const gchar *category_id)
+{
+        if ( !lgl_template_does_category_match (template, category_id) )
+        {
+                lgl_template_add_category (template, category_id);
+                multi_index_add (model->category_templates, ascii_key (category_id), template);
+        }
+}
+
+
+/*--------------------------------------------------------------------------*/
+/* PRIVATE.  Get smallest list of candidate templates for the given filters. */
+/* Candidates must still be tested against all filters.                     */
+/*--------------------------------------------------------------------------*/
+static GList *
+get_template_candidates (const gchar *brand,
+                         const gchar *paper_id,
+                         const gchar *category_id)
+{
+        GList *candidates = model->templates;
+        GList *list;
+        guint  n, n_min = G_MAXUINT;
+        gchar *key;
+
+        if ( brand != NULL )
+        {
+                key = utf8_key (brand);
+                list = g_hash_table_lookup (model->brand_templates, key);
+                g_free (key);
+
+                if ( list == NULL )
+                {
+                        return NULL;
+                }
+                n = g_list_length (list);
+                if ( n < n_min )
+                {
+                        candidates = list;
+                        n_min      = n;
+                }
+        }
 
-        g_hash_table_insert (model->template_cache, name, template);
+        if ( paper_id != NULL )
+        {
+                key = ascii_key (paper_id);
+                list = g_hash_table_lookup (model->paper_templates, key);
+                g_free (key);
+
+                if ( list == NULL )
+                {
+                        return NULL;
+                }
+                n = g_list_length (list);
+                if ( n < n_min )
+                {
+                        candidates = list;
+                        n_min      = n;
+                }
+        }
+
+        if ( category_id != NULL )
+        {
+                key = ascii_key (category_id);
+                list = g_hash_table_lookup (model->category_templates, key);
+                g_free (key);
+
+                if ( list == NULL )
+                {
+                        return NULL;
+                }
+                n = g_list_length (list);
+                if ( n < n_min )
+                {
+                        candidates = list;
+                        n_min      = n;
+                }
+        }
+
+        return candidates;
+}
+
+
+/*--------------------------------------------------------------------------*/
+/* PRIVATE.  Stamp of all directories the database is read from.            */
+/*--------------------------------------------------------------------------*/
+static gchar *
+cache_stamp (void)
+{
+        gchar *dirs[4];
+        gchar *stamp;
+
+        dirs[0] = SYSTEM_CONFIG_DIR;
+        dirs[1] = USER_CONFIG_DIR;
+        dirs[2] = ALT_USER_CONFIG_DIR;
+        dirs[3] = NULL;
+
+        stamp = _lgl_db_cache_stamp ((const gchar * const *)dirs);
+
+        g_free (dirs[0]);
+        g_free (dirs[1]);
+        g_free (dirs[2]);
+
+        return stamp;
 }
 
 
 void
 read_templates (void)
 {
-        gchar       *data_dir;
-        GList       *p;
-        lglTemplate *template;
+        gchar             *data_dir;
+        GList             *filenames = NULL;
+        guint              n_user, n_files, i;
+        GList             *p;
+        lglTemplate       *template;
+        TemplateFileJob   *jobs;
+        TemplateFileQueue  queue;
+        GThreadPool       *pool;
 
         /*
          * User defined templates.  Add to user-defined category.
          */
         data_dir = USER_CONFIG_DIR;
-        read_template_files_from_dir (data_dir);
+        filenames = find_template_files_in_dir (filenames, data_dir);
         g_free (data_dir);
-        for ( p=model->templates; p != NULL; p=p->next )
-        {
-                template = (lglTemplate *)p->data;
-                lgl_template_add_category (template, "user-defined");
-        }
+        n_user = g_list_length (filenames);
 
         /*
          * Alternate user defined templates.  (Used for manually created templates).
          */
         data_dir = ALT_USER_CONFIG_DIR;
-        read_template_files_from_dir (data_dir);
+        filenames = find_template_files_in_dir (filenames, data_dir);
         g_free (data_dir);
 
         /*
          * System templates.
          */
         data_dir = SYSTEM_CONFIG_DIR;
-        read_template_files_from_dir (data_dir);
+        filenames = find_template_files_in_dir (filenames, data_dir);
         g_free (data_dir);
 
+        /*
+         * Parse all files on a thread pool, but register their templates in
+         * the original order, so that the first definition of a template
+         * still wins and duplicate messages are unchanged.
+         */
+        n_files = g_list_length (filenames);
+        jobs    = g_new0 (TemplateFileJob, n_files);
+
+        g_mutex_init (&queue.mutex);
+        g_cond_init (&queue.cond);
+        pool = g_thread_pool_new ((GFunc)template_file_job_func, &queue,
+                                  g_get_num_processors (), FALSE, NULL);
+
+        for ( i = 0, p = filenames; p != NULL; i++, p = p->next )
+        {
+                jobs[i].filename = (gchar *)p->data;
+                g_thread_pool_push (pool, &jobs[i], NULL);
+        }
+
+        for ( i = 0; i < n_files; i++ )
+        {
+                g_mutex_lock (&queue.mutex);
+                while ( !jobs[i].done )
+                {
+                        g_cond_wait (&queue.cond, &queue.mutex);
+                }
+                g_mutex_unlock (&queue.mutex);
+
+                _lgl_xml_template_file_register (jobs[i].file);
+                g_free (jobs[i].filename);
+
+                if ( (i + 1) == n_user )
+                {
+                        for ( p=model->templates; p != NULL; p=p->next )
+                        {
+                                template = (lglTemplate *)p->data;
+                                add_template_category (template, "user-defined");
+                        }
+                }
+        }
+
+        g_thread_pool_free (pool, FALSE, TRUE);
+        g_mutex_clear (&queue.mutex);
+        g_cond_clear (&queue.cond);
+        g_free (jobs);
+        g_list_free (filenames);
+
         if (model->templates == NULL)
         {
                 g_critical (_("Unable to locate any template files.  Libglabels may not be installed correctly!"));
@@ -1991,27 +2495,27 @@ read_templates (void)
 }
 
 
-void
-read_template_files_from_dir (const gchar *dirname)
+GList *
+find_template_files_in_dir (GList       *filenames,
+                            const gchar *dirname)
 {
         GDir        *dp;
         const gchar *filename, *extension, *extension2;
-        gchar       *full_filename = NULL;
         GError      *gerror = NULL;
 
         if (dirname == NULL)
-                return;
+                return filenames;
 
         if (!g_file_test (dirname, G_FILE_TEST_EXISTS))
         {
-                return;
+                return filenames;
         }
 
         dp = g_dir_open (dirname, 0, &gerror);
         if (gerror != NULL)
         {
                 g_message ("cannot open data directory: %s", gerror->message );
-                return;
+                return filenames;
         }
 
         while ((filename = g_dir_read_name (dp)) != NULL)
@@ -2024,14 +2528,34 @@ read_template_files_from_dir (const gchar *dirname)
                      (extension2 && ASCII_EQUAL (extension2, "-templates.xml")) )
                 {
 
-                        full_filename = g_build_filename (dirname, filename, NULL);
-                        lgl_xml_template_read_templates_from_file (full_filename);
-                        g_free (full_filename);
+                        filenames = g_list_append (filenames,
+                                                   g_build_filename (dirname, filename, NULL));
                 }
 
         }
 
         g_dir_close (dp);
+
+        return filenames;
+}
+
+
+/*--------------------------------------------------------------------------*/
+/* PRIVATE.  Thread pool function: parse one template file.                 */
+/*--------------------------------------------------------------------------*/
+static void
+template_file_job_func (TemplateFileJob   *job,
+                        TemplateFileQueue *queue)
+{
+        lglXmlTemplateFile *file;
+
+        file = _lgl_xml_template_file_parse (job->filename);
+
+        g_mutex_lock (&queue->mutex);
+        job->file = file;
+        job->done = TRUE;
+        g_cond_broadcast (&queue->cond);
+        g_mutex_unlock (&queue->mutex);
 }
 
 
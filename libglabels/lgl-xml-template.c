@@ -36,6 +36,17 @@
 /* Private types                             */
 /*===========================================*/
 
+/* A template file, parsed but not yet registered with the database. */
+struct _lglXmlTemplateFile {
+        xmlDocPtr    doc;
+        GList       *items;     /* List of (ParsedNode *), in document order. */
+};
+
+typedef struct {
+        xmlNodePtr   node;
+        lglTemplate *template;  /* NULL if parsing must wait for registration. */
+} ParsedNode;
+
 /*===========================================*/
 /* Private globals                           */
 /*===========================================*/
@@ -68,6 +79,10 @@ static void  xml_parse_markup_ellipse_node  (xmlNodePtr              markup_node
 static void  xml_parse_alias_node           (xmlNodePtr              alias_node,
                                              lglTemplate            *template);
 
+static GList *xml_collect_template_nodes    (const xmlDocPtr         templates_doc,
+                                             gboolean                parse_flag);
+static void   xml_register_template_nodes   (GList                  *items);
+
 static void  xml_create_meta_node           (const gchar                  *attr,
                                              const gchar                  *value,
                                              xmlNodePtr                    root,
@@ -105,8 +120,27 @@ static void  xml_create_markup_ellipse_node (const lglTemplateMarkup      *circl
 void
 lgl_xml_template_read_templates_from_file (const gchar *utf8_filename)
 {
-        gchar      *filename;
-        xmlDocPtr   templates_doc;
+        lglXmlTemplateFile *file;
+
+        file = _lgl_xml_template_file_parse (utf8_filename);
+        _lgl_xml_template_file_register (file);
+}
+
+
+/*****************************************************************************/
+/* Parse template file, without registering any templates.  Templates that  */
+/* do not depend on the template database are fully converted to            */
+/* lglTemplates, others are left to _lgl_xml_template_file_register().      */
+/*                                                                          */
+/* May be called from any thread, while the main thread is only reading the */
+/* paper database.                                                          */
+/*****************************************************************************/
+lglXmlTemplateFile *
+_lgl_xml_template_file_parse (const gchar *utf8_filename)
+{
+        gchar              *filename;
+        xmlDocPtr           templates_doc;
+        lglXmlTemplateFile *file;
 
         LIBXML_TEST_VERSION;
 
@@ -114,7 +148,7 @@ lgl_xml_template_read_templates_from_file (const gchar *utf8_filename)
         if (!filename)
         {
                 g_message ("Utf8 filename conversion error");
-                return;
+                return NULL;
         }
 
         templates_doc = xmlParseFile (filename);
@@ -122,13 +156,35 @@ lgl_xml_template_read_templates_from_file (const gchar *utf8_filename)
         {
                 g_message ("\"%s\" is not a glabels template file (not XML)",
                       filename);
+                g_free (filename);
+                return NULL;
+        }
+        g_free (filename);
+
+        file = g_new0 (lglXmlTemplateFile, 1);
+        file->doc   = templates_doc;
+        file->items = xml_collect_template_nodes (templates_doc, TRUE);
+
+        return file;
+}
+
+
+/*****************************************************************************/
+/* Register templates of a parsed template file, in document order, and     */
+/* free it.  Must be called from the main thread.                           */
+/*****************************************************************************/
+void
+_lgl_xml_template_file_register (lglXmlTemplateFile *file)
+{
+        if (file == NULL)
+        {
                 return;
         }
 
-        lgl_xml_template_parse_templates_doc (templates_doc);
+        xml_register_template_nodes (file->items);
 
-        g_free (filename);
-        xmlFreeDoc (templates_doc);
+        xmlFreeDoc (file->doc);
+        g_free (file);
 }
 
 
@@ -142,24 +198,37 @@ lgl_xml_template_read_templates_from_file (const gchar *utf8_filename)
 void
 lgl_xml_template_parse_templates_doc (const xmlDocPtr templates_doc)
 {
-        
-        xmlNodePtr   root, node;
-        lglTemplate *template;
-
         LIBXML_TEST_VERSION;
 
+        xml_register_template_nodes (xml_collect_template_nodes (templates_doc, FALSE));
+}
+
+
+/*--------------------------------------------------------------------------*/
+/* PRIVATE.  Collect template nodes of a templates doc.  If parse_flag is    */
+/* set, also convert those that do not reference other templates.           */
+/*--------------------------------------------------------------------------*/
+static GList *
+xml_collect_template_nodes (const xmlDocPtr templates_doc,
+                            gboolean        parse_flag)
+{
+        xmlNodePtr   root, node;
+        xmlChar     *equiv;
+        ParsedNode  *item;
+        GList       *items = NULL;
+
         root = xmlDocGetRootElement (templates_doc);
         if (!root || !root->name)
         {
                 g_message ("\"%s\" is not a glabels template file (no root node)",
                            templates_doc->URL);
-                return;
+                return NULL;
         }
         if (!lgl_xml_is_node (root, "Glabels-templates"))
         {
                 g_message ("\"%s\" is not a glabels template file (wrong root node)",
                       templates_doc->URL);
-                return;
+                return NULL;
         }
 
         for (node = root->xmlChildrenNode; node != NULL; node = node->next)
@@ -167,12 +236,23 @@ lgl_xml_template_parse_templates_doc (const xmlDocPtr templates_doc)
 
                 if (lgl_xml_is_node (node, "Template"))
                 {
-                        template = lgl_xml_template_parse_template_node (node);
-                        if (template)
+                        item = g_new0 (ParsedNode, 1);
+                        item->node = node;
+
+                        /* Equivalent parts are copies of already registered templates. */
+                        equiv = xmlGetProp (node, (xmlChar *)"equiv");
+                        if (parse_flag && !equiv)
                         {
-                                _lgl_db_register_template_internal (template);
-                                lgl_template_free (template);
+                                item->template = lgl_xml_template_parse_template_node (node);
+                                if (!item->template)
+                                {
+                                        g_free (item);
+                                        continue;
+                                }
                         }
+                        xmlFree (equiv);
+
+                        items = g_list_prepend (items, item);
                 }
                 else
                 {
@@ -185,6 +265,42 @@ lgl_xml_template_parse_templates_doc (const xmlDocPtr templates_doc)
                         }
                 }
         }
+
+        return g_list_reverse (items);
+}
+
+
+/*--------------------------------------------------------------------------*/
+/* PRIVATE.  Register collected templates, parsing any that are left, and    */
+/* free list.                                                               */
+/*--------------------------------------------------------------------------*/
+static void
+xml_register_template_nodes (GList *items)
+{
+        GList       *p;
+        ParsedNode  *item;
+        lglTemplate *template;
+
+        for (p = items; p != NULL; p = p->next)
+        {
+                item = (ParsedNode *)p->data;
+
+                template = item->template;
+                if (!template)
+                {
+                        template = lgl_xml_template_parse_template_node (item->node);
+                }
+
+                if (template)
+                {
+                        _lgl_db_register_template_internal (template);
+                        lgl_template_free (template);
+                }
+
+                g_free (item);
+        }
+
+        g_list_free (items);
 }
 
 
@@ -32,7 +32,12 @@
 #define UTF8_EQUAL(s1,s2) (!lgl_str_utf8_casecmp (s1, s2))
 #define ASCII_EQUAL(s1,s2) (!g_ascii_strcasecmp (s1, s2))
 
-void _lgl_db_register_template_internal (const lglTemplate   *template);
+typedef struct _lglXmlTemplateFile lglXmlTemplateFile;
+
+void                _lgl_db_register_template_internal (const lglTemplate   *template);
+
+lglXmlTemplateFile *_lgl_xml_template_file_parse       (const gchar         *utf8_filename);
+void                _lgl_xml_template_file_register    (lglXmlTemplateFile  *file);
 
 
 #endif /* __LIBGLABELS_PRIVATE_H__ */
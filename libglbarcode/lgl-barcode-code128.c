@@ -0,0 +1,694 @@
+/*
+ *  lgl-barcode-code128.c
+ *  Copyright (C) 2026  agent <agent@local>.
+ *
+ *  This file is part of libglbarcode.
+ *
+ *  libglbarcode is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU Lesser General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  libglbarcode is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU Lesser General Public License for more details.
+ *
+ *  You should have received a copy of the GNU Lesser General Public License
+ *  along with libglbarcode.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/*
+ * This module implements Code 128 (ISO/IEC 15417) and GS1-128.
+ */
+
+#include <config.h>
+
+#include "lgl-barcode-code128.h"
+
+#include <glib.h>
+#include <string.h>
+
+
+/*========================================================*/
+/* Private macros and constants.                          */
+/*========================================================*/
+
+#define PTS_PER_INCH 72.0
+
+#define MIN_X        ( 0.01 *  PTS_PER_INCH )
+#define MIN_HEIGHT   ( 0.25 *  PTS_PER_INCH )
+#define QUIET_MODULES 10
+
+#define TEXT_AREA_HEIGHT 14.0
+#define TEXT_SIZE        10.0
+
+/* Pseudo character for FNC1 in the input code array. */
+#define FNC1         (-1)
+
+/* Symbol values. */
+#define VAL_SHIFT    98
+#define VAL_CODE_C   99
+#define VAL_CODE_B   100
+#define VAL_CODE_A   101
+#define VAL_FNC1     102
+#define VAL_START_A  103
+#define VAL_STOP     106
+
+#define INFINITE_COST (G_MAXINT / 2)
+
+
+/*========================================================*/
+/* Private types.                                         */
+/*========================================================*/
+
+typedef enum {
+        SET_A,
+        SET_B,
+        SET_C,
+        N_SETS
+} CodeSet;
+
+typedef enum {
+        ACTION_NONE,
+        ACTION_ENCODE,
+        ACTION_SHIFT
+} Action;
+
+
+/*===========================================*/
+/* Private globals                           */
+/*===========================================*/
+
+/* Code 128 symbols.  Position indicates value. */
+static const gchar *symbols[] = {
+        /*   0 */ "212222",  /*   1 */ "222122",  /*   2 */ "222221",  /*   3 */ "121223",
+        /*   4 */ "121322",  /*   5 */ "131222",  /*   6 */ "122213",  /*   7 */ "122312",
+        /*   8 */ "132212",  /*   9 */ "221213",  /*  10 */ "221312",  /*  11 */ "231212",
+        /*  12 */ "112232",  /*  13 */ "122132",  /*  14 */ "122231",  /*  15 */ "113222",
+        /*  16 */ "123122",  /*  17 */ "123221",  /*  18 */ "223211",  /*  19 */ "221132",
+        /*  20 */ "221231",  /*  21 */ "213212",  /*  22 */ "223112",  /*  23 */ "312131",
+        /*  24 */ "311222",  /*  25 */ "321122",  /*  26 */ "321221",  /*  27 */ "312212",
+        /*  28 */ "322112",  /*  29 */ "322211",  /*  30 */ "212123",  /*  31 */ "212321",
+        /*  32 */ "232121",  /*  33 */ "111323",  /*  34 */ "131123",  /*  35 */ "131321",
+        /*  36 */ "112313",  /*  37 */ "132113",  /*  38 */ "132311",  /*  39 */ "211313",
+        /*  40 */ "231113",  /*  41 */ "231311",  /*  42 */ "112133",  /*  43 */ "112331",
+        /*  44 */ "132131",  /*  45 */ "113123",  /*  46 */ "113321",  /*  47 */ "133121",
+        /*  48 */ "313121",  /*  49 */ "211331",  /*  50 */ "231131",  /*  51 */ "213113",
+        /*  52 */ "213311",  /*  53 */ "213131",  /*  54 */ "311123",  /*  55 */ "311321",
+        /*  56 */ "331121",  /*  57 */ "312113",  /*  58 */ "312311",  /*  59 */ "332111",
+        /*  60 */ "314111",  /*  61 */ "221411",  /*  62 */ "431111",  /*  63 */ "111224",
+        /*  64 */ "111422",  /*  65 */ "121124",  /*  66 */ "121421",  /*  67 */ "141122",
+        /*  68 */ "141221",  /*  69 */ "112214",  /*  70 */ "112412",  /*  71 */ "122114",
+        /*  72 */ "122411",  /*  73 */ "142112",  /*  74 */ "142211",  /*  75 */ "241211",
+        /*  76 */ "221114",  /*  77 */ "413111",  /*  78 */ "241112",  /*  79 */ "134111",
+        /*  80 */ "111242",  /*  81 */ "121142",  /*  82 */ "121241",  /*  83 */ "114212",
+        /*  84 */ "124112",  /*  85 */ "124211",  /*  86 */ "411212",  /*  87 */ "421112",
+        /*  88 */ "421211",  /*  89 */ "212141",  /*  90 */ "214121",  /*  91 */ "412121",
+        /*  92 */ "111143",  /*  93 */ "111341",  /*  94 */ "131141",  /*  95 */ "114113",
+        /*  96 */ "114311",  /*  97 */ "411113",  /*  98 */ "411311",  /*  99 */ "113141",
+        /* 100 */ "114131",  /* 101 */ "311141",  /* 102 */ "411131",  /* 103 */ "211412",
+        /* 104 */ "211214",  /* 105 */ "211232",  /* 106 */ "2331112",
+};
+
+/* Value of the code set switch symbol, indexed by target set. */
+static const gint switch_value[N_SETS] = { VAL_CODE_A, VAL_CODE_B, VAL_CODE_C };
+
+/*
+ * GS1 application identifiers with a predefined length, keyed by the first two
+ * digits of AI.  Length includes the AI itself.  Elements with a predefined
+ * length need no FNC1 separator.  (GS1 General Specifications, Figure 5.10.1-2)
+ */
+static const struct {
+        const gchar *ai;
+        gint         length;
+} gs1_predefined[] = {
+        { "00", 20 }, { "01", 16 }, { "02", 16 }, { "03", 16 }, { "04", 18 },
+        { "11",  8 }, { "12",  8 }, { "13",  8 }, { "14",  8 }, { "15",  8 },
+        { "16",  8 }, { "17",  8 }, { "18",  8 }, { "19",  8 }, { "20",  4 },
+        { "31", 10 }, { "32", 10 }, { "33", 10 }, { "34", 10 }, { "35", 10 },
+        { "36", 10 }, { "41", 16 },
+        { NULL, 0 }
+};
+
+
+/*===========================================*/
+/* Local function prototypes                 */
+/*===========================================*/
+
+static GArray     *code128_parse            (const gchar     *data,
+                                             gchar          **display_string);
+
+static GArray     *gs1_128_parse            (const gchar     *data,
+                                             gchar          **display_string);
+
+static gint        gs1_predefined_length    (const gchar     *ai);
+
+static GArray     *code128_encode           (const gint      *codes,
+                                             gint             n);
+
+static lglBarcode *code128_vectorize        (const lglBarcodeRuns *runs,
+                                             gdouble          w,
+                                             gdouble          h,
+                                             gboolean         text_flag,
+                                             const gchar     *string);
+
+
+/****************************************************************************/
+/* Generate new Code 128 barcode structure from data.                       */
+/****************************************************************************/
+lglBarcode *
+lgl_barcode_code128_new (lglBarcodeType  type,
+                         gboolean        text_flag,
+                         gboolean        checksum_flag,
+                         gdouble         w,
+                         gdouble         h,
+                         const gchar    *data)
+{
+        lglBarcodeRuns *runs;
+        gchar          *display_string;
+        lglBarcode     *bc;
+
+        if ( (type != LGL_BARCODE_TYPE_CODE128) &&
+             (type != LGL_BARCODE_TYPE_GS1_128) )
+        {
+                g_message ("Invalid barcode type for CODE128 backend.");
+                return NULL;
+        }
+
+        runs = lgl_barcode_code128_encode_runs (type, data, &display_string);
+        if ( runs == NULL )
+        {
+                return NULL;
+        }
+
+        bc = code128_vectorize (runs, w, h, text_flag, display_string);
+
+        lgl_barcode_runs_free (runs);
+        g_free (display_string);
+
+        return bc;
+}
+
+
+/****************************************************************************/
+/* Encode data as Code 128 run-length representation.                       */
+/****************************************************************************/
+lglBarcodeRuns *
+lgl_barcode_code128_encode_runs (lglBarcodeType   type,
+                                 const gchar     *data,
+                                 gchar          **display_string)
+{
+        GArray         *codes;
+        GArray         *values;
+        gchar          *string;
+        lglBarcodeRuns *runs;
+        guint           i;
+
+        if ( !data || (*data == '\0') )
+        {
+                return NULL;
+        }
+
+        if ( type == LGL_BARCODE_TYPE_GS1_128 )
+        {
+                codes = gs1_128_parse (data, &string);
+        }
+        else
+        {
+                codes = code128_parse (data, &string);
+        }
+        if ( codes == NULL )
+        {
+                return NULL;
+        }
+
+        values = code128_encode ((gint *)codes->data, codes->len);
+        g_array_free (codes, TRUE);
+
+        runs = lgl_barcode_runs_new ();
+        for ( i = 0; i < values->len; i++ )
+        {
+                lgl_barcode_runs_append (runs, symbols[g_array_index (values, gint, i)], FALSE);
+        }
+        g_array_free (values, TRUE);
+
+        if ( display_string )
+        {
+                *display_string = string;
+        }
+        else
+        {
+                g_free (string);
+        }
+
+        return runs;
+}
+
+
+/*--------------------------------------------------------------------------*/
+/* PRIVATE.  Validate and convert plain Code 128 data to code array.        */
+/*--------------------------------------------------------------------------*/
+static GArray *
+code128_parse (const gchar  *data,
+               gchar       **display_string)
+{
+        GArray      *codes;
+        const gchar *p;
+        gint         c;
+
+        codes = g_array_new (FALSE, FALSE, sizeof(gint));
+
+        for ( p = data; *p != '\0'; p++ )
+        {
+                c = (guchar)*p;
+                if ( c > 0x7f )
+                {
+                        g_array_free (codes, TRUE);
+                        return NULL;
+                }
+                g_array_append_val (codes, c);
+        }
+
+        *display_string = g_strdup (data);
+
+        return codes;
+}
+
+
+/*--------------------------------------------------------------------------*/
+/* PRIVATE.  Validate and convert GS1-128 element string to code array.     */
+/*                                                                          */
+/* Data is a sequence of "(AI)value" or "[AI]value" elements.  Data without */
+/* any AI delimiters is taken to be a raw element string.                   */
+/*--------------------------------------------------------------------------*/
+static GArray *
+gs1_128_parse (const gchar  *data,
+               gchar       **display_string)
+{
+        GArray      *codes;
+        GString     *string;
+        const gchar *p;
+        gchar        close_char;
+        gchar        ai[5];
+        gint         n_ai, n_value, length, c;
+        gboolean     need_fnc1;
+
+        codes  = g_array_new (FALSE, FALSE, sizeof(gint));
+        string = g_string_new ("");
+
+        c = FNC1;
+        g_array_append_val (codes, c);
+
+        if ( (*data != '(') && (*data != '[') )
+        {
+                for ( p = data; *p != '\0'; p++ )
+                {
+                        c = (guchar)*p;
+                        if ( (c < 0x20) || (c > 0x7e) )
+                        {
+                                goto error;
+                        }
+                        g_array_append_val (codes, c);
+                }
+                g_string_free (string, TRUE);
+                *display_string = g_strdup (data);
+                return codes;
+        }
+
+        need_fnc1 = FALSE;
+        p = data;
+        while ( *p != '\0' )
+        {
+                /* Application identifier. */
+                if ( (*p != '(') && (*p != '[') )
+                {
+                        goto error;
+                }
+                close_char = (*p == '(') ? ')' : ']';
+                p++;
+
+                for ( n_ai = 0; g_ascii_isdigit (*p) && (n_ai < 4); n_ai++, p++ )
+                {
+                        ai[n_ai] = *p;
+                }
+                ai[n_ai] = '\0';
+                if ( (n_ai < 2) || (*p != close_char) )
+                {
+                        goto error;
+                }
+                p++;
+
+                if ( need_fnc1 )
+                {
+                        c = FNC1;
+                        g_array_append_val (codes, c);
+                }
+                for ( c = 0; c < n_ai; c++ )
+                {
+                        gint d = ai[c];
+                        g_array_append_val (codes, d);
+                }
+                g_string_append_printf (string, "(%s)", ai);
+
+                /* Element data. */
+                if ( (*p == '\0') || (*p == '(') || (*p == '[') )
+                {
+                        goto error;
+                }
+                for ( n_value = 0; (*p != '\0') && (*p != '(') && (*p != '['); n_value++, p++ )
+                {
+                        c = (guchar)*p;
+                        if ( (c < 0x20) || (c > 0x7e) )
+                        {
+                                goto error;
+                        }
+                        g_array_append_val (codes, c);
+                        g_string_append_c (string, *p);
+                }
+
+                length = gs1_predefined_length (ai);
+                if ( length && (n_ai + n_value != length) )
+                {
+                        goto error;
+                }
+                need_fnc1 = (length == 0);
+        }
+
+        *display_string = g_string_free (string, FALSE);
+        return codes;
+
+error:
+        g_array_free (codes, TRUE);
+        g_string_free (string, TRUE);
+        return NULL;
+}
+
+
+/*--------------------------------------------------------------------------*/
+/* PRIVATE.  Predefined length of element with given AI, 0 if variable.    */
+/*--------------------------------------------------------------------------*/
+static gint
+gs1_predefined_length (const gchar *ai)
+{
+        gint i;
+
+        for ( i = 0; gs1_predefined[i].ai != NULL; i++ )
+        {
+                if ( strncmp (ai, gs1_predefined[i].ai, 2) == 0 )
+                {
+                        return gs1_predefined[i].length;
+                }
+        }
+
+        return 0;
+}
+
+
+/*--------------------------------------------------------------------------*/
+/* PRIVATE.  Can code be encoded as a single symbol in code set A or B?     */
+/*--------------------------------------------------------------------------*/
+static inline gboolean
+in_set (gint    c,
+        CodeSet set)
+{
+        if ( c == FNC1 )
+        {
+                return TRUE;
+        }
+
+        switch (set)
+        {
+        case SET_A:
+                return (c >= 0) && (c < 0x60);
+        case SET_B:
+                return (c >= 0x20) && (c < 0x80);
+        default:
+                return FALSE;
+        }
+}
+
+
+/*--------------------------------------------------------------------------*/
+/* PRIVATE.  Symbol value of code in code set A or B.                       */
+/*--------------------------------------------------------------------------*/
+static inline gint
+value_in_set (gint    c,
+              CodeSet set)
+{
+        if ( c == FNC1 )
+        {
+                return VAL_FNC1;
+        }
+
+        if ( (set == SET_A) && (c < 0x20) )
+        {
+                return c + 0x40;
+        }
+
+        return c - 0x20;
+}
+
+
+/*--------------------------------------------------------------------------*/
+/* PRIVATE.  Are there two digits at codes[i]?                              */
+/*--------------------------------------------------------------------------*/
+static inline gboolean
+is_digit_pair (const gint *codes,
+               gint        n,
+               gint        i)
+{
+        return ( (i + 1 < n) &&
+                 (codes[i]   >= '0') && (codes[i]   <= '9') &&
+                 (codes[i+1] >= '0') && (codes[i+1] <= '9') );
+}
+
+
+/*--------------------------------------------------------------------------*/
+/* PRIVATE.  Generate array of symbol values, including start, checksum and */
+/* stop symbols.                                                            */
+/*                                                                          */
+/* Code sets are chosen to minimize the number of symbols: cost[i][s] is    */
+/* the minimum number of symbols needed to encode codes[i..n-1] when code   */
+/* set s is active at position i, computed back to front.                   */
+/*--------------------------------------------------------------------------*/
+static GArray *
+code128_encode (const gint *codes,
+                gint        n)
+{
+        gint         (*cost)[N_SETS];    /* Best cost, switch allowed at i */
+        gint         (*cost_e)[N_SETS];  /* Best cost, no switch at i */
+        Action       (*action)[N_SETS];
+        CodeSet      (*next_set)[N_SETS];
+        GArray        *values;
+        gint           i, s, t, c, best, sum, k;
+        CodeSet        set;
+
+        cost     = g_malloc ((n + 1) * sizeof(*cost));
+        cost_e   = g_malloc ((n + 1) * sizeof(*cost_e));
+        action   = g_malloc ((n + 1) * sizeof(*action));
+        next_set = g_malloc ((n + 1) * sizeof(*next_set));
+
+        for ( s = 0; s < N_SETS; s++ )
+        {
+                cost[n][s]   = 0;
+                cost_e[n][s] = 0;
+        }
+
+        for ( i = n - 1; i >= 0; i-- )
+        {
+                /* Cost of encoding codes[i] in the current set. */
+                for ( s = 0; s < N_SETS; s++ )
+                {
+                        cost_e[i][s] = INFINITE_COST;
+                        action[i][s] = ACTION_NONE;
+
+                        if ( s == SET_C )
+                        {
+                                if ( codes[i] == FNC1 )
+                                {
+                                        cost_e[i][s] = 1 + cost[i+1][s];
+                                        action[i][s] = ACTION_ENCODE;
+                                }
+                                else if ( is_digit_pair (codes, n, i) )
+                                {
+                                        cost_e[i][s] = 1 + cost[i+2][s];
+                                        action[i][s] = ACTION_ENCODE;
+                                }
+                        }
+                        else
+                        {
+                                t = (s == SET_A) ? SET_B : SET_A;
+
+                                if ( in_set (codes[i], s) )
+                                {
+                                        cost_e[i][s] = 1 + cost[i+1][s];
+                                        action[i][s] = ACTION_ENCODE;
+                                }
+                                else if ( in_set (codes[i], t) )
+                                {
+                                        cost_e[i][s] = 2 + cost[i+1][s];
+                                        action[i][s] = ACTION_SHIFT;
+                                }
+                        }
+                }
+
+                /* Allow switching before encoding codes[i]. */
+                for ( s = 0; s < N_SETS; s++ )
+                {
+                        cost[i][s]     = cost_e[i][s];
+                        next_set[i][s] = s;
+
+                        for ( t = 0; t < N_SETS; t++ )
+                        {
+                                if ( (t != s) && (1 + cost_e[i][t] < cost[i][s]) )
+                                {
+                                        cost[i][s]     = 1 + cost_e[i][t];
+                                        next_set[i][s] = t;
+                                }
+                        }
+                }
+        }
+
+        /* Choose start set. */
+        set  = SET_B;
+        best = cost_e[0][SET_B];
+        for ( s = 0; s < N_SETS; s++ )
+        {
+                if ( cost_e[0][s] < best )
+                {
+                        best = cost_e[0][s];
+                        set  = s;
+                }
+        }
+
+        values = g_array_new (FALSE, FALSE, sizeof(gint));
+
+        c = VAL_START_A + set;
+        g_array_append_val (values, c);
+
+        for ( i = 0; i < n; )
+        {
+                if ( (i > 0) && (next_set[i][set] != set) )
+                {
+                        set = next_set[i][set];
+                        g_array_append_val (values, switch_value[set]);
+                }
+
+                switch (action[i][set])
+                {
+
+                case ACTION_ENCODE:
+                        if ( set == SET_C )
+                        {
+                                if ( codes[i] == FNC1 )
+                                {
+                                        c = VAL_FNC1;
+                                        i += 1;
+                                }
+                                else
+                                {
+                                        c = 10*(codes[i] - '0') + (codes[i+1] - '0');
+                                        i += 2;
+                                }
+                        }
+                        else
+                        {
+                                c = value_in_set (codes[i], set);
+                                i += 1;
+                        }
+                        g_array_append_val (values, c);
+                        break;
+
+                case ACTION_SHIFT:
+                        c = VAL_SHIFT;
+                        g_array_append_val (values, c);
+                        c = value_in_set (codes[i], (set == SET_A) ? SET_B : SET_A);
+                        g_array_append_val (values, c);
+                        i += 1;
+                        break;
+
+                default:
+                        g_assert_not_reached ();
+                        break;
+
+                }
+        }
+
+        /* Checksum. */
+        sum = g_array_index (values, gint, 0);
+        for ( k = 1; k < (gint)values->len; k++ )
+        {
+                sum += k * g_array_index (values, gint, k);
+        }
+        c = sum % 103;
+        g_array_append_val (values, c);
+
+        c = VAL_STOP;
+        g_array_append_val (values, c);
+
+        g_free (cost);
+        g_free (cost_e);
+        g_free (action);
+        g_free (next_set);
+
+        return values;
+}
+
+
+/*--------------------------------------------------------------------------*/
+/* PRIVATE.  Vectorize encoded barcode.                                     */
+/*--------------------------------------------------------------------------*/
+static lglBarcode *
+code128_vectorize (const lglBarcodeRuns *runs,
+                   gdouble               w,
+                   gdouble               h,
+                   gboolean              text_flag,
+                   const gchar          *string)
+{
+        gdouble      x;
+        gdouble      width, height;
+        gdouble      x_quiet;
+        lglBarcode  *bc;
+
+        /* determine module width */
+        x = MIN_X;
+        if ( w != 0 )
+        {
+                x = MAX (x, w / (runs->n_modules + 2*QUIET_MODULES));
+        }
+        width   = runs->n_modules * x;
+        x_quiet = QUIET_MODULES * x;
+
+        /* determine height of barcode */
+        height = text_flag ? h - TEXT_AREA_HEIGHT : h;
+        height = MAX (height, MAX(0.15*width, MIN_HEIGHT));
+
+        bc = lgl_barcode_new ();
+
+        lgl_barcode_runs_add_to_barcode (runs, bc, x_quiet, 0.0, x, height, height);
+
+        if ( text_flag )
+        {
+                lgl_barcode_add_string (bc,
+                                        x_quiet + width/2, height + (TEXT_AREA_HEIGHT-TEXT_SIZE)/2,
+                                        TEXT_SIZE, (gchar *)string, strlen (string));
+        }
+
+        bc->width  = width + 2*x_quiet;
+        bc->height = text_flag ? height + TEXT_AREA_HEIGHT : height;
+
+        return bc;
+}
+
+
+
+
+/*
+ * Local Variables:       -- emacs
+ * mode: C                -- emacs
+ * c-basic-offset: 8      -- emacs
+ * tab-width: 8           -- emacs
+ * indent-tabs-mode: nil  -- emacs
+ * End:                   -- emacs
+ */
@@ -25,6 +25,8 @@
 #include "lgl-barcode-postnet.h"
 #include "lgl-barcode-onecode.h"
 #include "lgl-barcode-code39.h"
+#include "lgl-barcode-code128.h"
+#include "lgl-barcode-ean.h"
 
 
 /*===========================================*/
@@ -60,6 +62,14 @@ BarcodeNewFunc create_func[LGL_BARCODE_N_TYPES] = {
 
         /* LGL_BARCODE_TYPE_CODE39     */ lgl_barcode_code39_new,
         /* LGL_BARCODE_TYPE_CODE39_EXT */ lgl_barcode_code39_new,
+
+        /* LGL_BARCODE_TYPE_CODE128    */ lgl_barcode_code128_new,
+        /* LGL_BARCODE_TYPE_GS1_128    */ lgl_barcode_code128_new,
+
+        /* LGL_BARCODE_TYPE_EAN_13     */ lgl_barcode_ean_new,
+        /* LGL_BARCODE_TYPE_EAN_8      */ lgl_barcode_ean_new,
+        /* LGL_BARCODE_TYPE_UPC_A      */ lgl_barcode_ean_new,
+        /* LGL_BARCODE_TYPE_UPC_E      */ lgl_barcode_ean_new,
 };
 
 /*===========================================*/
@@ -108,6 +118,47 @@ lgl_barcode_create (lglBarcodeType     type,
 }
 
 
+/****************************************************************************/
+/**
+ * lgl_barcode_create_runs:
+ * @type:           Barcode type selection (#lglBarcodeType)
+ * @data:           Data to encode into barcode
+ *
+ * Encode @data with selected barcode type into a compact run-length
+ * representation, without creating any drawing primitives.  This is only
+ * supported by linear barcode types whose bars and spaces are integral
+ * multiples of a module: %LGL_BARCODE_TYPE_CODE128, %LGL_BARCODE_TYPE_GS1_128,
+ * %LGL_BARCODE_TYPE_EAN_13, %LGL_BARCODE_TYPE_EAN_8, %LGL_BARCODE_TYPE_UPC_A
+ * and %LGL_BARCODE_TYPE_UPC_E.
+ *
+ * Returns: A newly allocated #lglBarcodeRuns structure, or %NULL if @type is
+ *          not supported or @data is invalid.  Use lgl_barcode_runs_free() to
+ *          free it.
+ */
+lglBarcodeRuns *
+lgl_barcode_create_runs (lglBarcodeType     type,
+                         const gchar       *data)
+{
+        switch (type)
+        {
+
+        case LGL_BARCODE_TYPE_CODE128:
+        case LGL_BARCODE_TYPE_GS1_128:
+                return lgl_barcode_code128_encode_runs (type, data, NULL);
+
+        case LGL_BARCODE_TYPE_EAN_13:
+        case LGL_BARCODE_TYPE_EAN_8:
+        case LGL_BARCODE_TYPE_UPC_A:
+        case LGL_BARCODE_TYPE_UPC_E:
+                return lgl_barcode_ean_encode_runs (type, data, NULL);
+
+        default:
+                return NULL;
+
+        }
+}
+
+
 
 /*
  * Local Variables:       -- emacs
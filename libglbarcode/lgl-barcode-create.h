@@ -25,16 +25,20 @@
 
 #include "lgl-barcode.h"
 #include "lgl-barcode-type.h"
+#include "lgl-barcode-runs.h"
 
 G_BEGIN_DECLS
 
 
-lglBarcode  *lgl_barcode_create (lglBarcodeType     type,
-                                 gboolean           text_flag,
-                                 gboolean           checksum_flag,
-                                 gdouble            w,
-                                 gdouble            h,
-                                 const gchar       *data);
+lglBarcode      *lgl_barcode_create      (lglBarcodeType     type,
+                                         gboolean           text_flag,
+                                         gboolean           checksum_flag,
+                                         gdouble            w,
+                                         gdouble            h,
+                                         const gchar       *data);
+
+lglBarcodeRuns *lgl_barcode_create_runs (lglBarcodeType     type,
+                                         const gchar       *data);
 
 G_END_DECLS
 
@@ -0,0 +1,531 @@
+/*
+ *  lgl-barcode-ean.c
+ *  Copyright (C) 2026  agent <agent@local>.
+ *
+ *  This file is part of libglbarcode.
+ *
+ *  libglbarcode is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU Lesser General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  libglbarcode is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU Lesser General Public License for more details.
+ *
+ *  You should have received a copy of the GNU Lesser General Public License
+ *  along with libglbarcode.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/*
+ * This module implements the EAN-13, EAN-8, UPC-A and UPC-E barcodes
+ * specified in ISO/IEC 15420.
+ */
+
+#include <config.h>
+
+#include "lgl-barcode-ean.h"
+
+#include <glib.h>
+#include <string.h>
+
+
+/*========================================================*/
+/* Private macros and constants.                          */
+/*========================================================*/
+
+#define PTS_PER_INCH 72.0
+
+#define MIN_X        ( 0.0104 * PTS_PER_INCH )   /* 80% magnification */
+#define MIN_HEIGHT   ( 0.25   * PTS_PER_INCH )
+
+#define TEXT_SIZE_MODULES    8.0
+#define GUARD_EXT_MODULES    5.0
+
+#define GUARD_NORMAL         "111"
+#define GUARD_CENTER         "11111"
+#define GUARD_UPCE_END       "111111"
+
+
+/*========================================================*/
+/* Private types.                                         */
+/*========================================================*/
+
+
+/*===========================================*/
+/* Private globals                           */
+/*===========================================*/
+
+/* Digit patterns, odd parity (set A).  Also used for right hand digits (set C). */
+static const gchar *l_symbols[10] = {
+        "3211", "2221", "2122", "1411", "1132", "1231", "1114", "1312", "1213", "3112"
+};
+
+/* Digit patterns, even parity (set B). */
+static const gchar *g_symbols[10] = {
+        "1123", "1222", "2212", "1141", "2311", "1321", "4111", "2131", "3121", "2113"
+};
+
+/* EAN-13 left half parity, indexed by first (implied) digit. */
+static const gchar *ean13_parity[10] = {
+        "LLLLLL", "LLGLGG", "LLGGLG", "LLGGGL", "LGLLGG",
+        "LGGLLG", "LGGGLL", "LGLGLG", "LGLGGL", "LGGLGL"
+};
+
+/* UPC-E parity for number system 0, indexed by check digit. */
+static const gchar *upce_parity[10] = {
+        "GGGLLL", "GGLGLL", "GGLLGL", "GGLLLG", "GLGGLL",
+        "GLLGGL", "GLLLGG", "GLGLGL", "GLGLLG", "GLLGLG"
+};
+
+
+/*===========================================*/
+/* Local function prototypes                 */
+/*===========================================*/
+
+static gchar      *ean_canonicalize  (lglBarcodeType   type,
+                                      const gchar     *data);
+
+static gint        ean_check_digit   (const gchar     *digits,
+                                      gint             n);
+
+static void        upce_expand       (const gchar     *upce,
+                                      gchar           *upca);
+
+static void        ean_append_digit  (lglBarcodeRuns  *runs,
+                                      gchar            digit,
+                                      gchar            parity,
+                                      gboolean         guard_flag);
+
+static lglBarcode *ean_vectorize     (lglBarcodeType   type,
+                                      const lglBarcodeRuns *runs,
+                                      gdouble          w,
+                                      gdouble          h,
+                                      gboolean         text_flag,
+                                      const gchar     *digits);
+
+static void        ean_add_text      (lglBarcode      *bc,
+                                      gdouble          x,
+                                      gdouble          y,
+                                      gdouble          fsize,
+                                      const gchar     *digits,
+                                      gint             n);
+
+
+/****************************************************************************/
+/* Generate new EAN/UPC barcode structure from data.                        */
+/****************************************************************************/
+lglBarcode *
+lgl_barcode_ean_new (lglBarcodeType  type,
+                     gboolean        text_flag,
+                     gboolean        checksum_flag,
+                     gdouble         w,
+                     gdouble         h,
+                     const gchar    *data)
+{
+        lglBarcodeRuns *runs;
+        gchar          *digits;
+        lglBarcode     *bc;
+
+        if ( (type != LGL_BARCODE_TYPE_EAN_13) &&
+             (type != LGL_BARCODE_TYPE_EAN_8)  &&
+             (type != LGL_BARCODE_TYPE_UPC_A)  &&
+             (type != LGL_BARCODE_TYPE_UPC_E) )
+        {
+                g_message ("Invalid barcode type for EAN backend.");
+                return NULL;
+        }
+
+        runs = lgl_barcode_ean_encode_runs (type, data, &digits);
+        if ( runs == NULL )
+        {
+                return NULL;
+        }
+
+        bc = ean_vectorize (type, runs, w, h, text_flag, digits);
+
+        lgl_barcode_runs_free (runs);
+        g_free (digits);
+
+        return bc;
+}
+
+
+/****************************************************************************/
+/* Encode data as EAN/UPC run-length representation.                        */
+/****************************************************************************/
+lglBarcodeRuns *
+lgl_barcode_ean_encode_runs (lglBarcodeType   type,
+                             const gchar     *data,
+                             gchar          **display_string)
+{
+        gchar          *digits;
+        const gchar    *parity;
+        gchar           inverse[7];
+        lglBarcodeRuns *runs;
+        gint            i;
+
+        digits = ean_canonicalize (type, data);
+        if ( digits == NULL )
+        {
+                return NULL;
+        }
+
+        runs = lgl_barcode_runs_new ();
+        lgl_barcode_runs_append (runs, GUARD_NORMAL, TRUE);
+
+        switch (type)
+        {
+
+        case LGL_BARCODE_TYPE_EAN_13:
+                parity = ean13_parity[digits[0] - '0'];
+                for ( i = 1; i <= 6; i++ )
+                {
+                        ean_append_digit (runs, digits[i], parity[i-1], FALSE);
+                }
+                lgl_barcode_runs_append (runs, GUARD_CENTER, TRUE);
+                for ( i = 7; i <= 12; i++ )
+                {
+                        ean_append_digit (runs, digits[i], 'R', FALSE);
+                }
+                lgl_barcode_runs_append (runs, GUARD_NORMAL, TRUE);
+                break;
+
+        case LGL_BARCODE_TYPE_UPC_A:
+                /* Number system and check digit bars extend to guard length. */
+                for ( i = 0; i <= 5; i++ )
+                {
+                        ean_append_digit (runs, digits[i], 'L', (i == 0));
+                }
+                lgl_barcode_runs_append (runs, GUARD_CENTER, TRUE);
+                for ( i = 6; i <= 11; i++ )
+                {
+                        ean_append_digit (runs, digits[i], 'R', (i == 11));
+                }
+                lgl_barcode_runs_append (runs, GUARD_NORMAL, TRUE);
+                break;
+
+        case LGL_BARCODE_TYPE_EAN_8:
+                for ( i = 0; i <= 3; i++ )
+                {
+                        ean_append_digit (runs, digits[i], 'L', FALSE);
+                }
+                lgl_barcode_runs_append (runs, GUARD_CENTER, TRUE);
+                for ( i = 4; i <= 7; i++ )
+                {
+                        ean_append_digit (runs, digits[i], 'R', FALSE);
+                }
+                lgl_barcode_runs_append (runs, GUARD_NORMAL, TRUE);
+                break;
+
+        case LGL_BARCODE_TYPE_UPC_E:
+                parity = upce_parity[digits[7] - '0'];
+                if ( digits[0] == '1' )
+                {
+                        for ( i = 0; i < 6; i++ )
+                        {
+                                inverse[i] = (parity[i] == 'L') ? 'G' : 'L';
+                        }
+                        inverse[6] = '\0';
+                        parity = inverse;
+                }
+                for ( i = 1; i <= 6; i++ )
+                {
+                        ean_append_digit (runs, digits[i], parity[i-1], FALSE);
+                }
+                lgl_barcode_runs_append (runs, GUARD_UPCE_END, TRUE);
+                break;
+
+        default:
+                g_assert_not_reached ();
+                break;
+
+        }
+
+        if ( display_string )
+        {
+                *display_string = digits;
+        }
+        else
+        {
+                g_free (digits);
+        }
+
+        return runs;
+}
+
+
+/*--------------------------------------------------------------------------*/
+/* PRIVATE.  Validate data and return complete digit string, including      */
+/* check digit.                                                             */
+/*--------------------------------------------------------------------------*/
+static gchar *
+ean_canonicalize (lglBarcodeType  type,
+                  const gchar    *data)
+{
+        gint         n, n_data;
+        const gchar *p;
+        gchar        upca[12];
+        gint         check;
+
+        if ( !data || (*data == '\0') )
+        {
+                return NULL;
+        }
+
+        for ( p = data; *p != '\0'; p++ )
+        {
+                if ( !g_ascii_isdigit (*p) )
+                {
+                        return NULL;
+                }
+        }
+        n = strlen (data);
+
+        if ( type == LGL_BARCODE_TYPE_UPC_E )
+        {
+                gchar digits[9];
+
+                switch (n)
+                {
+                case 6:
+                        digits[0] = '0';
+                        memcpy (&digits[1], data, 6);
+                        break;
+                case 7:
+                case 8:
+                        memcpy (digits, data, 7);
+                        break;
+                default:
+                        return NULL;
+                }
+                if ( (digits[0] != '0') && (digits[0] != '1') )
+                {
+                        return NULL;
+                }
+
+                upce_expand (digits, upca);
+                check = ean_check_digit (upca, 11);
+                if ( (n == 8) && (data[7] - '0' != check) )
+                {
+                        return NULL;
+                }
+                digits[7] = '0' + check;
+                digits[8] = '\0';
+
+                return g_strdup (digits);
+        }
+
+        switch (type)
+        {
+        case LGL_BARCODE_TYPE_EAN_13:
+                n_data = 12;
+                break;
+        case LGL_BARCODE_TYPE_EAN_8:
+                n_data = 7;
+                break;
+        case LGL_BARCODE_TYPE_UPC_A:
+                n_data = 11;
+                break;
+        default:
+                return NULL;
+        }
+
+        if ( (n != n_data) && (n != n_data + 1) )
+        {
+                return NULL;
+        }
+
+        check = ean_check_digit (data, n_data);
+        if ( (n == n_data + 1) && (data[n_data] - '0' != check) )
+        {
+                return NULL;
+        }
+
+        return g_strdup_printf ("%.*s%d", n_data, data, check);
+}
+
+
+/*--------------------------------------------------------------------------*/
+/* PRIVATE.  Calculate modulo 10 check digit (weights 3,1,3,... from right).*/
+/*--------------------------------------------------------------------------*/
+static gint
+ean_check_digit (const gchar *digits,
+                 gint         n)
+{
+        gint i, weight, sum;
+
+        sum = 0;
+        weight = 3;
+        for ( i = n-1; i >= 0; i-- )
+        {
+                sum += weight * (digits[i] - '0');
+                weight = 4 - weight;
+        }
+
+        return (10 - (sum % 10)) % 10;
+}
+
+
+/*--------------------------------------------------------------------------*/
+/* PRIVATE.  Expand number system + 6 digit UPC-E to 11 digit UPC-A.        */
+/*--------------------------------------------------------------------------*/
+static void
+upce_expand (const gchar *upce,
+             gchar       *upca)
+{
+        const gchar *d = &upce[1];
+
+        switch (d[5])
+        {
+        case '0':
+        case '1':
+        case '2':
+                g_snprintf (upca, 12, "%c%c%c%c0000%c%c%c",
+                            upce[0], d[0], d[1], d[5], d[2], d[3], d[4]);
+                break;
+        case '3':
+                g_snprintf (upca, 12, "%c%c%c%c00000%c%c",
+                            upce[0], d[0], d[1], d[2], d[3], d[4]);
+                break;
+        case '4':
+                g_snprintf (upca, 12, "%c%c%c%c%c00000%c",
+                            upce[0], d[0], d[1], d[2], d[3], d[4]);
+                break;
+        default:
+                g_snprintf (upca, 12, "%c%c%c%c%c%c0000%c",
+                            upce[0], d[0], d[1], d[2], d[3], d[4], d[5]);
+                break;
+        }
+}
+
+
+/*--------------------------------------------------------------------------*/
+/* PRIVATE.  Append one digit with given parity ('L', 'G' or 'R').          */
+/*--------------------------------------------------------------------------*/
+static void
+ean_append_digit (lglBarcodeRuns *runs,
+                  gchar           digit,
+                  gchar           parity,
+                  gboolean        guard_flag)
+{
+        gint d = digit - '0';
+
+        lgl_barcode_runs_append (runs,
+                                 (parity == 'G') ? g_symbols[d] : l_symbols[d],
+                                 guard_flag);
+}
+
+
+/*--------------------------------------------------------------------------*/
+/* PRIVATE.  Vectorize encoded barcode.                                     */
+/*--------------------------------------------------------------------------*/
+static lglBarcode *
+ean_vectorize (lglBarcodeType        type,
+               const lglBarcodeRuns *runs,
+               gdouble               w,
+               gdouble               h,
+               gboolean              text_flag,
+               const gchar          *digits)
+{
+        gint         quiet_l, quiet_r;
+        gdouble      x, x0, y_text;
+        gdouble      width, height, guard_height;
+        gdouble      fsize;
+        lglBarcode  *bc;
+
+        if ( type == LGL_BARCODE_TYPE_EAN_8 )
+        {
+                quiet_l = 7;
+                quiet_r = 7;
+        }
+        else
+        {
+                quiet_l = 11;
+                quiet_r = (type == LGL_BARCODE_TYPE_EAN_13) ? 7 : 9;
+        }
+
+        /* determine module width */
+        x = MIN_X;
+        if ( w != 0 )
+        {
+                x = MAX (x, w / (runs->n_modules + quiet_l + quiet_r));
+        }
+        width = runs->n_modules * x;
+        x0    = quiet_l * x;
+        fsize = TEXT_SIZE_MODULES * x;
+
+        /* determine height of barcode */
+        height = text_flag ? h - (fsize + x) : h;
+        height = MAX (height, MAX(0.15*width, MIN_HEIGHT));
+        guard_height = text_flag ? height + GUARD_EXT_MODULES * x : height;
+
+        bc = lgl_barcode_new ();
+
+        lgl_barcode_runs_add_to_barcode (runs, bc, x0, 0.0, x, height, guard_height);
+
+        if ( text_flag )
+        {
+                y_text = height + 0.5*x + 0.2*fsize;
+
+                switch (type)
+                {
+                case LGL_BARCODE_TYPE_EAN_13:
+                        ean_add_text (bc, x0 -  4*x, y_text, fsize, &digits[0], 1);
+                        ean_add_text (bc, x0 + 24*x, y_text, fsize, &digits[1], 6);
+                        ean_add_text (bc, x0 + 71*x, y_text, fsize, &digits[7], 6);
+                        break;
+                case LGL_BARCODE_TYPE_UPC_A:
+                        ean_add_text (bc, x0 -  4*x,   y_text, fsize, &digits[0],  1);
+                        ean_add_text (bc, x0 + 27.5*x, y_text, fsize, &digits[1],  5);
+                        ean_add_text (bc, x0 + 67.5*x, y_text, fsize, &digits[6],  5);
+                        ean_add_text (bc, x0 + 99*x,   y_text, fsize, &digits[11], 1);
+                        break;
+                case LGL_BARCODE_TYPE_EAN_8:
+                        ean_add_text (bc, x0 + 17*x, y_text, fsize, &digits[0], 4);
+                        ean_add_text (bc, x0 + 50*x, y_text, fsize, &digits[4], 4);
+                        break;
+                case LGL_BARCODE_TYPE_UPC_E:
+                        ean_add_text (bc, x0 -  4*x, y_text, fsize, &digits[0], 1);
+                        ean_add_text (bc, x0 + 24*x, y_text, fsize, &digits[1], 6);
+                        ean_add_text (bc, x0 + 55*x, y_text, fsize, &digits[7], 1);
+                        break;
+                default:
+                        g_assert_not_reached ();
+                        break;
+                }
+        }
+
+        bc->width  = width + (quiet_l + quiet_r) * x;
+        bc->height = text_flag ? height + fsize + x : height;
+
+        return bc;
+}
+
+
+/*--------------------------------------------------------------------------*/
+/* PRIVATE.  Add group of n human readable digits centered at x.            */
+/*--------------------------------------------------------------------------*/
+static void
+ean_add_text (lglBarcode  *bc,
+              gdouble      x,
+              gdouble      y,
+              gdouble      fsize,
+              const gchar *digits,
+              gint         n)
+{
+        lgl_barcode_add_string (bc, x, y, fsize, (gchar *)digits, n);
+}
+
+
+
+
+/*
+ * Local Variables:       -- emacs
+ * mode: C                -- emacs
+ * c-basic-offset: 8      -- emacs
+ * tab-width: 8           -- emacs
+ * indent-tabs-mode: nil  -- emacs
+ * End:                   -- emacs
+ */
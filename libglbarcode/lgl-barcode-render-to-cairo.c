@@ -34,6 +34,9 @@
 #define BARCODE_FONT_FAMILY      "Sans"
 #define BARCODE_FONT_WEIGHT      PANGO_WEIGHT_NORMAL
 
+#define EPSILON        1.0e-6
+#define GRID_TOLERANCE 0.01
+
 
 /*===========================================*/
 /* Private types                             */
@@ -49,6 +52,12 @@
 /* Local function prototypes                 */
 /*===========================================*/
 
+static gboolean get_bar_extents (const lglBarcodeShape *shape,
+                                 gdouble               *x1,
+                                 gdouble               *x2,
+                                 gdouble               *y1,
+                                 gdouble               *y2);
+
 
 /****************************************************************************/
 /**
@@ -335,6 +344,180 @@ lgl_barcode_render_to_cairo_path (const lglBarcode  *bc,
 }
 
 
+/****************************************************************************/
+/**
+ * lgl_barcode_render_to_cairo_snapped:
+ * @bc:     An #lglBarcode structure
+ * @cr:     A #cairo_t context
+ *
+ * Render barcode to cairo context like lgl_barcode_render_to_cairo(), but
+ * with bars aligned to the device pixel grid of @cr.  The module width,
+ * taken to be the width of the narrowest bar, is rounded to a whole number
+ * of device pixels and every bar edge is placed on a whole module, so bars
+ * and spaces are exact multiples of the pixel pitch.  The overall width of
+ * the barcode changes by up to half a pixel per module.
+ *
+ * This is intended for non-antialiased output to low resolution raster
+ * devices, such as 203 dpi thermal printers.  If the current transformation
+ * is rotated by other than a multiple of 90 degrees, or the bars do not lie
+ * on a regular module grid, the barcode is rendered unchanged.
+ */
+void
+lgl_barcode_render_to_cairo_snapped (const lglBarcode  *bc,
+                                     cairo_t           *cr)
+{
+        cairo_matrix_t    matrix;
+        GList            *p;
+        GList            *other_shapes = NULL;
+        lglBarcode        other;
+        gboolean          swap_flag;
+        gboolean          grid_flag = TRUE;
+        gdouble           x1, x2, y1, y2;
+        gdouble           x_min = G_MAXDOUBLE, module = G_MAXDOUBLE;
+        gdouble           along_scale, along_offset, across_scale, across_offset;
+        gdouble           origin, step, k;
+        gdouble           a1, a2, c1, c2;
+
+        cairo_get_matrix (cr, &matrix);
+
+        if ( (fabs (matrix.xy) < EPSILON) && (fabs (matrix.yx) < EPSILON) )
+        {
+                /* Bars are vertical on the device. */
+                swap_flag     = FALSE;
+                along_scale   = matrix.xx;
+                along_offset  = matrix.x0;
+                across_scale  = matrix.yy;
+                across_offset = matrix.y0;
+        }
+        else if ( (fabs (matrix.xx) < EPSILON) && (fabs (matrix.yy) < EPSILON) )
+        {
+                /* Rotated by 90 or 270 degrees, bars are horizontal. */
+                swap_flag     = TRUE;
+                along_scale   = matrix.yx;
+                along_offset  = matrix.y0;
+                across_scale  = matrix.xy;
+                across_offset = matrix.x0;
+        }
+        else
+        {
+                lgl_barcode_render_to_cairo (bc, cr);
+                return;
+        }
+
+        for (p = bc->shapes; p != NULL; p = p->next)
+        {
+                if ( get_bar_extents (p->data, &x1, &x2, &y1, &y2) && ((x2 - x1) > EPSILON) )
+                {
+                        x_min  = MIN (x_min, x1);
+                        module = MIN (module, x2 - x1);
+                }
+        }
+
+        if ( module == G_MAXDOUBLE )
+        {
+                /* No bars. */
+                lgl_barcode_render_to_cairo (bc, cr);
+                return;
+        }
+
+        for (p = bc->shapes; (p != NULL) && grid_flag; p = p->next)
+        {
+                if ( get_bar_extents (p->data, &x1, &x2, &y1, &y2) )
+                {
+                        k = (x1 - x_min) / module;
+                        grid_flag = grid_flag && (fabs (k - floor (k + 0.5)) < GRID_TOLERANCE);
+                        k = (x2 - x_min) / module;
+                        grid_flag = grid_flag && (fabs (k - floor (k + 0.5)) < GRID_TOLERANCE);
+                }
+        }
+
+        if ( !grid_flag )
+        {
+                lgl_barcode_render_to_cairo (bc, cr);
+                return;
+        }
+
+        origin = floor (along_scale * x_min + along_offset + 0.5);
+        step   = MAX (1.0, floor (module * fabs (along_scale) + 0.5));
+        step   = (along_scale < 0) ? -step : step;
+
+        cairo_save (cr);
+        cairo_identity_matrix (cr);
+
+        for (p = bc->shapes; p != NULL; p = p->next)
+        {
+                if ( !get_bar_extents (p->data, &x1, &x2, &y1, &y2) )
+                {
+                        other_shapes = g_list_prepend (other_shapes, p->data);
+                        continue;
+                }
+
+                a1 = origin + floor ((x1 - x_min) / module + 0.5) * step;
+                a2 = origin + floor ((x2 - x_min) / module + 0.5) * step;
+                c1 = floor (across_scale * y1 + across_offset + 0.5);
+                c2 = floor (across_scale * y2 + across_offset + 0.5);
+
+                if ( swap_flag )
+                {
+                        cairo_rectangle (cr, MIN (c1, c2), MIN (a1, a2), fabs (c2 - c1), fabs (a2 - a1));
+                }
+                else
+                {
+                        cairo_rectangle (cr, MIN (a1, a2), MIN (c1, c2), fabs (a2 - a1), fabs (c2 - c1));
+                }
+        }
+        cairo_fill (cr);
+
+        cairo_restore (cr);
+
+        /* Text and other shapes are drawn as usual. */
+        if ( other_shapes )
+        {
+                other.width  = bc->width;
+                other.height = bc->height;
+                other.shapes = g_list_reverse (other_shapes);
+
+                lgl_barcode_render_to_cairo (&other, cr);
+
+                g_list_free (other.shapes);
+        }
+}
+
+
+/*--------------------------------------------------------------------------*/
+/* PRIVATE.  Get horizontal and vertical extents of a bar (line or box).    */
+/*--------------------------------------------------------------------------*/
+static gboolean
+get_bar_extents (const lglBarcodeShape *shape,
+                 gdouble               *x1,
+                 gdouble               *x2,
+                 gdouble               *y1,
+                 gdouble               *y2)
+{
+        switch (shape->type)
+        {
+
+        case LGL_BARCODE_SHAPE_LINE:
+                *x1 = shape->line.x - shape->line.width/2;
+                *x2 = shape->line.x + shape->line.width/2;
+                *y1 = shape->line.y;
+                *y2 = shape->line.y + shape->line.length;
+                return TRUE;
+
+        case LGL_BARCODE_SHAPE_BOX:
+                *x1 = shape->box.x;
+                *x2 = shape->box.x + shape->box.width;
+                *y1 = shape->box.y;
+                *y2 = shape->box.y + shape->box.height;
+                return TRUE;
+
+        default:
+                return FALSE;
+
+        }
+}
+
+
 
 /*
  * Local Variables:       -- emacs
@@ -0,0 +1,308 @@
+/*
+ *  lgl-barcode-runs.c
+ *  Copyright (C) 2026  agent <agent@local>.
+ *
+ *  This file is part of libglbarcode.
+ *
+ *  libglbarcode is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU Lesser General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  libglbarcode is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU Lesser General Public License for more details.
+ *
+ *  You should have received a copy of the GNU Lesser General Public License
+ *  along with libglbarcode.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <config.h>
+
+#include "lgl-barcode-runs.h"
+
+#include <string.h>
+
+
+/*========================================================*/
+/* Private macros and constants.                          */
+/*========================================================*/
+
+
+/*========================================================*/
+/* Private types.                                         */
+/*========================================================*/
+
+
+/*========================================================*/
+/* Private globals.                                       */
+/*========================================================*/
+
+
+/*========================================================*/
+/* Private function prototypes.                           */
+/*========================================================*/
+
+static void set_bits (guint8 *scanline,
+                      guint   first,
+                      guint   n);
+
+
+/*****************************************************************************/
+/**
+ * lgl_barcode_runs_new:
+ *
+ * Allocate a new, empty #lglBarcodeRuns structure.
+ *
+ * Returns: A newly allocated #lglBarcodeRuns structure.  Use
+ *          lgl_barcode_runs_free() to free it.
+ *
+ */
+lglBarcodeRuns *
+lgl_barcode_runs_new (void)
+{
+        return g_new0 (lglBarcodeRuns, 1);
+}
+
+
+/*****************************************************************************/
+/**
+ * lgl_barcode_runs_free:
+ * @runs: The #lglBarcodeRuns structure to free
+ *
+ * Free a previously allocated #lglBarcodeRuns structure.
+ *
+ */
+void
+lgl_barcode_runs_free (lglBarcodeRuns *runs)
+{
+        if (runs != NULL)
+        {
+                g_free (runs->runs);
+                g_free (runs);
+        }
+}
+
+
+/*****************************************************************************/
+/**
+ * lgl_barcode_runs_append:
+ * @runs:       An #lglBarcodeRuns structure
+ * @pattern:    A string of run widths, e.g. "211214"
+ * @guard_flag: %TRUE if the runs belong to guard bars
+ *
+ * Append a symbol pattern to @runs.  Each character of @pattern is the width
+ * of one bar or space in modules ('1' - '9').  Callers are responsible for
+ * appending patterns such that bars and spaces continue to alternate.
+ *
+ * <note><para>
+ *        This function is intended to be used internally by barcode implementations.
+ * </para></note>
+ *
+ */
+void
+lgl_barcode_runs_append (lglBarcodeRuns *runs,
+                         const gchar    *pattern,
+                         gboolean        guard_flag)
+{
+        guint        n, i;
+        guint8       w;
+
+        g_return_if_fail (runs);
+        g_return_if_fail (pattern);
+
+        n = strlen (pattern);
+        runs->runs = g_renew (guint8, runs->runs, runs->n_runs + n);
+
+        for ( i = 0; i < n; i++ )
+        {
+                w = pattern[i] - '0';
+                runs->n_modules += w;
+
+                if ( guard_flag )
+                {
+                        w |= LGL_BARCODE_RUN_GUARD;
+                }
+                runs->runs[runs->n_runs++] = w;
+        }
+}
+
+
+/*****************************************************************************/
+/**
+ * lgl_barcode_runs_add_to_barcode:
+ * @runs:         An #lglBarcodeRuns structure
+ * @bc:           An #lglBarcode structure
+ * @x:            x coordinate of left edge of first bar
+ * @y:            y coordinate of top of bars
+ * @module_width: Width of one module
+ * @height:       Height of normal bars
+ * @guard_height: Height of guard bars
+ *
+ * Add one box per bar of @runs to @bc.  All units are in points
+ * ( 1 point = 1/72 inch ).
+ *
+ * <note><para>
+ *        This function is intended to be used internally by barcode implementations.
+ * </para></note>
+ *
+ */
+void
+lgl_barcode_runs_add_to_barcode (const lglBarcodeRuns *runs,
+                                 lglBarcode           *bc,
+                                 gdouble               x,
+                                 gdouble               y,
+                                 gdouble               module_width,
+                                 gdouble               height,
+                                 gdouble               guard_height)
+{
+        guint        i, m;
+        guint8       r;
+        gdouble      h;
+
+        g_return_if_fail (runs);
+        g_return_if_fail (bc);
+
+        m = 0;
+        for ( i = 0; i < runs->n_runs; i++ )
+        {
+                r = runs->runs[i];
+
+                if ( (i & 1) == 0 )
+                {
+                        h = (r & LGL_BARCODE_RUN_GUARD) ? guard_height : height;
+                        lgl_barcode_add_box (bc,
+                                             x + m*module_width, y,
+                                             LGL_BARCODE_RUN_WIDTH (r)*module_width, h);
+                }
+
+                m += LGL_BARCODE_RUN_WIDTH (r);
+        }
+}
+
+
+/*****************************************************************************/
+/**
+ * lgl_barcode_runs_render_to_cairo:
+ * @runs:         An #lglBarcodeRuns structure
+ * @cr:           A #cairo_t context
+ * @module_width: Width of one module
+ * @height:       Height of bars
+ *
+ * Render bars of @runs to cairo context, filling them all at once.  Context
+ * should be translated such that the origin is at the top left corner of the
+ * first bar.
+ *
+ */
+void
+lgl_barcode_runs_render_to_cairo (const lglBarcodeRuns *runs,
+                                  cairo_t              *cr,
+                                  gdouble               module_width,
+                                  gdouble               height)
+{
+        guint        i, m;
+        guint8       w;
+
+        g_return_if_fail (runs);
+
+        m = 0;
+        for ( i = 0; i < runs->n_runs; i++ )
+        {
+                w = LGL_BARCODE_RUN_WIDTH (runs->runs[i]);
+
+                if ( (i & 1) == 0 )
+                {
+                        cairo_rectangle (cr, m*module_width, 0.0, w*module_width, height);
+                }
+
+                m += w;
+        }
+        cairo_fill (cr);
+}
+
+
+/*****************************************************************************/
+/**
+ * lgl_barcode_runs_render_to_scanline:
+ * @runs:            An #lglBarcodeRuns structure
+ * @scanline:        A packed 1-bit scanline, MSB first, 1 = black
+ * @x_dot:           Dot position of left edge of first bar
+ * @dots_per_module: Width of one module in device dots
+ *
+ * Render bars of @runs into a single packed 1-bit scanline.  Bits for bars are
+ * set, bits for spaces are left untouched.  Since all widths are integral
+ * multiples of @dots_per_module, bar widths are exact on the device.  The
+ * caller must ensure @scanline holds at least
+ * ( @x_dot + @runs->n_modules * @dots_per_module ) bits.
+ *
+ */
+void
+lgl_barcode_runs_render_to_scanline (const lglBarcodeRuns *runs,
+                                     guint8               *scanline,
+                                     guint                 x_dot,
+                                     guint                 dots_per_module)
+{
+        guint        i, x;
+        guint        w;
+
+        g_return_if_fail (runs);
+        g_return_if_fail (scanline);
+
+        x = x_dot;
+        for ( i = 0; i < runs->n_runs; i++ )
+        {
+                w = LGL_BARCODE_RUN_WIDTH (runs->runs[i]) * dots_per_module;
+
+                if ( (i & 1) == 0 )
+                {
+                        set_bits (scanline, x, w);
+                }
+
+                x += w;
+        }
+}
+
+
+/*--------------------------------------------------------------------------*/
+/* PRIVATE.  Set n consecutive bits, starting at bit first.                 */
+/*--------------------------------------------------------------------------*/
+static void
+set_bits (guint8 *scanline,
+          guint   first,
+          guint   n)
+{
+        guint        last = first + n;
+
+        /* Leading partial byte. */
+        while ( (first < last) && (first & 7) )
+        {
+                scanline[first >> 3] |= 0x80 >> (first & 7);
+                first++;
+        }
+
+        /* Whole bytes. */
+        if ( (last - first) >= 8 )
+        {
+                memset (&scanline[first >> 3], 0xff, (last - first) >> 3);
+                first += (last - first) & ~7U;
+        }
+
+        /* Trailing partial byte. */
+        while ( first < last )
+        {
+                scanline[first >> 3] |= 0x80 >> (first & 7);
+                first++;
+        }
+}
+
+
+
+/*
+ * Local Variables:       -- emacs
+ * mode: C                -- emacs
+ * c-basic-offset: 8      -- emacs
+ * tab-width: 8           -- emacs
+ * indent-tabs-mode: nil  -- emacs
+ * End:                   -- emacs
+ */
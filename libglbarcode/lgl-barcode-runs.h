@@ -0,0 +1,111 @@
+/*
+ *  lgl-barcode-runs.h
+ *  Copyright (C) 2026  agent <agent@local>.
+ *
+ *  This file is part of libglbarcode.
+ *
+ *  libglbarcode is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU Lesser General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  libglbarcode is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU Lesser General Public License for more details.
+ *
+ *  You should have received a copy of the GNU Lesser General Public License
+ *  along with libglbarcode.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef __LGL_BARCODE_RUNS_H__
+#define __LGL_BARCODE_RUNS_H__
+
+#include <glib.h>
+#include <cairo.h>
+
+#include "lgl-barcode.h"
+
+G_BEGIN_DECLS
+
+
+/**
+ * LGL_BARCODE_RUN_GUARD:
+ *
+ * Flag bit of a run, set for guard bars that extend into the text area.
+ */
+#define LGL_BARCODE_RUN_GUARD      0x80
+
+/**
+ * LGL_BARCODE_RUN_WIDTH:
+ * @r: A run
+ *
+ * Extract the width of a run in modules.
+ */
+#define LGL_BARCODE_RUN_WIDTH(r)   ((r) & 0x7f)
+
+
+/**
+ * lglBarcodeRuns:
+ *  @n_runs:    Number of runs
+ *  @n_modules: Total width of all runs in modules
+ *  @runs:      Run widths in modules, alternating bar and space, starting with a bar
+ *
+ * A compact run-length representation of a linear (1D) barcode.  Each element
+ * of @runs is the width of a bar or space in modules, possibly or-ed with
+ * %LGL_BARCODE_RUN_GUARD.  Even indices are bars, odd indices are spaces.
+ * Quiet zones are not included.
+ *
+ * This representation can be rendered directly to cairo or to a packed
+ * 1-bit scanline without going through #lglBarcode shapes.
+ */
+typedef struct {
+
+        guint    n_runs;
+        guint    n_modules;
+
+        guint8  *runs;
+
+} lglBarcodeRuns;
+
+
+lglBarcodeRuns  *lgl_barcode_runs_new                (void);
+
+void             lgl_barcode_runs_free               (lglBarcodeRuns    *runs);
+
+void             lgl_barcode_runs_append             (lglBarcodeRuns    *runs,
+                                                      const gchar       *pattern,
+                                                      gboolean           guard_flag);
+
+void             lgl_barcode_runs_add_to_barcode     (const lglBarcodeRuns *runs,
+                                                      lglBarcode        *bc,
+                                                      gdouble            x,
+                                                      gdouble            y,
+                                                      gdouble            module_width,
+                                                      gdouble            height,
+                                                      gdouble            guard_height);
+
+void             lgl_barcode_runs_render_to_cairo    (const lglBarcodeRuns *runs,
+                                                      cairo_t           *cr,
+                                                      gdouble            module_width,
+                                                      gdouble            height);
+
+void             lgl_barcode_runs_render_to_scanline (const lglBarcodeRuns *runs,
+                                                      guint8            *scanline,
+                                                      guint              x_dot,
+                                                      guint              dots_per_module);
+
+G_END_DECLS
+
+#endif /* __LGL_BARCODE_RUNS_H__ */
+
+
+
+/*
+ * Local Variables:       -- emacs
+ * mode: C                -- emacs
+ * c-basic-offset: 8      -- emacs
+ * tab-width: 8           -- emacs
+ * indent-tabs-mode: nil  -- emacs
+ * End:                   -- emacs
+ */
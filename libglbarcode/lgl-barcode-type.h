@@ -39,6 +39,14 @@ typedef enum {
         LGL_BARCODE_TYPE_CODE39,         /* Code 39 */
         LGL_BARCODE_TYPE_CODE39_EXT,     /* Extended Code 39 (Supports full ASCII character set) */
 
+        LGL_BARCODE_TYPE_CODE128,        /* Code 128 (Automatic A/B/C code set selection) */
+        LGL_BARCODE_TYPE_GS1_128,        /* GS1-128 (Formerly UCC/EAN-128) */
+
+        LGL_BARCODE_TYPE_EAN_13,         /* EAN-13 */
+        LGL_BARCODE_TYPE_EAN_8,          /* EAN-8 */
+        LGL_BARCODE_TYPE_UPC_A,          /* UPC-A */
+        LGL_BARCODE_TYPE_UPC_E,          /* UPC-E */
+
         /*< private >*/
         LGL_BARCODE_N_TYPES
 
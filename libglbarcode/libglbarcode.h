@@ -25,10 +25,13 @@
 #include <libglbarcode/lgl-barcode.h>
 #include <libglbarcode/lgl-barcode-type.h>
 #include <libglbarcode/lgl-barcode-create.h>
+#include <libglbarcode/lgl-barcode-runs.h>
 
 #include <libglbarcode/lgl-barcode-render-to-cairo.h>
 
 #include <libglbarcode/lgl-barcode-code39.h>
+#include <libglbarcode/lgl-barcode-code128.h>
+#include <libglbarcode/lgl-barcode-ean.h>
 #include <libglbarcode/lgl-barcode-onecode.h>
 #include <libglbarcode/lgl-barcode-postnet.h>
 
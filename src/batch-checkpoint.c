@@ -0,0 +1,231 @@
+/*
+ *  batch-checkpoint.c
+ *  Copyright (C) 2026  agent <agent@local>.
+ *
+ *  This file is part of gLabels.
+ *
+ *  gLabels is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  gLabels is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with gLabels.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <config.h>
+
+#include "batch-checkpoint.h"
+
+#include <glib/gi18n.h>
+#include <gio/gio.h>
+#include <string.h>
+
+#include "debug.h"
+
+
+/*===========================================*/
+/* Private function prototypes.              */
+/*===========================================*/
+
+static gboolean parse_int    (const gchar  *value,
+                              gint64        min,
+                              gint64        max,
+                              gint64       *result);
+
+
+/*****************************************************************************/
+/* Initialize checkpoint to the start of a job.                              */
+/*****************************************************************************/
+void
+gl_batch_checkpoint_init (glBatchCheckpoint *checkpoint)
+{
+        g_return_if_fail (checkpoint);
+
+        checkpoint->sheet          = 0;
+        checkpoint->record         = -1;
+        checkpoint->copy           = 0;
+        checkpoint->chunk          = -1;
+        checkpoint->index_record   = -1;
+        checkpoint->index_position = -1;
+}
+
+
+/*****************************************************************************/
+/* Read checkpoint written for the job identified by job_id.  Fails with     */
+/* G_FILE_ERROR_NOENT if there is no checkpoint, i.e. nothing to resume.     */
+/*****************************************************************************/
+gboolean
+gl_batch_checkpoint_read (const gchar        *filename,
+                          const gchar        *job_id,
+                          glBatchCheckpoint  *checkpoint,
+                          GError            **error)
+{
+        gchar     *contents;
+        gchar    **lines;
+        gchar     *value;
+        gint64     n;
+        gboolean   job_flag = FALSE;
+        gboolean   sheet_flag = FALSE;
+        gboolean   ok = TRUE;
+        gint       i;
+
+        g_return_val_if_fail (filename, FALSE);
+        g_return_val_if_fail (job_id, FALSE);
+        g_return_val_if_fail (checkpoint, FALSE);
+
+        if ( !g_file_get_contents (filename, &contents, NULL, error) )
+        {
+                return FALSE;
+        }
+
+        gl_batch_checkpoint_init (checkpoint);
+
+        lines = g_strsplit (contents, "\n", -1);
+        for ( i = 0; ok && lines[i]; i++ )
+        {
+                if ( *lines[i] == '\0' )
+                {
+                        continue;
+                }
+
+                value = strchr (lines[i], '=');
+                if ( value == NULL )
+                {
+                        ok = FALSE;
+                        break;
+                }
+                *value++ = '\0';
+
+                if ( strcmp (lines[i], "job") == 0 )
+                {
+                        job_flag = (strcmp (value, job_id) == 0);
+                }
+                else if ( strcmp (lines[i], "sheet") == 0 )
+                {
+                        ok = sheet_flag = parse_int (value, 0, G_MAXINT, &n);
+                        checkpoint->sheet = n;
+                }
+                else if ( strcmp (lines[i], "record") == 0 )
+                {
+                        ok = parse_int (value, -1, G_MAXINT, &n);
+                        checkpoint->record = n;
+                }
+                else if ( strcmp (lines[i], "copy") == 0 )
+                {
+                        ok = parse_int (value, 0, G_MAXINT, &n);
+                        checkpoint->copy = n;
+                }
+                else if ( strcmp (lines[i], "chunk") == 0 )
+                {
+                        ok = parse_int (value, -1, G_MAXINT, &n);
+                        checkpoint->chunk = n;
+                }
+                else if ( strcmp (lines[i], "indexrecord") == 0 )
+                {
+                        ok = parse_int (value, -1, G_MAXINT, &n);
+                        checkpoint->index_record = n;
+                }
+                else if ( strcmp (lines[i], "indexposition") == 0 )
+                {
+                        ok = parse_int (value, -1, G_MAXINT64, &n);
+                        checkpoint->index_position = n;
+                }
+                /* Unknown keys are ignored. */
+        }
+        g_strfreev (lines);
+        g_free (contents);
+
+        if ( !ok || !sheet_flag )
+        {
+                g_set_error (error, G_IO_ERROR, G_IO_ERROR_INVALID_DATA,
+                             _("invalid checkpoint file %s"), filename);
+                return FALSE;
+        }
+
+        if ( !job_flag )
+        {
+                g_set_error (error, G_IO_ERROR, G_IO_ERROR_INVALID_DATA,
+                             _("checkpoint file %s belongs to a different job or merge input"), filename);
+                return FALSE;
+        }
+
+        return TRUE;
+}
+
+
+/*****************************************************************************/
+/* Write checkpoint for the job identified by job_id.  The file is replaced  */
+/* atomically, so that it is intact whenever the job dies.                   */
+/*****************************************************************************/
+gboolean
+gl_batch_checkpoint_write (const gchar              *filename,
+                           const gchar              *job_id,
+                           const glBatchCheckpoint  *checkpoint,
+                           GError                  **error)
+{
+        gchar    *contents;
+        gboolean  ret;
+
+        g_return_val_if_fail (filename, FALSE);
+        g_return_val_if_fail (job_id, FALSE);
+        g_return_val_if_fail (checkpoint, FALSE);
+
+        gl_debug (DEBUG_PRINT, "sheet %d", checkpoint->sheet);
+
+        contents = g_strdup_printf ("job=%s\n"
+                                    "sheet=%d\n"
+                                    "record=%d\n"
+                                    "copy=%d\n"
+                                    "chunk=%d\n"
+                                    "indexrecord=%d\n"
+                                    "indexposition=%" G_GINT64_FORMAT "\n",
+                                    job_id,
+                                    checkpoint->sheet,
+                                    checkpoint->record,
+                                    checkpoint->copy,
+                                    checkpoint->chunk,
+                                    checkpoint->index_record,
+                                    (gint64)checkpoint->index_position);
+
+        ret = g_file_set_contents (filename, contents, -1, error);
+
+        g_free (contents);
+
+        return ret;
+}
+
+
+/*---------------------------------------------------------------------------*/
+/* PRIVATE.  Parse decimal integer in [min, max].                            */
+/*---------------------------------------------------------------------------*/
+static gboolean
+parse_int (const gchar  *value,
+           gint64        min,
+           gint64        max,
+           gint64       *result)
+{
+        gchar *end;
+
+        *result = g_ascii_strtoll (value, &end, 10);
+
+        return ( (end != value) && (*end == '\0') &&
+                 (*result >= min) && (*result <= max) );
+}
+
+
+
+
+/*
+ * Local Variables:       -- emacs
+ * mode: C                -- emacs
+ * c-basic-offset: 8      -- emacs
+ * tab-width: 8           -- emacs
+ * indent-tabs-mode: nil  -- emacs
+ * End:                   -- emacs
+ */
@@ -0,0 +1,71 @@
+/*
+ *  batch-checkpoint.h
+ *  Copyright (C) 2026  agent <agent@local>.
+ *
+ *  This file is part of gLabels.
+ *
+ *  gLabels is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  gLabels is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with gLabels.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef __BATCH_CHECKPOINT_H__
+#define __BATCH_CHECKPOINT_H__
+
+#include <glib.h>
+
+G_BEGIN_DECLS
+
+
+/*
+ * Where an interrupted glabels-batch job can go on from.  Everything before
+ * sheet is in finished output files.  Sheets count from 0 over the whole job.
+ */
+typedef struct {
+        gint     sheet;            /* Next sheet to export. */
+        gint     record;           /* Merge record of its first label, -1 if none, */
+        gint     copy;             /* and which copy of that record. */
+        gint     chunk;            /* Output chunk of sheet, -1 if not chunked. */
+
+        gint     index_record;     /* Indexed merge record at or before record, */
+        goffset  index_position;   /* and where it starts in the source, -1 if unknown. */
+} glBatchCheckpoint;
+
+
+void      gl_batch_checkpoint_init  (glBatchCheckpoint        *checkpoint);
+
+gboolean  gl_batch_checkpoint_read  (const gchar              *filename,
+                                     const gchar              *job_id,
+                                     glBatchCheckpoint        *checkpoint,
+                                     GError                  **error);
+
+gboolean  gl_batch_checkpoint_write (const gchar              *filename,
+                                     const gchar              *job_id,
+                                     const glBatchCheckpoint  *checkpoint,
+                                     GError                  **error);
+
+
+G_END_DECLS
+
+#endif /* __BATCH_CHECKPOINT_H__ */
+
+
+
+
+/*
+ * Local Variables:       -- emacs
+ * mode: C                -- emacs
+ * c-basic-offset: 8      -- emacs
+ * tab-width: 8           -- emacs
+ * indent-tabs-mode: nil  -- emacs
+ * End:                   -- emacs
+ */
@@ -0,0 +1,1103 @@
+/*
+ *  batch-job.c
+ *  Copyright (C) 2026  agent <agent@local>.
+ *
+ *  This file is part of gLabels.
+ *
+ *  gLabels is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  gLabels is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with gLabels.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <config.h>
+
+#include "batch-job.h"
+
+#include <glib/gi18n.h>
+#include <gio/gio.h>
+#include <glib/gstdio.h>
+#include <errno.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+
+#include <libglabels.h>
+#include "xml-label.h"
+#include "batch-checkpoint.h"
+
+#include "debug.h"
+
+
+/*===========================================*/
+/* Private macros and constants.             */
+/*===========================================*/
+
+#define DEFAULT_OUTPUT "output.pdf"
+
+/* Minimum interval between checkpoint writes, in microseconds. */
+#define CHECKPOINT_INTERVAL (5 * G_USEC_PER_SEC)
+
+
+/*===========================================*/
+/* Private types.                            */
+/*===========================================*/
+
+typedef struct {
+        FILE                      *fp;
+
+        glPrintExportProgressFunc  progress_func;
+        gpointer                   progress_data;
+} Stream;
+
+typedef struct {
+        const gchar               *filename;
+        gchar                     *job_id;
+
+        /* Where labels are in the whole job. */
+        glMerge                   *merge;           /* As loaded, NULL if none. */
+        gboolean                   contiguous_flag; /* Copies of a record together. */
+        gint                       n_labels_per_page;
+        gint                       first;
+        gint                       n_copies;
+        gint                       n_records;       /* Records loaded, uncollated only. */
+        gint                       chunk_sheets;
+
+        glBatchCheckpoint          checkpoint;      /* Latest state. */
+        gboolean                   dirty_flag;      /* Latest state not written yet. */
+        gint64                     last_write;
+} Checkpointer;
+
+
+/*===========================================*/
+/* Private function prototypes.              */
+/*===========================================*/
+
+static gboolean parse_flag   (const gchar            *value);
+
+static gboolean parse_range  (const gchar            *value,
+                              gint                   *first,
+                              gint                   *last);
+
+static gboolean parse_shard  (const gchar            *value,
+                              gint                   *shard,
+                              gint                   *n_shards);
+
+static gboolean parse_count  (const gchar            *value,
+                              gint                   *count);
+
+static gboolean merge_part   (const glBatchJob        *job,
+                              glLabel                 *label,
+                              glMerge                 *merge,
+                              const gchar             *src,
+                              const glBatchCheckpoint *resume,
+                              glPrintExportSettings   *settings,
+                              GError                 **error);
+
+static void     shard_sheets (const glBatchJob       *job,
+                              gint                    n_sheets,
+                              gint                    chunk_sheets,
+                              gint                   *sheet_first,
+                              gint                   *sheet_last);
+
+static gboolean export_to_fd (glLabel                *label,
+                              gint                    fd,
+                              glPrintExportSettings  *settings,
+                              GError                **error);
+
+static gchar   *get_job_id   (const glBatchJob       *job,
+                              const gchar            *src);
+
+static void     checkpoint_cb    (gint                next_sheet,
+                                  gpointer            data);
+
+static void     checkpoint_flush (Checkpointer       *checkpointer,
+                                  gboolean            force_flag);
+
+static cairo_status_t stream_write    (void                *closure,
+                                       const unsigned char *data,
+                                       unsigned int         length);
+
+static void           stream_progress (gint                 sheet,
+                                       gint                 n_sheets,
+                                       gpointer             data);
+
+
+/*****************************************************************************/
+/* Create a new job with the same defaults as the command line.              */
+/*****************************************************************************/
+glBatchJob *
+gl_batch_job_new (void)
+{
+        glBatchJob *job;
+
+        job = g_new0 (glBatchJob, 1);
+
+        job->output   = g_strdup (DEFAULT_OUTPUT);
+        job->n_copies = 1;
+        job->n_sheets = 1;
+        job->first    = 1;
+
+        return job;
+}
+
+
+/*****************************************************************************/
+/* Free job.                                                                 */
+/*****************************************************************************/
+void
+gl_batch_job_free (glBatchJob *job)
+{
+        if ( job )
+        {
+                g_free (job->filename);
+                g_free (job->input);
+                g_free (job->output);
+                g_free (job->format);
+                g_free (job->checkpoint);
+                g_free (job);
+        }
+}
+
+
+/*****************************************************************************/
+/* Set one job parameter from its "key=value" form.  Returns FALSE if the    */
+/* key is unknown or the value is not valid.                                 */
+/*****************************************************************************/
+gboolean
+gl_batch_job_set (glBatchJob  *job,
+                  const gchar *key,
+                  const gchar *value)
+{
+        g_return_val_if_fail (job, FALSE);
+        g_return_val_if_fail (key && value, FALSE);
+
+        if ( strcmp (key, "label") == 0 )
+        {
+                g_free (job->filename);
+                job->filename = g_strdup (value);
+        }
+        else if ( strcmp (key, "input") == 0 )
+        {
+                g_free (job->input);
+                job->input = *value ? g_strdup (value) : NULL;
+        }
+        else if ( strcmp (key, "output") == 0 )
+        {
+                g_free (job->output);
+                job->output = g_strdup (value);
+        }
+        else if ( strcmp (key, "format") == 0 )
+        {
+                glPrintExportFormat format;
+
+                g_free (job->format);
+                job->format = NULL;
+                if ( *value )
+                {
+                        if ( !gl_print_export_format_from_name (value, &format) )
+                        {
+                                return FALSE;
+                        }
+                        job->format = g_strdup (value);
+                }
+        }
+        else if ( strcmp (key, "copies") == 0 )
+        {
+                return parse_count (value, &job->n_copies);
+        }
+        else if ( strcmp (key, "sheets") == 0 )
+        {
+                job->n_sheets = atoi (value);
+        }
+        else if ( strcmp (key, "first") == 0 )
+        {
+                return parse_count (value, &job->first);
+        }
+        else if ( strcmp (key, "collate") == 0 )
+        {
+                job->collate_flag = parse_flag (value);
+        }
+        else if ( strcmp (key, "outline") == 0 )
+        {
+                job->outline_flag = parse_flag (value);
+        }
+        else if ( strcmp (key, "reverse") == 0 )
+        {
+                job->reverse_flag = parse_flag (value);
+        }
+        else if ( strcmp (key, "cropmarks") == 0 )
+        {
+                job->crop_marks_flag = parse_flag (value);
+        }
+        else if ( strcmp (key, "resolution") == 0 )
+        {
+                job->resolution = g_ascii_strtod (value, NULL);
+        }
+        else if ( strcmp (key, "perlabel") == 0 )
+        {
+                job->per_label_flag = parse_flag (value);
+        }
+        else if ( strcmp (key, "threads") == 0 )
+        {
+                job->n_threads = atoi (value);
+        }
+        else if ( strcmp (key, "mono") == 0 )
+        {
+                job->mono_flag = parse_flag (value);
+        }
+        else if ( strcmp (key, "dither") == 0 )
+        {
+                return gl_mono_dither_from_string (value, &job->dither);
+        }
+        else if ( strcmp (key, "chunksheets") == 0 )
+        {
+                job->chunk_sheets = atoi (value);
+        }
+        else if ( strcmp (key, "chunkrecords") == 0 )
+        {
+                job->chunk_records = atoi (value);
+        }
+        else if ( strcmp (key, "records") == 0 )
+        {
+                return parse_range (value, &job->record_first, &job->record_last);
+        }
+        else if ( strcmp (key, "shard") == 0 )
+        {
+                return parse_shard (value, &job->shard, &job->n_shards);
+        }
+        else if ( strcmp (key, "checkpoint") == 0 )
+        {
+                g_free (job->checkpoint);
+                job->checkpoint = *value ? g_strdup (value) : NULL;
+        }
+        else if ( strcmp (key, "resume") == 0 )
+        {
+                job->resume_flag = parse_flag (value);
+        }
+        else
+        {
+                return FALSE;
+        }
+
+        return TRUE;
+}
+
+
+/*****************************************************************************/
+/* Serialize job as "key=value" lines, as read back by gl_batch_job_set().   */
+/*****************************************************************************/
+gchar *
+gl_batch_job_serialize (const glBatchJob *job)
+{
+        GString *string;
+        gchar    buffer[G_ASCII_DTOSTR_BUF_SIZE];
+
+        g_return_val_if_fail (job, NULL);
+
+        string = g_string_new ("");
+
+        g_string_append_printf (string, "label=%s\n",   job->filename ? job->filename : "");
+        g_string_append_printf (string, "input=%s\n",   job->input ? job->input : "");
+        g_string_append_printf (string, "output=%s\n",  job->output ? job->output : "");
+        g_string_append_printf (string, "format=%s\n",  job->format ? job->format : "");
+        g_string_append_printf (string, "copies=%d\n",  job->n_copies);
+        g_string_append_printf (string, "sheets=%d\n",  job->n_sheets);
+        g_string_append_printf (string, "first=%d\n",   job->first);
+        g_string_append_printf (string, "collate=%d\n", job->collate_flag);
+        g_string_append_printf (string, "outline=%d\n", job->outline_flag);
+        g_string_append_printf (string, "reverse=%d\n", job->reverse_flag);
+        g_string_append_printf (string, "cropmarks=%d\n", job->crop_marks_flag);
+        g_string_append_printf (string, "resolution=%s\n",
+                                g_ascii_dtostr (buffer, sizeof (buffer), job->resolution));
+        g_string_append_printf (string, "perlabel=%d\n", job->per_label_flag);
+        g_string_append_printf (string, "threads=%d\n", job->n_threads);
+        g_string_append_printf (string, "mono=%d\n", job->mono_flag);
+        g_string_append_printf (string, "dither=%s\n", gl_mono_dither_to_string (job->dither));
+        g_string_append_printf (string, "chunksheets=%d\n", job->chunk_sheets);
+        g_string_append_printf (string, "chunkrecords=%d\n", job->chunk_records);
+        if ( job->record_first > 0 )
+        {
+                g_string_append_printf (string, "records=%d-", job->record_first);
+                if ( job->record_last > 0 )
+                {
+                        g_string_append_printf (string, "%d", job->record_last);
+                }
+                g_string_append_c (string, '\n');
+        }
+        if ( job->n_shards > 0 )
+        {
+                g_string_append_printf (string, "shard=%d/%d\n", job->shard, job->n_shards);
+        }
+        if ( job->checkpoint != NULL )
+        {
+                g_string_append_printf (string, "checkpoint=%s\n", job->checkpoint);
+                g_string_append_printf (string, "resume=%d\n", job->resume_flag);
+        }
+
+        return g_string_free (string, FALSE);
+}
+
+
+/*****************************************************************************/
+/* File descriptor that output names: 1 for "-" (stdout), N for "fd:N".     */
+/* Returns -1 if output is a filename.                                       */
+/*****************************************************************************/
+gint
+gl_batch_job_output_fd (const gchar *output)
+{
+        gchar  *end;
+        gint64  fd;
+
+        if ( output == NULL )
+        {
+                return -1;
+        }
+
+        if ( strcmp (output, "-") == 0 )
+        {
+                return STDOUT_FILENO;
+        }
+
+        if ( g_str_has_prefix (output, "fd:") )
+        {
+                fd = g_ascii_strtoll (output + 3, &end, 10);
+                if ( (end != output + 3) && (*end == '\0') && (fd >= 0) && (fd <= G_MAXINT) )
+                {
+                        return fd;
+                }
+        }
+
+        return -1;
+}
+
+
+/*****************************************************************************/
+/* Open, merge and export the label described by job.                       */
+/*****************************************************************************/
+gboolean
+gl_batch_job_run (const glBatchJob           *job,
+                  glPrintExportProgressFunc   progress_func,
+                  gpointer                    progress_data,
+                  GError                    **error)
+{
+        glLabel               *label;
+        glMerge               *merge;
+        glXMLLabelStatus       status;
+        glPrintExportSettings  settings;
+        const lglTemplate     *template;
+        const lglTemplateFrame *frame;
+        Checkpointer           checkpointer = { NULL };
+        glBatchCheckpoint      resume;
+        gboolean               resume_flag = FALSE;
+        gchar                 *src;
+        gint                   fd;
+        gboolean               ret = TRUE;
+        GError                *local_error = NULL;
+
+        gl_debug (DEBUG_PRINT, "START");
+
+        g_return_val_if_fail (job, FALSE);
+
+        if ( (job->filename == NULL) || (job->output == NULL) )
+        {
+                g_set_error (error, G_IO_ERROR, G_IO_ERROR_INVALID_ARGUMENT,
+                             _("missing glabels file or output filename"));
+                return FALSE;
+        }
+
+        /* As enforced by gl_batch_job_set(), layout and checkpoints divide by these. */
+        if ( (job->n_copies < 1) || (job->first < 1) )
+        {
+                g_set_error (error, G_IO_ERROR, G_IO_ERROR_INVALID_ARGUMENT,
+                             _("number of copies and first label must be at least 1"));
+                return FALSE;
+        }
+
+        /* A stream is a single file, it cannot be split into chunk files. */
+        if ( (gl_batch_job_output_fd (job->output) >= 0) &&
+             ((job->chunk_sheets > 0) || (job->chunk_records > 0)) )
+        {
+                g_set_error (error, G_IO_ERROR, G_IO_ERROR_INVALID_ARGUMENT,
+                             _("chunked output cannot be written to a stream"));
+                return FALSE;
+        }
+
+        label = gl_xml_label_open (job->filename, &status);
+        if ( status != XML_LABEL_OK )
+        {
+                g_set_error (error, G_IO_ERROR, G_IO_ERROR_FAILED,
+                             _("cannot open glabels file %s"), job->filename);
+                return FALSE;
+        }
+
+        gl_print_export_settings_init (&settings, label);
+        settings.format          = gl_print_export_format_from_filename (job->output);
+        if ( job->format )
+        {
+                gl_print_export_format_from_name (job->format, &settings.format);
+        }
+        settings.n_sheets        = job->n_sheets;
+        settings.n_copies        = job->n_copies;
+        settings.first           = job->first;
+        settings.collate_flag    = job->collate_flag;
+        settings.outline_flag    = job->outline_flag;
+        settings.reverse_flag    = job->reverse_flag;
+        settings.crop_marks_flag = job->crop_marks_flag;
+        if ( job->resolution > 0 )
+        {
+                settings.resolution  = job->resolution;
+        }
+        settings.per_label_flag  = job->per_label_flag;
+        settings.n_threads       = job->n_threads;
+        settings.mono_flag       = job->mono_flag;
+        settings.dither          = job->dither;
+        settings.chunk_sheets    = job->chunk_sheets;
+        settings.chunk_records   = job->chunk_records;
+        settings.progress_func   = progress_func;
+        settings.progress_data   = progress_data;
+
+        fd = gl_batch_job_output_fd (job->output);
+
+        merge = gl_label_get_merge (label);
+        src   = NULL;
+        if ( merge != NULL )
+        {
+                /* The label's own source, unless overridden. */
+                src = job->input ? g_strdup (job->input) : gl_merge_get_src (merge);
+        }
+
+        /* Resumable jobs need files that are finished one after the other. */
+        if ( job->checkpoint != NULL )
+        {
+                if ( (fd >= 0) || !gl_print_export_can_checkpoint (&settings, label) )
+                {
+                        g_set_error (error, G_IO_ERROR, G_IO_ERROR_INVALID_ARGUMENT,
+                                     _("checkpoints need chunked PDF, PostScript or TIFF files, or one SVG, PNG or PBM file per sheet"));
+                        ret = FALSE;
+                }
+
+                checkpointer.filename = job->checkpoint;
+                checkpointer.job_id   = get_job_id (job, src);
+
+                if ( ret && job->resume_flag )
+                {
+                        resume_flag = gl_batch_checkpoint_read (job->checkpoint, checkpointer.job_id,
+                                                                &resume, &local_error);
+                        if ( g_error_matches (local_error, G_FILE_ERROR, G_FILE_ERROR_NOENT) )
+                        {
+                                /* Nothing to resume, start from the beginning. */
+                                g_clear_error (&local_error);
+                        }
+                        else if ( local_error )
+                        {
+                                g_propagate_error (error, local_error);
+                                ret = FALSE;
+                        }
+                }
+        }
+
+        if ( ret && (merge != NULL) )
+        {
+                if ( (job->input != NULL) || (job->record_first > 0) || (job->n_shards > 1) ||
+                     (job->checkpoint != NULL) )
+                {
+                        ret = merge_part (job, label, merge, src,
+                                          resume_flag ? &resume : NULL,
+                                          &settings, error);
+                        gl_label_set_merge (label, merge, FALSE);
+                }
+        }
+        else if ( ret )
+        {
+                if (job->input != NULL) {
+                        fprintf ( stderr,
+                                  _("cannot perform document merge with glabels file %s\n"),
+                                  job->filename );
+                }
+
+                /* Simple labels: split the requested sheets. */
+                shard_sheets (job, settings.n_sheets,
+                              gl_print_export_get_chunk_sheets (&settings, label),
+                              &settings.sheet_first, &settings.sheet_last);
+                if ( resume_flag )
+                {
+                        settings.sheet_first = MAX (settings.sheet_first, resume.sheet);
+                }
+        }
+
+        if ( ret )
+        {
+                gl_print_export_settings_count_sheets (&settings, label);
+
+                if ( job->checkpoint != NULL )
+                {
+                        template = gl_label_get_template (label);
+                        frame    = (lglTemplateFrame *)template->frames->data;
+
+                        checkpointer.merge             = merge;
+                        checkpointer.contiguous_flag   = job->collate_flag || (job->n_copies == 1);
+                        checkpointer.n_labels_per_page = lgl_template_frame_get_n_labels (frame);
+                        checkpointer.first             = job->first;
+                        checkpointer.n_copies          = job->n_copies;
+                        checkpointer.n_records         = merge ? gl_merge_get_record_count (merge) : 0;
+                        checkpointer.chunk_sheets      = gl_print_export_get_chunk_sheets (&settings, label);
+                        gl_batch_checkpoint_init (&checkpointer.checkpoint);
+
+                        settings.checkpoint_func = checkpoint_cb;
+                        settings.checkpoint_data = &checkpointer;
+                }
+
+                if ( fd >= 0 )
+                {
+                        ret = export_to_fd (label, fd, &settings, error);
+                }
+                else
+                {
+                        ret = gl_print_export (label, job->output, &settings, error);
+                }
+
+                if ( job->checkpoint != NULL )
+                {
+                        if ( ret )
+                        {
+                                /* Done, nothing left to resume. */
+                                g_unlink (job->checkpoint);
+                        }
+                        else
+                        {
+                                checkpoint_flush (&checkpointer, TRUE);
+                        }
+                }
+        }
+
+        g_free (checkpointer.job_id);
+        g_free (src);
+        if ( merge )
+        {
+                g_object_unref (merge);
+        }
+        g_object_unref (label);
+
+        gl_debug (DEBUG_PRINT, "END");
+
+        return ret;
+}
+
+
+/*---------------------------------------------------------------------------*/
+/* PRIVATE.  Parse boolean parameter value.                                  */
+/*---------------------------------------------------------------------------*/
+static gboolean
+parse_flag (const gchar *value)
+{
+        return ( (g_ascii_strcasecmp (value, "1") == 0)    ||
+                 (g_ascii_strcasecmp (value, "true") == 0) ||
+                 (g_ascii_strcasecmp (value, "yes") == 0) );
+}
+
+
+/*---------------------------------------------------------------------------*/
+/* PRIVATE.  Parse "A-B" range, from 1.  B may be left out, meaning the end  */
+/* (last = 0).  An empty value or "0" means no range.                        */
+/*---------------------------------------------------------------------------*/
+static gboolean
+parse_range (const gchar *value,
+             gint        *first,
+             gint        *last)
+{
+        gchar *end;
+        gint64 a, b = 0;
+
+        if ( (*value == '\0') || (strcmp (value, "0") == 0) )
+        {
+                *first = 0;
+                *last  = 0;
+                return TRUE;
+        }
+
+        a = g_ascii_strtoll (value, &end, 10);
+        if ( (end == value) || (*end != '-') || (a < 1) || (a > G_MAXINT) )
+        {
+                return FALSE;
+        }
+
+        value = end + 1;
+        if ( *value != '\0' )
+        {
+                b = g_ascii_strtoll (value, &end, 10);
+                if ( (end == value) || (*end != '\0') || (b < a) || (b > G_MAXINT) )
+                {
+                        return FALSE;
+                }
+        }
+
+        *first = a;
+        *last  = b;
+
+        return TRUE;
+}
+
+
+/*---------------------------------------------------------------------------*/
+/* PRIVATE.  Parse "I/N" shard, 1 <= I <= N.  An empty value means no shard. */
+/*---------------------------------------------------------------------------*/
+static gboolean
+parse_shard (const gchar *value,
+             gint        *shard,
+             gint        *n_shards)
+{
+        gchar *end;
+        gint64 i, n;
+
+        if ( *value == '\0' )
+        {
+                *shard    = 0;
+                *n_shards = 0;
+                return TRUE;
+        }
+
+        i = g_ascii_strtoll (value, &end, 10);
+        if ( (end == value) || (*end != '/') )
+        {
+                return FALSE;
+        }
+
+        value = end + 1;
+        n = g_ascii_strtoll (value, &end, 10);
+        if ( (end == value) || (*end != '\0') || (i < 1) || (i > n) || (n > G_MAXINT) )
+        {
+                return FALSE;
+        }
+
+        *shard    = i;
+        *n_shards = n;
+
+        return TRUE;
+}
+
+
+/*---------------------------------------------------------------------------*/
+/* PRIVATE.  Parse count of at least 1, e.g. copies or first label.          */
+/*---------------------------------------------------------------------------*/
+static gboolean
+parse_count (const gchar *value,
+             gint        *count)
+{
+        gchar  *end;
+        gint64  n;
+
+        n = g_ascii_strtoll (value, &end, 10);
+        if ( (end == value) || (*end != '\0') || (n < 1) || (n > G_MAXINT) )
+        {
+                return FALSE;
+        }
+
+        *count = n;
+
+        return TRUE;
+}
+
+
+/*---------------------------------------------------------------------------*/
+/* PRIVATE.  Load the records of src that the requested part of the job      */
+/* needs, and set up settings so that their labels land on the same sheets   */
+/* and positions as in the whole job.  Records before the part are skipped   */
+/* without being built, and with an index of src when sharding.  Resumable   */
+/* jobs always index src, and when resuming leave out sheets before the      */
+/* checkpoint and enter src at the checkpoint's index entry.                 */
+/*---------------------------------------------------------------------------*/
+static gboolean
+merge_part (const glBatchJob        *job,
+            glLabel                 *label,
+            glMerge                 *merge,
+            const gchar             *src,
+            const glBatchCheckpoint *resume,
+            glPrintExportSettings   *settings,
+            GError                 **error)
+{
+        const lglTemplate      *template;
+        const lglTemplateFrame *frame;
+        gboolean                contiguous_flag;
+        gint                    n_labels_per_page;
+        gint                    n_records, n_sheets, n_before;
+        gint                    sheet_first, sheet_last, n_skipped;
+        gint64                  i_label_first, i_label_last;
+        gint                    i_record_first, i_record_last;
+        gint                    n_records_part;
+
+        /* A record's copies only follow each other if collated. */
+        contiguous_flag = settings->collate_flag || (settings->n_copies == 1);
+
+        if ( (job->record_first > 0) && (job->n_shards > 1) )
+        {
+                g_set_error (error, G_IO_ERROR, G_IO_ERROR_INVALID_ARGUMENT,
+                             _("cannot combine a record range with shards"));
+                return FALSE;
+        }
+
+        i_record_first = 0;
+        n_records_part = -1;
+        sheet_first    = 0;
+        sheet_last     = G_MAXINT;
+
+        if ( job->record_first > 0 )
+        {
+                if ( !contiguous_flag )
+                {
+                        g_set_error (error, G_IO_ERROR, G_IO_ERROR_INVALID_ARGUMENT,
+                                     _("a record range with several copies needs collated copies"));
+                        return FALSE;
+                }
+
+                i_record_first = job->record_first - 1;
+                if ( job->record_last > 0 )
+                {
+                        n_records_part = job->record_last - job->record_first + 1;
+                }
+        }
+        else if ( job->n_shards > 1 )
+        {
+                n_records = gl_merge_index_src (merge, src);
+
+                if ( settings->format == GL_PRINT_EXPORT_FORMAT_ZPL )
+                {
+                        /* No sheets on a roll, split records instead. */
+                        i_record_first = (gint64)(job->shard - 1) * n_records / job->n_shards;
+                        i_record_last  = (gint64)job->shard * n_records / job->n_shards;
+
+                        gl_merge_set_src_range (merge, src, i_record_first, i_record_last - i_record_first);
+                        return TRUE;
+                }
+
+                template = gl_label_get_template (label);
+                frame    = (lglTemplateFrame *)template->frames->data;
+                n_labels_per_page = lgl_template_frame_get_n_labels (frame);
+
+                n_before = settings->first - 1;
+                n_sheets = ((gint64)n_before + (gint64)settings->n_copies * n_records + n_labels_per_page - 1)
+                        / n_labels_per_page;
+                shard_sheets (job, n_sheets,
+                              gl_print_export_get_chunk_sheets (settings, label),
+                              &sheet_first, &sheet_last);
+
+                if ( contiguous_flag )
+                {
+                        /* Merged labels of the shard's sheets, and the records they show. */
+                        i_label_first = MAX ((gint64)sheet_first * n_labels_per_page - n_before, 0);
+                        i_label_last  = MIN ((gint64)sheet_last * n_labels_per_page - n_before,
+                                             (gint64)settings->n_copies * n_records);
+
+                        i_record_first = i_label_first / settings->n_copies;
+                        i_record_last  = (i_label_last + settings->n_copies - 1) / settings->n_copies;
+                        n_records_part = MAX (i_record_last - i_record_first, 0);
+                }
+        }
+        else if ( job->checkpoint == NULL )
+        {
+                gl_merge_set_src (merge, src);
+                return TRUE;
+        }
+
+        if ( resume != NULL )
+        {
+                sheet_first = MAX (sheet_first, resume->sheet);
+        }
+
+        if ( !contiguous_flag )
+        {
+                /* Uncollated copies go through all records on every pass. */
+                gl_merge_set_src (merge, src);
+                settings->sheet_first = sheet_first;
+                settings->sheet_last  = sheet_last;
+                return TRUE;
+        }
+
+        if ( (resume != NULL) && (resume->record > i_record_first) )
+        {
+                /* Go straight to the checkpoint's record, by way of its index entry. */
+                gl_merge_set_index_position (merge, src, resume->index_record, resume->index_position);
+                if ( n_records_part >= 0 )
+                {
+                        n_records_part = MAX (n_records_part - (resume->record - i_record_first), 0);
+                }
+                i_record_first = resume->record;
+        }
+
+        gl_merge_set_src_range (merge, src, i_record_first, n_records_part);
+        n_skipped = gl_print_export_settings_skip_records (settings, label,
+                                                           gl_merge_get_record_offset (merge));
+
+        settings->sheet_offset = n_skipped;
+        settings->sheet_first  = MAX (sheet_first - n_skipped, 0);
+        settings->sheet_last   = (sheet_last == G_MAXINT) ? G_MAXINT : sheet_last - n_skipped;
+
+        return TRUE;
+}
+
+
+/*---------------------------------------------------------------------------*/
+/* PRIVATE.  Sheets of this job's shard, all n_sheets if not sharded.  With  */
+/* chunked output, shards are split between whole chunks, so that no two     */
+/* shards write the same chunk file.                                         */
+/*---------------------------------------------------------------------------*/
+static void
+shard_sheets (const glBatchJob *job,
+              gint              n_sheets,
+              gint              chunk_sheets,
+              gint             *sheet_first,
+              gint             *sheet_last)
+{
+        gint n_units;
+
+        if ( job->n_shards <= 1 )
+        {
+                *sheet_first = 0;
+                *sheet_last  = n_sheets;
+                return;
+        }
+
+        if ( chunk_sheets < 1 )
+        {
+                chunk_sheets = 1;
+        }
+        n_units = ((gint64)n_sheets + chunk_sheets - 1) / chunk_sheets;
+
+        *sheet_first = MIN ((gint64)(job->shard - 1) * n_units / job->n_shards * chunk_sheets,
+                            n_sheets);
+        *sheet_last  = MIN ((gint64)job->shard * n_units / job->n_shards * chunk_sheets,
+                            n_sheets);
+}
+
+
+/*---------------------------------------------------------------------------*/
+/* PRIVATE.  Identify job by a digest of its parameters and of the size and  */
+/* modification time of its merge source src, so that a checkpoint is never  */
+/* resumed by a job that would print something else, nor seek to a saved    */
+/* position of a source that has been edited since.                          */
+/*---------------------------------------------------------------------------*/
+static gchar *
+get_job_id (const glBatchJob *job,
+            const gchar      *src)
+{
+        glBatchJob  id_job;
+        GString    *string;
+        gchar      *params;
+        GStatBuf    buf;
+        gchar      *id;
+
+        /* Resuming and threads do not change the output. */
+        id_job             = *job;
+        id_job.resume_flag = FALSE;
+        id_job.n_threads   = 0;
+
+        params = gl_batch_job_serialize (&id_job);
+        string = g_string_new (params);
+        g_free (params);
+
+        if ( (src != NULL) && (g_stat (src, &buf) == 0) )
+        {
+                g_string_append_printf (string, "source=%s %" G_GINT64_FORMAT " %" G_GINT64_FORMAT "\n",
+                                        src, (gint64)buf.st_size, (gint64)buf.st_mtime);
+        }
+
+        id = g_compute_checksum_for_string (G_CHECKSUM_SHA1, string->str, -1);
+        g_string_free (string, TRUE);
+
+        return id;
+}
+
+
+/*---------------------------------------------------------------------------*/
+/* PRIVATE.  Sheets before next_sheet are finished: work out which record    */
+/* and copy come next, and write the checkpoint now and then.                */
+/*---------------------------------------------------------------------------*/
+static void
+checkpoint_cb (gint     next_sheet,
+               gpointer data)
+{
+        Checkpointer      *checkpointer = data;
+        glBatchCheckpoint *checkpoint   = &checkpointer->checkpoint;
+        gint64             i_label;
+
+        checkpoint->sheet = next_sheet;
+
+        if ( checkpointer->merge != NULL )
+        {
+                /* First merged label on next_sheet. */
+                i_label = MAX ((gint64)next_sheet * checkpointer->n_labels_per_page
+                               - (checkpointer->first - 1), 0);
+
+                if ( checkpointer->contiguous_flag )
+                {
+                        checkpoint->record = i_label / checkpointer->n_copies;
+                        checkpoint->copy   = i_label % checkpointer->n_copies;
+                }
+                else if ( checkpointer->n_records > 0 )
+                {
+                        checkpoint->record = i_label % checkpointer->n_records;
+                        checkpoint->copy   = i_label / checkpointer->n_records;
+                }
+
+                checkpoint->index_position =
+                        gl_merge_get_index_position (checkpointer->merge, checkpoint->record,
+                                                     &checkpoint->index_record);
+                if ( checkpoint->index_position < 0 )
+                {
+                        checkpoint->index_record = -1;
+                }
+        }
+
+        if ( checkpointer->chunk_sheets > 0 )
+        {
+                checkpoint->chunk = next_sheet / checkpointer->chunk_sheets;
+        }
+
+        checkpointer->dirty_flag = TRUE;
+        checkpoint_flush (checkpointer, FALSE);
+}
+
+
+/*---------------------------------------------------------------------------*/
+/* PRIVATE.  Write latest checkpoint, unless one was written only recently.  */
+/*---------------------------------------------------------------------------*/
+static void
+checkpoint_flush (Checkpointer *checkpointer,
+                  gboolean      force_flag)
+{
+        gint64  now;
+        GError *error = NULL;
+
+        if ( !checkpointer->dirty_flag )
+        {
+                return;
+        }
+
+        now = g_get_monotonic_time ();
+        if ( !force_flag && (checkpointer->last_write > 0) &&
+             (now - checkpointer->last_write < CHECKPOINT_INTERVAL) )
+        {
+                return;
+        }
+
+        if ( !gl_batch_checkpoint_write (checkpointer->filename, checkpointer->job_id,
+                                         &checkpointer->checkpoint, &error) )
+        {
+                g_warning ("%s", error->message);
+                g_error_free (error);
+                return;
+        }
+
+        checkpointer->dirty_flag = FALSE;
+        checkpointer->last_write = now;
+}
+
+
+/*---------------------------------------------------------------------------*/
+/* PRIVATE.  Export to an open file descriptor, e.g. stdout or a pipe.  The  */
+/* stream is flushed after every sheet, so that a reader can consume pages   */
+/* while later ones are still being rendered.  fd itself is left open.       */
+/*---------------------------------------------------------------------------*/
+static gboolean
+export_to_fd (glLabel                *label,
+              gint                    fd,
+              glPrintExportSettings  *settings,
+              GError                **error)
+{
+        Stream    stream;
+        gint      stream_fd;
+        gint      errsv;
+        gboolean  ret;
+
+        stream_fd = dup (fd);
+        if ( (stream_fd < 0) || ((stream.fp = fdopen (stream_fd, "wb")) == NULL) )
+        {
+                errsv = errno;
+                if ( stream_fd >= 0 )
+                {
+                        close (stream_fd);
+                }
+                g_set_error (error, G_IO_ERROR, g_io_error_from_errno (errsv),
+                             _("cannot write to file descriptor %d: %s"),
+                             fd, g_strerror (errsv));
+                return FALSE;
+        }
+
+        stream.progress_func = settings->progress_func;
+        stream.progress_data = settings->progress_data;
+
+        settings->progress_func = stream_progress;
+        settings->progress_data = &stream;
+
+        ret = gl_print_export_to_stream (label, stream_write, &stream, settings, error);
+
+        if ( (fclose (stream.fp) != 0) && ret )
+        {
+                errsv = errno;
+                g_set_error (error, G_IO_ERROR, g_io_error_from_errno (errsv),
+                             _("cannot write to file descriptor %d: %s"),
+                             fd, g_strerror (errsv));
+                ret = FALSE;
+        }
+
+        return ret;
+}
+
+
+/*---------------------------------------------------------------------------*/
+/* PRIVATE.  Cairo write function for stream.                                */
+/*---------------------------------------------------------------------------*/
+static cairo_status_t
+stream_write (void                *closure,
+              const unsigned char *data,
+              unsigned int         length)
+{
+        Stream *stream = closure;
+
+        if ( fwrite (data, 1, length, stream->fp) != length )
+        {
+                return CAIRO_STATUS_WRITE_ERROR;
+        }
+
+        return CAIRO_STATUS_SUCCESS;
+}
+
+
+/*---------------------------------------------------------------------------*/
+/* PRIVATE.  Sheet done: push it downstream, then report progress.           */
+/*---------------------------------------------------------------------------*/
+static void
+stream_progress (gint      sheet,
+                 gint      n_sheets,
+                 gpointer  data)
+{
+        Stream *stream = data;
+
+        fflush (stream->fp);
+
+        if ( stream->progress_func )
+        {
+                stream->progress_func (sheet, n_sheets, stream->progress_data);
+        }
+}
+
+
+
+
+/*
+ * Local Variables:       -- emacs
+ * mode: C                -- emacs
+ * c-basic-offset: 8      -- emacs
+ * tab-width: 8           -- emacs
+ * indent-tabs-mode: nil  -- emacs
+ * End:                   -- emacs
+ */
@@ -0,0 +1,104 @@
+/*
+ *  batch-job.h
+ *  Copyright (C) 2026  agent <agent@local>.
+ *
+ *  This file is part of gLabels.
+ *
+ *  gLabels is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  gLabels is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with gLabels.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef __BATCH_JOB_H__
+#define __BATCH_JOB_H__
+
+#include <glib.h>
+
+#include "print-export.h"
+
+G_BEGIN_DECLS
+
+
+/*
+ * One glabels-batch job: print a label file, optionally merged with input.
+ */
+typedef struct {
+        gchar        *filename;
+        gchar        *input;
+        gchar        *output;          /* "-" = stdout, "fd:N" = descriptor N. */
+        gchar        *format;          /* NULL = from output filename. */
+
+        gint          n_copies;
+        gint          n_sheets;
+        gint          first;
+
+        gboolean      collate_flag;
+        gboolean      outline_flag;
+        gboolean      reverse_flag;
+        gboolean      crop_marks_flag;
+
+        /* Part of the job only, laid out as in the whole job, 0 means all. */
+        gint          record_first;     /* First merge record, from 1. */
+        gint          record_last;      /* Last merge record, 0 = last of source. */
+        gint          shard;            /* Shard number, from 1 ... */
+        gint          n_shards;         /* ... of this many equal runs of sheets. */
+
+        /* Raster output only, 0 means default. */
+        gdouble       resolution;
+        gboolean      per_label_flag;
+        gint          n_threads;
+        gboolean      mono_flag;
+        glMonoDither  dither;
+
+        /* Split output into numbered files, 0 means a single file. */
+        gint          chunk_sheets;
+        gint          chunk_records;
+
+        /* Resumable jobs, file output only. */
+        gchar        *checkpoint;       /* Checkpoint file, NULL = none. */
+        gboolean      resume_flag;      /* Go on from checkpoint, if there is one. */
+} glBatchJob;
+
+
+glBatchJob *gl_batch_job_new        (void);
+
+void        gl_batch_job_free       (glBatchJob                *job);
+
+gboolean    gl_batch_job_set        (glBatchJob                *job,
+                                     const gchar               *key,
+                                     const gchar               *value);
+
+gchar      *gl_batch_job_serialize  (const glBatchJob          *job);
+
+gint        gl_batch_job_output_fd  (const gchar               *output);
+
+gboolean    gl_batch_job_run        (const glBatchJob          *job,
+                                     glPrintExportProgressFunc  progress_func,
+                                     gpointer                   progress_data,
+                                     GError                   **error);
+
+
+G_END_DECLS
+
+#endif /* __BATCH_JOB_H__ */
+
+
+
+
+/*
+ * Local Variables:       -- emacs
+ * mode: C                -- emacs
+ * c-basic-offset: 8      -- emacs
+ * tab-width: 8           -- emacs
+ * indent-tabs-mode: nil  -- emacs
+ * End:                   -- emacs
+ */
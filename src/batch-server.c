@@ -0,0 +1,673 @@
+/*
+ *  batch-server.c
+ *  Copyright (C) 2026  agent <agent@local>.
+ *
+ *  This file is part of gLabels.
+ *
+ *  gLabels is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  gLabels is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with gLabels.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <config.h>
+
+#include "batch-server.h"
+
+#include <glib/gi18n.h>
+#include <glib/gstdio.h>
+#include <glib-unix.h>
+#include <gio/gio.h>
+#include <gio/gunixsocketaddress.h>
+#include <pango/pangocairo.h>
+#include <fcntl.h>
+#include <signal.h>
+#include <string.h>
+#include <sys/stat.h>
+#include <sys/types.h>
+#include <sys/wait.h>
+#include <unistd.h>
+
+#include "debug.h"
+
+
+/*===========================================*/
+/* Private macros and constants.             */
+/*===========================================*/
+
+#define LISTEN_BACKLOG            64
+
+/* Workers are recycled after this many connections, to bound their growth. */
+#define MAX_CONNECTIONS_PER_WORKER 1000
+
+/* Delay before replacing a worker that did not exit cleanly. */
+#define RESPAWN_DELAY_SECONDS     1
+
+
+/*===========================================*/
+/* Private types.                            */
+/*===========================================*/
+
+typedef struct {
+        GSocket    *socket;
+        gchar      *program;    /* Path of glabels-batch, to run workers */
+        GMainLoop  *loop;
+        GHashTable *workers;    /* Set of worker pids */
+        gboolean    quit_flag;
+} Server;
+
+
+/*===========================================*/
+/* Private function prototypes.              */
+/*===========================================*/
+
+static void        remove_stale_socket (const gchar      *socket_path);
+
+static void        warm_up             (void);
+
+static void        spawn_worker        (Server           *server);
+
+static void        worker_setup        (gpointer          user_data);
+
+static void        worker_exit_cb      (GPid              pid,
+                                        gint              status,
+                                        gpointer          user_data);
+
+static gboolean    respawn_cb          (gpointer          user_data);
+
+static gboolean    quit_cb             (gpointer          user_data);
+
+static gint        worker_main         (GSocket          *listen_socket);
+
+static void        handle_connection   (GSocket          *socket);
+
+static glBatchJob *read_job            (GDataInputStream *in,
+                                        gchar           **bad_line);
+
+static void        write_line          (GOutputStream    *out,
+                                        const gchar      *line);
+
+static void        progress_cb         (gint              sheet,
+                                        gint              n_sheets,
+                                        gpointer          user_data);
+
+
+/*****************************************************************************/
+/* Listen on socket_path and serve jobs with a pool of n_workers processes   */
+/* (one per processor if n_workers < 1) until SIGINT or SIGTERM.  Workers    */
+/* are fresh "program --worker-fd=N" processes, since forking this one once  */
+/* GLib has started threads is not safe.  Each worker loads templates and    */
+/* fonts once and keeps them warm for all of its connections.               */
+/*****************************************************************************/
+gboolean
+gl_batch_server_run (const gchar  *socket_path,
+                     const gchar  *program,
+                     gint          n_workers,
+                     GError      **error)
+{
+        Server          server;
+        GSocketAddress *address;
+        GHashTableIter  iter;
+        gpointer        pid;
+        gint            i;
+
+        gl_debug (DEBUG_PRINT, "START");
+
+        g_return_val_if_fail (socket_path, FALSE);
+        g_return_val_if_fail (program, FALSE);
+
+        if ( n_workers < 1 )
+        {
+                n_workers = g_get_num_processors ();
+        }
+
+        remove_stale_socket (socket_path);
+
+        server.socket = g_socket_new (G_SOCKET_FAMILY_UNIX,
+                                      G_SOCKET_TYPE_STREAM,
+                                      G_SOCKET_PROTOCOL_DEFAULT,
+                                      error);
+        if ( server.socket == NULL )
+        {
+                return FALSE;
+        }
+
+        address = g_unix_socket_address_new (socket_path);
+        g_socket_set_listen_backlog (server.socket, LISTEN_BACKLOG);
+        if ( !g_socket_bind (server.socket, address, FALSE, error) ||
+             !g_socket_listen (server.socket, error) )
+        {
+                g_object_unref (address);
+                g_object_unref (server.socket);
+                return FALSE;
+        }
+        g_object_unref (address);
+
+        server.program   = g_strdup (program);
+        server.loop      = g_main_loop_new (NULL, FALSE);
+        server.workers   = g_hash_table_new (g_direct_hash, g_direct_equal);
+        server.quit_flag = FALSE;
+
+        g_unix_signal_add (SIGINT,  quit_cb, &server);
+        g_unix_signal_add (SIGTERM, quit_cb, &server);
+
+        for ( i = 0; i < n_workers; i++ )
+        {
+                spawn_worker (&server);
+        }
+
+        g_message (_("Listening on %s with %d workers"), socket_path, n_workers);
+
+        g_main_loop_run (server.loop);
+
+        /* Shut down pool. */
+        g_hash_table_iter_init (&iter, server.workers);
+        while ( g_hash_table_iter_next (&iter, &pid, NULL) )
+        {
+                kill (GPOINTER_TO_INT (pid), SIGTERM);
+        }
+        g_hash_table_iter_init (&iter, server.workers);
+        while ( g_hash_table_iter_next (&iter, &pid, NULL) )
+        {
+                waitpid (GPOINTER_TO_INT (pid), NULL, 0);
+        }
+
+        g_socket_close (server.socket, NULL);
+        g_object_unref (server.socket);
+        g_unlink (socket_path);
+
+        g_hash_table_destroy (server.workers);
+        g_main_loop_unref (server.loop);
+        g_free (server.program);
+
+        gl_debug (DEBUG_PRINT, "END");
+
+        return TRUE;
+}
+
+
+/*****************************************************************************/
+/* Submit job to server on socket_path, print its progress and wait for it.  */
+/* File names in job should be absolute, the server does not share our cwd.  */
+/*****************************************************************************/
+gboolean
+gl_batch_client_submit (const gchar       *socket_path,
+                        const glBatchJob  *job,
+                        GError           **error)
+{
+        GSocketClient     *client;
+        GSocketAddress    *address;
+        GSocketConnection *connection;
+        GDataInputStream  *in;
+        GOutputStream     *out;
+        gchar             *request;
+        gchar             *line;
+        gboolean           done = FALSE;
+        gboolean           ret  = FALSE;
+        GError            *local_error = NULL;
+
+        g_return_val_if_fail (socket_path, FALSE);
+        g_return_val_if_fail (job, FALSE);
+
+        client     = g_socket_client_new ();
+        address    = g_unix_socket_address_new (socket_path);
+        connection = g_socket_client_connect (client, G_SOCKET_CONNECTABLE (address),
+                                              NULL, error);
+        g_object_unref (address);
+        g_object_unref (client);
+
+        if ( connection == NULL )
+        {
+                return FALSE;
+        }
+
+        in  = g_data_input_stream_new (g_io_stream_get_input_stream (G_IO_STREAM (connection)));
+        out = g_io_stream_get_output_stream (G_IO_STREAM (connection));
+
+        line    = gl_batch_job_serialize (job);
+        request = g_strconcat (line, "\n", NULL);
+        g_free (line);
+
+        if ( g_output_stream_write_all (out, request, strlen (request), NULL, NULL, &local_error) )
+        {
+                while ( !done &&
+                        (line = g_data_input_stream_read_line (in, NULL, NULL, &local_error)) )
+                {
+                        if ( g_str_has_prefix (line, "PROGRESS ") )
+                        {
+                                g_print ("%s\n", line);
+                        }
+                        else if ( strcmp (line, "OK") == 0 )
+                        {
+                                ret  = TRUE;
+                                done = TRUE;
+                        }
+                        else if ( g_str_has_prefix (line, "ERROR ") )
+                        {
+                                g_set_error (&local_error, G_IO_ERROR, G_IO_ERROR_FAILED,
+                                             "%s", line + strlen ("ERROR "));
+                                done = TRUE;
+                        }
+                        g_free (line);
+                }
+
+                if ( !done && (local_error == NULL) )
+                {
+                        g_set_error (&local_error, G_IO_ERROR, G_IO_ERROR_CLOSED,
+                                     _("Server closed connection"));
+                }
+        }
+        g_free (request);
+
+        if ( local_error )
+        {
+                g_propagate_error (error, local_error);
+        }
+
+        g_object_unref (in);
+        g_io_stream_close (G_IO_STREAM (connection), NULL, NULL);
+        g_object_unref (connection);
+
+        return ret;
+}
+
+
+/*****************************************************************************/
+/* Worker process started by gl_batch_server_run(): serve connections to the */
+/* listening socket inherited as listen_fd.  Returns exit status.            */
+/*****************************************************************************/
+gint
+gl_batch_server_worker (gint listen_fd)
+{
+        GSocket *socket;
+        gint     ret;
+        GError  *error = NULL;
+
+        gl_debug (DEBUG_PRINT, "START");
+
+        /* Replies to a client that went away must not kill the worker. */
+        signal (SIGPIPE, SIG_IGN);
+
+        socket = g_socket_new_from_fd (listen_fd, &error);
+        if ( socket == NULL )
+        {
+                g_warning ("Cannot use listening socket: %s", error->message);
+                g_error_free (error);
+                return 1;
+        }
+
+        warm_up ();
+
+        ret = worker_main (socket);
+
+        g_object_unref (socket);
+
+        gl_debug (DEBUG_PRINT, "END");
+
+        return ret;
+}
+
+
+/*---------------------------------------------------------------------------*/
+/* PRIVATE.  Remove socket left behind by a server that is no longer running.*/
+/*---------------------------------------------------------------------------*/
+static void
+remove_stale_socket (const gchar *socket_path)
+{
+        GStatBuf        buf;
+        GSocket        *socket;
+        GSocketAddress *address;
+        GError         *error = NULL;
+
+        if ( (g_lstat (socket_path, &buf) != 0) || !S_ISSOCK (buf.st_mode) )
+        {
+                return;
+        }
+
+        socket = g_socket_new (G_SOCKET_FAMILY_UNIX,
+                               G_SOCKET_TYPE_STREAM,
+                               G_SOCKET_PROTOCOL_DEFAULT,
+                               NULL);
+        if ( socket == NULL )
+        {
+                return;
+        }
+
+        address = g_unix_socket_address_new (socket_path);
+        if ( !g_socket_connect (socket, address, NULL, &error) )
+        {
+                if ( g_error_matches (error, G_IO_ERROR, G_IO_ERROR_CONNECTION_REFUSED) )
+                {
+                        g_unlink (socket_path);
+                }
+                g_error_free (error);
+        }
+
+        g_object_unref (address);
+        g_object_unref (socket);
+}
+
+
+/*---------------------------------------------------------------------------*/
+/* PRIVATE.  Enumerate fonts once, before the worker's first job.            */
+/*---------------------------------------------------------------------------*/
+static void
+warm_up (void)
+{
+        PangoFontFamily **families;
+        gint              n;
+
+        pango_font_map_list_families (pango_cairo_font_map_get_default (),
+                                      &families, &n);
+        g_free (families);
+}
+
+
+/*---------------------------------------------------------------------------*/
+/* PRIVATE.  Start a new worker process.                                     */
+/*---------------------------------------------------------------------------*/
+static void
+spawn_worker (Server *server)
+{
+        gchar  *argv[3];
+        gint    fd;
+        GPid    pid;
+        GError *error = NULL;
+
+        fd = g_socket_get_fd (server->socket);
+
+        argv[0] = server->program;
+        argv[1] = g_strdup_printf ("--worker-fd=%d", fd);
+        argv[2] = NULL;
+
+        if ( !g_spawn_async (NULL, argv, NULL, G_SPAWN_DO_NOT_REAP_CHILD,
+                             worker_setup, GINT_TO_POINTER (fd), &pid, &error) )
+        {
+                g_warning ("Cannot start worker: %s", error->message);
+                g_error_free (error);
+                g_free (argv[1]);
+                return;
+        }
+        g_free (argv[1]);
+
+        gl_debug (DEBUG_PRINT, "worker %d started", pid);
+
+        g_hash_table_add (server->workers, GINT_TO_POINTER (pid));
+        g_child_watch_add (pid, worker_exit_cb, server);
+}
+
+
+/*---------------------------------------------------------------------------*/
+/* PRIVATE.  In the worker, between fork and exec: let it inherit the        */
+/* listening socket.  Only async-signal-safe calls are allowed here.         */
+/*---------------------------------------------------------------------------*/
+static void
+worker_setup (gpointer user_data)
+{
+        fcntl (GPOINTER_TO_INT (user_data), F_SETFD, 0);
+}
+
+
+/*---------------------------------------------------------------------------*/
+/* PRIVATE.  Worker exited, replace it.                                      */
+/*---------------------------------------------------------------------------*/
+static void
+worker_exit_cb (GPid      pid,
+                gint      status,
+                gpointer  user_data)
+{
+        Server *server = user_data;
+
+        g_spawn_close_pid (pid);
+        g_hash_table_remove (server->workers, GINT_TO_POINTER (pid));
+
+        if ( server->quit_flag )
+        {
+                return;
+        }
+
+        if ( WIFEXITED (status) && (WEXITSTATUS (status) == 0) )
+        {
+                gl_debug (DEBUG_PRINT, "worker %d recycled", pid);
+                spawn_worker (server);
+        }
+        else
+        {
+                g_warning ("Worker %d exited abnormally", pid);
+                g_timeout_add_seconds (RESPAWN_DELAY_SECONDS, respawn_cb, server);
+        }
+}
+
+
+/*---------------------------------------------------------------------------*/
+/* PRIVATE.  Delayed replacement of a failed worker.                         */
+/*---------------------------------------------------------------------------*/
+static gboolean
+respawn_cb (gpointer user_data)
+{
+        Server *server = user_data;
+
+        if ( !server->quit_flag )
+        {
+                spawn_worker (server);
+        }
+
+        return G_SOURCE_REMOVE;
+}
+
+
+/*---------------------------------------------------------------------------*/
+/* PRIVATE.  SIGINT or SIGTERM received.                                     */
+/*---------------------------------------------------------------------------*/
+static gboolean
+quit_cb (gpointer user_data)
+{
+        Server *server = user_data;
+
+        server->quit_flag = TRUE;
+        g_main_loop_quit (server->loop);
+
+        return G_SOURCE_CONTINUE;
+}
+
+
+/*---------------------------------------------------------------------------*/
+/* PRIVATE.  Worker process: accept and serve connections one at a time.     */
+/*---------------------------------------------------------------------------*/
+static gint
+worker_main (GSocket *listen_socket)
+{
+        GSocket *socket;
+        GError  *error = NULL;
+        gint     i;
+
+        for ( i = 0; i < MAX_CONNECTIONS_PER_WORKER; i++ )
+        {
+                socket = g_socket_accept (listen_socket, NULL, &error);
+                if ( socket == NULL )
+                {
+                        g_warning ("Cannot accept connection: %s", error->message);
+                        g_error_free (error);
+                        return 1;
+                }
+
+                handle_connection (socket);
+                g_object_unref (socket);
+        }
+
+        return 0;
+}
+
+
+/*---------------------------------------------------------------------------*/
+/* PRIVATE.  Run each job sent on connection and report its status.          */
+/*---------------------------------------------------------------------------*/
+static void
+handle_connection (GSocket *socket)
+{
+        GSocketConnection *connection;
+        GDataInputStream  *in;
+        GOutputStream     *out;
+        glBatchJob        *job;
+        gchar             *bad_line;
+        gchar             *reply;
+        GError            *error;
+
+        connection = g_socket_connection_factory_create_connection (socket);
+        in  = g_data_input_stream_new (g_io_stream_get_input_stream (G_IO_STREAM (connection)));
+        out = g_io_stream_get_output_stream (G_IO_STREAM (connection));
+
+        for (;;)
+        {
+                bad_line = NULL;
+                job      = read_job (in, &bad_line);
+                if ( job == NULL )
+                {
+                        break;
+                }
+
+                error = NULL;
+                if ( bad_line )
+                {
+                        g_set_error (&error, G_IO_ERROR, G_IO_ERROR_INVALID_ARGUMENT,
+                                     _("Unknown job parameter \"%s\""), bad_line);
+                        g_free (bad_line);
+                }
+                else if ( gl_batch_job_output_fd (job->output) >= 0 )
+                {
+                        /* Would go to the server's own descriptors. */
+                        g_set_error (&error, G_IO_ERROR, G_IO_ERROR_INVALID_ARGUMENT,
+                                     _("Cannot stream output from a render server"));
+                }
+                else
+                {
+                        gl_batch_job_run (job, progress_cb, out, &error);
+                }
+
+                if ( error )
+                {
+                        reply = g_strdup_printf ("ERROR %s\n",
+                                                 g_strdelimit (error->message, "\r\n", ' '));
+                        g_error_free (error);
+                }
+                else
+                {
+                        reply = g_strdup ("OK\n");
+                }
+                write_line (out, reply);
+                g_free (reply);
+
+                gl_batch_job_free (job);
+        }
+
+        g_object_unref (in);
+        g_io_stream_close (G_IO_STREAM (connection), NULL, NULL);
+        g_object_unref (connection);
+}
+
+
+/*---------------------------------------------------------------------------*/
+/* PRIVATE.  Read "key=value" lines up to an empty line.  Returns NULL at    */
+/* end of stream or if the job is not terminated.                            */
+/*---------------------------------------------------------------------------*/
+static glBatchJob *
+read_job (GDataInputStream  *in,
+          gchar            **bad_line)
+{
+        glBatchJob *job = NULL;
+        gchar      *line;
+        gchar      *value;
+        gsize       length;
+
+        while ( (line = g_data_input_stream_read_line (in, &length, NULL, NULL)) )
+        {
+                if ( (length > 0) && (line[length-1] == '\r') )
+                {
+                        line[--length] = '\0';
+                }
+
+                if ( length == 0 )
+                {
+                        g_free (line);
+                        if ( job )
+                        {
+                                return job;
+                        }
+                        continue;
+                }
+
+                if ( job == NULL )
+                {
+                        job = gl_batch_job_new ();
+                }
+
+                value = strchr (line, '=');
+                if ( value )
+                {
+                        *value++ = '\0';
+                }
+                if ( !value || !gl_batch_job_set (job, line, value) )
+                {
+                        if ( *bad_line == NULL )
+                        {
+                                *bad_line = g_strdup (line);
+                        }
+                }
+
+                g_free (line);
+        }
+
+        gl_batch_job_free (job);
+        g_free (*bad_line);
+        *bad_line = NULL;
+
+        return NULL;
+}
+
+
+/*---------------------------------------------------------------------------*/
+/* PRIVATE.  Send reply line, a client that went away is not our problem.    */
+/*---------------------------------------------------------------------------*/
+static void
+write_line (GOutputStream *out,
+            const gchar   *line)
+{
+        g_output_stream_write_all (out, line, strlen (line), NULL, NULL, NULL);
+}
+
+
+/*---------------------------------------------------------------------------*/
+/* PRIVATE.  Report progress of running job.                                 */
+/*---------------------------------------------------------------------------*/
+static void
+progress_cb (gint      sheet,
+             gint      n_sheets,
+             gpointer  user_data)
+{
+        GOutputStream *out = user_data;
+        gchar         *line;
+
+        line = g_strdup_printf ("PROGRESS %d/%d\n", sheet, n_sheets);
+        write_line (out, line);
+        g_free (line);
+}
+
+
+
+
+/*
+ * Local Variables:       -- emacs
+ * mode: C                -- emacs
+ * c-basic-offset: 8      -- emacs
+ * tab-width: 8           -- emacs
+ * indent-tabs-mode: nil  -- emacs
+ * End:                   -- emacs
+ */
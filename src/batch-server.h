@@ -0,0 +1,66 @@
+/*
+ *  batch-server.h
+ *  Copyright (C) 2026  agent <agent@local>.
+ *
+ *  This file is part of gLabels.
+ *
+ *  gLabels is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  gLabels is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with gLabels.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef __BATCH_SERVER_H__
+#define __BATCH_SERVER_H__
+
+#include <glib.h>
+
+#include "batch-job.h"
+
+G_BEGIN_DECLS
+
+
+/*
+ * Render server on a local (Unix domain) socket.
+ *
+ * A client sends a job as "key=value" lines (see gl_batch_job_set())
+ * terminated by an empty line.  The server answers with zero or more
+ * "PROGRESS sheet/n_sheets" lines followed by either "OK" or
+ * "ERROR message".  Several jobs may be sent on one connection.
+ */
+
+gboolean  gl_batch_server_run     (const gchar       *socket_path,
+                                   const gchar       *program,
+                                   gint               n_workers,
+                                   GError           **error);
+
+gint      gl_batch_server_worker  (gint               listen_fd);
+
+gboolean  gl_batch_client_submit  (const gchar       *socket_path,
+                                   const glBatchJob  *job,
+                                   GError           **error);
+
+
+G_END_DECLS
+
+#endif /* __BATCH_SERVER_H__ */
+
+
+
+
+/*
+ * Local Variables:       -- emacs
+ * mode: C                -- emacs
+ * c-basic-offset: 8      -- emacs
+ * tab-width: 8           -- emacs
+ * indent-tabs-mode: nil  -- emacs
+ * End:                   -- emacs
+ */
@@ -122,6 +122,24 @@ static const Style styles[] = {
         { "built-in", "Code39Ext", N_("Code 39 Extended"), gl_barcode_builtin_new,
           TRUE, TRUE, TRUE, TRUE, "1234567890", TRUE, 10},
 
+        { "built-in", "Code128", N_("Code 128"), gl_barcode_builtin_new,
+          TRUE, TRUE, TRUE, FALSE, "1234567890", TRUE, 10},
+
+        { "built-in", "GS1-128", N_("GS1-128"), gl_barcode_builtin_new,
+          TRUE, TRUE, TRUE, FALSE, "[01]12345678901231", FALSE, 18},
+
+        { "built-in", "EAN-13", N_("EAN-13"), gl_barcode_builtin_new,
+          TRUE, TRUE, TRUE, FALSE, "000000000000", FALSE, 12},
+
+        { "built-in", "EAN-8", N_("EAN-8"), gl_barcode_builtin_new,
+          TRUE, TRUE, TRUE, FALSE, "0000000", FALSE, 7},
+
+        { "built-in", "UPC-A", N_("UPC-A"), gl_barcode_builtin_new,
+          TRUE, TRUE, TRUE, FALSE, "00000000000", FALSE, 11},
+
+        { "built-in", "UPC-E", N_("UPC-E"), gl_barcode_builtin_new,
+          TRUE, TRUE, TRUE, FALSE, "000000", FALSE, 6},
+
 #ifdef HAVE_LIBBARCODE
 
         { "gnu-barcode", "EAN", N_("EAN (any)"), gl_barcode_gnubarcode_new,
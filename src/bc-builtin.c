@@ -88,6 +88,30 @@ gl_barcode_builtin_new (const gchar    *id,
         {
                 return lgl_barcode_create (LGL_BARCODE_TYPE_CODE39_EXT, text_flag, checksum_flag, w, h, digits);
         }
+        if ( (g_ascii_strcasecmp (id, "Code128") == 0) )
+        {
+                return lgl_barcode_create (LGL_BARCODE_TYPE_CODE128, text_flag, checksum_flag, w, h, digits);
+        }
+        if ( (g_ascii_strcasecmp (id, "GS1-128") == 0) )
+        {
+                return lgl_barcode_create (LGL_BARCODE_TYPE_GS1_128, text_flag, checksum_flag, w, h, digits);
+        }
+        if ( (g_ascii_strcasecmp (id, "EAN-13") == 0) )
+        {
+                return lgl_barcode_create (LGL_BARCODE_TYPE_EAN_13, text_flag, checksum_flag, w, h, digits);
+        }
+        if ( (g_ascii_strcasecmp (id, "EAN-8") == 0) )
+        {
+                return lgl_barcode_create (LGL_BARCODE_TYPE_EAN_8, text_flag, checksum_flag, w, h, digits);
+        }
+        if ( (g_ascii_strcasecmp (id, "UPC-A") == 0) )
+        {
+                return lgl_barcode_create (LGL_BARCODE_TYPE_UPC_A, text_flag, checksum_flag, w, h, digits);
+        }
+        if ( (g_ascii_strcasecmp (id, "UPC-E") == 0) )
+        {
+                return lgl_barcode_create (LGL_BARCODE_TYPE_UPC_E, text_flag, checksum_flag, w, h, digits);
+        }
 
         g_message ("Invalid builtin barcode ID: \"%s\"\n", id);
         return NULL;
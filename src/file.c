@@ -37,6 +37,17 @@
 #include "debug.h"
 
 
+/*===========================================*/
+/* Private types                             */
+/*===========================================*/
+
+typedef struct {
+	gchar    *filename;      /* As given by user, for messages. */
+	gchar    *abs_filename;
+	glWindow *window;        /* Weak pointer. */
+} OpenData;
+
+
 /*===========================================*/
 /* Private globals                           */
 /*===========================================*/
@@ -68,6 +79,14 @@ static void save_as_response                 (GtkDialog         *chooser,
 					      gint               response,
 					      glLabel           *label);
 
+static void open_error_dialog                (glWindow          *window,
+					      const gchar       *filename,
+					      const gchar       *reason);
+
+static void open_done_cb                     (GObject           *source_object,
+					      GAsyncResult      *result,
+					      gpointer           user_data);
+
 
 /*****************************************************************************/
 /* "New" menu callback.                                                      */
@@ -411,65 +430,125 @@ gl_file_open_recent (const gchar     *filename,
 
 
 /*---------------------------------------------------------------------------*/
-/* PRIVATE.  Open a file.                                                    */
+/* PRIVATE.  Open a file.  The file is read in the background, the label     */
+/* shows up once parsed and its embedded images follow as they are decoded.  */
+/* Returns FALSE if the file cannot be opened at all.                        */
 /*---------------------------------------------------------------------------*/
 gboolean
 gl_file_open_real (const gchar     *filename,
 		   glWindow        *window)
 {
-	gchar            *abs_filename;
-	glLabel          *label;
-	glXMLLabelStatus  status;
-	GtkWidget        *new_window;
+	OpenData *data;
 
 	gl_debug (DEBUG_FILE, "START");
 
-	abs_filename = gl_file_util_make_absolute (filename);
-	label = gl_xml_label_open (abs_filename, &status);
-	if (!label) {
-		GtkWidget *dialog;
+	data = g_new0 (OpenData, 1);
+	data->filename     = g_strdup (filename);
+	data->abs_filename = gl_file_util_make_absolute (filename);
 
-		gl_debug (DEBUG_FILE, "couldn't open file");
+	if ( !g_file_test (data->abs_filename, G_FILE_TEST_IS_REGULAR) ) {
 
-		dialog = gtk_message_dialog_new (GTK_WINDOW (window),
-					      GTK_DIALOG_DESTROY_WITH_PARENT,
-					      GTK_MESSAGE_ERROR,
-					      GTK_BUTTONS_CLOSE,
-					      _("Could not open file \"%s\""),
-					      filename);
-		gtk_message_dialog_format_secondary_text (GTK_MESSAGE_DIALOG (dialog),
-							  _("Not a supported file format"));
+		gl_debug (DEBUG_FILE, "couldn't open file");
 
-		gtk_dialog_run (GTK_DIALOG (dialog));
-		gtk_widget_destroy (dialog);
+		open_error_dialog (window, filename, _("File does not exist"));
 
-		g_free (abs_filename);
+		g_free (data->filename);
+		g_free (data->abs_filename);
+		g_free (data);
 
 		gl_debug (DEBUG_FILE, "END false");
 
 		return FALSE;
+	}
+
+	data->window = window;
+	if (window) {
+		g_object_add_weak_pointer (G_OBJECT (window), (gpointer *)&data->window);
+	}
+
+	gl_xml_label_open_async (data->abs_filename, NULL, open_done_cb, data);
+
+	gl_debug (DEBUG_FILE, "END true");
+
+	return TRUE;
+}
+
+
+/*---------------------------------------------------------------------------*/
+/* PRIVATE.  Label file read callback.                                       */
+/*---------------------------------------------------------------------------*/
+static void
+open_done_cb (GObject      *source_object,
+	      GAsyncResult *result,
+	      gpointer      user_data)
+{
+	OpenData         *data = (OpenData *)user_data;
+	glLabel          *label;
+	glXMLLabelStatus  status;
+	GtkWidget        *new_window;
+
+	gl_debug (DEBUG_FILE, "START");
+
+	if (data->window) {
+		g_object_remove_weak_pointer (G_OBJECT (data->window), (gpointer *)&data->window);
+	}
+
+	label = gl_xml_label_open_finish (result, &status);
+	if (!label) {
+
+		gl_debug (DEBUG_FILE, "couldn't open file");
+
+		open_error_dialog (data->window, data->filename,
+				   _("Not a supported file format"));
 
 	} else {
 
-		if ( gl_window_is_empty (GL_WINDOW(window)) ) {
-			gl_window_set_label (GL_WINDOW(window), label);
+		if ( data->window && gl_window_is_empty (data->window) ) {
+			gl_window_set_label (data->window, label);
 		} else {
 			new_window = gl_window_new_from_label (label);
 			gtk_widget_show_all (new_window);
 		}
 
-		gl_recent_add_utf8_filename (abs_filename);
+		gl_label_decode_images (label);
+
+		gl_recent_add_utf8_filename (data->abs_filename);
 
 		if (open_path != NULL)
 			g_free (open_path);
-		open_path = g_path_get_dirname (abs_filename);
-		g_free (abs_filename);
+		open_path = g_path_get_dirname (data->abs_filename);
 
-		gl_debug (DEBUG_FILE, "END true");
+	}
 
-		return TRUE;
+	g_free (data->filename);
+	g_free (data->abs_filename);
+	g_free (data);
 
-	}
+	gl_debug (DEBUG_FILE, "END");
+}
+
+
+/*---------------------------------------------------------------------------*/
+/* PRIVATE.  Tell user that a file could not be opened.                      */
+/*---------------------------------------------------------------------------*/
+static void
+open_error_dialog (glWindow    *window,
+		   const gchar *filename,
+		   const gchar *reason)
+{
+	GtkWidget *dialog;
+
+	dialog = gtk_message_dialog_new (GTK_WINDOW (window),
+					 GTK_DIALOG_DESTROY_WITH_PARENT,
+					 GTK_MESSAGE_ERROR,
+					 GTK_BUTTONS_CLOSE,
+					 _("Could not open file \"%s\""),
+					 filename);
+	gtk_message_dialog_format_secondary_text (GTK_MESSAGE_DIALOG (dialog),
+						  reason);
+
+	gtk_dialog_run (GTK_DIALOG (dialog));
+	gtk_widget_destroy (dialog);
 }
 
 
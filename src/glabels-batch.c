@@ -21,16 +21,14 @@
 #include <config.h>
 
 #include <glib/gi18n.h>
-
-#include <math.h>
+#include <unistd.h>
 
 #include <libglabels.h>
 #include "merge-init.h"
 #include "template-history.h"
 #include "font-history.h"
-#include "xml-label.h"
-#include "print.h"
-#include "print-op.h"
+#include "batch-job.h"
+#include "batch-server.h"
 #include "file-util.h"
 #include "prefs.h"
 #include "debug.h"
@@ -39,24 +37,45 @@
 /* Private globals                            */
 /*============================================*/
 static gchar    *output          = "output.pdf";
+static gchar    *format_name     = NULL;
 static gint     n_copies         = 1;
 static gint     n_sheets         = 1;
 static gint     first            = 1;
+static gboolean collate_flag     = FALSE;
 static gboolean outline_flag     = FALSE;
 static gboolean reverse_flag     = FALSE;
 static gboolean crop_marks_flag  = FALSE;
 static gchar    *input           = NULL;
+static gdouble  resolution       = 0;
+static gboolean per_label_flag   = FALSE;
+static gint     n_threads        = 0;
+static gboolean mono_flag        = FALSE;
+static gchar    *dither_name     = NULL;
+static gint     chunk_sheets     = 0;
+static gint     chunk_records    = 0;
+static gchar    *records         = NULL;
+static gchar    *shard           = NULL;
+static gchar    *checkpoint      = NULL;
+static gboolean resume_flag      = FALSE;
+static gchar    *server_socket   = NULL;
+static gchar    *client_socket   = NULL;
+static gint     n_jobs           = 0;
+static gint     worker_fd        = -1;
 static gchar    **remaining_args = NULL;
 
 static GOptionEntry option_entries[] = {
         {"output", 'o', 0, G_OPTION_ARG_STRING, &output,
-         N_("set output filename (default=\"output.pdf\")"), N_("filename")},
+         N_("set output filename, \"-\" for standard output or \"fd:N\" for file descriptor N (default=\"output.pdf\")"), N_("filename")},
+        {"format", 'F', 0, G_OPTION_ARG_STRING, &format_name,
+         N_("output format: pdf, ps, svg, png, tiff, pbm or zpl (default=from output filename)"), N_("format")},
         {"sheets", 's', 0, G_OPTION_ARG_INT, &n_sheets,
          N_("number of sheets (default=1)"), N_("sheets")},
         {"copies", 'c', 0, G_OPTION_ARG_INT, &n_copies,
          N_("number of copies (default=1)"), N_("copies")},
         {"first", 'f', 0, G_OPTION_ARG_INT, &first,
          N_("first label on first sheet (default=1)"), N_("first")},
+        {"collate", 0, 0, G_OPTION_ARG_NONE, &collate_flag,
+         N_("print all copies of a merge record before the next record"), NULL},
         {"outline", 'l', 0, G_OPTION_ARG_NONE, &outline_flag,
          N_("print outlines (to test printer alignment)"), NULL},
         {"reverse", 'r', 0, G_OPTION_ARG_NONE, &reverse_flag,
@@ -65,6 +84,36 @@ static GOptionEntry option_entries[] = {
          N_("print crop marks"), NULL},
         {"input", 'i', 0, G_OPTION_ARG_STRING, &input,
          N_("input file for merging"), N_("filename")},
+        {"resolution", 'd', 0, G_OPTION_ARG_DOUBLE, &resolution,
+         N_("resolution of PNG, TIFF, PBM and ZPL output in dots per inch (default=300)"), N_("dpi")},
+        {"per-label", 0, 0, G_OPTION_ARG_NONE, &per_label_flag,
+         N_("write one image per label instead of per sheet"), NULL},
+        {"threads", 't', 0, G_OPTION_ARG_INT, &n_threads,
+         N_("number of rasterizing threads (default=number of processors)"), N_("threads")},
+        {"mono", 'm', 0, G_OPTION_ARG_NONE, &mono_flag,
+         N_("write 1-bit PNG or TIFF images for direct thermal printers"), NULL},
+        {"dither", 0, 0, G_OPTION_ARG_STRING, &dither_name,
+         N_("reduce gray to 1 bit by threshold, ordered or diffusion (default=threshold)"), N_("method")},
+        {"chunk-sheets", 0, 0, G_OPTION_ARG_INT, &chunk_sheets,
+         N_("start a new numbered PDF, PostScript or TIFF file every n sheets"), N_("n")},
+        {"chunk-records", 0, 0, G_OPTION_ARG_INT, &chunk_records,
+         N_("start a new numbered output file about every n merge records"), N_("n")},
+        {"records", 0, 0, G_OPTION_ARG_STRING, &records,
+         N_("only print merge records a to b, in their places on the whole job's sheets"), N_("a-b")},
+        {"shard", 0, 0, G_OPTION_ARG_STRING, &shard,
+         N_("only print the i-th of n equal runs of sheets of the whole job"), N_("i/n")},
+        {"checkpoint", 0, 0, G_OPTION_ARG_FILENAME, &checkpoint,
+         N_("save progress to file now and then, removed once the job is done"), N_("filename")},
+        {"resume", 0, 0, G_OPTION_ARG_NONE, &resume_flag,
+         N_("go on from the checkpoint file of an interrupted job"), NULL},
+        {"server", 0, 0, G_OPTION_ARG_FILENAME, &server_socket,
+         N_("run as a render server listening on socket"), N_("socket")},
+        {"jobs", 'j', 0, G_OPTION_ARG_INT, &n_jobs,
+         N_("maximum number of concurrent server jobs (default=number of processors)"), N_("jobs")},
+        {"client", 0, 0, G_OPTION_ARG_FILENAME, &client_socket,
+         N_("send files to the render server listening on socket"), N_("socket")},
+        {"worker-fd", 0, G_OPTION_FLAG_HIDDEN, G_OPTION_ARG_INT, &worker_fd,
+         NULL, NULL},
         { G_OPTION_REMAINING, 0, 0, G_OPTION_ARG_FILENAME_ARRAY,
           &remaining_args, NULL, N_("[FILE...]") },
         { NULL }
@@ -80,15 +129,12 @@ main (int argc, char **argv)
 {
 	GOptionContext    *option_context;
         GList             *p, *file_list = NULL;
-        gchar             *abs_fn;
-        glLabel           *label = NULL;
-        glMerge           *merge = NULL;
-        const lglTemplate *template;
-        lglTemplateFrame  *frame;
-        glXMLLabelStatus   status;
-        glPrintOp         *print_op;
+        glBatchJob        *job, *part;
 	gchar	          *utf8_filename;
+        gchar             *program;
+        gint               ret = 0;
         GError            *error = NULL;
+        glMonoDither       dither = GL_MONO_DITHER_THRESHOLD;
 
         bindtextdomain (GETTEXT_PACKAGE, GLABELS_LOCALE_DIR);
 	bind_textdomain_codeset (GETTEXT_PACKAGE, "UTF-8");
@@ -100,8 +146,7 @@ main (int argc, char **argv)
 	g_option_context_add_main_entries (option_context, option_entries, GETTEXT_PACKAGE);
 
 
-        /* Initialize minimal gtk program */
-        gtk_parse_args (&argc, &argv);
+        /* No display needed, GTK is never initialized. */
         if (!g_option_context_parse (option_context, &argc, &argv, &error))
 	{
 	        g_print(_("%s\nRun '%s --help' to see a full list of available command line options.\n"),
@@ -111,6 +156,35 @@ main (int argc, char **argv)
 	}
 
 
+        if (n_copies < 1) {
+                fprintf ( stderr, _("number of copies must be at least 1\n") );
+                return 1;
+        }
+        if (first < 1) {
+                fprintf ( stderr, _("first label must be at least 1\n") );
+                return 1;
+        }
+
+        if (dither_name && !gl_mono_dither_from_string (dither_name, &dither)) {
+                fprintf ( stderr, _("unknown dither method \"%s\"\n"), dither_name );
+                return 1;
+        }
+
+        part = gl_batch_job_new ();
+        if (format_name && !gl_batch_job_set (part, "format", format_name)) {
+                fprintf ( stderr, _("unknown output format \"%s\"\n"), format_name );
+                return 1;
+        }
+        if (records && !gl_batch_job_set (part, "records", records)) {
+                fprintf ( stderr, _("invalid record range \"%s\"\n"), records );
+                return 1;
+        }
+        if (shard && !gl_batch_job_set (part, "shard", shard)) {
+                fprintf ( stderr, _("invalid shard \"%s\"\n"), shard );
+                return 1;
+        }
+
+
         /* create file list */
 	if (remaining_args != NULL) {
 		gint i, num_args;
@@ -125,72 +199,114 @@ main (int argc, char **argv)
 		remaining_args = NULL;
 	}
 
-        /* initialize components */
+        if (resume_flag && (checkpoint == NULL)) {
+                fprintf ( stderr, _("--resume needs --checkpoint\n") );
+                return 1;
+        }
+        if (checkpoint && (g_list_length (file_list) > 1)) {
+                fprintf ( stderr, _("--checkpoint needs a single glabels file\n") );
+                return 1;
+        }
+
+        /* initialize components, the server only supervises its workers */
         gl_debug_init ();
-        gl_merge_init ();
-        lgl_db_init ();
-        gl_prefs_init_null ();
-	gl_template_history_init_null ();
-	gl_font_history_init_null ();
+        if ((client_socket == NULL) && (server_socket == NULL)) {
+                gl_merge_init ();
+                lgl_db_init ();
+                gl_prefs_init_null ();
+                gl_template_history_init_null ();
+                gl_font_history_init_null ();
+        }
+
+        /* server worker, everything above stays warm across jobs */
+        if (worker_fd >= 0) {
+                g_list_free_full (file_list, g_free);
+                gl_batch_job_free (part);
+                return gl_batch_server_worker (worker_fd);
+        }
+
+        /* server mode, workers are started as new copies of this program */
+        if (server_socket != NULL) {
+                program = g_find_program_in_path (argv[0]);
+                if (program == NULL) {
+                        fprintf ( stderr, _("cannot find %s to start server workers\n"), argv[0] );
+                        ret = 1;
+                } else if (!gl_batch_server_run (server_socket, program, n_jobs, &error)) {
+                        fprintf ( stderr, "%s\n", error->message );
+                        g_error_free (error);
+                        ret = 1;
+                }
+                g_free (program);
+                g_list_free_full (file_list, g_free);
+                gl_batch_job_free (part);
+                return ret;
+        }
 
         /* now print the files */
         for (p = file_list; p; p = p->next) {
-                g_print ("LABEL FILE = %s\n", (gchar *) p->data);
-                label = gl_xml_label_open (p->data, &status);
-
-
-                if ( status == XML_LABEL_OK ) {
-
-                        merge = gl_label_get_merge (label);
-                        if (input != NULL) {
-                                if (merge != NULL) {
-                                        gl_merge_set_src(merge, input);
-                                        gl_label_set_merge(label, merge, FALSE);
-                                } else {
-                                        fprintf ( stderr,
-                                                  _("cannot perform document merge with glabels file %s\n"),
-                                                  (char *)p->data );
-                                }
-                        }
-                        abs_fn = gl_file_util_make_absolute ( output );
-                        template = gl_label_get_template (label);
-                        frame = (lglTemplateFrame *)template->frames->data;
-
-                        print_op = gl_print_op_new (label);
-                        gl_print_op_set_filename        (print_op, abs_fn);
-                        gl_print_op_set_n_copies        (print_op, n_copies);
-                        gl_print_op_set_first           (print_op, first);
-                        gl_print_op_set_outline_flag    (print_op, outline_flag);
-                        gl_print_op_set_reverse_flag    (print_op, reverse_flag);
-                        gl_print_op_set_crop_marks_flag (print_op, crop_marks_flag);
-                        if (merge)
-                        {
-                                gl_print_op_set_n_sheets (print_op,
-                                                          ceil ((double)(first-1 + n_copies * gl_merge_get_record_count(merge))
-                                                                / lgl_template_frame_get_n_labels (frame)));
-                        }
-                        else
-                        {
-                                gl_print_op_set_n_sheets (print_op, n_sheets);
-                                gl_print_op_set_last     (print_op,
-                                                          lgl_template_frame_get_n_labels (frame));
-                        }
-                        gtk_print_operation_run (GTK_PRINT_OPERATION (print_op),
-                                                 GTK_PRINT_OPERATION_ACTION_EXPORT,
-                                                 NULL,
-                                                 NULL);
-
-                        g_object_unref (label);
+                if (gl_batch_job_output_fd (output) == STDOUT_FILENO) {
+                        /* Keep standard output for the output itself. */
+                        g_printerr ("LABEL FILE = %s\n", (gchar *) p->data);
+                } else {
+                        g_print ("LABEL FILE = %s\n", (gchar *) p->data);
+                }
+
+                job = gl_batch_job_new ();
+                job->filename        = gl_file_util_make_absolute (p->data);
+                if (input && g_file_test (input, G_FILE_TEST_EXISTS)) {
+                        job->input   = gl_file_util_make_absolute (input);
+                } else {
+                        job->input   = g_strdup (input);
+                }
+                g_free (job->output);
+                if (gl_batch_job_output_fd (output) >= 0) {
+                        job->output  = g_strdup (output);
+                } else {
+                        job->output  = gl_file_util_make_absolute (output);
                 }
-                else {
-                        fprintf ( stderr, _("cannot open glabels file %s\n"),
-                                  (char *)p->data );
+                job->format          = g_strdup (part->format);
+                job->n_copies        = n_copies;
+                job->n_sheets        = n_sheets;
+                job->first           = first;
+                job->collate_flag    = collate_flag;
+                job->outline_flag    = outline_flag;
+                job->reverse_flag    = reverse_flag;
+                job->crop_marks_flag = crop_marks_flag;
+                job->resolution      = resolution;
+                job->per_label_flag  = per_label_flag;
+                job->n_threads       = n_threads;
+                job->mono_flag       = mono_flag;
+                job->dither          = dither;
+                job->chunk_sheets    = chunk_sheets;
+                job->chunk_records   = chunk_records;
+                job->record_first    = part->record_first;
+                job->record_last     = part->record_last;
+                job->shard           = part->shard;
+                job->n_shards        = part->n_shards;
+                if (checkpoint) {
+                        job->checkpoint  = gl_file_util_make_absolute (checkpoint);
+                }
+                job->resume_flag     = resume_flag;
+
+                if (client_socket != NULL) {
+                        gl_batch_client_submit (client_socket, job, &error);
+                } else {
+                        gl_batch_job_run (job, NULL, NULL, &error);
                 }
+
+                if (error) {
+                        fprintf ( stderr, "%s\n", error->message );
+                        g_clear_error (&error);
+                        ret = 1;
+                }
+
+                gl_batch_job_free (job);
         }
 
-        g_list_free (file_list);
+        g_list_free_full (file_list, g_free);
+        gl_batch_job_free (part);
 
-        return 0;
+        return ret;
 }
 
 
@@ -0,0 +1,544 @@
+/*
+ *  glabels-render.c
+ *  Copyright (C) 2026  agent <agent@local>.
+ *
+ *  This file is part of gLabels.
+ *
+ *  gLabels is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  gLabels is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with gLabels.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <config.h>
+
+#include "glabels-render.h"
+
+#include <glib/gi18n.h>
+#include <gio/gio.h>
+
+#include <libglabels.h>
+#include "label.h"
+#include "merge.h"
+#include "merge-init.h"
+#include "xml-label.h"
+#include "print-export.h"
+#include "prefs.h"
+#include "template-history.h"
+#include "font-history.h"
+
+#include "debug.h"
+
+
+/*===========================================*/
+/* Private macros and constants.             */
+/*===========================================*/
+
+/* Backend used for records bound to a label that has no merge of its own. */
+#define DEFAULT_MERGE_BACKEND "Text/Comma/Line1Keys"
+
+
+/*===========================================*/
+/* Private types.                            */
+/*===========================================*/
+
+struct _glRenderLabel {
+        glLabel  *label;
+
+        glMerge  *merge;        /* Bound records, NULL if none bound yet */
+        GList    *new_records;  /* Not yet handed to merge, newest first */
+        gboolean  dirty_flag;   /* merge differs from label's merge */
+};
+
+
+/*===========================================*/
+/* Private function prototypes.              */
+/*===========================================*/
+
+static glRenderLabel *render_label_new   (glLabel                *label,
+                                          glXMLLabelStatus        status,
+                                          const gchar            *name,
+                                          GError                **error);
+
+static glMerge       *get_merge          (glRenderLabel          *label);
+
+static void           sync_records       (glRenderLabel          *label);
+
+static void           get_settings       (glRenderLabel          *label,
+                                          const glRenderOptions  *options,
+                                          glPrintExportSettings  *settings);
+
+static void           free_record        (glMergeRecord          *record);
+
+
+/*****************************************************************************/
+/* Initialize library: templates, merge backends.  Safe to call repeatedly.  */
+/*****************************************************************************/
+void
+gl_render_init (void)
+{
+        static gsize initialized = 0;
+
+        if ( g_once_init_enter (&initialized) )
+        {
+                gl_debug_init ();
+                gl_merge_init ();
+                lgl_db_init ();
+                gl_prefs_init_null ();
+                gl_template_history_init_null ();
+                gl_font_history_init_null ();
+
+                g_once_init_leave (&initialized, 1);
+        }
+}
+
+
+/*****************************************************************************/
+/* Default render options: one PDF sheet, one copy, starting at label 1.     */
+/*****************************************************************************/
+void
+gl_render_options_init (glRenderOptions *options)
+{
+        g_return_if_fail (options);
+
+        options->format          = GL_RENDER_FORMAT_PDF;
+        options->n_sheets        = 1;
+        options->n_copies        = 1;
+        options->first           = 1;
+        options->collate_flag    = FALSE;
+        options->outline_flag    = FALSE;
+        options->reverse_flag    = FALSE;
+        options->crop_marks_flag = FALSE;
+        options->resolution      = 300.0;
+        options->per_label_flag  = FALSE;
+        options->n_threads       = 0;
+        options->mono_flag       = FALSE;
+        options->dither          = GL_RENDER_DITHER_THRESHOLD;
+}
+
+
+/*****************************************************************************/
+/* Open label from file.                                                     */
+/*****************************************************************************/
+glRenderLabel *
+gl_render_label_open_file (const gchar  *filename,
+                           GError      **error)
+{
+        glLabel          *label;
+        glXMLLabelStatus  status;
+
+        g_return_val_if_fail (filename, NULL);
+
+        label = gl_xml_label_open (filename, &status);
+
+        return render_label_new (label, status, filename, error);
+}
+
+
+/*****************************************************************************/
+/* Open label from an in-memory document.                                    */
+/*****************************************************************************/
+glRenderLabel *
+gl_render_label_open_buffer (const gchar  *buffer,
+                             GError      **error)
+{
+        glLabel          *label;
+        glXMLLabelStatus  status;
+
+        g_return_val_if_fail (buffer, NULL);
+
+        label = gl_xml_label_open_buffer (buffer, &status);
+
+        return render_label_new (label, status, NULL, error);
+}
+
+
+/*****************************************************************************/
+/* Free label.                                                               */
+/*****************************************************************************/
+void
+gl_render_label_free (glRenderLabel *label)
+{
+        if ( label )
+        {
+                g_object_unref (label->label);
+                if ( label->merge )
+                {
+                        g_object_unref (label->merge);
+                }
+                g_list_free_full (label->new_records, (GDestroyNotify)free_record);
+                g_free (label);
+        }
+}
+
+
+/*****************************************************************************/
+/* Get page size in points.                                                  */
+/*****************************************************************************/
+void
+gl_render_label_get_page_size (glRenderLabel *label,
+                               gdouble       *width,
+                               gdouble       *height)
+{
+        const lglTemplate *template;
+
+        g_return_if_fail (label);
+
+        template = gl_label_get_template (label->label);
+
+        if ( width )
+        {
+                *width = template->page_width;
+        }
+        if ( height )
+        {
+                *height = template->page_height;
+        }
+}
+
+
+/*****************************************************************************/
+/* Get number of labels per sheet.                                           */
+/*****************************************************************************/
+gint
+gl_render_label_get_n_labels (glRenderLabel *label)
+{
+        const lglTemplate      *template;
+        const lglTemplateFrame *frame;
+
+        g_return_val_if_fail (label, 0);
+
+        template = gl_label_get_template (label->label);
+        frame    = (lglTemplateFrame *)template->frames->data;
+
+        return lgl_template_frame_get_n_labels (frame);
+}
+
+
+/*****************************************************************************/
+/* Drop all merge records, including those read from the label's own merge  */
+/* source.                                                                   */
+/*****************************************************************************/
+void
+gl_render_label_clear_records (glRenderLabel *label)
+{
+        g_return_if_fail (label);
+
+        g_list_free_full (label->new_records, (GDestroyNotify)free_record);
+        label->new_records = NULL;
+
+        gl_merge_set_src (get_merge (label), NULL);
+        label->dirty_flag = TRUE;
+}
+
+
+/*****************************************************************************/
+/* Add a merge record.  keys is NULL terminated, values has one entry per    */
+/* key.  The first record bound replaces the label's own merge source.       */
+/*****************************************************************************/
+void
+gl_render_label_add_record (glRenderLabel       *label,
+                            const gchar * const *keys,
+                            const gchar * const *values)
+{
+        glMergeRecord *record;
+        glMergeField  *field;
+        gint           i;
+
+        g_return_if_fail (label);
+        g_return_if_fail (keys && values);
+
+        get_merge (label);
+
+        record = g_new0 (glMergeRecord, 1);
+        record->select_flag = TRUE;
+
+        for ( i = 0; keys[i] != NULL; i++ )
+        {
+                field = g_new0 (glMergeField, 1);
+                field->key   = g_strdup (keys[i]);
+                field->value = g_strdup (values[i]);
+
+                record->field_list = g_list_prepend (record->field_list, field);
+        }
+        record->field_list = g_list_reverse (record->field_list);
+
+        label->new_records = g_list_prepend (label->new_records, record);
+        label->dirty_flag  = TRUE;
+}
+
+
+/*****************************************************************************/
+/* Get number of sheets rendered with options.                               */
+/*****************************************************************************/
+gint
+gl_render_label_get_n_sheets (glRenderLabel         *label,
+                              const glRenderOptions *options)
+{
+        glPrintExportSettings settings;
+
+        g_return_val_if_fail (label, 0);
+        g_return_val_if_fail (options, 0);
+
+        sync_records (label);
+        get_settings (label, options, &settings);
+
+        return settings.n_sheets;
+}
+
+
+/*****************************************************************************/
+/* Draw one sheet onto a caller supplied cairo context, in points.  Sheets   */
+/* may be drawn in any order.                                                */
+/*****************************************************************************/
+void
+gl_render_label_draw_sheet (glRenderLabel         *label,
+                            cairo_t               *cr,
+                            gint                   sheet,
+                            const glRenderOptions *options)
+{
+        glPrintExportSettings settings;
+
+        g_return_if_fail (label);
+        g_return_if_fail (cr);
+        g_return_if_fail (options);
+
+        sync_records (label);
+        get_settings (label, options, &settings);
+
+        gl_print_export_draw_sheet (label->label, cr, sheet, &settings);
+}
+
+
+/*****************************************************************************/
+/* Render all sheets to a cairo write function.  SVG, PNG and PBM images     */
+/* follow one another on the stream, each complete.  TIFF is one multi-page  */
+/* file.                                                                     */
+/*****************************************************************************/
+gboolean
+gl_render_label_render (glRenderLabel          *label,
+                        cairo_write_func_t      write_func,
+                        void                   *closure,
+                        const glRenderOptions  *options,
+                        GError                **error)
+{
+        glPrintExportSettings settings;
+
+        g_return_val_if_fail (label, FALSE);
+        g_return_val_if_fail (write_func, FALSE);
+        g_return_val_if_fail (options, FALSE);
+
+        sync_records (label);
+        get_settings (label, options, &settings);
+
+        return gl_print_export_to_stream (label->label, write_func, closure,
+                                          &settings, error);
+}
+
+
+/*****************************************************************************/
+/* Render all sheets to file, see gl_print_export().                         */
+/*****************************************************************************/
+gboolean
+gl_render_label_render_to_file (glRenderLabel          *label,
+                                const gchar            *filename,
+                                const glRenderOptions  *options,
+                                GError                **error)
+{
+        glPrintExportSettings settings;
+
+        g_return_val_if_fail (label, FALSE);
+        g_return_val_if_fail (filename, FALSE);
+        g_return_val_if_fail (options, FALSE);
+
+        sync_records (label);
+        get_settings (label, options, &settings);
+
+        return gl_print_export (label->label, filename, &settings, error);
+}
+
+
+/*---------------------------------------------------------------------------*/
+/* PRIVATE.  Wrap freshly opened label.                                      */
+/*---------------------------------------------------------------------------*/
+static glRenderLabel *
+render_label_new (glLabel           *label,
+                  glXMLLabelStatus   status,
+                  const gchar       *name,
+                  GError           **error)
+{
+        glRenderLabel *render_label;
+
+        if ( status != XML_LABEL_OK )
+        {
+                if ( label )
+                {
+                        g_object_unref (label);
+                }
+
+                if ( name )
+                {
+                        g_set_error (error, G_IO_ERROR, G_IO_ERROR_INVALID_DATA,
+                                     _("Cannot open glabels file \"%s\""), name);
+                }
+                else
+                {
+                        g_set_error (error, G_IO_ERROR, G_IO_ERROR_INVALID_DATA,
+                                     _("Cannot parse glabels document"));
+                }
+                return NULL;
+        }
+
+        render_label = g_new0 (glRenderLabel, 1);
+        render_label->label = label;
+
+        return render_label;
+}
+
+
+/*---------------------------------------------------------------------------*/
+/* PRIVATE.  Get merge holding bound records, creating it on first use.      */
+/*---------------------------------------------------------------------------*/
+static glMerge *
+get_merge (glRenderLabel *label)
+{
+        if ( label->merge == NULL )
+        {
+                label->merge = gl_label_get_merge (label->label);
+                if ( label->merge == NULL )
+                {
+                        label->merge = gl_merge_new (DEFAULT_MERGE_BACKEND);
+                }
+
+                /* Bound records replace those of the label's own source. */
+                gl_merge_set_src (label->merge, NULL);
+                label->dirty_flag = TRUE;
+        }
+
+        return label->merge;
+}
+
+
+/*---------------------------------------------------------------------------*/
+/* PRIVATE.  Install records bound since last render into label.             */
+/*---------------------------------------------------------------------------*/
+static void
+sync_records (glRenderLabel *label)
+{
+        if ( !label->dirty_flag )
+        {
+                return;
+        }
+
+        gl_merge_append_records (label->merge, g_list_reverse (label->new_records));
+        label->new_records = NULL;
+
+        gl_label_set_merge (label->label, label->merge, FALSE);
+        label->dirty_flag = FALSE;
+}
+
+
+/*---------------------------------------------------------------------------*/
+/* PRIVATE.  Translate public options into export settings.                  */
+/*---------------------------------------------------------------------------*/
+static void
+get_settings (glRenderLabel          *label,
+              const glRenderOptions  *options,
+              glPrintExportSettings  *settings)
+{
+        gl_print_export_settings_init (settings, label->label);
+
+        switch (options->format)
+        {
+        case GL_RENDER_FORMAT_PS:
+                settings->format = GL_PRINT_EXPORT_FORMAT_PS;
+                break;
+        case GL_RENDER_FORMAT_SVG:
+                settings->format = GL_PRINT_EXPORT_FORMAT_SVG;
+                break;
+        case GL_RENDER_FORMAT_PNG:
+                settings->format = GL_PRINT_EXPORT_FORMAT_PNG;
+                break;
+        case GL_RENDER_FORMAT_TIFF:
+                settings->format = GL_PRINT_EXPORT_FORMAT_TIFF;
+                break;
+        case GL_RENDER_FORMAT_PBM:
+                settings->format = GL_PRINT_EXPORT_FORMAT_PBM;
+                break;
+        case GL_RENDER_FORMAT_ZPL:
+                settings->format = GL_PRINT_EXPORT_FORMAT_ZPL;
+                break;
+        default:
+                settings->format = GL_PRINT_EXPORT_FORMAT_PDF;
+                break;
+        }
+
+        settings->n_sheets        = options->n_sheets;
+        settings->n_copies        = options->n_copies;
+        settings->first           = options->first;
+        settings->collate_flag    = options->collate_flag;
+        settings->outline_flag    = options->outline_flag;
+        settings->reverse_flag    = options->reverse_flag;
+        settings->crop_marks_flag = options->crop_marks_flag;
+        settings->resolution      = options->resolution;
+        settings->per_label_flag  = options->per_label_flag;
+        settings->n_threads       = options->n_threads;
+        settings->mono_flag       = options->mono_flag;
+
+        switch (options->dither)
+        {
+        case GL_RENDER_DITHER_ORDERED:
+                settings->dither = GL_MONO_DITHER_ORDERED;
+                break;
+        case GL_RENDER_DITHER_DIFFUSION:
+                settings->dither = GL_MONO_DITHER_DIFFUSION;
+                break;
+        default:
+                settings->dither = GL_MONO_DITHER_THRESHOLD;
+                break;
+        }
+
+        gl_print_export_settings_count_sheets (settings, label->label);
+}
+
+
+/*---------------------------------------------------------------------------*/
+/* PRIVATE.  Free a record built by gl_render_label_add_record().            */
+/*---------------------------------------------------------------------------*/
+static void
+free_record (glMergeRecord *record)
+{
+        GList        *p;
+        glMergeField *field;
+
+        for ( p = record->field_list; p != NULL; p = p->next )
+        {
+                field = (glMergeField *)p->data;
+
+                g_free (field->key);
+                g_free (field->value);
+                g_free (field);
+        }
+        g_list_free (record->field_list);
+        g_free (record);
+}
+
+
+
+
+/*
+ * Local Variables:       -- emacs
+ * mode: C                -- emacs
+ * c-basic-offset: 8      -- emacs
+ * tab-width: 8           -- emacs
+ * indent-tabs-mode: nil  -- emacs
+ * End:                   -- emacs
+ */
@@ -0,0 +1,145 @@
+/*
+ *  glabels-render.h
+ *  Copyright (C) 2026  agent <agent@local>.
+ *
+ *  This file is part of gLabels.
+ *
+ *  gLabels is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  gLabels is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with gLabels.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef __GLABELS_RENDER_H__
+#define __GLABELS_RENDER_H__
+
+#include <glib.h>
+#include <cairo.h>
+
+G_BEGIN_DECLS
+
+
+/*
+ * Public API of libglabels-render: open gLabels documents, bind merge
+ * records from memory and render them in-process.  Only the functions
+ * declared here are part of the stable interface.
+ *
+ * gl_render_init() must be called once before anything else.  A
+ * glRenderLabel must only be used from one thread at a time.
+ */
+
+typedef struct _glRenderLabel glRenderLabel;
+
+
+typedef enum {
+        GL_RENDER_FORMAT_PDF,
+        GL_RENDER_FORMAT_PS,
+        GL_RENDER_FORMAT_SVG,
+        GL_RENDER_FORMAT_PNG,
+        GL_RENDER_FORMAT_TIFF,
+        GL_RENDER_FORMAT_PBM,
+        GL_RENDER_FORMAT_ZPL
+} glRenderFormat;
+
+
+/*
+ * Reduction of gray to 1 bit for mono output.
+ */
+typedef enum {
+        GL_RENDER_DITHER_THRESHOLD,
+        GL_RENDER_DITHER_ORDERED,
+        GL_RENDER_DITHER_DIFFUSION
+} glRenderDither;
+
+
+typedef struct {
+        glRenderFormat  format;
+
+        gint            n_sheets;       /* Ignored if records are merged. */
+        gint            n_copies;
+        gint            first;
+
+        gboolean        collate_flag;
+        gboolean        outline_flag;
+        gboolean        reverse_flag;
+        gboolean        crop_marks_flag;
+
+        /* PNG, TIFF and PBM only, resolution and dither also ZPL. */
+        gdouble         resolution;     /* Pixels per inch. */
+        gboolean        per_label_flag; /* One image per label, not per sheet. */
+        gint            n_threads;      /* 0 = one per processor. */
+        gboolean        mono_flag;      /* 1 bit per pixel, always set for PBM. */
+        glRenderDither  dither;
+} glRenderOptions;
+
+
+void            gl_render_init                 (void);
+
+void            gl_render_options_init         (glRenderOptions        *options);
+
+
+glRenderLabel  *gl_render_label_open_file      (const gchar            *filename,
+                                                GError                **error);
+
+glRenderLabel  *gl_render_label_open_buffer    (const gchar            *buffer,
+                                                GError                **error);
+
+void            gl_render_label_free           (glRenderLabel          *label);
+
+void            gl_render_label_get_page_size  (glRenderLabel          *label,
+                                                gdouble                *width,
+                                                gdouble                *height);
+
+gint            gl_render_label_get_n_labels   (glRenderLabel          *label);
+
+
+void            gl_render_label_clear_records  (glRenderLabel          *label);
+
+void            gl_render_label_add_record     (glRenderLabel          *label,
+                                                const gchar * const    *keys,
+                                                const gchar * const    *values);
+
+
+gint            gl_render_label_get_n_sheets   (glRenderLabel          *label,
+                                                const glRenderOptions  *options);
+
+void            gl_render_label_draw_sheet     (glRenderLabel          *label,
+                                                cairo_t                *cr,
+                                                gint                    sheet,
+                                                const glRenderOptions  *options);
+
+gboolean        gl_render_label_render         (glRenderLabel          *label,
+                                                cairo_write_func_t      write_func,
+                                                void                   *closure,
+                                                const glRenderOptions  *options,
+                                                GError                **error);
+
+gboolean        gl_render_label_render_to_file (glRenderLabel          *label,
+                                                const gchar            *filename,
+                                                const glRenderOptions  *options,
+                                                GError                **error);
+
+
+G_END_DECLS
+
+#endif /* __GLABELS_RENDER_H__ */
+
+
+
+
+/*
+ * Local Variables:       -- emacs
+ * mode: C                -- emacs
+ * c-basic-offset: 8      -- emacs
+ * tab-width: 8           -- emacs
+ * indent-tabs-mode: nil  -- emacs
+ * End:                   -- emacs
+ */
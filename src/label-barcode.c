@@ -109,6 +109,9 @@ static void     draw_handles                (glLabelObject       *object,
 static void     create_alt_msg_path         (cairo_t             *cr,
                                              gchar               *text);
 
+static void     render_barcode              (const lglBarcode    *gbc,
+                                             cairo_t             *cr);
+
 
 /*****************************************************************************/
 /* Boilerplate object stuff.                                                 */
@@ -529,7 +532,7 @@ draw_object (glLabelObject *object,
 
                 if ( gbc != NULL )
                 {
-                        lgl_barcode_render_to_cairo (gbc, cr);
+                        render_barcode (gbc, cr);
                         lgl_barcode_free (gbc);
                 }
 
@@ -544,7 +547,7 @@ draw_object (glLabelObject *object,
                 }
                 else
                 {
-                        lgl_barcode_render_to_cairo (lbc->priv->display_gbc, cr);
+                        render_barcode (lbc->priv->display_gbc, cr);
                 }
 
         }
@@ -661,6 +664,25 @@ draw_handles (glLabelObject     *object,
 }
 
 
+/*****************************************************************************/
+/* Render barcode.  Without antialiasing (1-bit printer rasters) bars are    */
+/* snapped to whole device pixels, so their widths stay exact.               */
+/*****************************************************************************/
+static void
+render_barcode (const lglBarcode *gbc,
+                cairo_t          *cr)
+{
+        if ( cairo_get_antialias (cr) == CAIRO_ANTIALIAS_NONE )
+        {
+                lgl_barcode_render_to_cairo_snapped (gbc, cr);
+        }
+        else
+        {
+                lgl_barcode_render_to_cairo (gbc, cr);
+        }
+}
+
+
 /*****************************************************************************/
 /* Create a cairo path with apropos message.                                 */
 /*****************************************************************************/
@@ -54,7 +54,7 @@ struct _glLabelImagePrivate {
 
         FileType          type;
 
-        GdkPixbuf        *pixbuf;
+        GdkPixbuf        *pixbuf;       /* NULL while still being decoded. */
         RsvgHandle       *svg_handle;
 };
 
@@ -95,6 +95,20 @@ static gboolean object_at                (glLabelObject     *object,
                                           gdouble            x_pixels,
                                           gdouble            y_pixels);
 
+static GdkPixbuf *get_cached_pixbuf      (glLabelImage      *this,
+                                          gboolean           decode_flag);
+
+static void get_image_size               (glLabelImage      *this,
+                                          gdouble           *image_w,
+                                          gdouble           *image_h);
+
+static gboolean is_pending               (glLabelImage      *this,
+                                          glMergeRecord     *record);
+
+static void draw_placeholder             (cairo_t           *cr,
+                                          gdouble            w,
+                                          gdouble            h);
+
 
 /*****************************************************************************/
 /* Boilerplate object stuff.                                                 */
@@ -218,6 +232,8 @@ copy (glLabelObject *dst_object,
         glLabelImage     *new_limage = (glLabelImage *)dst_object;
         glTextNode       *filename;
         GdkPixbuf        *pixbuf;
+        const gchar      *encoded;
+        glPixbufCacheFormat format;
         gchar            *contents;
         glLabel          *src_label, *dst_label;
         GHashTable       *cache;
@@ -239,10 +255,18 @@ copy (glLabelObject *dst_object,
                 {
 
                 case FILE_TYPE_PIXBUF:
-                        pixbuf = src_limage->priv->pixbuf;
+                        pixbuf = get_cached_pixbuf (src_limage, FALSE);
                         if ( pixbuf != NULL ) {
                                 cache = gl_label_get_pixbuf_cache (dst_label);
                                 gl_pixbuf_cache_add_pixbuf (cache, filename->data, pixbuf);
+                        } else {
+                                /* Not decoded yet, copy it still encoded. */
+                                cache = gl_label_get_pixbuf_cache (src_label);
+                                encoded = gl_pixbuf_cache_get_encoded (cache, filename->data, &format);
+                                if ( encoded != NULL ) {
+                                        cache = gl_label_get_pixbuf_cache (dst_label);
+                                        gl_pixbuf_cache_add_encoded (cache, filename->data, encoded, format);
+                                }
                         }
                         break;
 
@@ -308,7 +332,6 @@ gl_label_image_set_filename (glLabelImage *this,
         GHashTable        *svg_cache;
         GdkPixbuf         *pixbuf;
         RsvgHandle        *svg_handle;
-        RsvgDimensionData  svg_dim;
         gdouble            image_w, image_h, aspect_ratio, w, h;
 
         gl_debug (DEBUG_LABEL, "START");
@@ -381,6 +404,13 @@ gl_label_image_set_filename (glLabelImage *this,
                         }
 
                 }
+                else if ( gl_pixbuf_cache_ref_encoded (pixbuf_cache, filename->data) )
+                {
+                        /* Embedded image not decoded yet, pick it up later. */
+                        this->priv->type       = FILE_TYPE_PIXBUF;
+                        this->priv->pixbuf     = NULL;
+                        this->priv->svg_handle = NULL;
+                }
                 else
                 {
 
@@ -411,26 +441,7 @@ gl_label_image_set_filename (glLabelImage *this,
 
         /* Treat current size as a bounding box, scale image to maintain aspect
          * ratio while fitting it in this bounding box. */
-        switch (this->priv->type)
-        {
-
-        case FILE_TYPE_PIXBUF:
-                image_w = gdk_pixbuf_get_width (this->priv->pixbuf);
-                image_h = gdk_pixbuf_get_height (this->priv->pixbuf);
-                break;
-
-        case FILE_TYPE_SVG:
-                rsvg_handle_get_dimensions (this->priv->svg_handle, &svg_dim);
-                image_w = svg_dim.width;
-                image_h = svg_dim.height;
-                break;
-
-        default:
-                image_w = gdk_pixbuf_get_width (default_pixbuf);
-                image_h = gdk_pixbuf_get_height (default_pixbuf);
-                break;
-
-        }
+        get_image_size (this, &image_w, &image_h);
         aspect_ratio = image_h / image_w;
         gl_label_object_get_size (GL_LABEL_OBJECT(this), &w, &h);
         if ( h > w*aspect_ratio ) {
@@ -531,16 +542,18 @@ GdkPixbuf *
 gl_label_image_get_pixbuf (glLabelImage  *this,
                            glMergeRecord *record)
 {
+        GdkPixbuf *pixbuf;
+
         g_return_val_if_fail (this && GL_IS_LABEL_IMAGE (this), NULL);
 
         if ((record != NULL) && this->priv->filename->field_flag)
         {
 
-                GdkPixbuf   *pixbuf = NULL;
                 gchar       *real_filename;
 
                 /* Indirect filename, re-evaluate for given record. */
 
+                pixbuf = NULL;
                 real_filename = gl_merge_eval_key (record,
 						   this->priv->filename->data);
 
@@ -553,7 +566,8 @@ gl_label_image_get_pixbuf (glLabelImage  *this,
 
         if ( this->priv->type == FILE_TYPE_PIXBUF )
         {
-                return g_object_ref (this->priv->pixbuf);
+                pixbuf = get_cached_pixbuf (this, TRUE);
+                return pixbuf ? g_object_ref (pixbuf) : NULL;
         }
         else
         {
@@ -645,35 +659,127 @@ gl_label_image_get_base_size (glLabelImage *this,
                               gdouble      *w,
                               gdouble      *h)
 {
-        RsvgDimensionData  svg_dim;
-
         g_return_if_fail (this && GL_IS_LABEL_IMAGE (this));
         g_return_if_fail (w != NULL);
         g_return_if_fail (h != NULL);
 
+        get_image_size (this, w, h);
+}
+
+
+/*---------------------------------------------------------------------------*/
+/* PRIVATE.  Get pixbuf from cache, decoding it now if decode_flag is set.   */
+/* Returns NULL while the image is still waiting to be decoded.              */
+/*---------------------------------------------------------------------------*/
+static GdkPixbuf *
+get_cached_pixbuf (glLabelImage *this,
+                   gboolean      decode_flag)
+{
+        glLabel    *label;
+        GHashTable *cache;
+
+        if ( (this->priv->pixbuf == NULL) && (this->priv->type == FILE_TYPE_PIXBUF) )
+        {
+                label = gl_label_object_get_parent (GL_LABEL_OBJECT (this));
+                cache = gl_label_get_pixbuf_cache (label);
+
+                this->priv->pixbuf = gl_pixbuf_cache_peek_pixbuf (cache,
+                                                                  this->priv->filename->data,
+                                                                  decode_flag);
+        }
+
+        return this->priv->pixbuf;
+}
+
+
+/*---------------------------------------------------------------------------*/
+/* PRIVATE.  Get natural size of image, without decoding it.                 */
+/*---------------------------------------------------------------------------*/
+static void
+get_image_size (glLabelImage *this,
+                gdouble      *image_w,
+                gdouble      *image_h)
+{
+        glLabel           *label;
+        GHashTable        *cache;
+        gint               pixbuf_w, pixbuf_h;
+        RsvgDimensionData  svg_dim;
+
         switch (this->priv->type)
         {
 
         case FILE_TYPE_PIXBUF:
-                *w = gdk_pixbuf_get_width (this->priv->pixbuf);
-                *h = gdk_pixbuf_get_height (this->priv->pixbuf);
+                label = gl_label_object_get_parent (GL_LABEL_OBJECT (this));
+                cache = gl_label_get_pixbuf_cache (label);
+                if ( (this->priv->pixbuf == NULL) &&
+                     gl_pixbuf_cache_get_size (cache, this->priv->filename->data,
+                                               &pixbuf_w, &pixbuf_h) )
+                {
+                        *image_w = pixbuf_w;
+                        *image_h = pixbuf_h;
+                        break;
+                }
+                if ( get_cached_pixbuf (this, TRUE) != NULL )
+                {
+                        *image_w = gdk_pixbuf_get_width (this->priv->pixbuf);
+                        *image_h = gdk_pixbuf_get_height (this->priv->pixbuf);
+                        break;
+                }
+                *image_w = gdk_pixbuf_get_width (default_pixbuf);
+                *image_h = gdk_pixbuf_get_height (default_pixbuf);
                 break;
 
         case FILE_TYPE_SVG:
                 rsvg_handle_get_dimensions (this->priv->svg_handle, &svg_dim);
-                *w = svg_dim.width;
-                *h = svg_dim.height;
+                *image_w = svg_dim.width;
+                *image_h = svg_dim.height;
                 break;
 
         default:
-                *w = gdk_pixbuf_get_width (default_pixbuf);
-                *h = gdk_pixbuf_get_height (default_pixbuf);
+                *image_w = gdk_pixbuf_get_width (default_pixbuf);
+                *image_h = gdk_pixbuf_get_height (default_pixbuf);
                 break;
 
         }
 }
 
 
+/*---------------------------------------------------------------------------*/
+/* PRIVATE.  Is the (non-merged) image still waiting to be decoded?          */
+/*---------------------------------------------------------------------------*/
+static gboolean
+is_pending (glLabelImage  *this,
+            glMergeRecord *record)
+{
+        if ( (record != NULL) && this->priv->filename->field_flag )
+        {
+                return FALSE;
+        }
+
+        return ( (this->priv->type == FILE_TYPE_PIXBUF) &&
+                 (get_cached_pixbuf (this, FALSE) == NULL) );
+}
+
+
+/*---------------------------------------------------------------------------*/
+/* PRIVATE.  Draw checkerboard in place of a missing image.                  */
+/*---------------------------------------------------------------------------*/
+static void
+draw_placeholder (cairo_t *cr,
+                  gdouble  w,
+                  gdouble  h)
+{
+        gdouble image_w, image_h;
+
+        cairo_rectangle (cr, 0.0, 0.0, w, h);
+        image_w = gdk_pixbuf_get_width (default_pixbuf);
+        image_h = gdk_pixbuf_get_height (default_pixbuf);
+        cairo_scale (cr, w/image_w, h/image_h);
+        gdk_cairo_set_source_pixbuf (cr, default_pixbuf, 0, 0);
+        cairo_fill (cr);
+}
+
+
 /*****************************************************************************/
 /* Draw object method.                                                       */
 /*****************************************************************************/
@@ -700,6 +806,12 @@ draw_object (glLabelObject *object,
         {
 
         case FILE_TYPE_PIXBUF:
+                if ( screen_flag && is_pending (this, record) )
+                {
+                        /* Don't block the canvas, image will be redrawn once decoded. */
+                        draw_placeholder (cr, w, h);
+                        break;
+                }
                 pixbuf = gl_label_image_get_pixbuf (this, record);
                 if ( pixbuf )
                 {
@@ -724,12 +836,7 @@ draw_object (glLabelObject *object,
                 break;
 
         default:
-                cairo_rectangle (cr, 0.0, 0.0, w, h);
-                image_w = gdk_pixbuf_get_width (default_pixbuf);
-                image_h = gdk_pixbuf_get_height (default_pixbuf);
-                cairo_scale (cr, w/image_w, h/image_h);
-                gdk_cairo_set_source_pixbuf (cr, default_pixbuf, 0, 0);
-                cairo_fill (cr);
+                draw_placeholder (cr, w, h);
                 break;
 
         }
@@ -776,6 +883,15 @@ draw_shadow (glLabelObject *object,
         {
 
         case FILE_TYPE_PIXBUF:
+                if ( screen_flag && is_pending (this, record) )
+                {
+                        shadow_color = gl_color_set_opacity (shadow_color, shadow_opacity);
+
+                        cairo_rectangle (cr, 0.0, 0.0, w, h);
+                        cairo_set_source_rgba (cr, GL_COLOR_RGBA_ARGS (shadow_color));
+                        cairo_fill (cr);
+                        break;
+                }
                 pixbuf = gl_label_image_get_pixbuf (this, record);
                 if ( pixbuf )
                 {
@@ -69,6 +69,9 @@ struct _glLabelObjectPrivate {
 	gdouble            shadow_y;
 	glColorNode       *shadow_color_node;
 	gdouble            shadow_opacity;
+
+        /* Bumped on every change, lets undo states share unchanged copies. */
+        guint              version;
 };
 
 enum {
@@ -268,6 +271,7 @@ gl_label_object_emit_changed (glLabelObject *object)
 
         g_return_if_fail (object && GL_IS_LABEL_OBJECT (object));
 
+        object->priv->version++;
         g_signal_emit (G_OBJECT(object), signals[CHANGED], 0);
 
         gl_debug (DEBUG_LABEL, "END");
@@ -372,6 +376,18 @@ gl_label_object_get_name (glLabelObject *object)
 }
 
 
+/*****************************************************************************/
+/* Get version of object.  Changes whenever the object is modified.          */
+/*****************************************************************************/
+guint
+gl_label_object_get_version (glLabelObject *object)
+{
+        g_return_val_if_fail (object && GL_IS_LABEL_OBJECT (object), 0);
+
+        return object->priv->version;
+}
+
+
 /*****************************************************************************/
 /* Set position of object.                                                   */
 /*****************************************************************************/
@@ -395,6 +411,7 @@ gl_label_object_set_position (glLabelObject *object,
 		object->priv->x = x;
 		object->priv->y = y;
 
+                object->priv->version++;
                 g_signal_emit (G_OBJECT(object), signals[MOVED], 0);
 
 	}
@@ -430,6 +447,7 @@ gl_label_object_set_position_relative (glLabelObject *object,
 			  object->priv->x,
 			  object->priv->y);
 
+                object->priv->version++;
                 g_signal_emit (G_OBJECT(object), signals[MOVED], 0);
 	}
 
@@ -1429,6 +1447,10 @@ gl_label_object_flip_horiz (glLabelObject *object)
 
         cairo_matrix_init_scale (&flip_matrix, -1.0, 1.0);
         cairo_matrix_multiply (&object->priv->matrix, &object->priv->matrix, &flip_matrix);
+        object->priv->version++;
+
+        /* Extent has changed. */
+        g_signal_emit (G_OBJECT(object), signals[MOVED], 0);
 
 	gl_debug (DEBUG_LABEL, "END");
 }
@@ -1448,6 +1470,10 @@ gl_label_object_flip_vert (glLabelObject *object)
 
         cairo_matrix_init_scale (&flip_matrix, 1.0, -1.0);
         cairo_matrix_multiply (&object->priv->matrix, &object->priv->matrix, &flip_matrix);
+        object->priv->version++;
+
+        /* Extent has changed. */
+        g_signal_emit (G_OBJECT(object), signals[MOVED], 0);
 
 	gl_debug (DEBUG_LABEL, "END");
 }
@@ -1468,6 +1494,10 @@ gl_label_object_rotate (glLabelObject *object,
 
         cairo_matrix_init_rotate (&rotate_matrix, theta_degs*(G_PI/180.));
         cairo_matrix_multiply (&object->priv->matrix, &object->priv->matrix, &rotate_matrix);
+        object->priv->version++;
+
+        /* Extent has changed. */
+        g_signal_emit (G_OBJECT(object), signals[MOVED], 0);
 
 	gl_debug (DEBUG_LABEL, "END");
 }
@@ -1485,6 +1515,10 @@ gl_label_object_set_matrix (glLabelObject  *object,
 	g_return_if_fail (object && GL_IS_LABEL_OBJECT (object));
 
         object->priv->matrix = *matrix;
+        object->priv->version++;
+
+        /* Extent has changed. */
+        g_signal_emit (G_OBJECT(object), signals[MOVED], 0);
 }
 
 
@@ -240,6 +240,8 @@ void           gl_label_object_set_name              (glLabelObject     *object,
 
 gchar         *gl_label_object_get_name              (glLabelObject     *object);
 
+guint          gl_label_object_get_version           (glLabelObject     *object);
+
 
 void           gl_label_object_set_position          (glLabelObject     *object,
                                                       gdouble            x,
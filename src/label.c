@@ -32,6 +32,7 @@
 #include "label-text.h"
 #include "label-image.h"
 #include "marshal.h"
+#include "spatial-index.h"
 
 #include "debug.h"
 
@@ -41,10 +42,27 @@
 /*========================================================*/
 
 
+/* Grid cell size of the object index, in points. */
+#define OBJECT_INDEX_CELL_SIZE  36.0
+
+/* Hit-test tolerance around object extents, in pixels. */
+#define HIT_SLOP_PIXELS         8.0
+
+
 /*========================================================*/
 /* Private types.                                         */
 /*========================================================*/
 
+typedef struct {
+        gint         ref_count;
+        lglTemplate *template;
+} TemplateSnapshot;
+
+typedef struct {
+        glLabelObject *copy;
+        guint          version;
+} ObjectSnapshot;
+
 struct _glLabelPrivate {
 
 	gchar       *filename;
@@ -58,15 +76,20 @@ struct _glLabelPrivate {
         gboolean     rotate_flag;
 
         GList       *object_list;
+        glSpatialIndex *object_index;
 
 	glMerge     *merge;
 
 	GHashTable  *pixbuf_cache;
 	GHashTable  *svg_cache;
 
-        /* Delay changed signals while operating on selections of multiple objects. */
-        gboolean     selection_op_flag;
+        /* Delay changed signals while operating on multiple objects, see
+           gl_label_begin_batch(). */
+        gint         batch_depth;
         gboolean     delayed_change_flag;
+        gboolean     delayed_selection_flag;
+        gboolean     delayed_label_flag;       /* Not only batch_objects changed. */
+        GHashTable  *batch_objects;            /* Object -> deleted flag. */
 
 	/* Default object text properties */
 	gchar             *default_font_family;
@@ -90,6 +113,10 @@ struct _glLabelPrivate {
         GQueue      *redo_stack;
         gboolean     cp_cleared_flag;
         gchar       *cp_desc;
+
+        /* Undo snapshots shared between states, see state_new() */
+        GHashTable         *snapshots;
+        TemplateSnapshot   *template_snapshot;
 };
 
 typedef struct {
@@ -101,6 +128,7 @@ typedef struct {
 enum {
 	SELECTION_CHANGED,
 	CHANGED,
+	OBJECTS_CHANGED,
 	NAME_CHANGED,
 	MODIFIED_CHANGED,
 	MERGE_CHANGED,
@@ -114,10 +142,11 @@ typedef struct {
 	gboolean     modified_flag;
         GTimeVal     time_stamp;
 
-        lglTemplate *template;
+        TemplateSnapshot *template;
         gboolean     rotate_flag;
 
         GList       *object_list;
+        GList       *selection;
 
 	glMerge     *merge;
 
@@ -147,8 +176,22 @@ static void object_moved_cb        (glLabelObject *object,
 
 static void do_modify              (glLabel       *label);
 
-static void begin_selection_op     (glLabel       *label);
-static void end_selection_op       (glLabel       *label);
+static void do_modify_object       (glLabel       *label,
+                                    glLabelObject *object,
+                                    gboolean       deleted_flag);
+
+static void emit_selection_changed (glLabel       *label);
+
+static void decode_images_cb       (GObject       *source_object,
+                                    GAsyncResult  *result,
+                                    gpointer       user_data);
+
+static void index_object           (glLabel       *label,
+                                    glLabelObject *object);
+static GHashTable *query_objects   (glLabel       *label,
+                                    cairo_t       *cr,
+                                    gdouble        x_pixels,
+                                    gdouble        y_pixels);
 
 static void clipboard_get_cb       (GtkClipboard     *clipboard,
                                     GtkSelectionData *selection_data,
@@ -179,6 +222,8 @@ static void   stack_clear          (GQueue           *stack);
 static void   stack_push_state     (GQueue           *stack,
                                     State            *state);
 static State *stack_pop_state      (GQueue           *stack);
+static void   stack_trim           (GQueue           *stack,
+                                    gint              max_copies);
 
 static State *state_new            (glLabel          *this,
                                     const gchar      *description);
@@ -186,6 +231,13 @@ static void   state_free           (State            *state);
 static void   state_restore        (State            *state,
                                     glLabel          *this);
 
+static TemplateSnapshot *template_snapshot_ref   (TemplateSnapshot *snapshot);
+static void              template_snapshot_unref (TemplateSnapshot *snapshot);
+
+static void           object_snapshot_free (ObjectSnapshot   *snapshot);
+static glLabelObject *object_snapshot      (glLabel          *this,
+                                            glLabelObject    *object);
+
 
 /*****************************************************************************/
 /* Boilerplate object stuff.                                                 */
@@ -222,6 +274,15 @@ gl_label_class_init (glLabelClass *class)
 			      gl_marshal_VOID__VOID,
 			      G_TYPE_NONE,
 			      0);
+	signals[OBJECTS_CHANGED] =
+		g_signal_new ("objects_changed",
+			      G_OBJECT_CLASS_TYPE (object_class),
+			      G_SIGNAL_RUN_LAST,
+			      G_STRUCT_OFFSET (glLabelClass, objects_changed),
+			      NULL, NULL,
+			      gl_marshal_VOID__POINTER_POINTER,
+			      G_TYPE_NONE,
+			      2, G_TYPE_POINTER, G_TYPE_POINTER);
 	signals[NAME_CHANGED] =
 		g_signal_new ("name_changed",
 			      G_OBJECT_CLASS_TYPE (object_class),
@@ -273,6 +334,7 @@ gl_label_init (glLabel *label)
 	label->priv->template      = NULL;
 	label->priv->rotate_flag   = FALSE;
         label->priv->object_list   = NULL;
+        label->priv->object_index  = gl_spatial_index_new (OBJECT_INDEX_CELL_SIZE);
 
 	label->priv->filename      = NULL;
 	label->priv->modified_flag = FALSE;
@@ -284,6 +346,11 @@ gl_label_init (glLabel *label)
 
         label->priv->undo_stack    = g_queue_new ();
         label->priv->redo_stack    = g_queue_new ();
+        label->priv->snapshots     = g_hash_table_new_full (g_direct_hash, g_direct_equal,
+                                                            NULL,
+                                                            (GDestroyNotify)object_snapshot_free);
+        label->priv->batch_objects = g_hash_table_new_full (g_direct_hash, g_direct_equal,
+                                                            g_object_unref, NULL);
 
         /*
          * Defaults from preferences
@@ -318,6 +385,7 @@ gl_label_finalize (GObject *object)
 		g_object_unref (G_OBJECT(p->data));
 	}
         g_list_free (label->priv->object_list);
+        gl_spatial_index_free (label->priv->object_index);
 
 	lgl_template_free (label->priv->template);
 	g_free (label->priv->filename);
@@ -333,6 +401,10 @@ gl_label_finalize (GObject *object)
         g_queue_free (label->priv->undo_stack);
         g_queue_free (label->priv->redo_stack);
 
+        g_hash_table_destroy (label->priv->snapshots);
+        g_hash_table_destroy (label->priv->batch_objects);
+        template_snapshot_unref (label->priv->template_snapshot);
+
 	gl_pixbuf_cache_free (label->priv->pixbuf_cache);
 	gl_svg_cache_free (label->priv->svg_cache);
 
@@ -518,7 +590,8 @@ static void
 object_changed_cb (glLabelObject *object,
                    glLabel       *label)
 {
-        do_modify (label);
+        index_object (label, object);
+        do_modify_object (label, object, FALSE);
 }
 
 
@@ -529,7 +602,8 @@ static void
 object_moved_cb (glLabelObject *object,
                  glLabel       *label)
 {
-        do_modify (label);
+        index_object (label, object);
+        do_modify_object (label, object, FALSE);
 }
 
 
@@ -539,9 +613,10 @@ object_moved_cb (glLabelObject *object,
 static void
 do_modify (glLabel  *label)
 {
-        if ( label->priv->selection_op_flag )
+        if ( label->priv->batch_depth > 0 )
         {
                 label->priv->delayed_change_flag = TRUE;
+                label->priv->delayed_label_flag  = TRUE;
         }
         else
         {
@@ -554,27 +629,126 @@ do_modify (glLabel  *label)
 
 
 /****************************************************************************/
-/* Begin selection operation.                                               */
+/* Do modify, only object has been added, changed or deleted.  Outside a    */
+/* batch, this is a batch of its own.                                       */
 /****************************************************************************/
 static void
-begin_selection_op (glLabel  *label)
+do_modify_object (glLabel       *label,
+                  glLabelObject *object,
+                  gboolean       deleted_flag)
 {
-        label->priv->selection_op_flag = TRUE;
+        gl_label_begin_batch (label);
+
+        if ( deleted_flag )
+        {
+                /* Replaces any earlier entry, and its reference. */
+                g_hash_table_replace (label->priv->batch_objects,
+                                      g_object_ref (object), GINT_TO_POINTER (TRUE));
+        }
+        else if ( !g_hash_table_contains (label->priv->batch_objects, object) )
+        {
+                g_hash_table_insert (label->priv->batch_objects,
+                                     g_object_ref (object), GINT_TO_POINTER (FALSE));
+        }
+        label->priv->delayed_change_flag = TRUE;
+
+        gl_label_end_batch (label);
 }
 
 
 /****************************************************************************/
-/* End selection operation.                                                 */
+/* Emit "selection_changed", or delay it until the end of current batch.    */
 /****************************************************************************/
 static void
-end_selection_op (glLabel  *label)
+emit_selection_changed (glLabel  *label)
 {
-        label->priv->selection_op_flag = FALSE;
+        if ( label->priv->batch_depth > 0 )
+        {
+                label->priv->delayed_selection_flag = TRUE;
+        }
+        else
+        {
+                g_signal_emit (G_OBJECT(label), signals[SELECTION_CHANGED], 0);
+        }
+}
+
+
+/*****************************************************************************/
+/* Begin batch of object mutations.                                          */
+/*                                                                           */
+/* Until the matching gl_label_end_batch(), "changed", "selection_changed"   */
+/* and modification tracking are delayed.  Batches may be nested.            */
+/*****************************************************************************/
+void
+gl_label_begin_batch (glLabel  *label)
+{
+	g_return_if_fail (label && GL_IS_LABEL (label));
+
+        label->priv->batch_depth++;
+}
+
+
+/*****************************************************************************/
+/* End batch of object mutations.                                            */
+/*                                                                           */
+/* When the outermost batch ends, a single "changed" and "selection_changed" */
+/* are emitted, as needed.  If only objects were added, changed or deleted,  */
+/* "changed" is preceded by "objects_changed" with lists of the changed      */
+/* (including added) and deleted objects, so that views need not look at    */
+/* every other object.                                                       */
+/*****************************************************************************/
+void
+gl_label_end_batch (glLabel  *label)
+{
+        GHashTableIter  iter;
+        gpointer        object, deleted_flag;
+        GList          *changed = NULL;
+        GList          *deleted = NULL;
+
+	g_return_if_fail (label && GL_IS_LABEL (label));
+	g_return_if_fail (label->priv->batch_depth > 0);
+
+        if ( --label->priv->batch_depth > 0 )
+        {
+                return;
+        }
+
         if ( label->priv->delayed_change_flag )
         {
                 label->priv->delayed_change_flag = FALSE;
+
+                if ( !label->priv->delayed_label_flag )
+                {
+                        g_hash_table_iter_init (&iter, label->priv->batch_objects);
+                        while ( g_hash_table_iter_next (&iter, &object, &deleted_flag) )
+                        {
+                                if ( GPOINTER_TO_INT (deleted_flag) )
+                                {
+                                        deleted = g_list_prepend (deleted, object);
+                                }
+                                else
+                                {
+                                        changed = g_list_prepend (changed, object);
+                                }
+                        }
+
+                        g_signal_emit (G_OBJECT(label), signals[OBJECTS_CHANGED], 0,
+                                       changed, deleted);
+
+                        g_list_free (changed);
+                        g_list_free (deleted);
+                }
+
                 do_modify (label);
         }
+        label->priv->delayed_label_flag = FALSE;
+        g_hash_table_remove_all (label->priv->batch_objects);
+
+        if ( label->priv->delayed_selection_flag )
+        {
+                label->priv->delayed_selection_flag = FALSE;
+                g_signal_emit (G_OBJECT(label), signals[SELECTION_CHANGED], 0);
+        }
 }
 
 
@@ -605,6 +779,9 @@ gl_label_set_template (glLabel           *label,
 		lgl_template_free (label->priv->template);
 		label->priv->template = lgl_template_dup (template);
 
+                template_snapshot_unref (label->priv->template_snapshot);
+                label->priv->template_snapshot = NULL;
+
                 do_modify (label);
 		g_signal_emit (G_OBJECT(label), signals[SIZE_CHANGED], 0);
 
@@ -884,6 +1061,56 @@ gl_label_get_svg_cache (glLabel       *label)
 }
 
 
+/****************************************************************************/
+/* Decode embedded images in the background.  Image objects are redrawn as */
+/* a single batch once done; this does not count as a modification.        */
+/****************************************************************************/
+void
+gl_label_decode_images (glLabel       *label)
+{
+        g_return_if_fail (label && GL_IS_LABEL (label));
+
+        gl_pixbuf_cache_decode_async (label->priv->pixbuf_cache, label, NULL,
+                                      decode_images_cb, NULL);
+}
+
+
+/*--------------------------------------------------------------------------*/
+/* PRIVATE.  Embedded images decoded callback.                              */
+/*--------------------------------------------------------------------------*/
+static void
+decode_images_cb (GObject       *source_object,
+                  GAsyncResult  *result,
+                  gpointer       user_data)
+{
+        glLabel  *label = GL_LABEL (source_object);
+        GList    *p;
+        gboolean  modified_flag;
+
+        if ( !gl_pixbuf_cache_decode_finish (label->priv->pixbuf_cache, label, result, NULL) )
+        {
+                return;
+        }
+
+        modified_flag = label->priv->modified_flag;
+
+        gl_label_begin_batch (label);
+        for ( p = label->priv->object_list; p != NULL; p = p->next )
+        {
+                if ( GL_IS_LABEL_IMAGE (p->data) )
+                {
+                        gl_label_object_emit_changed (GL_LABEL_OBJECT (p->data));
+                }
+        }
+        gl_label_end_batch (label);
+
+        if ( !modified_flag )
+        {
+                gl_label_clear_modified (label);
+        }
+}
+
+
 /*****************************************************************************/
 /* Add object to label.                                                      */
 /*****************************************************************************/
@@ -898,13 +1125,14 @@ gl_label_add_object (glLabel       *label,
 
 	gl_label_object_set_parent (object, label);
 	label->priv->object_list = g_list_append (label->priv->object_list, object);
+        index_object (label, object);
 
         g_signal_connect (G_OBJECT (object), "changed",
                           G_CALLBACK (object_changed_cb), label);
         g_signal_connect (G_OBJECT (object), "moved",
                           G_CALLBACK (object_moved_cb), label);
 
-        do_modify (label);
+        do_modify_object (label, object, FALSE);
 
 	gl_debug (DEBUG_LABEL, "END");
 }
@@ -923,14 +1151,16 @@ gl_label_delete_object (glLabel       *label,
 	g_return_if_fail (object && GL_IS_LABEL_OBJECT (object));
 
         label->priv->object_list = g_list_remove (label->priv->object_list, object);
+        gl_spatial_index_remove (label->priv->object_index, object);
+        g_hash_table_remove (label->priv->snapshots, object);
 
         g_signal_handlers_disconnect_by_func (G_OBJECT (object),
                                               G_CALLBACK (object_changed_cb), label);
         g_signal_handlers_disconnect_by_func (G_OBJECT (object),
                                               G_CALLBACK (object_moved_cb), label);
-        g_object_unref (object);
 
-        do_modify (label);
+        do_modify_object (label, object, TRUE);
+        g_object_unref (object);
 
 	gl_debug (DEBUG_LABEL, "END");
 }
@@ -961,7 +1191,7 @@ gl_label_select_object (glLabel       *label,
         gl_label_object_select (object);
 
         label->priv->cp_cleared_flag = TRUE;
-	g_signal_emit (G_OBJECT(label), signals[SELECTION_CHANGED], 0);
+	emit_selection_changed (label);
 
 	gl_debug (DEBUG_LABEL, "END");
 }
@@ -982,7 +1212,7 @@ gl_label_unselect_object (glLabel       *label,
         gl_label_object_unselect (object);
 
         label->priv->cp_cleared_flag = TRUE;
-	g_signal_emit (G_OBJECT(label), signals[SELECTION_CHANGED], 0);
+	emit_selection_changed (label);
 
 	gl_debug (DEBUG_LABEL, "END");
 }
@@ -1009,7 +1239,7 @@ gl_label_select_all (glLabel       *label)
         }
 
         label->priv->cp_cleared_flag = TRUE;
-	g_signal_emit (G_OBJECT(label), signals[SELECTION_CHANGED], 0);
+	emit_selection_changed (label);
 
 	gl_debug (DEBUG_LABEL, "END");
 }
@@ -1036,7 +1266,7 @@ gl_label_unselect_all (glLabel       *label)
         }
 
         label->priv->cp_cleared_flag = TRUE;
-	g_signal_emit (G_OBJECT(label), signals[SELECTION_CHANGED], 0);
+	emit_selection_changed (label);
 
 	gl_debug (DEBUG_LABEL, "END");
 }
@@ -1049,7 +1279,8 @@ void
 gl_label_select_region (glLabel       *label,
                         glLabelRegion *region)
 {
-	GList         *p;
+	GHashTable    *candidates;
+	GHashTableIter iter;
 	glLabelObject *object;
         gdouble        r_x1, r_y1;
         gdouble        r_x2, r_y2;
@@ -1064,10 +1295,12 @@ gl_label_select_region (glLabel       *label,
         r_x2 = MAX (region->x1, region->x2);
         r_y2 = MAX (region->y1, region->y2);
 
-	for (p = label->priv->object_list; p != NULL; p = p->next)
-        {
-		object = GL_LABEL_OBJECT(p->data);
+        candidates = gl_spatial_index_query (label->priv->object_index,
+                                             r_x1, r_y1, r_x2, r_y2);
 
+        g_hash_table_iter_init (&iter, candidates);
+	while ( g_hash_table_iter_next (&iter, (gpointer *)&object, NULL) )
+        {
                 gl_label_object_get_extent (object, &obj_extent);
                 if ((obj_extent.x1 >= r_x1) &&
                     (obj_extent.x2 <= r_x2) &&
@@ -1078,8 +1311,10 @@ gl_label_select_region (glLabel       *label,
                 }
 	}
 
+        g_hash_table_destroy (candidates);
+
         label->priv->cp_cleared_flag = TRUE;
-	g_signal_emit (G_OBJECT(label), signals[SELECTION_CHANGED], 0);
+	emit_selection_changed (label);
 
 	gl_debug (DEBUG_LABEL, "END");
 }
@@ -1330,7 +1565,7 @@ gl_label_delete_selection (glLabel       *label)
 
         gl_label_checkpoint (label, _("Delete"));
 
-        begin_selection_op (label);
+        gl_label_begin_batch (label);
 
         selection_list = gl_label_get_selection_list (label);
 
@@ -1343,9 +1578,9 @@ gl_label_delete_selection (glLabel       *label)
 
         g_list_free (selection_list);
 
-        end_selection_op (label);
+        gl_label_end_batch (label);
 
-	g_signal_emit (G_OBJECT(label), signals[SELECTION_CHANGED], 0);
+	emit_selection_changed (label);
 
 	gl_debug (DEBUG_LABEL, "END");
 }
@@ -1365,7 +1600,7 @@ gl_label_raise_selection_to_top (glLabel       *label)
 
         gl_label_checkpoint (label, _("Bring to front"));
 
-        begin_selection_op (label);
+        gl_label_begin_batch (label);
 
         selection_list = gl_label_get_selection_list (label);
 
@@ -1374,14 +1609,13 @@ gl_label_raise_selection_to_top (glLabel       *label)
                 object = GL_LABEL_OBJECT (p->data);
 
                 label->priv->object_list = g_list_remove (label->priv->object_list, object);
+                do_modify_object (label, object, FALSE);
         }
 
 	/* Move to end of list, representing front most object */
 	label->priv->object_list = g_list_concat (label->priv->object_list, selection_list);
 
-        do_modify (label);
-
-        end_selection_op (label);
+        gl_label_end_batch (label);
 
 	gl_debug (DEBUG_LABEL, "END");
 }
@@ -1401,7 +1635,7 @@ gl_label_lower_selection_to_bottom (glLabel       *label)
 
         gl_label_checkpoint (label, _("Send to back"));
 
-        begin_selection_op (label);
+        gl_label_begin_batch (label);
 
         selection_list = gl_label_get_selection_list (label);
 
@@ -1410,14 +1644,13 @@ gl_label_lower_selection_to_bottom (glLabel       *label)
                 object = GL_LABEL_OBJECT (p->data);
 
                 label->priv->object_list = g_list_remove (label->priv->object_list, object);
+                do_modify_object (label, object, FALSE);
         }
 
 	/* Move to front of list, representing rear most object */
 	label->priv->object_list = g_list_concat (selection_list, label->priv->object_list);
 
-        do_modify (label);
-
-        end_selection_op (label);
+        gl_label_end_batch (label);
 
 	gl_debug (DEBUG_LABEL, "END");
 }
@@ -1438,7 +1671,7 @@ gl_label_rotate_selection (glLabel *label,
 
 	g_return_if_fail (label && GL_IS_LABEL (label));
 
-        begin_selection_op (label);
+        gl_label_begin_batch (label);
 
         gl_label_checkpoint (label, _("Rotate"));
 
@@ -1453,9 +1686,7 @@ gl_label_rotate_selection (glLabel *label,
 
 	g_list_free (selection_list);
 
-	do_modify (label);
-
-	end_selection_op (label);
+	gl_label_end_batch (label);
 
 	gl_debug (DEBUG_LABEL, "END");
 }
@@ -1475,7 +1706,7 @@ gl_label_rotate_selection_left (glLabel *label)
 
 	g_return_if_fail (label && GL_IS_LABEL (label));
 
-        begin_selection_op (label);
+        gl_label_begin_batch (label);
 
         gl_label_checkpoint (label, _("Rotate left"));
 
@@ -1490,9 +1721,7 @@ gl_label_rotate_selection_left (glLabel *label)
 
 	g_list_free (selection_list);
 
-	do_modify (label);
-
-	end_selection_op (label);
+	gl_label_end_batch (label);
 
 	gl_debug (DEBUG_LABEL, "END");
 }
@@ -1514,7 +1743,7 @@ gl_label_rotate_selection_right (glLabel *label)
 
         gl_label_checkpoint (label, _("Rotate right"));
 
-        begin_selection_op (label);
+        gl_label_begin_batch (label);
 
         selection_list = gl_label_get_selection_list (label);
 
@@ -1527,9 +1756,7 @@ gl_label_rotate_selection_right (glLabel *label)
 
 	g_list_free (selection_list);
 
-	do_modify (label);
-
-	end_selection_op (label);
+	gl_label_end_batch (label);
 
 	gl_debug (DEBUG_LABEL, "END");
 }
@@ -1551,7 +1778,7 @@ gl_label_flip_selection_horiz (glLabel *label)
 
         gl_label_checkpoint (label, _("Flip horizontally"));
 
-        begin_selection_op (label);
+        gl_label_begin_batch (label);
 
         selection_list = gl_label_get_selection_list (label);
 
@@ -1564,9 +1791,7 @@ gl_label_flip_selection_horiz (glLabel *label)
 
 	g_list_free (selection_list);
 
-	do_modify (label);
-
-	end_selection_op (label);
+	gl_label_end_batch (label);
 
 	gl_debug (DEBUG_LABEL, "END");
 }
@@ -1588,7 +1813,7 @@ gl_label_flip_selection_vert (glLabel *label)
 
         gl_label_checkpoint (label, _("Flip vertically"));
 
-        begin_selection_op (label);
+        gl_label_begin_batch (label);
 
         selection_list = gl_label_get_selection_list (label);
 
@@ -1601,9 +1826,7 @@ gl_label_flip_selection_vert (glLabel *label)
 
 	g_list_free (selection_list);
 
-	do_modify (label);
-
-	end_selection_op (label);
+	gl_label_end_batch (label);
 
 	gl_debug (DEBUG_LABEL, "END");
 }
@@ -1630,7 +1853,7 @@ gl_label_align_selection_left (glLabel *label)
 
         gl_label_checkpoint (label, _("Align left"));
 
-        begin_selection_op (label);
+        gl_label_begin_batch (label);
 
         selection_list = gl_label_get_selection_list (label);
 
@@ -1660,7 +1883,7 @@ gl_label_align_selection_left (glLabel *label)
 
         g_list_free (selection_list);
 
-        end_selection_op (label);
+        gl_label_end_batch (label);
 
 	gl_debug (DEBUG_LABEL, "END");
 }
@@ -1687,7 +1910,7 @@ gl_label_align_selection_right (glLabel *label)
 
         gl_label_checkpoint (label, _("Align right"));
 
-        begin_selection_op (label);
+        gl_label_begin_batch (label);
 
         selection_list = gl_label_get_selection_list (label);
 
@@ -1717,7 +1940,7 @@ gl_label_align_selection_right (glLabel *label)
 
         g_list_free (selection_list);
 
-        end_selection_op (label);
+        gl_label_end_batch (label);
 
 	gl_debug (DEBUG_LABEL, "END");
 }
@@ -1748,7 +1971,7 @@ gl_label_align_selection_hcenter (glLabel *label)
 
         gl_label_checkpoint (label, _("Align horizontal center"));
 
-        begin_selection_op (label);
+        gl_label_begin_batch (label);
 
         selection_list = gl_label_get_selection_list (label);
 
@@ -1797,7 +2020,7 @@ gl_label_align_selection_hcenter (glLabel *label)
 
         g_list_free (selection_list);
 
-        end_selection_op (label);
+        gl_label_end_batch (label);
 
 	gl_debug (DEBUG_LABEL, "END");
 }
@@ -1824,7 +2047,7 @@ gl_label_align_selection_top (glLabel *label)
 
         gl_label_checkpoint (label, _("Align tops"));
 
-        begin_selection_op (label);
+        gl_label_begin_batch (label);
 
         selection_list = gl_label_get_selection_list (label);
 
@@ -1854,7 +2077,7 @@ gl_label_align_selection_top (glLabel *label)
 
         g_list_free (selection_list);
 
-        end_selection_op (label);
+        gl_label_end_batch (label);
 
 	gl_debug (DEBUG_LABEL, "END");
 }
@@ -1881,7 +2104,7 @@ gl_label_align_selection_bottom (glLabel *label)
 
         gl_label_checkpoint (label, _("Align bottoms"));
 
-        begin_selection_op (label);
+        gl_label_begin_batch (label);
 
         selection_list = gl_label_get_selection_list (label);
 
@@ -1911,7 +2134,7 @@ gl_label_align_selection_bottom (glLabel *label)
 
         g_list_free (selection_list);
 
-        end_selection_op (label);
+        gl_label_end_batch (label);
 
 	gl_debug (DEBUG_LABEL, "END");
 }
@@ -1942,7 +2165,7 @@ gl_label_align_selection_vcenter (glLabel *label)
 
         gl_label_checkpoint (label, _("Align vertical center"));
 
-        begin_selection_op (label);
+        gl_label_begin_batch (label);
 
         selection_list = gl_label_get_selection_list (label);
 
@@ -1991,7 +2214,7 @@ gl_label_align_selection_vcenter (glLabel *label)
 
         g_list_free (selection_list);
 
-        end_selection_op (label);
+        gl_label_end_batch (label);
 
 	gl_debug (DEBUG_LABEL, "END");
 }
@@ -2020,7 +2243,7 @@ gl_label_center_selection_horiz (glLabel *label)
 
         gl_label_checkpoint (label, _("Center horizontally"));
 
-        begin_selection_op (label);
+        gl_label_begin_batch (label);
 
 	gl_label_get_size (label, &w, &h);
 	x_label_center = w / 2.0;
@@ -2038,7 +2261,7 @@ gl_label_center_selection_horiz (glLabel *label)
 	}
         g_list_free (selection_list);
 
-        end_selection_op (label);
+        gl_label_end_batch (label);
 
 	gl_debug (DEBUG_LABEL, "END");
 }
@@ -2067,7 +2290,7 @@ gl_label_center_selection_vert (glLabel *label)
 
         gl_label_checkpoint (label, _("Center vertically"));
 
-        begin_selection_op (label);
+        gl_label_begin_batch (label);
 
 	gl_label_get_size (label, &w, &h);
 	y_label_center = h / 2.0;
@@ -2085,7 +2308,7 @@ gl_label_center_selection_vert (glLabel *label)
 	}
         g_list_free (selection_list);
 
-        end_selection_op (label);
+        gl_label_end_batch (label);
 
 	gl_debug (DEBUG_LABEL, "END");
 }
@@ -2107,7 +2330,7 @@ gl_label_move_selection (glLabel  *label,
 
 	g_return_if_fail (label && GL_IS_LABEL (label));
 
-        begin_selection_op (label);
+        gl_label_begin_batch (label);
 
         selection_list = gl_label_get_selection_list (label);
 
@@ -2120,7 +2343,7 @@ gl_label_move_selection (glLabel  *label,
 
         g_list_free (selection_list);
 
-        end_selection_op (label);
+        gl_label_end_batch (label);
 
 	gl_debug (DEBUG_LABEL, "END");
 }
@@ -2141,7 +2364,7 @@ gl_label_set_selection_font_family (glLabel      *label,
 
 	g_return_if_fail (label && GL_IS_LABEL (label));
 
-        begin_selection_op (label);
+        gl_label_begin_batch (label);
 
         selection_list = gl_label_get_selection_list (label);
 
@@ -2153,7 +2376,7 @@ gl_label_set_selection_font_family (glLabel      *label,
 
         g_list_free (selection_list);
 
-        end_selection_op (label);
+        gl_label_end_batch (label);
 
 	gl_debug (DEBUG_LABEL, "END");
 }
@@ -2174,7 +2397,7 @@ gl_label_set_selection_font_size (glLabel  *label,
 
 	g_return_if_fail (label && GL_IS_LABEL (label));
 
-        begin_selection_op (label);
+        gl_label_begin_batch (label);
 
         selection_list = gl_label_get_selection_list (label);
 
@@ -2186,7 +2409,7 @@ gl_label_set_selection_font_size (glLabel  *label,
 
         g_list_free (selection_list);
 
-        end_selection_op (label);
+        gl_label_end_batch (label);
 
 	gl_debug (DEBUG_LABEL, "END");
 }
@@ -2207,7 +2430,7 @@ gl_label_set_selection_font_weight (glLabel      *label,
 
 	g_return_if_fail (label && GL_IS_LABEL (label));
 
-        begin_selection_op (label);
+        gl_label_begin_batch (label);
 
         selection_list = gl_label_get_selection_list (label);
 
@@ -2219,7 +2442,7 @@ gl_label_set_selection_font_weight (glLabel      *label,
 
         g_list_free (selection_list);
 
-        end_selection_op (label);
+        gl_label_end_batch (label);
 
 	gl_debug (DEBUG_LABEL, "END");
 }
@@ -2240,7 +2463,7 @@ gl_label_set_selection_font_italic_flag (glLabel   *label,
 
 	g_return_if_fail (label && GL_IS_LABEL (label));
 
-        begin_selection_op (label);
+        gl_label_begin_batch (label);
 
         selection_list = gl_label_get_selection_list (label);
 
@@ -2252,7 +2475,7 @@ gl_label_set_selection_font_italic_flag (glLabel   *label,
 
         g_list_free (selection_list);
 
-        end_selection_op (label);
+        gl_label_end_batch (label);
 
 	gl_debug (DEBUG_LABEL, "END");
 }
@@ -2273,7 +2496,7 @@ gl_label_set_selection_text_alignment (glLabel        *label,
 
 	g_return_if_fail (label && GL_IS_LABEL (label));
 
-        begin_selection_op (label);
+        gl_label_begin_batch (label);
 
         selection_list = gl_label_get_selection_list (label);
 
@@ -2285,7 +2508,7 @@ gl_label_set_selection_text_alignment (glLabel        *label,
 
         g_list_free (selection_list);
 
-        end_selection_op (label);
+        gl_label_end_batch (label);
 
 	gl_debug (DEBUG_LABEL, "END");
 }
@@ -2306,7 +2529,7 @@ gl_label_set_selection_text_valignment (glLabel        *label,
 
 	g_return_if_fail (label && GL_IS_LABEL (label));
 
-        begin_selection_op (label);
+        gl_label_begin_batch (label);
 
         selection_list = gl_label_get_selection_list (label);
 
@@ -2318,7 +2541,7 @@ gl_label_set_selection_text_valignment (glLabel        *label,
 
         g_list_free (selection_list);
 
-        end_selection_op (label);
+        gl_label_end_batch (label);
 
 	gl_debug (DEBUG_LABEL, "END");
 }
@@ -2339,7 +2562,7 @@ gl_label_set_selection_text_line_spacing (glLabel  *label,
 
 	g_return_if_fail (label && GL_IS_LABEL (label));
 
-        begin_selection_op (label);
+        gl_label_begin_batch (label);
 
         selection_list = gl_label_get_selection_list (label);
 
@@ -2351,7 +2574,7 @@ gl_label_set_selection_text_line_spacing (glLabel  *label,
 
         g_list_free (selection_list);
 
-        end_selection_op (label);
+        gl_label_end_batch (label);
 
 	gl_debug (DEBUG_LABEL, "END");
 }
@@ -2372,7 +2595,7 @@ gl_label_set_selection_text_color (glLabel      *label,
 
 	g_return_if_fail (label && GL_IS_LABEL (label));
 
-        begin_selection_op (label);
+        gl_label_begin_batch (label);
 
         selection_list = gl_label_get_selection_list (label);
 
@@ -2384,7 +2607,7 @@ gl_label_set_selection_text_color (glLabel      *label,
 
         g_list_free (selection_list);
 
-        end_selection_op (label);
+        gl_label_end_batch (label);
 
 	gl_debug (DEBUG_LABEL, "END");
 }
@@ -2405,7 +2628,7 @@ gl_label_set_selection_fill_color (glLabel      *label,
 
 	g_return_if_fail (label && GL_IS_LABEL (label));
 
-        begin_selection_op (label);
+        gl_label_begin_batch (label);
 
         selection_list = gl_label_get_selection_list (label);
 
@@ -2417,7 +2640,7 @@ gl_label_set_selection_fill_color (glLabel      *label,
 
         g_list_free (selection_list);
 
-        end_selection_op (label);
+        gl_label_end_batch (label);
 
 	gl_debug (DEBUG_LABEL, "END");
 }
@@ -2438,7 +2661,7 @@ gl_label_set_selection_line_color (glLabel      *label,
 
 	g_return_if_fail (label && GL_IS_LABEL (label));
 
-        begin_selection_op (label);
+        gl_label_begin_batch (label);
 
         selection_list = gl_label_get_selection_list (label);
 
@@ -2450,7 +2673,7 @@ gl_label_set_selection_line_color (glLabel      *label,
 
         g_list_free (selection_list);
 
-        end_selection_op (label);
+        gl_label_end_batch (label);
 
 	gl_debug (DEBUG_LABEL, "END");
 }
@@ -2471,7 +2694,7 @@ gl_label_set_selection_line_width (glLabel  *label,
 
 	g_return_if_fail (label && GL_IS_LABEL (label));
 
-        begin_selection_op (label);
+        gl_label_begin_batch (label);
 
         selection_list = gl_label_get_selection_list (label);
 
@@ -2483,7 +2706,7 @@ gl_label_set_selection_line_width (glLabel  *label,
 
         g_list_free (selection_list);
 
-        end_selection_op (label);
+        gl_label_end_batch (label);
 
 	gl_debug (DEBUG_LABEL, "END");
 }
@@ -2796,6 +3019,8 @@ paste_xml_received_cb (GtkClipboard     *clipboard,
         label_copy = gl_xml_label_open_buffer (xml_buffer, &status);
         if ( label_copy )
         {
+                gl_label_begin_batch (label);
+
                 gl_label_unselect_all (label);
 
                 for (p = label_copy->priv->object_list; p != NULL; p = p->next)
@@ -2809,6 +3034,8 @@ paste_xml_received_cb (GtkClipboard     *clipboard,
                         gl_debug (DEBUG_LABEL, "object pasted");
                 }
 
+                gl_label_end_batch (label);
+
                 g_object_unref (G_OBJECT (label_copy));
         }
 
@@ -3261,22 +3488,36 @@ glLabelObject *gl_label_object_at              (glLabel       *label,
                                                 gdouble        x_pixels,
                                                 gdouble        y_pixels)
 {
+	GHashTable       *candidates;
 	GList            *p_obj;
 	glLabelObject    *object;
 
 	g_return_val_if_fail (label && GL_IS_LABEL (label), NULL);
 
-	for (p_obj = g_list_last (label->priv->object_list); p_obj != NULL; p_obj = p_obj->prev)
+        candidates = query_objects (label, cr, x_pixels, y_pixels);
+
+        /* Test candidates only, topmost first. */
+	for (p_obj = g_list_last (label->priv->object_list);
+             (p_obj != NULL) && (g_hash_table_size (candidates) > 0);
+             p_obj = p_obj->prev)
         {
 		object = GL_LABEL_OBJECT (p_obj->data);
 
+                if ( !g_hash_table_remove (candidates, object) )
+                {
+                        continue;
+                }
+
                 if (gl_label_object_is_located_at (object, cr, x_pixels, y_pixels))
                 {
+                        g_hash_table_destroy (candidates);
                         return object;
                 }
 
 	}
 
+        g_hash_table_destroy (candidates);
+
         return NULL;
 }
 
@@ -3291,34 +3532,85 @@ gl_label_get_handle_at (glLabel             *label,
                         gdouble              y_pixels,
                         glLabelObjectHandle *handle)
 {
-        GList            *selection_list;
+	GHashTable       *candidates;
 	GList            *p_obj;
 	glLabelObject    *object;
 
 	g_return_val_if_fail (label && GL_IS_LABEL (label), NULL);
 
-        selection_list = gl_label_get_selection_list (label);
+        candidates = query_objects (label, cr, x_pixels, y_pixels);
 
-	for (p_obj = g_list_last (selection_list); p_obj != NULL; p_obj = p_obj->prev)
+        /* Test selected candidates only, topmost first. */
+	for (p_obj = g_list_last (label->priv->object_list);
+             (p_obj != NULL) && (g_hash_table_size (candidates) > 0);
+             p_obj = p_obj->prev)
         {
 
 		object = GL_LABEL_OBJECT (p_obj->data);
 
+                if ( !g_hash_table_remove (candidates, object) ||
+                     !gl_label_object_is_selected (object) )
+                {
+                        continue;
+                }
+
                 if ((*handle = gl_label_object_handle_at (object, cr, x_pixels, y_pixels)))
                 {
-                        g_list_free (selection_list);
+                        g_hash_table_destroy (candidates);
                         return object;
                 }
 
 	}
 
-        g_list_free (selection_list);
+        g_hash_table_destroy (candidates);
 
         *handle = GL_LABEL_OBJECT_HANDLE_NONE;
         return NULL;
 }
 
 
+/*---------------------------------------------------------------------------*/
+/* PRIVATE.  Update object's entry in the spatial index.                     */
+/*---------------------------------------------------------------------------*/
+static void
+index_object (glLabel       *label,
+              glLabelObject *object)
+{
+        glLabelRegion  extent;
+
+        gl_label_object_get_extent (object, &extent);
+        gl_spatial_index_set (label->priv->object_index, object,
+                              extent.x1, extent.y1, extent.x2, extent.y2);
+}
+
+
+/*---------------------------------------------------------------------------*/
+/* PRIVATE.  Get set of objects whose extent is near device coordinates.     */
+/*---------------------------------------------------------------------------*/
+static GHashTable *
+query_objects (glLabel       *label,
+               cairo_t       *cr,
+               gdouble        x_pixels,
+               gdouble        y_pixels)
+{
+        gdouble x, y;
+        gdouble dx, dy;
+
+        x  = x_pixels;
+        y  = y_pixels;
+        cairo_device_to_user (cr, &x, &y);
+
+        dx = HIT_SLOP_PIXELS;
+        dy = HIT_SLOP_PIXELS;
+        cairo_device_to_user_distance (cr, &dx, &dy);
+        dx = fabs (dx);
+        dy = fabs (dy);
+
+        return gl_spatial_index_query (label->priv->object_index,
+                                       x - dx, y - dy, x + dx, y + dy);
+}
+
+
 /****************************************************************************/
 /* Checkpoint state.                                                        */
 /****************************************************************************/
@@ -3348,6 +3640,8 @@ gl_label_checkpoint (glLabel       *this,
                 /* Save state onto undo stack. */
                 state = state_new (this, description);
                 stack_push_state (this->priv->undo_stack, state);
+                stack_trim (this->priv->undo_stack,
+                            gl_prefs_model_get_max_undo_objects (gl_prefs));
 
                 /* Track consecutive checkpoints. */
                 this->priv->cp_cleared_flag = FALSE;
@@ -3525,8 +3819,70 @@ stack_pop_state (GQueue *stack)
 }
 
 
+/****************************************************************************/
+/* Trim stack to a maximum number of distinct object copies.                */
+/****************************************************************************/
+static void
+stack_trim (GQueue *stack,
+            gint    max_copies)
+{
+        GHashTable     *seen;
+        GList          *p_state, *p_obj;
+        State          *state;
+        gint            n_copies;
+        guint           n_keep;
+
+	gl_debug (DEBUG_LABEL, "START");
+
+        if ( max_copies <= 0 )
+        {
+                return;
+        }
+
+        /*
+         * Copies are shared between states, so count each one once, newest
+         * state first.  The most recent state is always kept.
+         */
+        seen     = g_hash_table_new (g_direct_hash, g_direct_equal);
+        n_copies = 0;
+        n_keep   = 0;
+        for ( p_state = stack->head; p_state != NULL; p_state = p_state->next )
+        {
+                state = (State *)p_state->data;
+
+                for ( p_obj = state->object_list; p_obj != NULL; p_obj = p_obj->next )
+                {
+                        if ( !g_hash_table_contains (seen, p_obj->data) )
+                        {
+                                g_hash_table_add (seen, p_obj->data);
+                                n_copies++;
+                        }
+                }
+
+                if ( (n_copies > max_copies) && (n_keep > 0) )
+                {
+                        break;
+                }
+                n_keep++;
+        }
+        g_hash_table_destroy (seen);
+
+        while ( g_queue_get_length (stack) > n_keep )
+        {
+                state_free (g_queue_pop_tail (stack));
+        }
+
+	gl_debug (DEBUG_LABEL, "END");
+}
+
+
 /****************************************************************************/
 /* New state from label.                                                    */
+/*                                                                          */
+/* States share immutable snapshots: an object that has not changed since   */
+/* the last checkpoint is represented by the same copy in both states, and  */
+/* the template and merge are only referenced.  Memory therefore grows with */
+/* the number of changes rather than with the size of the label.            */
 /****************************************************************************/
 static State *
 state_new (glLabel       *this,
@@ -3535,6 +3891,7 @@ state_new (glLabel       *this,
         State          *state;
         GList          *p_obj;
         glLabelObject  *object;
+        glLabelObject  *copy;
 
 	gl_debug (DEBUG_LABEL, "START");
 
@@ -3542,18 +3899,33 @@ state_new (glLabel       *this,
 
         state->description = g_strdup (description);
 
-        state->template    = lgl_template_dup (this->priv->template);
+        if ( (this->priv->template_snapshot == NULL) && (this->priv->template != NULL) )
+        {
+                this->priv->template_snapshot = g_new0 (TemplateSnapshot, 1);
+                this->priv->template_snapshot->ref_count = 1;
+                this->priv->template_snapshot->template  = lgl_template_dup (this->priv->template);
+        }
+        state->template    = template_snapshot_ref (this->priv->template_snapshot);
         state->rotate_flag = this->priv->rotate_flag;
 
         for ( p_obj = this->priv->object_list; p_obj != NULL; p_obj = p_obj->next )
         {
                 object = GL_LABEL_OBJECT (p_obj->data);
 
-                state->object_list = g_list_append (state->object_list,
-                                                    gl_label_object_dup (object, this));
+                copy = object_snapshot (this, object);
+                state->object_list = g_list_prepend (state->object_list, copy);
+
+                if ( gl_label_object_is_selected (object) )
+                {
+                        state->selection = g_list_prepend (state->selection, copy);
+                }
         }
+        state->object_list = g_list_reverse (state->object_list);
 
-        state->merge = gl_merge_dup (this->priv->merge);
+        if ( this->priv->merge )
+        {
+                state->merge = g_object_ref (this->priv->merge);
+        }
 
         state->modified_flag = this->priv->modified_flag;
         state->time_stamp    = this->priv->time_stamp;
@@ -3576,7 +3948,7 @@ state_free (State   *state)
 
         g_free (state->description);
 
-        lgl_template_free (state->template);
+        template_snapshot_unref (state->template);
         if ( state->merge )
         {
                 g_object_unref (G_OBJECT (state->merge));
@@ -3587,6 +3959,7 @@ state_free (State   *state)
                 g_object_unref (G_OBJECT (p_obj->data));
         }
         g_list_free (state->object_list);
+        g_list_free (state->selection);
 
         g_free (state);
 
@@ -3596,38 +3969,143 @@ state_free (State   *state)
 
 /****************************************************************************/
 /* Restore label from saved state.                                          */
+/*                                                                          */
+/* Live objects whose snapshot is still current and appears in the state   */
+/* are kept as is, only the others are recreated or deleted.                */
 /****************************************************************************/
 static void
 state_restore (State   *state,
                glLabel *this)
                
 {
-        GList          *p_obj, *p_next;
-        glLabelObject  *object;
+        GHashTable     *live, *selected, *kept;
+        GList          *p_obj, *p_old, *object_list;
+        glLabelObject  *object, *copy;
+        ObjectSnapshot *snapshot;
 
 	gl_debug (DEBUG_LABEL, "START");
 
+        gl_label_begin_batch (this);
+
         gl_label_set_rotate_flag (this, state->rotate_flag, FALSE);
-        gl_label_set_template (this, state->template, FALSE);
+        if ( state->template && (state->template != this->priv->template_snapshot) )
+        {
+                gl_label_set_template (this, state->template->template, FALSE);
+
+                template_snapshot_unref (this->priv->template_snapshot);
+                this->priv->template_snapshot = template_snapshot_ref (state->template);
+        }
 
-        for ( p_obj = this->priv->object_list; p_obj != NULL; p_obj = p_next )
+        /* Map copies back to the unchanged live objects they describe. */
+        live = g_hash_table_new (g_direct_hash, g_direct_equal);
+        for ( p_obj = this->priv->object_list; p_obj != NULL; p_obj = p_obj->next )
         {
-                p_next = p_obj->next; /* Hold on to next; delete is destructive */
-                object = GL_LABEL_OBJECT (p_obj->data);
+                object   = GL_LABEL_OBJECT (p_obj->data);
+                snapshot = g_hash_table_lookup (this->priv->snapshots, object);
 
-                gl_label_delete_object (this, object);
+                if ( snapshot && (snapshot->version == gl_label_object_get_version (object)) )
+                {
+                        g_hash_table_insert (live, snapshot->copy, object);
+                }
         }
 
+        selected = g_hash_table_new (g_direct_hash, g_direct_equal);
+        for ( p_obj = state->selection; p_obj != NULL; p_obj = p_obj->next )
+        {
+                g_hash_table_add (selected, p_obj->data);
+        }
+
+        kept         = g_hash_table_new (g_direct_hash, g_direct_equal);
+        object_list  = NULL;
+        p_old        = this->priv->object_list;
         for ( p_obj = state->object_list; p_obj != NULL; p_obj = p_obj->next )
+        {
+                copy   = GL_LABEL_OBJECT (p_obj->data);
+                object = g_hash_table_lookup (live, copy);
+
+                if ( object )
+                {
+                        /* Each live object can only be claimed once. */
+                        g_hash_table_remove (live, copy);
+                }
+                else
+                {
+                        object = gl_label_object_dup (copy, this);
+
+                        snapshot = g_new0 (ObjectSnapshot, 1);
+                        snapshot->copy    = g_object_ref (copy);
+                        snapshot->version = gl_label_object_get_version (object);
+                        g_hash_table_replace (this->priv->snapshots, object, snapshot);
+
+                        g_signal_connect (G_OBJECT (object), "changed",
+                                          G_CALLBACK (object_changed_cb), this);
+                        g_signal_connect (G_OBJECT (object), "moved",
+                                          G_CALLBACK (object_moved_cb), this);
+
+                        index_object (this, object);
+                }
+
+                if ( g_hash_table_contains (selected, copy) )
+                {
+                        gl_label_object_select (object);
+                }
+                else
+                {
+                        gl_label_object_unselect (object);
+                }
+
+                /* New, or moved in stacking order. */
+                if ( (p_old == NULL) || (p_old->data != object) )
+                {
+                        do_modify_object (this, object, FALSE);
+                }
+                p_old = p_old ? p_old->next : NULL;
+
+                g_hash_table_add (kept, object);
+                object_list = g_list_prepend (object_list, object);
+        }
+        object_list = g_list_reverse (object_list);
+
+        /* Delete live objects that do not appear in the restored state. */
+        for ( p_obj = this->priv->object_list; p_obj != NULL; p_obj = p_obj->next )
         {
                 object = GL_LABEL_OBJECT (p_obj->data);
 
-                gl_label_add_object (this, gl_label_object_dup (object, this));
+                if ( !g_hash_table_contains (kept, object) )
+                {
+                        gl_spatial_index_remove (this->priv->object_index, object);
+                        g_hash_table_remove (this->priv->snapshots, object);
+
+                        g_signal_handlers_disconnect_by_func (G_OBJECT (object),
+                                                              G_CALLBACK (object_changed_cb), this);
+                        g_signal_handlers_disconnect_by_func (G_OBJECT (object),
+                                                              G_CALLBACK (object_moved_cb), this);
+                        do_modify_object (this, object, TRUE);
+                        g_object_unref (object);
+                }
+        }
+        g_list_free (this->priv->object_list);
+        this->priv->object_list = object_list;
+
+        g_hash_table_destroy (live);
+        g_hash_table_destroy (selected);
+        g_hash_table_destroy (kept);
+
+	emit_selection_changed (this);
+
+        if ( state->merge != this->priv->merge )
+        {
+                if ( this->priv->merge != NULL )
+                {
+                        g_object_unref (G_OBJECT(this->priv->merge));
+                }
+                this->priv->merge = state->merge ? g_object_ref (state->merge) : NULL;
+
+                do_modify (this);
+                g_signal_emit (G_OBJECT(this), signals[MERGE_CHANGED], 0);
         }
-	g_signal_emit (G_OBJECT(this), signals[SELECTION_CHANGED], 0);
 
-        gl_label_set_merge (this, state->merge, FALSE);
-        
+        gl_label_end_batch (this);
 
         if ( !state->modified_flag &&
              (state->time_stamp.tv_sec  == this->priv->time_stamp.tv_sec) &&
@@ -3640,6 +4118,71 @@ state_restore (State   *state,
 }
 
 
+/*---------------------------------------------------------------------------*/
+/* PRIVATE.  Reference template snapshot.                                    */
+/*---------------------------------------------------------------------------*/
+static TemplateSnapshot *
+template_snapshot_ref (TemplateSnapshot *snapshot)
+{
+        if ( snapshot )
+        {
+                snapshot->ref_count++;
+        }
+
+        return snapshot;
+}
+
+
+/*---------------------------------------------------------------------------*/
+/* PRIVATE.  Unreference template snapshot.                                  */
+/*---------------------------------------------------------------------------*/
+static void
+template_snapshot_unref (TemplateSnapshot *snapshot)
+{
+        if ( snapshot && (--snapshot->ref_count == 0) )
+        {
+                lgl_template_free (snapshot->template);
+                g_free (snapshot);
+        }
+}
+
+
+/*---------------------------------------------------------------------------*/
+/* PRIVATE.  Free object snapshot.                                           */
+/*---------------------------------------------------------------------------*/
+static void
+object_snapshot_free (ObjectSnapshot *snapshot)
+{
+        g_object_unref (G_OBJECT (snapshot->copy));
+        g_free (snapshot);
+}
+
+
+/*---------------------------------------------------------------------------*/
+/* PRIVATE.  Get a reference to an immutable copy of object, reusing the    */
+/* copy made at an earlier checkpoint if the object has not changed since.  */
+/*---------------------------------------------------------------------------*/
+static glLabelObject *
+object_snapshot (glLabel       *this,
+                 glLabelObject *object)
+{
+        ObjectSnapshot *snapshot;
+        guint           version;
+
+        version  = gl_label_object_get_version (object);
+        snapshot = g_hash_table_lookup (this->priv->snapshots, object);
+
+        if ( (snapshot == NULL) || (snapshot->version != version) )
+        {
+                snapshot = g_new0 (ObjectSnapshot, 1);
+                snapshot->copy    = gl_label_object_dup (object, this);
+                snapshot->version = version;
+                g_hash_table_replace (this->priv->snapshots, object, snapshot);
+        }
+
+        return g_object_ref (snapshot->copy);
+}
+
 
 
 /*
@@ -66,6 +66,11 @@ struct _glLabelClass {
 	void (*changed)           (glLabel       *label,
 				   gpointer       user_data);
 
+	void (*objects_changed)   (glLabel       *label,
+				   GList         *changed,
+				   GList         *deleted,
+				   gpointer       user_data);
+
 	void (*name_changed)      (glLabel       *label,
 				   gpointer       user_data);
 
@@ -137,6 +142,8 @@ GHashTable   *gl_label_get_pixbuf_cache        (glLabel       *label);
 
 GHashTable   *gl_label_get_svg_cache           (glLabel       *label);
 
+void          gl_label_decode_images           (glLabel       *label);
+
 
 void          gl_label_add_object              (glLabel       *label,
 						glLabelObject *object);
@@ -148,6 +155,14 @@ void          gl_label_delete_object           (glLabel       *label,
 const GList  *gl_label_get_object_list         (glLabel       *label);
 
 
+/*
+ * Batch modification methods
+ */
+void          gl_label_begin_batch             (glLabel       *label);
+
+void          gl_label_end_batch               (glLabel       *label);
+
+
 
 /*
  * Modify selection methods
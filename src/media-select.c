@@ -43,13 +43,14 @@
 
 #define HISTORY_SIZE 5
 
+#define MINI_PREVIEW_SIZE 72
+
 /*===========================================*/
 /* Private types                             */
 /*===========================================*/
 
 enum {
 	NAME_COLUMN,
-	PREVIEW_COLUMN,
 	PREVIEW_COLUMN_STOCK,
 	PREVIEW_COLUMN_STOCK_SIZE,
 	DESCRIPTION_COLUMN,
@@ -59,6 +60,7 @@ enum {
 struct _glMediaSelectPrivate {
 
         gulong        db_notify_id;
+        gulong        preview_notify_id;
 
         GtkBuilder   *builder;
 
@@ -141,6 +143,15 @@ static void   page_changed_cb            (GtkNotebook            *notebook,
 
 static void   db_changed_cb              (glMediaSelect          *this);
 
+static void   preview_ready_cb           (const gchar            *name,
+                                          glMediaSelect          *this);
+
+static void   preview_data_func          (GtkTreeViewColumn      *column,
+                                          GtkCellRenderer        *renderer,
+                                          GtkTreeModel           *model,
+                                          GtkTreeIter            *iter,
+                                          gpointer                data);
+
 static void   load_recent_list           (glMediaSelect          *this,
                                           GtkListStore           *store,
                                           GtkTreeSelection       *selection,
@@ -213,6 +224,11 @@ gl_media_select_finalize (GObject *object)
                 lgl_db_notify_remove (this->priv->db_notify_id);
         }
 
+        if (this->priv->preview_notify_id)
+        {
+                gl_mini_preview_pixbuf_cache_notify_remove (this->priv->preview_notify_id);
+        }
+
         if (this->priv->builder)
         {
                 g_object_unref (this->priv->builder);
@@ -329,15 +345,16 @@ gl_media_select_construct (glMediaSelect *this)
         gtk_widget_show_all (GTK_WIDGET (this));
 
         /* Recent templates treeview */
-        this->priv->recent_store = gtk_list_store_new (N_COLUMNS, G_TYPE_STRING, GDK_TYPE_PIXBUF, G_TYPE_STRING, G_TYPE_UINT, G_TYPE_STRING);
+        this->priv->recent_store = gtk_list_store_new (N_COLUMNS, G_TYPE_STRING, G_TYPE_STRING, G_TYPE_UINT, G_TYPE_STRING);
         gtk_tree_view_set_model (GTK_TREE_VIEW (this->priv->recent_treeview),
                                  GTK_TREE_MODEL (this->priv->recent_store));
         renderer = gtk_cell_renderer_pixbuf_new ();
+        gtk_cell_renderer_set_fixed_size (renderer, MINI_PREVIEW_SIZE, MINI_PREVIEW_SIZE);
         column = gtk_tree_view_column_new_with_attributes ("", renderer,
-                                                           "pixbuf", PREVIEW_COLUMN,
                                                            "stock-id", PREVIEW_COLUMN_STOCK,
                                                            "stock-size", PREVIEW_COLUMN_STOCK_SIZE,
                                                            NULL);
+        gtk_tree_view_column_set_cell_data_func (column, renderer, preview_data_func, this, NULL);
         gtk_tree_view_column_set_sizing (column, GTK_TREE_VIEW_COLUMN_AUTOSIZE);
         gtk_tree_view_append_column (GTK_TREE_VIEW (this->priv->recent_treeview), column);
         renderer = gtk_cell_renderer_text_new ();
@@ -375,15 +392,16 @@ gl_media_select_construct (glMediaSelect *this)
         gl_combo_util_set_active_text (GTK_COMBO_BOX (this->priv->category_combo), C_("Category", "Any"));
 
         /* Search all treeview */
-        this->priv->search_all_store = gtk_list_store_new (N_COLUMNS, G_TYPE_STRING, GDK_TYPE_PIXBUF, G_TYPE_STRING, G_TYPE_UINT, G_TYPE_STRING);
+        this->priv->search_all_store = gtk_list_store_new (N_COLUMNS, G_TYPE_STRING, G_TYPE_STRING, G_TYPE_UINT, G_TYPE_STRING);
         gtk_tree_view_set_model (GTK_TREE_VIEW (this->priv->search_all_treeview),
                                  GTK_TREE_MODEL (this->priv->search_all_store));
         renderer = gtk_cell_renderer_pixbuf_new ();
+        gtk_cell_renderer_set_fixed_size (renderer, MINI_PREVIEW_SIZE, MINI_PREVIEW_SIZE);
         column = gtk_tree_view_column_new_with_attributes ("", renderer,
-                                                           "pixbuf", PREVIEW_COLUMN,
                                                            "stock-id", PREVIEW_COLUMN_STOCK,
                                                            "stock-size", PREVIEW_COLUMN_STOCK_SIZE,
                                                            NULL);
+        gtk_tree_view_column_set_cell_data_func (column, renderer, preview_data_func, this, NULL);
         gtk_tree_view_column_set_sizing (column, GTK_TREE_VIEW_COLUMN_AUTOSIZE);
         gtk_tree_view_append_column (GTK_TREE_VIEW (this->priv->search_all_treeview), column);
         renderer = gtk_cell_renderer_text_new ();
@@ -398,15 +416,16 @@ gl_media_select_construct (glMediaSelect *this)
         lgl_db_free_template_name_list (search_all_names);
 
         /* Custom templates treeview */
-        this->priv->custom_store = gtk_list_store_new (N_COLUMNS, G_TYPE_STRING, GDK_TYPE_PIXBUF, G_TYPE_STRING, G_TYPE_UINT, G_TYPE_STRING);
+        this->priv->custom_store = gtk_list_store_new (N_COLUMNS, G_TYPE_STRING, G_TYPE_STRING, G_TYPE_UINT, G_TYPE_STRING);
         gtk_tree_view_set_model (GTK_TREE_VIEW (this->priv->custom_treeview),
                                  GTK_TREE_MODEL (this->priv->custom_store));
         renderer = gtk_cell_renderer_pixbuf_new ();
+        gtk_cell_renderer_set_fixed_size (renderer, MINI_PREVIEW_SIZE, MINI_PREVIEW_SIZE);
         column = gtk_tree_view_column_new_with_attributes ("", renderer,
-                                                           "pixbuf", PREVIEW_COLUMN,
                                                            "stock-id", PREVIEW_COLUMN_STOCK,
                                                            "stock-size", PREVIEW_COLUMN_STOCK_SIZE,
                                                            NULL);
+        gtk_tree_view_column_set_cell_data_func (column, renderer, preview_data_func, this, NULL);
         gtk_tree_view_column_set_sizing (column, GTK_TREE_VIEW_COLUMN_AUTOSIZE);
         gtk_tree_view_append_column (GTK_TREE_VIEW (this->priv->custom_treeview), column);
         renderer = gtk_cell_renderer_text_new ();
@@ -470,6 +489,8 @@ gl_media_select_construct (glMediaSelect *this)
         gl_template_history_model_free_name_list (recent_list);
 
         this->priv->db_notify_id = lgl_db_notify_add ((lglDbNotifyFunc)db_changed_cb, this);
+        this->priv->preview_notify_id =
+                gl_mini_preview_pixbuf_cache_notify_add ((glMiniPreviewPixbufCacheNotifyFunc)preview_ready_cb, this);
 
         gl_debug (DEBUG_MEDIA_SELECT, "END");
 }
@@ -753,6 +774,47 @@ db_changed_cb (glMediaSelect *this)
 }
 
 
+/*--------------------------------------------------------------------------*/
+/* PRIVATE.  Mini preview became available.                                 */
+/*--------------------------------------------------------------------------*/
+static void
+preview_ready_cb (const gchar   *name,
+                  glMediaSelect *this)
+{
+        /* Only visible rows asked for previews, so just redraw them. */
+        gtk_widget_queue_draw (this->priv->recent_treeview);
+        gtk_widget_queue_draw (this->priv->search_all_treeview);
+        gtk_widget_queue_draw (this->priv->custom_treeview);
+}
+
+
+/*--------------------------------------------------------------------------*/
+/* PRIVATE.  Set mini preview of row.  Only called for rows being drawn, so  */
+/* previews are created lazily, in the background.                          */
+/*--------------------------------------------------------------------------*/
+static void
+preview_data_func (GtkTreeViewColumn *column,
+                   GtkCellRenderer   *renderer,
+                   GtkTreeModel      *model,
+                   GtkTreeIter       *iter,
+                   gpointer           data)
+{
+        gchar     *name;
+        GdkPixbuf *pixbuf;
+
+        gtk_tree_model_get (model, iter, NAME_COLUMN, &name, -1);
+        pixbuf = gl_mini_preview_pixbuf_cache_lookup (name);
+        g_free (name);
+
+        g_object_set (renderer, "pixbuf", pixbuf, NULL);
+
+        if (pixbuf)
+        {
+                g_object_unref (pixbuf);
+        }
+}
+
+
 /****************************************************************************/
 /* query selected label template name.                                      */
 /****************************************************************************/
@@ -925,7 +987,6 @@ load_recent_list (glMediaSelect      *this,
         lglUnits          units;
         lglTemplate      *template;
         lglTemplateFrame *frame;
-        GdkPixbuf        *pixbuf;
         gchar            *size;
         gchar            *layout;
         gchar            *description;
@@ -954,7 +1015,6 @@ load_recent_list (glMediaSelect      *this,
 
                         template = lgl_db_lookup_template_from_name (p->data);
                         frame    = (lglTemplateFrame *)template->frames->data;
-                        pixbuf   = gl_mini_preview_pixbuf_cache_get_pixbuf (p->data);
 
                         size     = lgl_template_frame_get_size_description (frame, units);
                         layout   = lgl_template_frame_get_layout_description (frame);
@@ -971,11 +1031,9 @@ load_recent_list (glMediaSelect      *this,
                         gtk_list_store_append (store, &iter);
                         gtk_list_store_set (store, &iter,
                                             NAME_COLUMN, p->data,
-                                            PREVIEW_COLUMN, pixbuf,
                                             DESCRIPTION_COLUMN, description,
                                             -1);
 
-                        g_object_unref (G_OBJECT (pixbuf));
                         g_free (description);
                 }
 
@@ -1018,7 +1076,6 @@ load_search_all_list (glMediaSelect      *this,
         lglUnits          units;
         lglTemplate      *template;
         lglTemplateFrame *frame;
-        GdkPixbuf        *pixbuf;
         gchar            *size;
         gchar            *layout;
         gchar            *description;
@@ -1046,7 +1103,6 @@ load_search_all_list (glMediaSelect      *this,
 
                         template = lgl_db_lookup_template_from_name (p->data);
                         frame    = (lglTemplateFrame *)template->frames->data;
-                        pixbuf   = gl_mini_preview_pixbuf_cache_get_pixbuf (p->data);
 
                         size     = lgl_template_frame_get_size_description (frame, units);
                         layout   = lgl_template_frame_get_layout_description (frame);
@@ -1063,11 +1119,9 @@ load_search_all_list (glMediaSelect      *this,
                         gtk_list_store_append (store, &iter);
                         gtk_list_store_set (store, &iter,
                                             NAME_COLUMN, p->data,
-                                            PREVIEW_COLUMN, pixbuf,
                                             DESCRIPTION_COLUMN, description,
                                             -1);
 
-                        g_object_unref (G_OBJECT (pixbuf));
                         g_free (description);
                 }
 
@@ -1111,7 +1165,6 @@ load_custom_list (glMediaSelect      *this,
         lglUnits          units;
         lglTemplate      *template;
         lglTemplateFrame *frame;
-        GdkPixbuf        *pixbuf;
         gchar            *size;
         gchar            *layout;
         gchar            *description;
@@ -1140,7 +1193,6 @@ load_custom_list (glMediaSelect      *this,
 
                         template = lgl_db_lookup_template_from_name (p->data);
                         frame    = (lglTemplateFrame *)template->frames->data;
-                        pixbuf   = gl_mini_preview_pixbuf_cache_get_pixbuf (p->data);
 
                         size     = lgl_template_frame_get_size_description (frame, units);
                         layout   = lgl_template_frame_get_layout_description (frame);
@@ -1157,11 +1209,9 @@ load_custom_list (glMediaSelect      *this,
                         gtk_list_store_append (store, &iter);
                         gtk_list_store_set (store, &iter,
                                             NAME_COLUMN, p->data,
-                                            PREVIEW_COLUMN, pixbuf,
                                             DESCRIPTION_COLUMN, description,
                                             -1);
 
-                        g_object_unref (G_OBJECT (pixbuf));
                         g_free (description);
                 }
 
@@ -414,6 +414,7 @@ gl_merge_evolution_open (glMerge *merge)
                 }
                 e_book_query_unref(query);
                 free_field_list(merge_evolution->priv->fields);
+                merge_evolution->priv->fields = NULL;
                 g_object_unref(merge_evolution->priv->book);
                 merge_evolution->priv->book = NULL;
 
@@ -538,6 +539,9 @@ gl_merge_evolution_copy (glMerge       *dst_merge,
         dst_merge_evolution = GL_MERGE_EVOLUTION (dst_merge);
         src_merge_evolution = GL_MERGE_EVOLUTION (src_merge);
 
+        g_free (dst_merge_evolution->priv->query);
+        free_field_list (dst_merge_evolution->priv->fields);
+
         dst_merge_evolution->priv->query = g_strdup(src_merge_evolution->priv->query);
 
         dst_merge_evolution->priv->fields = g_list_copy(src_merge_evolution->priv->fields);
@@ -0,0 +1,622 @@
+/*
+ *  merge-model.c
+ *  Copyright (C) 2026  agent <agent@local>.
+ *
+ *  This file is part of gLabels.
+ *
+ *  gLabels is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  gLabels is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with gLabels.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <config.h>
+
+#include "merge-model.h"
+
+#include "debug.h"
+
+
+/*
+ * Tree model presenting the records of a glMerge, with the fields of each
+ * record as child rows.
+ *
+ * Rows are not stored, they are read directly from the merge records
+ * whenever the tree view asks for them.  An iter holds the record index
+ * (user_data) and, for field rows, the field list node (user_data2) and the
+ * field index (user_data3).
+ */
+
+
+/*========================================================*/
+/* Private types.                                         */
+/*========================================================*/
+
+struct _glMergeModelPrivate {
+
+	glMerge    *merge;
+
+        GPtrArray  *records;       /* glMergeRecord, in merge order */
+        gchar      *primary_key;
+
+        gint        stamp;
+};
+
+
+/*========================================================*/
+/* Private macros.                                        */
+/*========================================================*/
+
+#define ITER_RECORD_INDEX(iter)  GPOINTER_TO_INT ((iter)->user_data)
+#define ITER_FIELD_NODE(iter)    ((GList *)(iter)->user_data2)
+#define ITER_FIELD_INDEX(iter)   GPOINTER_TO_INT ((iter)->user_data3)
+
+
+/*========================================================*/
+/* Private function prototypes.                           */
+/*========================================================*/
+
+static void              gl_merge_model_finalize       (GObject           *object);
+
+static void              gl_merge_model_tree_model_init(GtkTreeModelIface *iface);
+
+static GtkTreeModelFlags get_flags                     (GtkTreeModel      *tree_model);
+
+static gint              get_n_columns                 (GtkTreeModel      *tree_model);
+
+static GType             get_column_type               (GtkTreeModel      *tree_model,
+                                                        gint               index);
+
+static gboolean          get_iter                      (GtkTreeModel      *tree_model,
+                                                        GtkTreeIter       *iter,
+                                                        GtkTreePath       *path);
+
+static GtkTreePath      *get_path                      (GtkTreeModel      *tree_model,
+                                                        GtkTreeIter       *iter);
+
+static void              get_value                     (GtkTreeModel      *tree_model,
+                                                        GtkTreeIter       *iter,
+                                                        gint               column,
+                                                        GValue            *value);
+
+static gboolean          iter_next                     (GtkTreeModel      *tree_model,
+                                                        GtkTreeIter       *iter);
+
+static gboolean          iter_children                 (GtkTreeModel      *tree_model,
+                                                        GtkTreeIter       *iter,
+                                                        GtkTreeIter       *parent);
+
+static gboolean          iter_has_child                (GtkTreeModel      *tree_model,
+                                                        GtkTreeIter       *iter);
+
+static gint              iter_n_children               (GtkTreeModel      *tree_model,
+                                                        GtkTreeIter       *iter);
+
+static gboolean          iter_nth_child                (GtkTreeModel      *tree_model,
+                                                        GtkTreeIter       *iter,
+                                                        GtkTreeIter       *parent,
+                                                        gint               n);
+
+static gboolean          iter_parent                   (GtkTreeModel      *tree_model,
+                                                        GtkTreeIter       *iter,
+                                                        GtkTreeIter       *child);
+
+static void              set_record_iter               (glMergeModel      *model,
+                                                        GtkTreeIter       *iter,
+                                                        gint               i_record);
+
+static void              set_field_iter                (glMergeModel      *model,
+                                                        GtkTreeIter       *iter,
+                                                        gint               i_record,
+                                                        GList             *p_field,
+                                                        gint               i_field);
+
+
+/*****************************************************************************/
+/* Boilerplate object stuff.                                                 */
+/*****************************************************************************/
+G_DEFINE_TYPE_WITH_CODE (glMergeModel, gl_merge_model, G_TYPE_OBJECT,
+                         G_IMPLEMENT_INTERFACE (GTK_TYPE_TREE_MODEL,
+                                                gl_merge_model_tree_model_init))
+
+
+static void
+gl_merge_model_class_init (glMergeModelClass *class)
+{
+	GObjectClass *object_class = G_OBJECT_CLASS (class);
+
+	gl_merge_model_parent_class = g_type_class_peek_parent (class);
+
+	object_class->finalize = gl_merge_model_finalize;
+}
+
+
+static void
+gl_merge_model_tree_model_init (GtkTreeModelIface *iface)
+{
+        iface->get_flags       = get_flags;
+        iface->get_n_columns   = get_n_columns;
+        iface->get_column_type = get_column_type;
+        iface->get_iter        = get_iter;
+        iface->get_path        = get_path;
+        iface->get_value       = get_value;
+        iface->iter_next       = iter_next;
+        iface->iter_children   = iter_children;
+        iface->iter_has_child  = iter_has_child;
+        iface->iter_n_children = iter_n_children;
+        iface->iter_nth_child  = iter_nth_child;
+        iface->iter_parent     = iter_parent;
+}
+
+
+static void
+gl_merge_model_init (glMergeModel *model)
+{
+	model->priv = g_new0 (glMergeModelPrivate, 1);
+
+        model->priv->records = g_ptr_array_new ();
+        model->priv->stamp   = g_random_int ();
+}
+
+
+static void
+gl_merge_model_finalize (GObject *object)
+{
+	glMergeModel *model = GL_MERGE_MODEL (object);
+
+	g_return_if_fail (object && GL_IS_MERGE_MODEL (object));
+
+        if ( model->priv->merge )
+        {
+                g_object_unref (G_OBJECT (model->priv->merge));
+        }
+        g_ptr_array_free (model->priv->records, TRUE);
+        g_free (model->priv->primary_key);
+	g_free (model->priv);
+
+	G_OBJECT_CLASS (gl_merge_model_parent_class)->finalize (object);
+}
+
+
+/*****************************************************************************/
+/* New merge model.                                                          */
+/*****************************************************************************/
+glMergeModel *
+gl_merge_model_new (glMerge *merge)
+{
+        glMergeModel *model;
+        const GList  *p;
+
+	gl_debug (DEBUG_MERGE, "START");
+
+        model = g_object_new (GL_TYPE_MERGE_MODEL, NULL);
+
+        if ( merge )
+        {
+                model->priv->merge       = g_object_ref (G_OBJECT (merge));
+                model->priv->primary_key = gl_merge_get_primary_key (merge);
+
+                /* Only an index of the records, so rows can be found by number. */
+                for ( p = gl_merge_get_record_list (merge); p != NULL; p = p->next )
+                {
+                        g_ptr_array_add (model->priv->records, p->data);
+                }
+        }
+
+	gl_debug (DEBUG_MERGE, "END");
+
+        return model;
+}
+
+
+/*****************************************************************************/
+/* Toggle select flag of record at path.                                     */
+/*****************************************************************************/
+void
+gl_merge_model_toggle_record (glMergeModel *model,
+                              GtkTreePath  *path)
+{
+        GtkTreeIter    iter;
+        glMergeRecord *record;
+
+        g_return_if_fail (model && GL_IS_MERGE_MODEL (model));
+
+        if ( !get_iter (GTK_TREE_MODEL (model), &iter, path) || ITER_FIELD_NODE (&iter) )
+        {
+                return;
+        }
+
+        record = g_ptr_array_index (model->priv->records, ITER_RECORD_INDEX (&iter));
+        record->select_flag ^= 1;
+
+        gtk_tree_model_row_changed (GTK_TREE_MODEL (model), path, &iter);
+}
+
+
+/*****************************************************************************/
+/* Set select flag of all records.                                           */
+/*                                                                           */
+/* No per-row signals are emitted, the caller is expected to redraw its      */
+/* view.                                                                     */
+/*****************************************************************************/
+void
+gl_merge_model_set_all_selected (glMergeModel *model,
+                                 gboolean      select_flag)
+{
+        glMergeRecord *record;
+        guint          i;
+
+        g_return_if_fail (model && GL_IS_MERGE_MODEL (model));
+
+        for ( i = 0; i < model->priv->records->len; i++ )
+        {
+                record = g_ptr_array_index (model->priv->records, i);
+                record->select_flag = select_flag;
+        }
+}
+
+
+/*---------------------------------------------------------------------------*/
+/* PRIVATE.  Get model flags.                                                */
+/*---------------------------------------------------------------------------*/
+static GtkTreeModelFlags
+get_flags (GtkTreeModel *tree_model)
+{
+        return GTK_TREE_MODEL_ITERS_PERSIST;
+}
+
+
+/*---------------------------------------------------------------------------*/
+/* PRIVATE.  Get number of columns.                                          */
+/*---------------------------------------------------------------------------*/
+static gint
+get_n_columns (GtkTreeModel *tree_model)
+{
+        return GL_MERGE_MODEL_N_COLUMNS;
+}
+
+
+/*---------------------------------------------------------------------------*/
+/* PRIVATE.  Get column type.                                                */
+/*---------------------------------------------------------------------------*/
+static GType
+get_column_type (GtkTreeModel *tree_model,
+                 gint          index)
+{
+        switch (index)
+        {
+        case GL_MERGE_MODEL_SELECT_COLUMN:
+        case GL_MERGE_MODEL_IS_RECORD_COLUMN:
+                return G_TYPE_BOOLEAN;
+        case GL_MERGE_MODEL_RECORD_FIELD_COLUMN:
+        case GL_MERGE_MODEL_VALUE_COLUMN:
+                return G_TYPE_STRING;
+        case GL_MERGE_MODEL_DATA_COLUMN:
+                return G_TYPE_POINTER;
+        default:
+                g_return_val_if_reached (G_TYPE_INVALID);
+        }
+}
+
+
+/*---------------------------------------------------------------------------*/
+/* PRIVATE.  Get iter from path.                                             */
+/*---------------------------------------------------------------------------*/
+static gboolean
+get_iter (GtkTreeModel *tree_model,
+          GtkTreeIter  *iter,
+          GtkTreePath  *path)
+{
+        glMergeModel  *model = GL_MERGE_MODEL (tree_model);
+        gint          *indices;
+        gint           depth;
+        glMergeRecord *record;
+        GList         *p_field;
+
+        indices = gtk_tree_path_get_indices (path);
+        depth   = gtk_tree_path_get_depth (path);
+
+        if ( (depth < 1) || (depth > 2) ||
+             (indices[0] < 0) || (indices[0] >= (gint)model->priv->records->len) )
+        {
+                return FALSE;
+        }
+
+        if ( depth == 1 )
+        {
+                set_record_iter (model, iter, indices[0]);
+                return TRUE;
+        }
+
+        record  = g_ptr_array_index (model->priv->records, indices[0]);
+        p_field = (indices[1] >= 0) ? g_list_nth (record->field_list, indices[1]) : NULL;
+        if ( p_field == NULL )
+        {
+                return FALSE;
+        }
+
+        set_field_iter (model, iter, indices[0], p_field, indices[1]);
+        return TRUE;
+}
+
+
+/*---------------------------------------------------------------------------*/
+/* PRIVATE.  Get path from iter.                                             */
+/*---------------------------------------------------------------------------*/
+static GtkTreePath *
+get_path (GtkTreeModel *tree_model,
+          GtkTreeIter  *iter)
+{
+        glMergeModel *model = GL_MERGE_MODEL (tree_model);
+        GtkTreePath  *path;
+
+        g_return_val_if_fail (iter->stamp == model->priv->stamp, NULL);
+
+        path = gtk_tree_path_new ();
+        gtk_tree_path_append_index (path, ITER_RECORD_INDEX (iter));
+        if ( ITER_FIELD_NODE (iter) )
+        {
+                gtk_tree_path_append_index (path, ITER_FIELD_INDEX (iter));
+        }
+
+        return path;
+}
+
+
+/*---------------------------------------------------------------------------*/
+/* PRIVATE.  Get value of column at iter.                                    */
+/*---------------------------------------------------------------------------*/
+static void
+get_value (GtkTreeModel *tree_model,
+           GtkTreeIter  *iter,
+           gint          column,
+           GValue       *value)
+{
+        glMergeModel  *model = GL_MERGE_MODEL (tree_model);
+        glMergeRecord *record;
+        glMergeField  *field;
+
+        g_return_if_fail (iter->stamp == model->priv->stamp);
+
+        g_value_init (value, get_column_type (tree_model, column));
+
+        record = g_ptr_array_index (model->priv->records, ITER_RECORD_INDEX (iter));
+        field  = ITER_FIELD_NODE (iter) ? ITER_FIELD_NODE (iter)->data : NULL;
+
+        switch (column)
+        {
+        case GL_MERGE_MODEL_SELECT_COLUMN:
+                g_value_set_boolean (value, field ? FALSE : record->select_flag);
+                break;
+        case GL_MERGE_MODEL_RECORD_FIELD_COLUMN:
+                if ( field )
+                {
+                        g_value_set_string (value, field->key);
+                }
+                else
+                {
+                        /* Only evaluated for rows the view actually shows. */
+                        g_value_take_string (value,
+                                             gl_merge_eval_key (record, model->priv->primary_key));
+                }
+                break;
+        case GL_MERGE_MODEL_VALUE_COLUMN:
+                g_value_set_string (value, field ? field->value : NULL);
+                break;
+        case GL_MERGE_MODEL_IS_RECORD_COLUMN:
+                g_value_set_boolean (value, field == NULL);
+                break;
+        case GL_MERGE_MODEL_DATA_COLUMN:
+                g_value_set_pointer (value, field ? NULL : record);
+                break;
+        default:
+                break;
+        }
+}
+
+
+/*---------------------------------------------------------------------------*/
+/* PRIVATE.  Move iter to next sibling.                                      */
+/*---------------------------------------------------------------------------*/
+static gboolean
+iter_next (GtkTreeModel *tree_model,
+           GtkTreeIter  *iter)
+{
+        glMergeModel *model = GL_MERGE_MODEL (tree_model);
+        gint          i_record;
+
+        g_return_val_if_fail (iter->stamp == model->priv->stamp, FALSE);
+
+        i_record = ITER_RECORD_INDEX (iter);
+
+        if ( ITER_FIELD_NODE (iter) )
+        {
+                if ( ITER_FIELD_NODE (iter)->next == NULL )
+                {
+                        iter->stamp = 0;
+                        return FALSE;
+                }
+                set_field_iter (model, iter, i_record,
+                                ITER_FIELD_NODE (iter)->next, ITER_FIELD_INDEX (iter) + 1);
+                return TRUE;
+        }
+
+        if ( (i_record + 1) >= (gint)model->priv->records->len )
+        {
+                iter->stamp = 0;
+                return FALSE;
+        }
+        set_record_iter (model, iter, i_record + 1);
+        return TRUE;
+}
+
+
+/*---------------------------------------------------------------------------*/
+/* PRIVATE.  Get first child of parent.                                      */
+/*---------------------------------------------------------------------------*/
+static gboolean
+iter_children (GtkTreeModel *tree_model,
+               GtkTreeIter  *iter,
+               GtkTreeIter  *parent)
+{
+        return iter_nth_child (tree_model, iter, parent, 0);
+}
+
+
+/*---------------------------------------------------------------------------*/
+/* PRIVATE.  Does iter have children?                                        */
+/*---------------------------------------------------------------------------*/
+static gboolean
+iter_has_child (GtkTreeModel *tree_model,
+                GtkTreeIter  *iter)
+{
+        return iter_n_children (tree_model, iter) > 0;
+}
+
+
+/*---------------------------------------------------------------------------*/
+/* PRIVATE.  Get number of children.                                         */
+/*---------------------------------------------------------------------------*/
+static gint
+iter_n_children (GtkTreeModel *tree_model,
+                 GtkTreeIter  *iter)
+{
+        glMergeModel  *model = GL_MERGE_MODEL (tree_model);
+        glMergeRecord *record;
+
+        if ( iter == NULL )
+        {
+                return model->priv->records->len;
+        }
+
+        g_return_val_if_fail (iter->stamp == model->priv->stamp, 0);
+
+        if ( ITER_FIELD_NODE (iter) )
+        {
+                return 0;
+        }
+
+        record = g_ptr_array_index (model->priv->records, ITER_RECORD_INDEX (iter));
+        return g_list_length (record->field_list);
+}
+
+
+/*---------------------------------------------------------------------------*/
+/* PRIVATE.  Get nth child of parent.                                        */
+/*---------------------------------------------------------------------------*/
+static gboolean
+iter_nth_child (GtkTreeModel *tree_model,
+                GtkTreeIter  *iter,
+                GtkTreeIter  *parent,
+                gint          n)
+{
+        glMergeModel  *model = GL_MERGE_MODEL (tree_model);
+        glMergeRecord *record;
+        GList         *p_field;
+
+        if ( n < 0 )
+        {
+                return FALSE;
+        }
+
+        if ( parent == NULL )
+        {
+                if ( n >= (gint)model->priv->records->len )
+                {
+                        return FALSE;
+                }
+                set_record_iter (model, iter, n);
+                return TRUE;
+        }
+
+        g_return_val_if_fail (parent->stamp == model->priv->stamp, FALSE);
+
+        if ( ITER_FIELD_NODE (parent) )
+        {
+                return FALSE;
+        }
+
+        record  = g_ptr_array_index (model->priv->records, ITER_RECORD_INDEX (parent));
+        p_field = g_list_nth (record->field_list, n);
+        if ( p_field == NULL )
+        {
+                return FALSE;
+        }
+
+        set_field_iter (model, iter, ITER_RECORD_INDEX (parent), p_field, n);
+        return TRUE;
+}
+
+
+/*---------------------------------------------------------------------------*/
+/* PRIVATE.  Get parent of child.                                            */
+/*---------------------------------------------------------------------------*/
+static gboolean
+iter_parent (GtkTreeModel *tree_model,
+             GtkTreeIter  *iter,
+             GtkTreeIter  *child)
+{
+        glMergeModel *model = GL_MERGE_MODEL (tree_model);
+
+        g_return_val_if_fail (child->stamp == model->priv->stamp, FALSE);
+
+        if ( ITER_FIELD_NODE (child) == NULL )
+        {
+                return FALSE;
+        }
+
+        set_record_iter (model, iter, ITER_RECORD_INDEX (child));
+        return TRUE;
+}
+
+
+/*---------------------------------------------------------------------------*/
+/* PRIVATE.  Point iter at record row.                                       */
+/*---------------------------------------------------------------------------*/
+static void
+set_record_iter (glMergeModel *model,
+                 GtkTreeIter  *iter,
+                 gint          i_record)
+{
+        iter->stamp      = model->priv->stamp;
+        iter->user_data  = GINT_TO_POINTER (i_record);
+        iter->user_data2 = NULL;
+        iter->user_data3 = NULL;
+}
+
+
+/*---------------------------------------------------------------------------*/
+/* PRIVATE.  Point iter at field row.                                        */
+/*---------------------------------------------------------------------------*/
+static void
+set_field_iter (glMergeModel *model,
+                GtkTreeIter  *iter,
+                gint          i_record,
+                GList        *p_field,
+                gint          i_field)
+{
+        iter->stamp      = model->priv->stamp;
+        iter->user_data  = GINT_TO_POINTER (i_record);
+        iter->user_data2 = p_field;
+        iter->user_data3 = GINT_TO_POINTER (i_field);
+}
+
+
+
+
+/*
+ * Local Variables:       -- emacs
+ * mode: C                -- emacs
+ * c-basic-offset: 8      -- emacs
+ * tab-width: 8           -- emacs
+ * indent-tabs-mode: nil  -- emacs
+ * End:                   -- emacs
+ */
@@ -0,0 +1,94 @@
+/*
+ *  merge-model.h
+ *  Copyright (C) 2026  agent <agent@local>.
+ *
+ *  This file is part of gLabels.
+ *
+ *  gLabels is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  gLabels is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with gLabels.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef __MERGE_MODEL_H__
+#define __MERGE_MODEL_H__
+
+#include <gtk/gtk.h>
+#include "merge.h"
+
+G_BEGIN_DECLS
+
+/*
+ * Columns
+ */
+enum {
+	/* Real columns */
+	GL_MERGE_MODEL_SELECT_COLUMN,
+	GL_MERGE_MODEL_RECORD_FIELD_COLUMN,
+	GL_MERGE_MODEL_VALUE_COLUMN,
+
+	/* Invisible columns */
+	GL_MERGE_MODEL_IS_RECORD_COLUMN,
+	GL_MERGE_MODEL_DATA_COLUMN, /* points to glMergeRecord */
+
+	GL_MERGE_MODEL_N_COLUMNS
+};
+
+
+#define GL_TYPE_MERGE_MODEL            (gl_merge_model_get_type ())
+#define GL_MERGE_MODEL(obj)            (G_TYPE_CHECK_INSTANCE_CAST ((obj), GL_TYPE_MERGE_MODEL, glMergeModel))
+#define GL_MERGE_MODEL_CLASS(klass)    (G_TYPE_CHECK_CLASS_CAST ((klass), GL_TYPE_MERGE_MODEL, glMergeModelClass))
+#define GL_IS_MERGE_MODEL(obj)         (G_TYPE_CHECK_INSTANCE_TYPE ((obj), GL_TYPE_MERGE_MODEL))
+#define GL_IS_MERGE_MODEL_CLASS(klass) (G_TYPE_CHECK_CLASS_TYPE ((klass), GL_TYPE_MERGE_MODEL))
+
+
+typedef struct _glMergeModel          glMergeModel;
+typedef struct _glMergeModelClass     glMergeModelClass;
+
+typedef struct _glMergeModelPrivate   glMergeModelPrivate;
+
+
+struct _glMergeModel {
+	GObject              object;
+
+	glMergeModelPrivate *priv;
+};
+
+struct _glMergeModelClass {
+	GObjectClass         parent_class;
+};
+
+
+GType         gl_merge_model_get_type          (void) G_GNUC_CONST;
+
+glMergeModel *gl_merge_model_new               (glMerge      *merge);
+
+void          gl_merge_model_toggle_record     (glMergeModel *model,
+                                                GtkTreePath  *path);
+
+void          gl_merge_model_set_all_selected  (glMergeModel *model,
+                                                gboolean      select_flag);
+
+
+G_END_DECLS
+
+#endif
+
+
+
+/*
+ * Local Variables:       -- emacs
+ * mode: C                -- emacs
+ * c-basic-offset: 8      -- emacs
+ * tab-width: 8           -- emacs
+ * indent-tabs-mode: nil  -- emacs
+ * End:                   -- emacs
+ */
@@ -28,6 +28,7 @@
 
 #include "label.h"
 #include "merge.h"
+#include "merge-model.h"
 #include "combo-util.h"
 #include "builder-util.h"
 
@@ -50,7 +51,7 @@ struct _glMergePropertiesDialogPrivate {
 	GtkWidget    *location_vbox;
 	GtkWidget    *src_entry;
 
-	GtkTreeStore *store;
+	glMergeModel *model;
 	GtkWidget    *treeview;
 
 	GtkWidget    *select_all_button;
@@ -60,19 +61,10 @@ struct _glMergePropertiesDialogPrivate {
 
 	gchar        *saved_src;
 
-};
-
-enum {
-	/* Real columns */
-	SELECT_COLUMN,
-	RECORD_FIELD_COLUMN,
-	VALUE_COLUMN,
-
-	/* Invisible columns */
-	IS_RECORD_COLUMN,
-	DATA_COLUMN, /* points to glMergeRecord */
+        /* Asynchronous loading of merge source */
+        GCancellable *load_cancellable;
+        GtkWidget    *progress_bar;
 
-	N_COLUMNS
 };
 
 
@@ -100,12 +92,28 @@ static void response_cb                           (glMergePropertiesDialog
 					           gint                          response,
 						   gpointer                      user_data);
 
-static void load_tree                             (GtkTreeStore                 *store,
-					           glMerge                      *merge);
+static void destroy_cb                            (glMergePropertiesDialog      *dialog);
+
+static void load_src                              (glMergePropertiesDialog      *dialog,
+						   const gchar                  *src);
+
+static void cancel_load                           (glMergePropertiesDialog      *dialog);
+
+static void load_progress_cb                      (glMerge                      *merge,
+						   gint                          n_records,
+						   goffset                       n_bytes,
+						   goffset                       total_bytes,
+						   glMergePropertiesDialog      *dialog);
+
+static void load_done_cb                          (GObject                      *source,
+						   GAsyncResult                 *result,
+						   glMergePropertiesDialog      *dialog);
+
+static void load_tree                             (glMergePropertiesDialog      *dialog);
 
 static void record_select_toggled_cb              (GtkCellRendererToggle        *cell,
 						   gchar                        *path_str,
-						   GtkTreeStore                 *store);
+						   glMergePropertiesDialog      *dialog);
 
 static void select_all_button_clicked_cb          (GtkWidget                    *widget,
 						   glMergePropertiesDialog      *dialog);
@@ -184,6 +192,11 @@ gl_merge_properties_dialog_init (glMergePropertiesDialog *dialog)
 	gtk_container_add (GTK_CONTAINER (vbox), merge_properties_vbox);
         dialog->priv->builder = builder;
 
+        dialog->priv->progress_bar = gtk_progress_bar_new ();
+        gtk_progress_bar_set_show_text (GTK_PROGRESS_BAR (dialog->priv->progress_bar), TRUE);
+        gtk_widget_set_no_show_all (dialog->priv->progress_bar, TRUE);
+        gtk_box_pack_start (GTK_BOX (vbox), dialog->priv->progress_bar, FALSE, FALSE, 0);
+
         dialog->priv->type_combo = gtk_combo_box_text_new ();
         gtk_box_pack_start (GTK_BOX (dialog->priv->type_combo_hbox), dialog->priv->type_combo, TRUE, TRUE, 0);
 	gtk_widget_show_all (GTK_WIDGET (dialog->priv->type_combo));
@@ -209,6 +222,12 @@ gl_merge_properties_dialog_finalize (GObject *object)
 	if (dialog->priv->merge != NULL) {
 		g_object_unref (G_OBJECT (dialog->priv->merge));
 	}
+	if (dialog->priv->model != NULL) {
+		g_object_unref (G_OBJECT (dialog->priv->model));
+	}
+	if (dialog->priv->load_cancellable != NULL) {
+		g_object_unref (G_OBJECT (dialog->priv->load_cancellable));
+	}
 	if (dialog->priv->builder != NULL) {
 		g_object_unref (G_OBJECT (dialog->priv->builder));
 	}
@@ -320,45 +339,55 @@ gl_merge_properties_dialog_construct (glMergePropertiesDialog *dialog,
 			    dialog->priv->src_entry, FALSE, FALSE, 0);
 	gtk_widget_show_all (GTK_WIDGET (dialog->priv->location_vbox));
 
-	dialog->priv->store = gtk_tree_store_new (N_COLUMNS,
-					  G_TYPE_BOOLEAN, /* Record selector */
-					  G_TYPE_STRING,  /* Record/Field name */
-					  G_TYPE_STRING,  /* Field value */
-					  G_TYPE_BOOLEAN, /* Is Record? */
-					  G_TYPE_POINTER  /* Pointer to record */);
-	load_tree (dialog->priv->store, dialog->priv->merge);
-
-	gtk_tree_view_set_model (GTK_TREE_VIEW (dialog->priv->treeview),
-				 GTK_TREE_MODEL (dialog->priv->store));
+	load_tree (dialog);
 
 	gtk_tree_view_set_rules_hint (GTK_TREE_VIEW (dialog->priv->treeview),
 				      TRUE);
 	selection = gtk_tree_view_get_selection (GTK_TREE_VIEW (dialog->priv->treeview));
 	gtk_tree_selection_set_mode (selection, GTK_SELECTION_NONE);
+
+	/*
+	 * All rows have the same fixed height, so the view only needs to look
+	 * at the rows it actually displays, rather than measuring every record.
+	 */
 	renderer = gtk_cell_renderer_toggle_new ();
 	g_signal_connect (G_OBJECT (renderer), "toggled",
-			  G_CALLBACK (record_select_toggled_cb), dialog->priv->store);
+			  G_CALLBACK (record_select_toggled_cb), dialog);
 	column = gtk_tree_view_column_new_with_attributes (_("Select"), renderer,
-							   "active", SELECT_COLUMN,
-							   "visible", IS_RECORD_COLUMN,
+							   "active", GL_MERGE_MODEL_SELECT_COLUMN,
+							   "visible", GL_MERGE_MODEL_IS_RECORD_COLUMN,
 							   NULL);
+	gtk_tree_view_column_set_sizing (column, GTK_TREE_VIEW_COLUMN_FIXED);
+	gtk_tree_view_column_set_fixed_width (column, 60);
 	gtk_tree_view_append_column (GTK_TREE_VIEW (dialog->priv->treeview), column);
 	renderer = gtk_cell_renderer_text_new ();
-	g_object_set (G_OBJECT (renderer), "yalign", 0.0, NULL);
+	g_object_set (G_OBJECT (renderer),
+		      "ellipsize", PANGO_ELLIPSIZE_END,
+		      "single-paragraph-mode", TRUE,
+		      NULL);
 	column = gtk_tree_view_column_new_with_attributes (_("Record/Field"), renderer,
-							   "text", RECORD_FIELD_COLUMN,
+							   "text", GL_MERGE_MODEL_RECORD_FIELD_COLUMN,
 							   NULL);
-	gtk_tree_view_column_set_sizing (column, GTK_TREE_VIEW_COLUMN_AUTOSIZE);
+	gtk_tree_view_column_set_sizing (column, GTK_TREE_VIEW_COLUMN_FIXED);
+	gtk_tree_view_column_set_fixed_width (column, 180);
+	gtk_tree_view_column_set_resizable (column, TRUE);
 	gtk_tree_view_append_column (GTK_TREE_VIEW (dialog->priv->treeview), column);
 	gtk_tree_view_set_expander_column (GTK_TREE_VIEW (dialog->priv->treeview), column);
 	renderer = gtk_cell_renderer_text_new ();
-	g_object_set (G_OBJECT (renderer), "yalign", 0.0, NULL);
+	g_object_set (G_OBJECT (renderer),
+		      "ellipsize", PANGO_ELLIPSIZE_END,
+		      "single-paragraph-mode", TRUE,
+		      NULL);
 	column = gtk_tree_view_column_new_with_attributes (_("Data"), renderer,
-							   "text", VALUE_COLUMN,
+							   "text", GL_MERGE_MODEL_VALUE_COLUMN,
 							   NULL);
-	gtk_tree_view_column_set_sizing (column, GTK_TREE_VIEW_COLUMN_AUTOSIZE);
+	gtk_tree_view_column_set_sizing (column, GTK_TREE_VIEW_COLUMN_FIXED);
+	gtk_tree_view_column_set_fixed_width (column, 220);
+	gtk_tree_view_column_set_resizable (column, TRUE);
 	gtk_tree_view_append_column (GTK_TREE_VIEW (dialog->priv->treeview), column);
 
+	gtk_tree_view_set_fixed_height_mode (GTK_TREE_VIEW (dialog->priv->treeview), TRUE);
+
 	g_signal_connect (G_OBJECT (dialog->priv->select_all_button),
 			  "clicked",
 			  G_CALLBACK (select_all_button_clicked_cb), dialog);
@@ -378,6 +407,8 @@ gl_merge_properties_dialog_construct (glMergePropertiesDialog *dialog,
 
 	g_signal_connect(G_OBJECT (dialog), "response",
 			 G_CALLBACK (response_cb), NULL);
+	g_signal_connect(G_OBJECT (dialog), "destroy",
+			 G_CALLBACK (destroy_cb), NULL);
 
 	gl_debug (DEBUG_MERGE, "END");
 }
@@ -407,6 +438,8 @@ type_changed_cb (GtkWidget               *widget,
 		dialog->priv->saved_src = src;
 	}
 
+	cancel_load (dialog);
+
 	if (dialog->priv->merge != NULL) {
 		g_object_unref (G_OBJECT(dialog->priv->merge));
 	}
@@ -425,7 +458,7 @@ type_changed_cb (GtkWidget               *widget,
 			gl_debug (DEBUG_MERGE, "Setting src = \"%s\"", dialog->priv->saved_src);
 			gtk_file_chooser_set_filename (GTK_FILE_CHOOSER (dialog->priv->src_entry),
 						       dialog->priv->saved_src);
-			gl_merge_set_src (dialog->priv->merge, dialog->priv->saved_src);
+			load_src (dialog, dialog->priv->saved_src);
 		}
 		g_signal_connect (G_OBJECT (dialog->priv->src_entry),
 				  "selection-changed",
@@ -451,7 +484,7 @@ type_changed_cb (GtkWidget               *widget,
 			    dialog->priv->src_entry, FALSE, FALSE, 0);
 	gtk_widget_show_all (dialog->priv->location_vbox);
 
-	load_tree (dialog->priv->store, dialog->priv->merge);
+	load_tree (dialog);
 
 	g_free (description);
 	g_free (name);
@@ -480,8 +513,7 @@ src_changed_cb (GtkWidget               *widget,
 	    ((orig_src != NULL) && (src == NULL)) ||
 	    ((orig_src != NULL) && (src != NULL) && strcmp (src, orig_src)))
 	{
-		gl_merge_set_src (dialog->priv->merge, src);
-		load_tree (dialog->priv->store, dialog->priv->merge);
+		load_src (dialog, src);
 	}
 
 	g_free (orig_src);
@@ -524,92 +556,166 @@ response_cb (glMergePropertiesDialog *dialog,
 
 
 /*--------------------------------------------------------------------------*/
-/* PRIVATE.  Load tree store from merge data.                               */
+/* PRIVATE.  "destroy" callback.                                            */
 /*--------------------------------------------------------------------------*/
 static void
-load_tree (GtkTreeStore           *store,
-	   glMerge                *merge)
+destroy_cb (glMergePropertiesDialog *dialog)
 {
-	const GList   *record_list;
-	GList         *p_rec, *p_field;
-	glMergeRecord *record;
-	glMergeField  *field;
-	GtkTreeIter    iter1, iter2;
-	gchar         *primary_key;
-	gchar         *primary_value;
+	cancel_load (dialog);
+}
+
 
+/*--------------------------------------------------------------------------*/
+/* PRIVATE.  Start loading merge source in the background.                  */
+/*--------------------------------------------------------------------------*/
+static void
+load_src (glMergePropertiesDialog *dialog,
+	  const gchar             *src)
+{
 	gl_debug (DEBUG_MERGE, "START");
 
-	gtk_tree_store_clear (store);
+	cancel_load (dialog);
+
+	dialog->priv->load_cancellable = g_cancellable_new ();
 
-	primary_key = gl_merge_get_primary_key (merge);
-	record_list = gl_merge_get_record_list (merge);
+	/* The dialog is kept alive until loading is done or cancelled. */
+	gl_merge_set_src_async (dialog->priv->merge, src,
+				dialog->priv->load_cancellable,
+				(glMergeProgressFunc)load_progress_cb, dialog,
+				(GAsyncReadyCallback)load_done_cb, g_object_ref (dialog));
 
-	for ( p_rec=(GList *)record_list; p_rec!=NULL; p_rec=p_rec->next ) {
-		record = (glMergeRecord *)p_rec->data;
-		
-		primary_value = gl_merge_eval_key (record, primary_key);
+	gtk_progress_bar_set_fraction (GTK_PROGRESS_BAR (dialog->priv->progress_bar), 0.0);
+	gtk_progress_bar_set_text (GTK_PROGRESS_BAR (dialog->priv->progress_bar), _("Loading..."));
+	gtk_widget_show (dialog->priv->progress_bar);
+	gtk_widget_set_sensitive (dialog->priv->ok_button, FALSE);
+
+	/* Records have been dropped until the load completes. */
+	load_tree (dialog);
+
+	gl_debug (DEBUG_MERGE, "END");
+}
 
-		gtk_tree_store_append (store, &iter1, NULL);
-		gtk_tree_store_set (store, &iter1,
-				    SELECT_COLUMN,       record->select_flag,
-				    RECORD_FIELD_COLUMN, primary_value,
-				    IS_RECORD_COLUMN,    TRUE,
-				    DATA_COLUMN,         record,
-				    -1);
 
-		g_free (primary_value);
+/*--------------------------------------------------------------------------*/
+/* PRIVATE.  Cancel loading of merge source, if any.                        */
+/*--------------------------------------------------------------------------*/
+static void
+cancel_load (glMergePropertiesDialog *dialog)
+{
+	if (dialog->priv->load_cancellable != NULL) {
+		g_cancellable_cancel (dialog->priv->load_cancellable);
+		g_object_unref (G_OBJECT (dialog->priv->load_cancellable));
+		dialog->priv->load_cancellable = NULL;
 
-		for ( p_field=record->field_list; p_field!=NULL; p_field=p_field->next ) {
-			field = (glMergeField *)p_field->data;
+		gtk_widget_hide (dialog->priv->progress_bar);
+		gtk_widget_set_sensitive (dialog->priv->ok_button, TRUE);
+	}
+}
+
+
+/*--------------------------------------------------------------------------*/
+/* PRIVATE.  Merge source load progress callback.                           */
+/*--------------------------------------------------------------------------*/
+static void
+load_progress_cb (glMerge                 *merge,
+		  gint                     n_records,
+		  goffset                  n_bytes,
+		  goffset                  total_bytes,
+		  glMergePropertiesDialog *dialog)
+{
+	gchar *text;
+
+	if ( (n_bytes >= 0) && (total_bytes > 0) ) {
+		gtk_progress_bar_set_fraction (GTK_PROGRESS_BAR (dialog->priv->progress_bar),
+					       MIN (1.0, (gdouble)n_bytes / (gdouble)total_bytes));
+	} else {
+		gtk_progress_bar_pulse (GTK_PROGRESS_BAR (dialog->priv->progress_bar));
+	}
+
+	text = g_strdup_printf (ngettext ("Loading... %d record", "Loading... %d records", n_records),
+				n_records);
+	gtk_progress_bar_set_text (GTK_PROGRESS_BAR (dialog->priv->progress_bar), text);
+	g_free (text);
+}
 
-			gtk_tree_store_append (store, &iter2, &iter1);
-			gtk_tree_store_set (store, &iter2,
-					    RECORD_FIELD_COLUMN, field->key,
-					    VALUE_COLUMN,        field->value,
-					    IS_RECORD_COLUMN,    FALSE,
-					    -1);
+
+/*--------------------------------------------------------------------------*/
+/* PRIVATE.  Merge source load done callback.                               */
+/*--------------------------------------------------------------------------*/
+static void
+load_done_cb (GObject                 *source,
+	      GAsyncResult            *result,
+	      glMergePropertiesDialog *dialog)
+{
+	GError *error = NULL;
+
+	gl_debug (DEBUG_MERGE, "START");
+
+	if ( gl_merge_set_src_finish (GL_MERGE (source), result, &error) ) {
+
+		if ( GL_MERGE (source) == dialog->priv->merge ) {
+			g_object_unref (G_OBJECT (dialog->priv->load_cancellable));
+			dialog->priv->load_cancellable = NULL;
+
+			gtk_widget_hide (dialog->priv->progress_bar);
+			gtk_widget_set_sensitive (dialog->priv->ok_button, TRUE);
+
+			load_tree (dialog);
 		}
+
+	} else {
+
+		if ( !g_error_matches (error, G_IO_ERROR, G_IO_ERROR_CANCELLED) ) {
+			g_message ("Cannot load merge source: %s", error->message);
+			cancel_load (dialog);
+		}
+		g_error_free (error);
+
 	}
 
-	g_free (primary_key);
+	g_object_unref (G_OBJECT (dialog));
 
 	gl_debug (DEBUG_MERGE, "END");
 }
 
 
 /*--------------------------------------------------------------------------*/
-/* PRIVATE.  Record select toggled.                                         */
+/* PRIVATE.  Load tree from merge data.                                     */
+/*                                                                          */
+/* The model reads rows directly from the merge records, so this is cheap   */
+/* regardless of the number of records.                                     */
 /*--------------------------------------------------------------------------*/
 static void
-record_select_toggled_cb (GtkCellRendererToggle *cell,
-			  gchar                 *path_str,
-			  GtkTreeStore          *store)
+load_tree (glMergePropertiesDialog *dialog)
 {
-	GtkTreePath   *path;
-	GtkTreeIter    iter;
-	glMergeRecord *record;
-
 	gl_debug (DEBUG_MERGE, "START");
 
-	/* get toggled iter */
-	path = gtk_tree_path_new_from_string (path_str);
-	gtk_tree_model_get_iter (GTK_TREE_MODEL (store), &iter, path);
+	if (dialog->priv->model != NULL) {
+		g_object_unref (G_OBJECT (dialog->priv->model));
+	}
+	dialog->priv->model = gl_merge_model_new (dialog->priv->merge);
 
-	/* get current data */
-	gtk_tree_model_get (GTK_TREE_MODEL (store), &iter,
-			    DATA_COLUMN,   &record,
-			    -1);
+	gtk_tree_view_set_model (GTK_TREE_VIEW (dialog->priv->treeview),
+				 GTK_TREE_MODEL (dialog->priv->model));
 
-	/* toggle the select flag within the record */
-	record->select_flag ^= 1;
+	gl_debug (DEBUG_MERGE, "END");
+}
 
-	/* set new value in store */
-	gtk_tree_store_set (store, &iter,
-			    SELECT_COLUMN, record->select_flag,
-			    -1);
 
-	/* clean up */
+/*--------------------------------------------------------------------------*/
+/* PRIVATE.  Record select toggled.                                         */
+/*--------------------------------------------------------------------------*/
+static void
+record_select_toggled_cb (GtkCellRendererToggle   *cell,
+			  gchar                   *path_str,
+			  glMergePropertiesDialog *dialog)
+{
+	GtkTreePath   *path;
+
+	gl_debug (DEBUG_MERGE, "START");
+
+	path = gtk_tree_path_new_from_string (path_str);
+	gl_merge_model_toggle_record (dialog->priv->model, path);
 	gtk_tree_path_free (path);
 
 	gl_debug (DEBUG_MERGE, "END");
@@ -623,33 +729,10 @@ static void
 select_all_button_clicked_cb (GtkWidget                    *widget,
 			      glMergePropertiesDialog      *dialog)
 {
-	GtkTreeModel  *store = GTK_TREE_MODEL (dialog->priv->store);
-	GtkTreeIter    iter;
-	glMergeRecord *record;
-	gboolean       good;
-
 	gl_debug (DEBUG_MERGE, "START");
 
-	for ( good = gtk_tree_model_get_iter_first (store, &iter);
-	      good;
-	      good = gtk_tree_model_iter_next (store, &iter) )
-	{
-		
-		/* get current data */
-		gtk_tree_model_get (GTK_TREE_MODEL (store), &iter,
-				    DATA_COLUMN,   &record,
-				    -1);
-
-		
-		/* Set select flag within the record */
-		record->select_flag = TRUE;
-
-		/* set new value in store */
-		gtk_tree_store_set (GTK_TREE_STORE (store), &iter,
-				    SELECT_COLUMN, record->select_flag,
-				    -1);
-
-	}
+	gl_merge_model_set_all_selected (dialog->priv->model, TRUE);
+	gtk_widget_queue_draw (dialog->priv->treeview);
 
 	gl_debug (DEBUG_MERGE, "END");
 }
@@ -662,33 +745,10 @@ static void
 unselect_all_button_clicked_cb (GtkWidget                    *widget,
 				glMergePropertiesDialog      *dialog)
 {
-	GtkTreeModel  *store = GTK_TREE_MODEL (dialog->priv->store);
-	GtkTreeIter    iter;
-	glMergeRecord *record;
-	gboolean       good;
-
 	gl_debug (DEBUG_MERGE, "START");
 
-	for ( good = gtk_tree_model_get_iter_first (store, &iter);
-	      good;
-	      good = gtk_tree_model_iter_next (store, &iter) )
-	{
-		
-		/* get current data */
-		gtk_tree_model_get (GTK_TREE_MODEL (store), &iter,
-				    DATA_COLUMN,   &record,
-				    -1);
-
-		
-		/* Set select flag within the record */
-		record->select_flag = FALSE;
-
-		/* set new value in store */
-		gtk_tree_store_set (GTK_TREE_STORE (store), &iter,
-				    SELECT_COLUMN, record->select_flag,
-				    -1);
-
-	}
+	gl_merge_model_set_all_selected (dialog->priv->model, FALSE);
+	gtk_widget_queue_draw (dialog->priv->treeview);
 
 	gl_debug (DEBUG_MERGE, "END");
 }
@@ -109,9 +109,15 @@ static void           gl_merge_text_close           (glMerge          *merge);
 static glMergeRecord *gl_merge_text_get_record      (glMerge          *merge);
 static void           gl_merge_text_copy            (glMerge          *dst_merge,
                                                      const glMerge    *src_merge);
+static goffset        gl_merge_text_get_position    (glMerge          *merge);
+static gboolean       gl_merge_text_skip_record     (glMerge          *merge);
+static gboolean       gl_merge_text_seek            (glMerge          *merge,
+                                                     goffset           position);
 
 static GList         *parse_line                    (glMergeText       *merge_text,
                                                      gchar             delim);
+static gboolean       skip_line                     (glMergeText       *merge_text,
+                                                     gchar             delim);
 static void           free_fields                   (GList           **fields);
 
 
@@ -157,6 +163,9 @@ gl_merge_text_class_init (glMergeTextClass *class)
         merge_class->close           = gl_merge_text_close;
         merge_class->get_record      = gl_merge_text_get_record;
         merge_class->copy            = gl_merge_text_copy;
+        merge_class->get_position    = gl_merge_text_get_position;
+        merge_class->skip_record     = gl_merge_text_skip_record;
+        merge_class->seek            = gl_merge_text_seek;
 
         gl_debug (DEBUG_MERGE, "END");
 }
@@ -644,6 +653,7 @@ gl_merge_text_copy (glMerge       *dst_merge,
         dst_merge_text->priv->delim          = src_merge_text->priv->delim;
         dst_merge_text->priv->line1_has_keys = src_merge_text->priv->line1_has_keys;
 
+        clear_keys (dst_merge_text);
         for ( i=0; i < src_merge_text->priv->keys->len; i++ )
         {
                 g_ptr_array_add (dst_merge_text->priv->keys,
@@ -654,6 +664,62 @@ gl_merge_text_copy (glMerge       *dst_merge,
 }
 
 
+/*---------------------------------------------------------------------------*/
+/* Get position within opened source.                                        */
+/*---------------------------------------------------------------------------*/
+static goffset
+gl_merge_text_get_position (glMerge *merge)
+{
+        glMergeText *merge_text = GL_MERGE_TEXT (merge);
+
+        if ( (merge_text->priv->fp == NULL) || (merge_text->priv->fp == stdin) )
+        {
+                return -1;
+        }
+
+        return ftello (merge_text->priv->fp);
+}
+
+
+/*---------------------------------------------------------------------------*/
+/* Skip next record of opened source, FALSE if no records left.              */
+/*---------------------------------------------------------------------------*/
+static gboolean
+gl_merge_text_skip_record (glMerge *merge)
+{
+        glMergeText *merge_text = GL_MERGE_TEXT (merge);
+
+        return skip_line (merge_text, merge_text->priv->delim);
+}
+
+
+/*---------------------------------------------------------------------------*/
+/* Continue reading opened source at a position from get_position().         */
+/*---------------------------------------------------------------------------*/
+static gboolean
+gl_merge_text_seek (glMerge *merge,
+                    goffset  position)
+{
+        glMergeText *merge_text = GL_MERGE_TEXT (merge);
+
+        if ( (merge_text->priv->fp == NULL) || (merge_text->priv->fp == stdin) )
+        {
+                return FALSE;
+        }
+
+        if ( fseeko (merge_text->priv->fp, position, SEEK_SET) != 0 )
+        {
+                return FALSE;
+        }
+
+        /* Records end on a newline, so no converted characters are pending. */
+        merge_text->priv->buf_pos = 0;
+        merge_text->priv->buf_len = 0;
+
+        return TRUE;
+}
+
+
 /*---------------------------------------------------------------------------*/
 /* PRIVATE.  Parse line.                                                     */
 /*                                                                           */
@@ -888,6 +954,127 @@ parse_line (glMergeText* merge_text,
 }
 
 
+/*---------------------------------------------------------------------------*/
+/* PRIVATE.  Skip line.                                                      */
+/*                                                                           */
+/* Same state machine as parse_line(), but only tracks where the line ends,  */
+/* without decoding or keeping any fields.                                   */
+/*                                                                           */
+/* Returns FALSE when done, i.e. when parse_line() would have returned NULL. */
+/*---------------------------------------------------------------------------*/
+static gboolean
+skip_line (glMergeText* merge_text,
+           gchar  delim )
+{
+        gboolean line_flag;
+        gint     c;
+        enum { DELIM,
+               QUOTED, QUOTED_QUOTE1, QUOTED_ESCAPED,
+               SIMPLE, SIMPLE_ESCAPED,
+               DONE } state;
+
+        if (merge_text->priv->fp == NULL) {
+                return FALSE;
+        }
+
+        state     = DELIM;
+        line_flag = FALSE;
+        while ( state != DONE ) {
+                c=gl_getc (merge_text);
+
+                switch (state) {
+
+                case DELIM:
+                        if ( c == EOF )
+                        {
+                                state = DONE;
+                        }
+                        else if ( c == '\n' )
+                        {
+                                line_flag = TRUE;
+                                state = DONE;
+                        }
+                        else if ( c == '"' )
+                        {
+                                line_flag = TRUE;
+                                state = QUOTED;
+                        }
+                        else if ( c == '\\' )
+                        {
+                                line_flag = TRUE;
+                                state = SIMPLE_ESCAPED;
+                        }
+                        else if ( c != '\r' )
+                        {
+                                line_flag = TRUE;
+                                state = (c == delim) ? DELIM : SIMPLE;
+                        }
+                        break;
+
+                case QUOTED:
+                        if ( c == EOF )
+                        {
+                                state = DONE;
+                        }
+                        else if ( c == '"' )
+                        {
+                                state = QUOTED_QUOTE1;
+                        }
+                        else if ( c == '\\' )
+                        {
+                                state = QUOTED_ESCAPED;
+                        }
+                        break;
+
+                case QUOTED_QUOTE1:
+                        if ( (c == '\n') || (c == EOF) )
+                        {
+                                state = DONE;
+                        }
+                        else if ( c == '"' )
+                        {
+                                state = QUOTED;
+                        }
+                        else
+                        {
+                                state = (c == delim) ? DELIM : SIMPLE;
+                        }
+                        break;
+
+                case QUOTED_ESCAPED:
+                        state = (c == EOF) ? DONE : QUOTED;
+                        break;
+
+                case SIMPLE:
+                        if ( (c == '\n') || (c == EOF) )
+                        {
+                                state = DONE;
+                        }
+                        else if ( c == '\\' )
+                        {
+                                state = SIMPLE_ESCAPED;
+                        }
+                        else if ( c == delim )
+                        {
+                                state = DELIM;
+                        }
+                        break;
+
+                case SIMPLE_ESCAPED:
+                        state = (c == EOF) ? DONE : SIMPLE;
+                        break;
+
+                default:
+                        g_assert_not_reached();
+                        break;
+                }
+
+        }
+
+        return line_flag;
+}
+
+
 /*---------------------------------------------------------------------------*/
 /* Free list of fields.                                                      */
 /*---------------------------------------------------------------------------*/
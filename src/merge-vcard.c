@@ -80,6 +80,7 @@ static void           gl_merge_vcard_close           (glMerge          *merge);
 static glMergeRecord *gl_merge_vcard_get_record      (glMerge          *merge);
 static void           gl_merge_vcard_copy            (glMerge          *dst_merge,
                                                       const glMerge    *src_merge);
+static goffset        gl_merge_vcard_get_position    (glMerge          *merge);
 static char *         parse_next_vcard               (FILE             *fp);
 
 
@@ -110,6 +111,7 @@ gl_merge_vcard_class_init (glMergeVCardClass *class)
         merge_class->close           = gl_merge_vcard_close;
         merge_class->get_record      = gl_merge_vcard_get_record;
         merge_class->copy            = gl_merge_vcard_copy;
+        merge_class->get_position    = gl_merge_vcard_get_position;
 
         gl_debug (DEBUG_MERGE, "END");
 }
@@ -385,6 +387,23 @@ gl_merge_vcard_copy (glMerge       *dst_merge,
 }
 
 
+/*---------------------------------------------------------------------------*/
+/* Get position within opened source.                                        */
+/*---------------------------------------------------------------------------*/
+static goffset
+gl_merge_vcard_get_position (glMerge *merge)
+{
+        glMergeVCard *merge_vcard = GL_MERGE_VCARD (merge);
+
+        if ( merge_vcard->priv->fp == NULL )
+        {
+                return -1;
+        }
+
+        return ftello (merge_vcard->priv->fp);
+}
+
+
 /*---------------------------------------------------------------------------*/
 /* PRIVATE: pull out a full VCard from the open file                         */
 /* Arguments:                                                                */
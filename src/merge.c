@@ -25,6 +25,7 @@
 #include <glib/gi18n.h>
 #include <gobject/gvaluecollector.h>
 #include <string.h>
+#include <glib/gstdio.h>
 
 #include <libglabels.h>
 
@@ -41,12 +42,45 @@ struct _glMergePrivate {
 	glMergeSrcType     src_type;
 
 	GList             *record_list;
+	gint               record_offset; /* Records of src before record_list */
+
+	gchar             *index_src;     /* src that index was built for */
+	GArray            *index;         /* IndexEntries, by record */
+
+	guint              load_serial;   /* Identifies latest load */
 };
 
 enum {
 	LAST_SIGNAL
 };
 
+typedef struct {
+	guint              serial;
+	glMerge           *loader;        /* Private instance, owned by worker */
+	gchar             *src;
+	GList             *record_list;
+
+	glMergeProgressFunc progress_func;
+	gpointer           progress_data;
+} LoadData;
+
+typedef struct {
+	glMerge           *merge;
+	guint              serial;
+	GCancellable      *cancellable;
+	gint               n_records;
+	goffset            n_bytes;
+	goffset            total_bytes;
+
+	glMergeProgressFunc progress_func;
+	gpointer           progress_data;
+} LoadProgress;
+
+typedef struct {
+	gint               i_record;
+	goffset            position;      /* Where record i_record starts */
+} IndexEntry;
+
 typedef struct {
 
 	GType              type;
@@ -59,6 +93,16 @@ typedef struct {
 
 } Backend;
 
+/*========================================================*/
+/* Private macros and constants.                          */
+/*========================================================*/
+
+/* Minimum interval between progress reports, in microseconds. */
+#define LOAD_PROGRESS_INTERVAL (100 * 1000)
+
+/* Records between entries of a source index. */
+#define INDEX_INTERVAL 1024
+
 /*========================================================*/
 /* Private globals.                                       */
 /*========================================================*/
@@ -85,6 +129,42 @@ static void           merge_free_record_list (GList               **record_list)
 
 static GList         *merge_dup_record_list  (GList                *record_list);
 
+static GList         *merge_read_records     (glMerge              *merge);
+
+static goffset        merge_get_position     (glMerge              *merge);
+
+static gboolean       merge_skip_record      (glMerge              *merge);
+
+static gint           merge_skip_records     (glMerge              *merge,
+					      gint                  n_records);
+
+static void           merge_use_index        (glMerge              *merge,
+					      const gchar          *src);
+
+static void           merge_index_record     (glMerge              *merge,
+					      gint                  i_record);
+
+static gint           merge_find_index       (const glMerge        *merge,
+					      gint                  i_record);
+
+static void           merge_free_index       (glMerge              *merge);
+
+static void           load_data_free         (LoadData             *data);
+
+static void           load_thread            (GTask                *task,
+					      glMerge              *merge,
+					      LoadData             *data,
+					      GCancellable         *cancellable);
+
+static void           load_report_progress   (GTask                *task,
+					      LoadData             *data,
+					      gint                  n_records,
+					      goffset               total_bytes);
+
+static gboolean       load_progress_cb       (LoadProgress         *progress);
+
+static void           load_progress_free     (LoadProgress         *progress);
+
 
 
 
@@ -262,6 +342,7 @@ gl_merge_finalize (GObject *object)
 	g_return_if_fail (object && GL_IS_MERGE (object));
 
 	merge_free_record_list (&merge->priv->record_list);
+	merge_free_index (merge);
 	g_free (merge->priv->name);
 	g_free (merge->priv->description);
 	g_free (merge->priv->src);
@@ -334,6 +415,17 @@ gl_merge_dup (const glMerge *src_merge)
 	dst_merge->priv->src_type    = src_merge->priv->src_type;
 	dst_merge->priv->record_list 
 		= merge_dup_record_list (src_merge->priv->record_list);
+	dst_merge->priv->record_offset = src_merge->priv->record_offset;
+
+	if ( src_merge->priv->index != NULL ) {
+		dst_merge->priv->index_src = g_strdup (src_merge->priv->index_src);
+		dst_merge->priv->index
+			= g_array_sized_new (FALSE, FALSE, sizeof (IndexEntry),
+					     src_merge->priv->index->len);
+		g_array_append_vals (dst_merge->priv->index,
+				     src_merge->priv->index->data,
+				     src_merge->priv->index->len);
+	}
 
 	if ( GL_MERGE_GET_CLASS(src_merge)->copy != NULL ) {
 
@@ -405,9 +497,6 @@ void
 gl_merge_set_src (glMerge       *merge,
 		  const gchar   *src)
 {
-	GList         *record_list = NULL;
-	glMergeRecord *record;
-
 	gl_debug (DEBUG_MERGE, "START");
 
 	if (merge == NULL)
@@ -418,6 +507,9 @@ gl_merge_set_src (glMerge       *merge,
 
 	g_return_if_fail (GL_IS_MERGE (merge));
 
+	/* Supersede any pending asynchronous load. */
+	merge->priv->load_serial++;
+
 	if ( src == NULL)
 	{
 
@@ -427,6 +519,7 @@ gl_merge_set_src (glMerge       *merge,
 		}
 		merge->priv->src = NULL;
 		merge_free_record_list (&merge->priv->record_list);
+		merge->priv->record_offset = 0;
 
 	}
 	else
@@ -439,21 +532,325 @@ gl_merge_set_src (glMerge       *merge,
 		merge->priv->src = g_strdup (src);
 
 		merge_free_record_list (&merge->priv->record_list);
-			
-		merge_open (merge);
-		while ( (record = merge_get_record (merge)) != NULL )
+		merge->priv->record_offset = 0;
+
+		merge->priv->record_list = merge_read_records (merge);
+
+	}
+		     
+
+	gl_debug (DEBUG_MERGE, "END");
+}
+
+/*****************************************************************************/
+/* Set src of merge, reading records in a worker thread.                     */
+/*                                                                           */
+/* The src is set and the current records are dropped immediately.  Records */
+/* are read by a private instance of the backend, so the merge itself stays  */
+/* usable meanwhile.  progress_func (if any) is called on the main loop from */
+/* time to time with the number of records and bytes read so far.  When     */
+/* loading is done, callback is called and must call                         */
+/* gl_merge_set_src_finish(), which installs the new records.  A later call  */
+/* to gl_merge_set_src() or gl_merge_set_src_async() supersedes this one.    */
+/*****************************************************************************/
+void
+gl_merge_set_src_async (glMerge             *merge,
+			const gchar         *src,
+			GCancellable        *cancellable,
+			glMergeProgressFunc  progress_func,
+			gpointer             progress_data,
+			GAsyncReadyCallback  callback,
+			gpointer             user_data)
+{
+	GTask    *task;
+	LoadData *data;
+
+	gl_debug (DEBUG_MERGE, "START");
+
+	g_return_if_fail (merge && GL_IS_MERGE (merge));
+
+	g_free (merge->priv->src);
+	merge->priv->src = g_strdup (src);
+	merge_free_record_list (&merge->priv->record_list);
+	merge->priv->record_offset = 0;
+
+	data = g_new0 (LoadData, 1);
+	data->serial        = ++merge->priv->load_serial;
+	data->src           = g_strdup (src);
+	data->progress_func = progress_func;
+	data->progress_data = progress_data;
+
+	data->loader = g_object_new (G_OBJECT_TYPE (merge), NULL);
+	data->loader->priv->name     = g_strdup (merge->priv->name);
+	data->loader->priv->src      = g_strdup (src);
+	data->loader->priv->src_type = merge->priv->src_type;
+	if ( GL_MERGE_GET_CLASS(merge)->copy != NULL ) {
+		GL_MERGE_GET_CLASS(merge)->copy (data->loader, merge);
+	}
+
+	task = g_task_new (merge, cancellable, callback, user_data);
+	g_task_set_source_tag (task, gl_merge_set_src_async);
+	g_task_set_task_data (task, data, (GDestroyNotify)load_data_free);
+
+	if ( src != NULL ) {
+		g_task_run_in_thread (task, (GTaskThreadFunc)load_thread);
+	} else {
+		g_task_return_boolean (task, TRUE);
+	}
+	g_object_unref (task);
+
+	gl_debug (DEBUG_MERGE, "END");
+}
+
+/*****************************************************************************/
+/* Finish asynchronous setting of src.                                       */
+/*****************************************************************************/
+gboolean
+gl_merge_set_src_finish (glMerge       *merge,
+			 GAsyncResult  *result,
+			 GError       **error)
+{
+	LoadData *data;
+
+	gl_debug (DEBUG_MERGE, "START");
+
+	g_return_val_if_fail (merge && GL_IS_MERGE (merge), FALSE);
+	g_return_val_if_fail (g_task_is_valid (result, merge), FALSE);
+
+	if ( !g_task_propagate_boolean (G_TASK (result), error) ) {
+		gl_debug (DEBUG_MERGE, "END (failed)");
+		return FALSE;
+	}
+
+	data = g_task_get_task_data (G_TASK (result));
+	if ( data->serial != merge->priv->load_serial ) {
+		g_set_error_literal (error, G_IO_ERROR, G_IO_ERROR_CANCELLED,
+				     "Superseded by a later merge source");
+		gl_debug (DEBUG_MERGE, "END (superseded)");
+		return FALSE;
+	}
+
+	/* Take records and backend state (e.g. keys) from the loader. */
+
+	merge_free_record_list (&merge->priv->record_list);
+	merge->priv->record_list = data->record_list;
+	data->record_list = NULL;
+
+	if ( GL_MERGE_GET_CLASS(merge)->copy != NULL ) {
+		GL_MERGE_GET_CLASS(merge)->copy (merge, data->loader);
+	}
+
+	gl_debug (DEBUG_MERGE, "END");
+
+	return TRUE;
+}
+
+/*****************************************************************************/
+/* Index src of merge, returning the number of records in it.               */
+/*                                                                           */
+/* The source is read once without keeping any records: the record list is  */
+/* left empty.  If the backend can tell and seek to its position, every Nth  */
+/* record's position is remembered, so that gl_merge_set_src_range() can     */
+/* later go straight to a record instead of reading up to it.                */
+/*****************************************************************************/
+gint
+gl_merge_index_src (glMerge     *merge,
+		    const gchar *src)
+{
+	gint n_records = 0;
+
+	gl_debug (DEBUG_MERGE, "START");
+
+	g_return_val_if_fail (merge && GL_IS_MERGE (merge), 0);
+
+	/* Supersede any pending asynchronous load. */
+	merge->priv->load_serial++;
+
+	g_free (merge->priv->src);
+	merge->priv->src = g_strdup (src);
+	merge_free_record_list (&merge->priv->record_list);
+	merge->priv->record_offset = 0;
+	merge_free_index (merge);
+
+	if ( src == NULL )
+	{
+		gl_debug (DEBUG_MERGE, "END (NULL)");
+		return 0;
+	}
+
+	merge_use_index (merge, src);
+
+	merge_open (merge);
+	for (;;)
+	{
+		merge_index_record (merge, n_records);
+
+		if ( !merge_skip_record (merge) )
 		{
-			record_list = g_list_append( record_list, record );
+			break;
 		}
-		merge_close (merge);
-		merge->priv->record_list = record_list;
+		n_records++;
+	}
+	merge_close (merge);
+
+	gl_debug (DEBUG_MERGE, "END");
+
+	return n_records;
+}
+
+/*****************************************************************************/
+/* Set src of merge, keeping only n_records records from record i_first on   */
+/* (counting from 0).  n_records < 0 means all remaining records.  Earlier   */
+/* records are skipped without being built, seeking to the closest record    */
+/* in the index of src, if any.  The index is extended as records are read.  */
+/*****************************************************************************/
+void
+gl_merge_set_src_range (glMerge     *merge,
+			const gchar *src,
+			gint         i_first,
+			gint         n_records)
+{
+	GList         *record_list = NULL;
+	glMergeRecord *record;
+	gint           i;
+
+	gl_debug (DEBUG_MERGE, "START");
+
+	g_return_if_fail (merge && GL_IS_MERGE (merge));
+
+	/* Supersede any pending asynchronous load. */
+	merge->priv->load_serial++;
 
+	g_free (merge->priv->src);
+	merge->priv->src = g_strdup (src);
+	merge_free_record_list (&merge->priv->record_list);
+	merge->priv->record_offset = 0;
+
+	if ( src == NULL )
+	{
+		gl_debug (DEBUG_MERGE, "END (NULL)");
+		return;
+	}
+
+	merge_use_index (merge, src);
+
+	merge_open (merge);
+
+	merge->priv->record_offset = merge_skip_records (merge, MAX (i_first, 0));
+
+	for ( i = 0; (n_records < 0) || (i < n_records); i++ )
+	{
+		merge_index_record (merge, merge->priv->record_offset + i);
+
+		if ( (record = merge_get_record (merge)) == NULL )
+		{
+			break;
+		}
+		record_list = g_list_prepend (record_list, record);
 	}
-		     
+
+	merge_close (merge);
+
+	merge->priv->record_list = g_list_reverse (record_list);
 
 	gl_debug (DEBUG_MERGE, "END");
 }
 
+/*****************************************************************************/
+/* Get position of the closest indexed record of src at or before i_record,  */
+/* and that record's number in *i_indexed.  Returns -1 if there is none.     */
+/* Together with gl_merge_set_index_position() this lets a later run, e.g.   */
+/* of a resumed job, seek straight back to where this one left off.          */
+/*****************************************************************************/
+goffset
+gl_merge_get_index_position (const glMerge *merge,
+			     gint           i_record,
+			     gint          *i_indexed)
+{
+	IndexEntry *entry;
+	gint        i_entry;
+
+	gl_debug (DEBUG_MERGE, "");
+
+	g_return_val_if_fail (merge && GL_IS_MERGE (merge), -1);
+	g_return_val_if_fail (i_indexed, -1);
+
+	i_entry = merge_find_index (merge, i_record);
+	if ( i_entry < 0 )
+	{
+		return -1;
+	}
+
+	entry = &g_array_index (merge->priv->index, IndexEntry, i_entry);
+	*i_indexed = entry->i_record;
+
+	return entry->position;
+}
+
+/*****************************************************************************/
+/* Remember that record i_record of src starts at position, as returned by   */
+/* gl_merge_get_index_position() for the same source.                        */
+/*****************************************************************************/
+void
+gl_merge_set_index_position (glMerge     *merge,
+			     const gchar *src,
+			     gint         i_record,
+			     goffset      position)
+{
+	IndexEntry  new_entry;
+	IndexEntry *entry;
+	guint       i;
+
+	gl_debug (DEBUG_MERGE, "");
+
+	g_return_if_fail (merge && GL_IS_MERGE (merge));
+
+	if ( (src == NULL) || (i_record < 0) || (position < 0) ||
+	     (GL_MERGE_GET_CLASS(merge)->seek == NULL) )
+	{
+		return;
+	}
+
+	merge_use_index (merge, src);
+
+	/* Keep entries in record order. */
+	for ( i = 0; i < merge->priv->index->len; i++ )
+	{
+		entry = &g_array_index (merge->priv->index, IndexEntry, i);
+		if ( entry->i_record == i_record )
+		{
+			entry->position = position;
+			return;
+		}
+		if ( entry->i_record > i_record )
+		{
+			break;
+		}
+	}
+
+	new_entry.i_record = i_record;
+	new_entry.position = position;
+	g_array_insert_val (merge->priv->index, i, new_entry);
+}
+
+/*****************************************************************************/
+/* Get number of records of src that come before the record list, i.e. the   */
+/* i_first actually reached by gl_merge_set_src_range().                     */
+/*****************************************************************************/
+gint
+gl_merge_get_record_offset (const glMerge *merge)
+{
+	gl_debug (DEBUG_MERGE, "");
+
+	if (merge == NULL) {
+		return 0;
+	}
+
+	g_return_val_if_fail (GL_IS_MERGE (merge), 0);
+
+	return merge->priv->record_offset;
+}
+
 /*****************************************************************************/
 /* Get src of merge.                                                         */
 /*****************************************************************************/
@@ -717,6 +1114,28 @@ gl_merge_get_record_list (const glMerge *merge)
 	}
 }
 
+/*****************************************************************************/
+/* Append records supplied by the caller, e.g. from memory rather than from */
+/* the merge source.  Takes ownership of record_list, a list of             */
+/* glMergeRecords whose fields are allocated with g_malloc.                  */
+/*****************************************************************************/
+void
+gl_merge_append_records (glMerge *merge,
+			 GList   *record_list)
+{
+	gl_debug (DEBUG_MERGE, "START");
+
+	g_return_if_fail (merge && GL_IS_MERGE (merge));
+
+	/* Supersede any pending asynchronous load. */
+	merge->priv->load_serial++;
+
+	merge->priv->record_list = g_list_concat (merge->priv->record_list,
+						  record_list);
+
+	gl_debug (DEBUG_MERGE, "END");
+}
+
 /*---------------------------------------------------------------------------*/
 /* Free a list of records.                                                   */
 /*---------------------------------------------------------------------------*/
@@ -765,6 +1184,337 @@ merge_dup_record_list (GList *record_list)
 	return dest_list;
 }
 
+/*---------------------------------------------------------------------------*/
+/* Read all records from merge source.                                       */
+/*---------------------------------------------------------------------------*/
+static GList *
+merge_read_records (glMerge *merge)
+{
+	GList         *record_list = NULL;
+	glMergeRecord *record;
+
+	merge_open (merge);
+	while ( (record = merge_get_record (merge)) != NULL )
+	{
+		record_list = g_list_prepend (record_list, record);
+	}
+	merge_close (merge);
+
+	return g_list_reverse (record_list);
+}
+
+/*---------------------------------------------------------------------------*/
+/* Get position within opened merge source.                                  */
+/*---------------------------------------------------------------------------*/
+static goffset
+merge_get_position (glMerge *merge)
+{
+	if ( GL_MERGE_GET_CLASS(merge)->get_position != NULL ) {
+
+		return GL_MERGE_GET_CLASS(merge)->get_position (merge);
+
+	}
+
+	return -1;
+}
+
+/*---------------------------------------------------------------------------*/
+/* Pass over next record of opened merge source, FALSE if none left.         */
+/*---------------------------------------------------------------------------*/
+static gboolean
+merge_skip_record (glMerge *merge)
+{
+	glMergeRecord *record;
+
+	if ( GL_MERGE_GET_CLASS(merge)->skip_record != NULL ) {
+
+		return GL_MERGE_GET_CLASS(merge)->skip_record (merge);
+
+	}
+
+	/* No cheap way, build the record and throw it away. */
+	if ( (record = merge_get_record (merge)) == NULL ) {
+		return FALSE;
+	}
+	merge_free_record (&record);
+
+	return TRUE;
+}
+
+/*---------------------------------------------------------------------------*/
+/* Pass over first n_records records of just opened merge source, seeking    */
+/* as far as the index allows.  Returns number of records passed over, less */
+/* than n_records if the source ran out.                                     */
+/*---------------------------------------------------------------------------*/
+static gint
+merge_skip_records (glMerge *merge,
+		    gint     n_records)
+{
+	IndexEntry *entry;
+	gint        i_entry;
+	gint        i = 0;
+
+	i_entry = merge_find_index (merge, n_records);
+	if ( i_entry >= 0 )
+	{
+		entry = &g_array_index (merge->priv->index, IndexEntry, i_entry);
+
+		if ( (entry->i_record > 0) &&
+		     GL_MERGE_GET_CLASS(merge)->seek (merge, entry->position) )
+		{
+			i = entry->i_record;
+		}
+	}
+
+	for ( ; i < n_records; i++ )
+	{
+		merge_index_record (merge, i);
+
+		if ( !merge_skip_record (merge) )
+		{
+			break;
+		}
+	}
+
+	return i;
+}
+
+/*---------------------------------------------------------------------------*/
+/* Make index belong to src, dropping it if it was for another source.  No   */
+/* index is kept if the backend cannot seek.                                 */
+/*---------------------------------------------------------------------------*/
+static void
+merge_use_index (glMerge     *merge,
+		 const gchar *src)
+{
+	if ( (merge->priv->index != NULL) &&
+	     (g_strcmp0 (merge->priv->index_src, src) == 0) )
+	{
+		return;
+	}
+
+	merge_free_index (merge);
+
+	if ( (src != NULL) && (GL_MERGE_GET_CLASS(merge)->seek != NULL) )
+	{
+		merge->priv->index_src = g_strdup (src);
+		merge->priv->index     = g_array_new (FALSE, FALSE, sizeof (IndexEntry));
+	}
+}
+
+/*---------------------------------------------------------------------------*/
+/* About to read record i_record of opened source: add every Nth record's    */
+/* position to the index, unless already there.                              */
+/*---------------------------------------------------------------------------*/
+static void
+merge_index_record (glMerge *merge,
+		    gint     i_record)
+{
+	IndexEntry entry;
+	GArray    *index = merge->priv->index;
+
+	if ( (index == NULL) || ((i_record % INDEX_INTERVAL) != 0) )
+	{
+		return;
+	}
+
+	/* Records are read in order, so new entries go at the end. */
+	if ( (index->len > 0) &&
+	     (g_array_index (index, IndexEntry, index->len - 1).i_record >= i_record) )
+	{
+		return;
+	}
+
+	entry.i_record = i_record;
+	entry.position = merge_get_position (merge);
+	if ( entry.position >= 0 )
+	{
+		g_array_append_val (index, entry);
+	}
+}
+
+/*---------------------------------------------------------------------------*/
+/* Find last index entry at or before i_record, -1 if none.                  */
+/*---------------------------------------------------------------------------*/
+static gint
+merge_find_index (const glMerge *merge,
+		  gint           i_record)
+{
+	GArray *index = merge->priv->index;
+	gint    lo, hi, mid;
+
+	if ( (index == NULL) ||
+	     (g_strcmp0 (merge->priv->index_src, merge->priv->src) != 0) )
+	{
+		return -1;
+	}
+
+	/* Binary search for first entry after i_record. */
+	lo = 0;
+	hi = index->len;
+	while ( lo < hi )
+	{
+		mid = (lo + hi) / 2;
+		if ( g_array_index (index, IndexEntry, mid).i_record <= i_record )
+		{
+			lo = mid + 1;
+		}
+		else
+		{
+			hi = mid;
+		}
+	}
+
+	return lo - 1;
+}
+
+/*---------------------------------------------------------------------------*/
+/* Forget index of merge source.                                             */
+/*---------------------------------------------------------------------------*/
+static void
+merge_free_index (glMerge *merge)
+{
+	if ( merge->priv->index != NULL )
+	{
+		g_array_free (merge->priv->index, TRUE);
+		merge->priv->index = NULL;
+	}
+	g_free (merge->priv->index_src);
+	merge->priv->index_src = NULL;
+}
+
+/*---------------------------------------------------------------------------*/
+/* Free asynchronous load data.                                              */
+/*---------------------------------------------------------------------------*/
+static void
+load_data_free (LoadData *data)
+{
+	merge_free_record_list (&data->record_list);
+	g_object_unref (G_OBJECT (data->loader));
+	g_free (data->src);
+	g_free (data);
+}
+
+/*---------------------------------------------------------------------------*/
+/* Worker thread: read records using private loader instance.                */
+/*---------------------------------------------------------------------------*/
+static void
+load_thread (GTask        *task,
+	     glMerge      *merge,
+	     LoadData     *data,
+	     GCancellable *cancellable)
+{
+	GList         *record_list = NULL;
+	glMergeRecord *record;
+	gint           n_records = 0;
+	goffset        total_bytes = -1;
+	gint64         last_report = 0;
+	gint64         now;
+	GStatBuf       statbuf;
+
+	if ( (data->loader->priv->src_type == GL_MERGE_SRC_IS_FILE) &&
+	     (strcmp (data->src, "-") != 0) &&
+	     (g_stat (data->src, &statbuf) == 0) )
+	{
+		total_bytes = statbuf.st_size;
+	}
+
+	merge_open (data->loader);
+	while ( !g_cancellable_is_cancelled (cancellable) &&
+		((record = merge_get_record (data->loader)) != NULL) )
+	{
+		record_list = g_list_prepend (record_list, record);
+		n_records++;
+
+		now = g_get_monotonic_time ();
+		if ( (now - last_report) >= LOAD_PROGRESS_INTERVAL )
+		{
+			load_report_progress (task, data, n_records, total_bytes);
+			last_report = now;
+		}
+	}
+	load_report_progress (task, data, n_records, total_bytes);
+	merge_close (data->loader);
+
+	data->record_list = g_list_reverse (record_list);
+
+	if ( !g_task_return_error_if_cancelled (task) )
+	{
+		g_task_return_boolean (task, TRUE);
+	}
+}
+
+/*---------------------------------------------------------------------------*/
+/* Worker thread: queue progress report to main loop.                        */
+/*---------------------------------------------------------------------------*/
+static void
+load_report_progress (GTask    *task,
+		      LoadData *data,
+		      gint      n_records,
+		      goffset   total_bytes)
+{
+	LoadProgress *progress;
+
+	if ( data->progress_func == NULL )
+	{
+		return;
+	}
+
+	progress = g_new0 (LoadProgress, 1);
+	progress->merge         = g_object_ref (g_task_get_source_object (task));
+	progress->serial        = data->serial;
+	progress->cancellable   = g_task_get_cancellable (task);
+	if ( progress->cancellable )
+	{
+		g_object_ref (progress->cancellable);
+	}
+	progress->n_records     = n_records;
+	progress->n_bytes       = merge_get_position (data->loader);
+	progress->total_bytes   = total_bytes;
+	progress->progress_func = data->progress_func;
+	progress->progress_data = data->progress_data;
+
+	g_main_context_invoke_full (g_task_get_context (task),
+				    G_PRIORITY_DEFAULT,
+				    (GSourceFunc)load_progress_cb,
+				    progress,
+				    (GDestroyNotify)load_progress_free);
+}
+
+/*---------------------------------------------------------------------------*/
+/* Main loop: deliver progress report, unless load has been cancelled or     */
+/* superseded.                                                               */
+/*---------------------------------------------------------------------------*/
+static gboolean
+load_progress_cb (LoadProgress *progress)
+{
+	if ( !g_cancellable_is_cancelled (progress->cancellable) &&
+	     (progress->serial == progress->merge->priv->load_serial) )
+	{
+		progress->progress_func (progress->merge,
+					 progress->n_records,
+					 progress->n_bytes,
+					 progress->total_bytes,
+					 progress->progress_data);
+	}
+
+	return G_SOURCE_REMOVE;
+}
+
+/*---------------------------------------------------------------------------*/
+/* Free progress report.                                                     */
+/*---------------------------------------------------------------------------*/
+static void
+load_progress_free (LoadProgress *progress)
+{
+	g_object_unref (G_OBJECT (progress->merge));
+	if ( progress->cancellable )
+	{
+		g_object_unref (progress->cancellable);
+	}
+	g_free (progress);
+}
+
 /*****************************************************************************/
 /* Count selected records.                                                   */
 /*****************************************************************************/
@@ -22,6 +22,7 @@
 #define __MERGE_H__
 
 #include <glib-object.h>
+#include <gio/gio.h>
 
 G_BEGIN_DECLS
 
@@ -76,9 +77,30 @@ struct _glMergeClass {
 
 	void           (*copy)            (glMerge       *dst_merge,
 					   const glMerge *src_merge);
+
+	/* Optional: bytes of source consumed so far, -1 if unknown. */
+	goffset        (*get_position)    (glMerge       *merge);
+
+	/* Optional: pass over next record without building it, FALSE if none. */
+	gboolean       (*skip_record)     (glMerge       *merge);
+
+	/* Optional: continue reading at a position from get_position(). */
+	gboolean       (*seek)            (glMerge       *merge,
+					   goffset        position);
 };
 
 
+/*
+ * Progress of asynchronous loading, called on the main loop.
+ * total_bytes is -1 if the size of the source is unknown.
+ */
+typedef void (*glMergeProgressFunc) (glMerge  *merge,
+                                     gint      n_records,
+                                     goffset   n_bytes,
+                                     goffset   total_bytes,
+                                     gpointer  user_data);
+
+
 void              gl_merge_register_backend    (GType              type,
 						gchar             *name,
 						gchar             *description,
@@ -107,6 +129,37 @@ glMergeSrcType    gl_merge_get_src_type        (const glMerge       *merge);
 void              gl_merge_set_src             (glMerge             *merge,
 						const gchar         *src);
 
+void              gl_merge_set_src_async       (glMerge             *merge,
+						const gchar         *src,
+						GCancellable        *cancellable,
+						glMergeProgressFunc  progress_func,
+						gpointer             progress_data,
+						GAsyncReadyCallback  callback,
+						gpointer             user_data);
+
+gboolean          gl_merge_set_src_finish      (glMerge             *merge,
+						GAsyncResult        *result,
+						GError             **error);
+
+gint              gl_merge_index_src           (glMerge             *merge,
+						const gchar         *src);
+
+void              gl_merge_set_src_range       (glMerge             *merge,
+						const gchar         *src,
+						gint                 i_first,
+						gint                 n_records);
+
+gint              gl_merge_get_record_offset   (const glMerge       *merge);
+
+goffset           gl_merge_get_index_position  (const glMerge       *merge,
+						gint                 i_record,
+						gint                *i_indexed);
+
+void              gl_merge_set_index_position  (glMerge             *merge,
+						const gchar         *src,
+						gint                 i_record,
+						goffset              position);
+
 gchar            *gl_merge_get_src             (const glMerge       *merge);
 
 GList            *gl_merge_get_key_list        (const glMerge       *merge);
@@ -120,6 +173,9 @@ gchar            *gl_merge_eval_key            (const glMergeRecord *record,
 
 const GList      *gl_merge_get_record_list     (const glMerge       *merge);
 
+void              gl_merge_append_records      (glMerge             *merge,
+						GList               *record_list);
+
 gint              gl_merge_get_record_count    (const glMerge       *merge);
 
 G_END_DECLS
@@ -23,51 +23,79 @@
 #include "mini-preview-pixbuf-cache.h"
 
 #include <glib.h>
+#include <glib/gstdio.h>
 
 #include <libglabels.h>
 #include "mini-preview-pixbuf.h"
 
 #include "debug.h"
 
+/*========================================================*/
+/* Private macros and constants.                          */
+/*========================================================*/
+
+#define THUMBNAIL_SIZE  72
+
+/* Bump whenever the look of mini previews changes, to invalidate the disk cache. */
+#define THUMBNAIL_VERSION 1
+
+/* Persistent thumbnail directory.  (must free w/ g_free()) */
+#define DISK_CACHE_DIR  g_build_filename (g_get_user_cache_dir (), "glabels-3.0", "mini-previews", NULL)
+
 /*========================================================*/
 /* Private types.                                         */
 /*========================================================*/
 
+typedef struct {
+        gchar       *name;
+        lglTemplate *template;
+        GdkPixbuf   *pixbuf;
+} RenderJob;
+
+typedef struct {
+        gulong                              id;
+        glMiniPreviewPixbufCacheNotifyFunc  func;
+        gpointer                            user_data;
+} NotifyEntry;
+
 /*========================================================*/
 /* Private globals.                                       */
 /*========================================================*/
 
-static GHashTable *mini_preview_pixbuf_cache = NULL;
+static GHashTable  *mini_preview_pixbuf_cache = NULL;   /* name -> GdkPixbuf */
+static GHashTable  *pending_jobs              = NULL;   /* name -> RenderJob */
+static GThreadPool *render_pool               = NULL;
+
+static GList       *notify_list               = NULL;
+static gulong       notify_next_id            = 1;
 
 /*========================================================*/
 /* Private function prototypes.                           */
 /*========================================================*/
 
+static gchar     *geometry_key         (const lglTemplate *template);
+static GdkPixbuf *load_or_render       (const lglTemplate *template);
+
+static void       render_job_func      (RenderJob         *job,
+                                        gpointer           user_data);
+static gboolean   render_job_done      (RenderJob         *job);
+static void       render_job_free      (RenderJob         *job);
+
 
 /*****************************************************************************/
 /* Create a new hash table to keep track of cached mini preview pixbufs.     */
+/* Pixbufs are created on demand, see gl_mini_preview_pixbuf_cache_lookup(). */
 /*****************************************************************************/
 void
 gl_mini_preview_pixbuf_cache_init (void)
 {
-        GList       *names = NULL;
-        GList       *p;
-        lglTemplate *template;
-
 	gl_debug (DEBUG_PIXBUF_CACHE, "START");
 
 	mini_preview_pixbuf_cache = g_hash_table_new_full (g_str_hash, g_str_equal, g_free, g_object_unref);
+	pending_jobs = g_hash_table_new (g_str_hash, g_str_equal);
 
-        names = lgl_db_get_template_name_list_all (NULL, NULL, NULL);
-        for ( p=names; p != NULL; p=p->next )
-        {
-                gl_debug (DEBUG_PIXBUF_CACHE, "name = \"%s\"", p->data);
-
-                template = lgl_db_lookup_template_from_name (p->data);
-                gl_mini_preview_pixbuf_cache_add_by_template (template);
-                lgl_template_free (template);
-        }
-        lgl_db_free_template_name_list (names);
+        render_pool = g_thread_pool_new ((GFunc)render_job_func, NULL,
+                                         MAX (1, g_get_num_processors () - 1), FALSE, NULL);
 
 	gl_debug (DEBUG_PIXBUF_CACHE, "END pixbuf_cache=%p", mini_preview_pixbuf_cache);
 }
@@ -84,12 +112,13 @@ gl_mini_preview_pixbuf_cache_add_by_template (lglTemplate *template)
 
 	gl_debug (DEBUG_PIXBUF_CACHE, "START");
 
-        pixbuf = gl_mini_preview_pixbuf_new (template, 72, 72);
+        pixbuf = load_or_render (template);
 
         name = g_strdup_printf ("%s %s", template->brand, template->part);
-        g_hash_table_insert (mini_preview_pixbuf_cache, name, g_object_ref (pixbuf));
 
-        g_object_unref (pixbuf);
+        /* Forget about any render in flight, it may be for the old geometry. */
+        g_hash_table_remove (pending_jobs, name);
+        g_hash_table_insert (mini_preview_pixbuf_cache, name, pixbuf);
 
 	gl_debug (DEBUG_PIXBUF_CACHE, "END");
 }
@@ -102,16 +131,13 @@ void
 gl_mini_preview_pixbuf_cache_add_by_name (gchar      *name)
 {
         lglTemplate *template;
-        GdkPixbuf   *pixbuf;
 
 	gl_debug (DEBUG_PIXBUF_CACHE, "START");
 
         template = lgl_db_lookup_template_from_name (name);
-        pixbuf = gl_mini_preview_pixbuf_new (template, 72, 72);
+        gl_mini_preview_pixbuf_cache_add_by_template (template);
         lgl_template_free (template);
 
-        g_hash_table_insert (mini_preview_pixbuf_cache, g_strdup (name), pixbuf);
-
 	gl_debug (DEBUG_PIXBUF_CACHE, "END");
 }
 
@@ -125,13 +151,14 @@ gl_mini_preview_pixbuf_cache_delete_by_name (gchar *name)
 	gl_debug (DEBUG_PIXBUF_CACHE, "START");
 
         g_hash_table_remove (mini_preview_pixbuf_cache, name);
+        g_hash_table_remove (pending_jobs, name);
 
 	gl_debug (DEBUG_PIXBUF_CACHE, "END");
 }
 
 
 /*****************************************************************************/
-/* Get pixbuf.                                                               */
+/* Get pixbuf, creating it synchronously if needed.                          */
 /*****************************************************************************/
 GdkPixbuf *
 gl_mini_preview_pixbuf_cache_get_pixbuf (gchar      *name)
@@ -154,6 +181,254 @@ gl_mini_preview_pixbuf_cache_get_pixbuf (gchar      *name)
 }
 
 
+/*****************************************************************************/
+/* Lookup pixbuf without blocking.  If it is not cached yet, queue it to be  */
+/* loaded from disk or rendered in the background and return NULL.  Notify   */
+/* functions are called once it is available.                                */
+/*****************************************************************************/
+GdkPixbuf *
+gl_mini_preview_pixbuf_cache_lookup (const gchar *name)
+{
+	GdkPixbuf   *pixbuf;
+        RenderJob   *job;
+
+	pixbuf = g_hash_table_lookup (mini_preview_pixbuf_cache, name);
+        if (pixbuf)
+        {
+                return g_object_ref (pixbuf);
+        }
+
+        if (!g_hash_table_lookup (pending_jobs, name))
+        {
+                gl_debug (DEBUG_PIXBUF_CACHE, "queue \"%s\"", name);
+
+                /* The template database is not thread safe, so copy template now. */
+                job = g_new0 (RenderJob, 1);
+                job->name     = g_strdup (name);
+                job->template = lgl_db_lookup_template_from_name (name);
+
+                g_hash_table_insert (pending_jobs, job->name, job);
+                g_thread_pool_push (render_pool, job, NULL);
+        }
+
+        return NULL;
+}
+
+
+/*****************************************************************************/
+/* Register callback for when a pixbuf becomes available.                    */
+/*****************************************************************************/
+gulong
+gl_mini_preview_pixbuf_cache_notify_add (glMiniPreviewPixbufCacheNotifyFunc func,
+                                         gpointer                           user_data)
+{
+        NotifyEntry *entry;
+
+        entry = g_new0 (NotifyEntry, 1);
+        entry->id        = notify_next_id++;
+        entry->func      = func;
+        entry->user_data = user_data;
+
+        notify_list = g_list_append (notify_list, entry);
+
+        return entry->id;
+}
+
+
+/*****************************************************************************/
+/* Unregister callback.                                                      */
+/*****************************************************************************/
+void
+gl_mini_preview_pixbuf_cache_notify_remove (gulong id)
+{
+        GList       *p;
+        NotifyEntry *entry;
+
+        for ( p = notify_list; p != NULL; p = p->next )
+        {
+                entry = (NotifyEntry *)p->data;
+                if ( entry->id == id )
+                {
+                        notify_list = g_list_delete_link (notify_list, p);
+                        g_free (entry);
+                        return;
+                }
+        }
+}
+
+
+/*--------------------------------------------------------------------------*/
+/* PRIVATE.  Key identifying everything that affects the look of a mini     */
+/* preview.  Templates with identical geometry share a thumbnail.            */
+/*--------------------------------------------------------------------------*/
+static gchar *
+geometry_key (const lglTemplate *template)
+{
+        GString                 *s;
+        const lglTemplateFrame  *frame;
+        GList                   *p;
+        lglTemplateLayout       *layout;
+        gchar                   *key;
+
+        s = g_string_new (NULL);
+
+        g_string_append_printf (s, "%d %d %.6g %.6g",
+                                THUMBNAIL_VERSION, THUMBNAIL_SIZE,
+                                template->page_width, template->page_height);
+
+        frame = (lglTemplateFrame *)template->frames->data;
+        switch (frame->shape)
+        {
+        case LGL_TEMPLATE_FRAME_SHAPE_RECT:
+                g_string_append_printf (s, " rect %.6g %.6g %.6g",
+                                        frame->rect.w, frame->rect.h, frame->rect.r);
+                break;
+        case LGL_TEMPLATE_FRAME_SHAPE_ELLIPSE:
+                g_string_append_printf (s, " ellipse %.6g %.6g",
+                                        frame->ellipse.w, frame->ellipse.h);
+                break;
+        case LGL_TEMPLATE_FRAME_SHAPE_ROUND:
+                g_string_append_printf (s, " round %.6g",
+                                        frame->round.r);
+                break;
+        case LGL_TEMPLATE_FRAME_SHAPE_CD:
+                g_string_append_printf (s, " cd %.6g %.6g %.6g %.6g",
+                                        frame->cd.r1, frame->cd.r2, frame->cd.w, frame->cd.h);
+                break;
+        default:
+                break;
+        }
+
+        for ( p = frame->all.layouts; p != NULL; p = p->next )
+        {
+                layout = (lglTemplateLayout *)p->data;
+                g_string_append_printf (s, " layout %d %d %.6g %.6g %.6g %.6g",
+                                        layout->nx, layout->ny,
+                                        layout->x0, layout->y0,
+                                        layout->dx, layout->dy);
+        }
+
+        key = g_compute_checksum_for_string (G_CHECKSUM_SHA1, s->str, s->len);
+        g_string_free (s, TRUE);
+
+        return key;
+}
+
+
+/*--------------------------------------------------------------------------*/
+/* PRIVATE.  Load thumbnail from disk cache, or render and save it.  Safe to */
+/* call from any thread.                                                    */
+/*--------------------------------------------------------------------------*/
+static GdkPixbuf *
+load_or_render (const lglTemplate *template)
+{
+        gchar     *dir;
+        gchar     *key;
+        gchar     *filename, *tmp_filename;
+        GdkPixbuf *pixbuf;
+
+        dir      = DISK_CACHE_DIR;
+        key      = geometry_key (template);
+        filename = g_strdup_printf ("%s%s%s.png", dir, G_DIR_SEPARATOR_S, key);
+
+        pixbuf = gdk_pixbuf_new_from_file (filename, NULL);
+        if ( pixbuf &&
+             (gdk_pixbuf_get_width (pixbuf) == THUMBNAIL_SIZE) &&
+             (gdk_pixbuf_get_height (pixbuf) == THUMBNAIL_SIZE) )
+        {
+                gl_debug (DEBUG_PIXBUF_CACHE, "disk hit %s", key);
+        }
+        else
+        {
+                if (pixbuf)
+                {
+                        g_object_unref (pixbuf);
+                }
+
+                pixbuf = gl_mini_preview_pixbuf_new ((lglTemplate *)template,
+                                                     THUMBNAIL_SIZE, THUMBNAIL_SIZE);
+
+                /* Save under a unique name and rename, so concurrent writers never clash. */
+                g_mkdir_with_parents (dir, 0775);
+                tmp_filename = g_strdup_printf ("%s.%p.tmp", filename, (gpointer)g_thread_self ());
+                if ( gdk_pixbuf_save (pixbuf, tmp_filename, "png", NULL, NULL) )
+                {
+                        g_rename (tmp_filename, filename);
+                }
+                else
+                {
+                        g_unlink (tmp_filename);
+                }
+                g_free (tmp_filename);
+        }
+
+        g_free (dir);
+        g_free (key);
+        g_free (filename);
+
+        return pixbuf;
+}
+
+
+/*--------------------------------------------------------------------------*/
+/* PRIVATE.  Thread pool function.                                          */
+/*--------------------------------------------------------------------------*/
+static void
+render_job_func (RenderJob *job,
+                 gpointer   user_data)
+{
+        job->pixbuf = load_or_render (job->template);
+
+        g_idle_add ((GSourceFunc)render_job_done, job);
+}
+
+
+/*--------------------------------------------------------------------------*/
+/* PRIVATE.  Back in main loop: publish pixbuf and notify.                  */
+/*--------------------------------------------------------------------------*/
+static gboolean
+render_job_done (RenderJob *job)
+{
+        GList       *p, *next;
+        NotifyEntry *entry;
+
+        /* Only publish if the job has not been cancelled in the meantime. */
+        if ( g_hash_table_lookup (pending_jobs, job->name) == job )
+        {
+                g_hash_table_remove (pending_jobs, job->name);
+                g_hash_table_insert (mini_preview_pixbuf_cache,
+                                     g_strdup (job->name), g_object_ref (job->pixbuf));
+
+                for ( p = notify_list; p != NULL; p = next )
+                {
+                        next  = p->next;
+                        entry = (NotifyEntry *)p->data;
+                        entry->func (job->name, entry->user_data);
+                }
+        }
+
+        render_job_free (job);
+
+        return FALSE;
+}
+
+
+/*--------------------------------------------------------------------------*/
+/* PRIVATE.  Free render job.                                               */
+/*--------------------------------------------------------------------------*/
+static void
+render_job_free (RenderJob *job)
+{
+        g_free (job->name);
+        lgl_template_free (job->template);
+        if (job->pixbuf)
+        {
+                g_object_unref (job->pixbuf);
+        }
+        g_free (job);
+}
+
+
 
 /*
  * Local Variables:       -- emacs
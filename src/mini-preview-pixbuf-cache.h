@@ -26,6 +26,9 @@
 
 G_BEGIN_DECLS
 
+typedef void (*glMiniPreviewPixbufCacheNotifyFunc) (const gchar *name,
+                                                    gpointer     user_data);
+
 void        gl_mini_preview_pixbuf_cache_init            (void);
 
 void        gl_mini_preview_pixbuf_cache_add_by_name     (gchar       *name);
@@ -35,6 +38,13 @@ void        gl_mini_preview_pixbuf_cache_delete_by_name  (gchar       *name);
 
 GdkPixbuf  *gl_mini_preview_pixbuf_cache_get_pixbuf      (gchar       *name);
 
+GdkPixbuf  *gl_mini_preview_pixbuf_cache_lookup          (const gchar *name);
+
+gulong      gl_mini_preview_pixbuf_cache_notify_add      (glMiniPreviewPixbufCacheNotifyFunc func,
+                                                          gpointer                           user_data);
+
+void        gl_mini_preview_pixbuf_cache_notify_remove   (gulong       id);
+
 
 G_END_DECLS
 
@@ -1140,13 +1140,10 @@ draw_rich_preview (glMiniPreview          *this,
         }
         else
         {
-                /* FIXME: maybe the renderers should be more self contained.
-                 *        This will only work for the first page, since
-                 *        previous pages must be rendered to establish
-                 *        state.
-                 */
-                state.i_copy = 0;
-                state.p_record = (GList *)gl_merge_get_record_list (merge);
+                /* Renderers seek to the first record of this page. */
+                state.i_copy   = 0;
+                state.p_record = NULL;
+                state.merge    = NULL;
 
                 if (this->priv->collate_flag)
                 {
@@ -1172,6 +1169,9 @@ draw_rich_preview (glMiniPreview          *this,
                                                          this->priv->crop_marks_flag,
                                                          &state);
                 }
+
+                gl_print_state_clear (&state);
+                g_object_unref (merge);
         }
 }
 
@@ -0,0 +1,427 @@
+/*
+ *  mono-bitmap.c
+ *  Copyright (C) 2026  agent <agent@local>.
+ *
+ *  This file is part of gLabels.
+ *
+ *  gLabels is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  gLabels is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with gLabels.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <config.h>
+
+#include "mono-bitmap.h"
+
+#include <string.h>
+
+#include "debug.h"
+
+
+/*===========================================*/
+/* Private macros and constants.             */
+/*===========================================*/
+
+#define THRESHOLD 128
+
+/* 8x8 Bayer matrix, 0..63. */
+static const guchar bayer[8][8] = {
+        {  0, 32,  8, 40,  2, 34, 10, 42 },
+        { 48, 16, 56, 24, 50, 18, 58, 26 },
+        { 12, 44,  4, 36, 14, 46,  6, 38 },
+        { 60, 28, 52, 20, 62, 30, 54, 22 },
+        {  3, 35, 11, 43,  1, 33,  9, 41 },
+        { 51, 19, 59, 27, 49, 17, 57, 25 },
+        { 15, 47,  7, 39, 13, 45,  5, 37 },
+        { 63, 31, 55, 23, 61, 29, 53, 21 }
+};
+
+static const gchar *dither_names[] = {
+        "threshold",
+        "ordered",
+        "diffusion"
+};
+
+
+/*===========================================*/
+/* Private function prototypes.              */
+/*===========================================*/
+
+static void luminance_row (const guint32 *pixel,
+                           guchar        *lum,
+                           guint32        width);
+
+static void compare_row   (const guchar  *lum,
+                           const guchar  *thresholds,
+                           guchar        *ink,
+                           guint32        width);
+
+static void diffuse_row   (const guchar  *lum,
+                           gint          *err_cur,
+                           gint          *err_next,
+                           guchar        *ink,
+                           guint32        width,
+                           gboolean       reverse_flag);
+
+static void pack_row      (const guchar  *ink,
+                           guchar        *out,
+                           guint32        width);
+
+
+/*****************************************************************************/
+/* Reduce opaque RGB24 or ARGB32 image surface to 1 bit per pixel.           */
+/*****************************************************************************/
+glMonoBitmap *
+gl_mono_bitmap_new_from_surface (cairo_surface_t *surface,
+                                 glMonoDither     dither)
+{
+        glMonoBitmap  *bitmap;
+        const guchar  *data;
+        gint           src_stride;
+        guchar        *lum, *ink, *thresholds = NULL;
+        gint          *err_cur = NULL, *err_next = NULL, *err_tmp;
+        guint32        x, y, n_rows;
+
+        g_return_val_if_fail (surface, NULL);
+        g_return_val_if_fail (cairo_surface_get_type (surface) == CAIRO_SURFACE_TYPE_IMAGE, NULL);
+
+        cairo_surface_flush (surface);
+
+        bitmap = g_new0 (glMonoBitmap, 1);
+        bitmap->width  = cairo_image_surface_get_width (surface);
+        bitmap->height = cairo_image_surface_get_height (surface);
+        bitmap->stride = (bitmap->width + 7) / 8;
+        bitmap->data   = g_new0 (guchar, (gsize)bitmap->stride * bitmap->height);
+
+        data       = cairo_image_surface_get_data (surface);
+        src_stride = cairo_image_surface_get_stride (surface);
+
+        lum = g_new (guchar, bitmap->width);
+        ink = g_new (guchar, bitmap->width);
+
+        switch (dither)
+        {
+
+        case GL_MONO_DITHER_DIFFUSION:
+                err_cur  = g_new0 (gint, bitmap->width + 2);
+                err_next = g_new0 (gint, bitmap->width + 2);
+                break;
+
+        default:
+                /* One row of thresholds per matrix row, so comparing is a flat loop. */
+                n_rows     = (dither == GL_MONO_DITHER_ORDERED) ? 8 : 1;
+                thresholds = g_new (guchar, n_rows * bitmap->width);
+                for ( y = 0; y < n_rows; y++ )
+                {
+                        for ( x = 0; x < bitmap->width; x++ )
+                        {
+                                thresholds[y*bitmap->width + x] =
+                                        (n_rows == 8) ? (4*bayer[y][x & 7] + 2) : THRESHOLD;
+                        }
+                }
+                break;
+
+        }
+
+        for ( y = 0; y < bitmap->height; y++ )
+        {
+                luminance_row ((const guint32 *)(data + y*src_stride), lum, bitmap->width);
+
+                switch (dither)
+                {
+
+                case GL_MONO_DITHER_DIFFUSION:
+                        diffuse_row (lum, err_cur, err_next, ink, bitmap->width, (y & 1));
+                        err_tmp  = err_cur;
+                        err_cur  = err_next;
+                        err_next = err_tmp;
+                        memset (err_next, 0, (bitmap->width + 2) * sizeof (gint));
+                        break;
+
+                case GL_MONO_DITHER_ORDERED:
+                        compare_row (lum, thresholds + (y & 7)*bitmap->width, ink, bitmap->width);
+                        break;
+
+                default:
+                        compare_row (lum, thresholds, ink, bitmap->width);
+                        break;
+
+                }
+
+                pack_row (ink, bitmap->data + y*bitmap->stride, bitmap->width);
+        }
+
+        g_free (lum);
+        g_free (ink);
+        g_free (thresholds);
+        g_free (err_cur);
+        g_free (err_next);
+
+        return bitmap;
+}
+
+
+/*****************************************************************************/
+/* Free bitmap.                                                              */
+/*****************************************************************************/
+void
+gl_mono_bitmap_free (glMonoBitmap *bitmap)
+{
+        if ( bitmap )
+        {
+                g_free (bitmap->data);
+                g_free (bitmap);
+        }
+}
+
+
+/*****************************************************************************/
+/* Create an A1 image surface from bitmap, for cairo_surface_write_to_png(). */
+/* Cairo writes A1 as 1-bit grayscale with set bits white, so bits are       */
+/* inverted here.                                                            */
+/*****************************************************************************/
+cairo_surface_t *
+gl_mono_bitmap_create_surface (const glMonoBitmap *bitmap)
+{
+        cairo_surface_t *surface;
+        guchar          *data;
+        gint             stride;
+        const guchar    *row;
+        guchar          *dest;
+        guint32          x, y;
+
+        g_return_val_if_fail (bitmap, NULL);
+
+        surface = cairo_image_surface_create (CAIRO_FORMAT_A1, bitmap->width, bitmap->height);
+        cairo_surface_flush (surface);
+
+        data   = cairo_image_surface_get_data (surface);
+        stride = cairo_image_surface_get_stride (surface);
+
+        for ( y = 0; y < bitmap->height; y++ )
+        {
+                row  = bitmap->data + y*bitmap->stride;
+                dest = data + y*stride;
+
+#if G_BYTE_ORDER == G_BIG_ENDIAN
+                for ( x = 0; x < (guint32)bitmap->stride; x++ )
+                {
+                        dest[x] = ~row[x];
+                }
+#else
+                /* Pixels are packed in native 32 bit words, i.e. LSB first here. */
+                for ( x = 0; x < bitmap->width; x++ )
+                {
+                        if ( !(row[x >> 3] & (0x80 >> (x & 7))) )
+                        {
+                                dest[x >> 3] |= 1 << (x & 7);
+                        }
+                }
+#endif
+        }
+
+        cairo_surface_mark_dirty (surface);
+
+        return surface;
+}
+
+
+/*****************************************************************************/
+/* Append bitmap to buffer as a raw PBM (P4) image.  Several images may      */
+/* follow one another in one stream.                                         */
+/*****************************************************************************/
+void
+gl_mono_bitmap_append_pbm (const glMonoBitmap *bitmap,
+                           GByteArray         *buffer)
+{
+        gchar   *header;
+        guint32  y;
+
+        g_return_if_fail (bitmap);
+        g_return_if_fail (buffer);
+
+        header = g_strdup_printf ("P4\n%u %u\n", bitmap->width, bitmap->height);
+        g_byte_array_append (buffer, (const guchar *)header, strlen (header));
+        g_free (header);
+
+        for ( y = 0; y < bitmap->height; y++ )
+        {
+                g_byte_array_append (buffer,
+                                     bitmap->data + y*bitmap->stride,
+                                     (bitmap->width + 7) / 8);
+        }
+}
+
+
+/*****************************************************************************/
+/* Parse dither name ("threshold", "ordered" or "diffusion").                */
+/*****************************************************************************/
+gboolean
+gl_mono_dither_from_string (const gchar  *string,
+                            glMonoDither *dither)
+{
+        guint i;
+
+        g_return_val_if_fail (dither, FALSE);
+
+        for ( i = 0; string && (i < G_N_ELEMENTS (dither_names)); i++ )
+        {
+                if ( g_ascii_strcasecmp (string, dither_names[i]) == 0 )
+                {
+                        *dither = i;
+                        return TRUE;
+                }
+        }
+
+        return FALSE;
+}
+
+
+/*****************************************************************************/
+/* Name of dither.                                                           */
+/*****************************************************************************/
+const gchar *
+gl_mono_dither_to_string (glMonoDither dither)
+{
+        g_return_val_if_fail (dither < G_N_ELEMENTS (dither_names), NULL);
+
+        return dither_names[dither];
+}
+
+
+/*---------------------------------------------------------------------------*/
+/* PRIVATE.  Luminance of one row of 0x00RRGGBB pixels.                      */
+/*                                                                           */
+/* This and compare_row() are kept as flat, branch free loops over whole     */
+/* rows so that the compiler can vectorize them.                             */
+/*---------------------------------------------------------------------------*/
+static void
+luminance_row (const guint32 *pixel,
+               guchar        *lum,
+               guint32        width)
+{
+        guint32 x;
+
+        for ( x = 0; x < width; x++ )
+        {
+                lum[x] = ( 77 * ((pixel[x] >> 16) & 0xff) +
+                          150 * ((pixel[x] >> 8)  & 0xff) +
+                           29 * ( pixel[x]        & 0xff) + 128 ) >> 8;
+        }
+}
+
+
+/*---------------------------------------------------------------------------*/
+/* PRIVATE.  Ink where luminance is below threshold.                         */
+/*---------------------------------------------------------------------------*/
+static void
+compare_row (const guchar *lum,
+             const guchar *thresholds,
+             guchar       *ink,
+             guint32       width)
+{
+        guint32 x;
+
+        for ( x = 0; x < width; x++ )
+        {
+                ink[x] = (lum[x] < thresholds[x]);
+        }
+}
+
+
+/*---------------------------------------------------------------------------*/
+/* PRIVATE.  Floyd-Steinberg error diffusion of one row, serpentine.  Errors */
+/* are kept in sixteenths, indexed from x+1.  Pure black and white pixels    */
+/* neither take nor pass on error, so edges of bars and lines stay exact     */
+/* next to photos.                                                           */
+/*---------------------------------------------------------------------------*/
+static void
+diffuse_row (const guchar *lum,
+             gint         *err_cur,
+             gint         *err_next,
+             guchar       *ink,
+             guint32       width,
+             gboolean      reverse_flag)
+{
+        guint32 i, x;
+        gint    dir, v, e;
+
+        dir = reverse_flag ? -1 : 1;
+
+        for ( i = 0; i < width; i++ )
+        {
+                x = reverse_flag ? (width - 1 - i) : i;
+
+                if ( (lum[x] == 0) || (lum[x] == 255) )
+                {
+                        ink[x] = (lum[x] == 0);
+                        continue;
+                }
+
+                v = lum[x] + err_cur[x+1] / 16;
+                if ( v < THRESHOLD )
+                {
+                        ink[x] = 1;
+                        e      = v;
+                }
+                else
+                {
+                        ink[x] = 0;
+                        e      = v - 255;
+                }
+
+                err_cur[x+1+dir]  += 7 * e;
+                err_next[x+1-dir] += 3 * e;
+                err_next[x+1]     += 5 * e;
+                err_next[x+1+dir] += e;
+        }
+}
+
+
+/*---------------------------------------------------------------------------*/
+/* PRIVATE.  Pack row of 0/1 bytes, most significant bit first.              */
+/*---------------------------------------------------------------------------*/
+static void
+pack_row (const guchar *ink,
+          guchar       *out,
+          guint32       width)
+{
+        guint32 i, x;
+
+        for ( i = 0; i < width / 8; i++ )
+        {
+                x = 8*i;
+                out[i] = (ink[x]   << 7) | (ink[x+1] << 6) | (ink[x+2] << 5) | (ink[x+3] << 4) |
+                         (ink[x+4] << 3) | (ink[x+5] << 2) | (ink[x+6] << 1) |  ink[x+7];
+        }
+
+        if ( width % 8 )
+        {
+                out[i] = 0;
+                for ( x = 8*i; x < width; x++ )
+                {
+                        out[i] |= ink[x] << (7 - (x & 7));
+                }
+        }
+}
+
+
+
+
+/*
+ * Local Variables:       -- emacs
+ * mode: C                -- emacs
+ * c-basic-offset: 8      -- emacs
+ * tab-width: 8           -- emacs
+ * indent-tabs-mode: nil  -- emacs
+ * End:                   -- emacs
+ */
@@ -0,0 +1,84 @@
+/*
+ *  mono-bitmap.h
+ *  Copyright (C) 2026  agent <agent@local>.
+ *
+ *  This file is part of gLabels.
+ *
+ *  gLabels is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  gLabels is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with gLabels.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef __MONO_BITMAP_H__
+#define __MONO_BITMAP_H__
+
+#include <glib.h>
+#include <cairo.h>
+
+G_BEGIN_DECLS
+
+
+/*
+ * How gray pixels are reduced to black and white.  Pure black and pure white
+ * pixels, e.g. non-antialiased bars and lines, are never changed.
+ */
+typedef enum {
+        GL_MONO_DITHER_THRESHOLD,
+        GL_MONO_DITHER_ORDERED,
+        GL_MONO_DITHER_DIFFUSION
+} glMonoDither;
+
+
+/*
+ * Packed 1-bit image for direct thermal printers: rows of stride bytes, most
+ * significant bit first, 1 = black.  This is also the PBM (P4) raster.
+ */
+typedef struct {
+        guint32  width;
+        guint32  height;
+        gint     stride;
+
+        guchar  *data;
+} glMonoBitmap;
+
+
+glMonoBitmap    *gl_mono_bitmap_new_from_surface (cairo_surface_t    *surface,
+                                                  glMonoDither        dither);
+
+void             gl_mono_bitmap_free             (glMonoBitmap       *bitmap);
+
+cairo_surface_t *gl_mono_bitmap_create_surface   (const glMonoBitmap *bitmap);
+
+void             gl_mono_bitmap_append_pbm       (const glMonoBitmap *bitmap,
+                                                  GByteArray         *buffer);
+
+gboolean         gl_mono_dither_from_string      (const gchar        *string,
+                                                  glMonoDither       *dither);
+
+const gchar     *gl_mono_dither_to_string        (glMonoDither        dither);
+
+
+G_END_DECLS
+
+#endif /* __MONO_BITMAP_H__ */
+
+
+
+
+/*
+ * Local Variables:       -- emacs
+ * mode: C                -- emacs
+ * c-basic-offset: 8      -- emacs
+ * tab-width: 8           -- emacs
+ * indent-tabs-mode: nil  -- emacs
+ * End:                   -- emacs
+ */
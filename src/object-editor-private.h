@@ -34,6 +34,11 @@ struct _glObjectEditorPrivate {
         glLabel        *label;
         glLabelObject  *object;
 
+        /* Deferred reload from object */
+        guint           load_idle_id;
+        gboolean        load_properties_flag;
+        gboolean        load_position_flag;
+
 	gdouble     units_per_point;
 
 	GtkWidget  *title_image;
@@ -90,6 +90,16 @@ static void object_changed_cb                   (glLabelObject        *object,
 static void object_moved_cb                     (glLabelObject        *object,
                                                  glObjectEditor       *editor);
 
+static gboolean load_idle_cb                    (glObjectEditor       *editor);
+
+static void cancel_load                         (glObjectEditor       *editor);
+
+static void load_object_properties              (glLabelObject        *object,
+                                                 glObjectEditor       *editor);
+
+static void load_object_position                (glLabelObject        *object,
+                                                 glObjectEditor       *editor);
+
 
 
 /*****************************************************************************/
@@ -205,6 +215,7 @@ gl_object_editor_finalize (GObject *object)
                                                       object_moved_cb, editor);
                 g_object_unref (editor->priv->object);
         }
+        cancel_load (editor);
 
         g_object_unref (editor->priv->builder);
 
@@ -293,6 +304,8 @@ set_object (glObjectEditor  *editor,
 
 	gl_debug (DEBUG_EDITOR, "START");
 
+        cancel_load (editor);
+
         if ( editor->priv->object != NULL )
         {
                 g_signal_handlers_disconnect_by_func (G_OBJECT(editor->priv->object),
@@ -450,8 +463,8 @@ set_object (glObjectEditor  *editor,
                         gtk_notebook_set_current_page (GTK_NOTEBOOK (editor->priv->notebook), 0);
                 }
 
-                object_moved_cb (object, editor);
-                object_changed_cb (object, editor);
+                load_object_position (object, editor);
+                load_object_properties (object, editor);
 
                 g_signal_connect (G_OBJECT (object), "changed",
                                   G_CALLBACK (object_changed_cb), editor);
@@ -734,10 +747,90 @@ set_key_names (glObjectEditor      *editor,
 
 /*---------------------------------------------------------------------------*/
 /* PRIVATE. object "changed" callback.                                       */
+/*                                                                           */
+/* Objects can change many times per frame while being dragged, so the       */
+/* editor is only reloaded from an idle handler, after the canvas has been   */
+/* repainted.                                                                */
 /*---------------------------------------------------------------------------*/
 static void
 object_changed_cb (glLabelObject  *object,
                    glObjectEditor *editor)
+{
+        editor->priv->load_properties_flag = TRUE;
+
+        if ( editor->priv->load_idle_id == 0 )
+        {
+                editor->priv->load_idle_id = g_idle_add ((GSourceFunc)load_idle_cb, editor);
+        }
+}
+
+
+/*---------------------------------------------------------------------------*/
+/* PRIVATE. object "moved" callback.                                         */
+/*---------------------------------------------------------------------------*/
+static void
+object_moved_cb (glLabelObject  *object,
+                 glObjectEditor *editor)
+{
+        editor->priv->load_position_flag = TRUE;
+
+        if ( editor->priv->load_idle_id == 0 )
+        {
+                editor->priv->load_idle_id = g_idle_add ((GSourceFunc)load_idle_cb, editor);
+        }
+}
+
+
+/*---------------------------------------------------------------------------*/
+/* PRIVATE. Reload editor from object, after it has changed or moved.        */
+/*---------------------------------------------------------------------------*/
+static gboolean
+load_idle_cb (glObjectEditor *editor)
+{
+        editor->priv->load_idle_id = 0;
+
+        if ( editor->priv->object )
+        {
+                if ( editor->priv->load_position_flag )
+                {
+                        load_object_position (editor->priv->object, editor);
+                }
+                if ( editor->priv->load_properties_flag )
+                {
+                        load_object_properties (editor->priv->object, editor);
+                }
+        }
+
+        editor->priv->load_position_flag   = FALSE;
+        editor->priv->load_properties_flag = FALSE;
+
+        return G_SOURCE_REMOVE;
+}
+
+
+/*---------------------------------------------------------------------------*/
+/* PRIVATE. Cancel pending reload.                                           */
+/*---------------------------------------------------------------------------*/
+static void
+cancel_load (glObjectEditor *editor)
+{
+        if ( editor->priv->load_idle_id )
+        {
+                g_source_remove (editor->priv->load_idle_id);
+                editor->priv->load_idle_id = 0;
+        }
+
+        editor->priv->load_position_flag   = FALSE;
+        editor->priv->load_properties_flag = FALSE;
+}
+
+
+/*---------------------------------------------------------------------------*/
+/* PRIVATE. Load object properties into editor.                              */
+/*---------------------------------------------------------------------------*/
+static void
+load_object_properties (glLabelObject  *object,
+                        glObjectEditor *editor)
 {
         gdouble              w, h;
         glColorNode         *line_color_node;
@@ -882,11 +975,11 @@ object_changed_cb (glLabelObject  *object,
 
 
 /*---------------------------------------------------------------------------*/
-/* PRIVATE. object "moved" callback.                                         */
+/* PRIVATE. Load object position into editor.                                */
 /*---------------------------------------------------------------------------*/
 static void
-object_moved_cb (glLabelObject  *object,
-                 glObjectEditor *editor)
+load_object_position (glLabelObject  *object,
+                      glObjectEditor *editor)
 {
         gdouble              x, y;
 
@@ -22,9 +22,25 @@
 
 #include "pixbuf-cache.h"
 
+#include <string.h>
+#include <gdk-pixbuf/gdk-pixdata.h>
+
 #include "debug.h"
 
 
+/*========================================================*/
+/* Private macros and constants.                          */
+/*========================================================*/
+
+/* Enough base64 characters to cover a GdkPixdata header or PNG IHDR chunk. */
+#define HEADER_BASE64_LENGTH 64
+
+/* Both formats happen to store big-endian width and height at this offset. */
+#define HEADER_SIZE_OFFSET   16
+
+static const guchar png_signature[8] = { 0x89, 'P', 'N', 'G', '\r', '\n', 0x1a, '\n' };
+
+
 /*========================================================*/
 /* Private types.                                         */
 /*========================================================*/
@@ -33,8 +49,21 @@ typedef struct {
 	gchar     *key;
 	guint      references;
 	GdkPixbuf *pixbuf;
+
+	/* Base64 image data.  Pixdata is dropped once decoded, PNG is kept
+	   since it is compact and is what gets saved. */
+	gchar               *encoded;
+	glPixbufCacheFormat  format;
+	gboolean             failed_flag;	/* encoded could not be decoded */
 } CacheRecord;
 
+typedef struct {
+	gchar               *key;
+	gchar               *encoded;
+	glPixbufCacheFormat  format;
+	GdkPixbuf           *pixbuf;
+} DecodeJob;
+
 
 /*========================================================*/
 /* Private globals.                                       */
@@ -45,11 +74,33 @@ typedef struct {
 /* Private function prototypes.                           */
 /*========================================================*/
 
-static void  record_destroy   (gpointer val);
+static void       record_destroy     (gpointer      val);
+
+static GdkPixbuf *decode_image       (const gchar         *encoded,
+				      glPixbufCacheFormat  format);
+
+static gboolean   read_header_size   (const gchar         *encoded,
+				      glPixbufCacheFormat  format,
+				      gint                *width,
+				      gint                *height);
+
+static gboolean   record_is_pending  (CacheRecord  *record);
+
+static void       record_set_pixbuf  (CacheRecord  *record,
+				      GdkPixbuf    *pixbuf);
 
-static void  add_name_to_list (gpointer key,
-			       gpointer val,
-			       gpointer user_data);
+static void       record_decode      (CacheRecord  *record);
+
+static void       decode_job_free    (gpointer      data);
+
+static void       decode_thread      (GTask        *task,
+				      gpointer      source_object,
+				      gpointer      task_data,
+				      GCancellable *cancellable);
+
+static void       add_name_to_list   (gpointer      key,
+				      gpointer      val,
+				      gpointer      user_data);
 
 
 /*---------------------------------------------------------------------------*/
@@ -63,7 +114,10 @@ record_destroy (gpointer val)
 	g_return_if_fail (record);
 
 	g_free (record->key);
-	g_object_unref (record->pixbuf);
+	if ( record->pixbuf ) {
+		g_object_unref (record->pixbuf);
+	}
+	g_free (record->encoded);
 	g_free (record);
 }
 
@@ -148,6 +202,11 @@ gl_pixbuf_cache_get_pixbuf (GHashTable *pixbuf_cache,
 	record = g_hash_table_lookup (pixbuf_cache, name);
 
 	if (record != NULL) {
+		record_decode (record);
+		if (record->pixbuf == NULL) {
+			gl_debug (DEBUG_PIXBUF_CACHE, "END undecodable");
+			return NULL;
+		}
 		record->references++;
 		gl_debug (DEBUG_PIXBUF_CACHE, "references=%d", record->references);
 		gl_debug (DEBUG_PIXBUF_CACHE, "END cached");
@@ -200,6 +259,514 @@ gl_pixbuf_cache_remove_pixbuf (GHashTable *pixbuf_cache,
 }
 
 
+/*****************************************************************************/
+/* Move all records of src_cache not already in dst_cache to dst_cache,      */
+/* without copying any image data.  src_cache is left with the rest.         */
+/*****************************************************************************/
+void
+gl_pixbuf_cache_transfer (GHashTable *dst_cache,
+			  GHashTable *src_cache)
+{
+	GHashTableIter  iter;
+	CacheRecord    *record;
+
+	gl_debug (DEBUG_PIXBUF_CACHE, "START");
+
+	g_hash_table_iter_init (&iter, src_cache);
+	while ( g_hash_table_iter_next (&iter, NULL, (gpointer *)&record) )
+	{
+		if ( !g_hash_table_contains (dst_cache, record->key) )
+		{
+			g_hash_table_iter_steal (&iter);
+			g_hash_table_insert (dst_cache, record->key, record);
+		}
+	}
+
+	gl_debug (DEBUG_PIXBUF_CACHE, "END");
+}
+
+/*****************************************************************************/
+/* Add encoded (base64) image to cache explicitly (not a reference).  The    */
+/* pixbuf is not decoded until somebody actually needs it.                   */
+/*****************************************************************************/
+void
+gl_pixbuf_cache_add_encoded (GHashTable          *pixbuf_cache,
+			     gchar               *name,
+			     const gchar         *encoded,
+			     glPixbufCacheFormat  format)
+{
+	CacheRecord *test_record, *record;
+
+	gl_debug (DEBUG_PIXBUF_CACHE, "START");
+
+	test_record = g_hash_table_lookup (pixbuf_cache, name);
+	if (test_record != NULL) {
+		/* image is already in the cache. */
+		gl_debug (DEBUG_PIXBUF_CACHE, "END already in cache");
+		return;
+	}
+
+	record = g_new0 (CacheRecord, 1);
+	record->key        = g_strdup (name);
+	record->references = 0; /* Nobody has referenced it yet. */
+	record->pixbuf     = NULL;
+	record->encoded    = g_strdup (encoded);
+	record->format     = format;
+
+	g_hash_table_insert (pixbuf_cache, record->key, record);
+
+	gl_debug (DEBUG_PIXBUF_CACHE, "END");
+}
+
+
+/*****************************************************************************/
+/* Reference a cached image that has not been decoded yet, without decoding  */
+/* it.  Returns FALSE if name is not in the cache or is already decoded.     */
+/*****************************************************************************/
+gboolean
+gl_pixbuf_cache_ref_encoded (GHashTable *pixbuf_cache,
+			     gchar      *name)
+{
+	CacheRecord *record;
+
+	record = g_hash_table_lookup (pixbuf_cache, name);
+	if ( (record == NULL) || !record_is_pending (record) ) {
+		return FALSE;
+	}
+
+	record->references++;
+	gl_debug (DEBUG_PIXBUF_CACHE, "references=%d", record->references);
+
+	return TRUE;
+}
+
+
+/*****************************************************************************/
+/* Peek at cached pixbuf without adding a reference.  If it has not been     */
+/* decoded yet, decode it now if decode_flag is set, else return NULL.       */
+/*****************************************************************************/
+GdkPixbuf *
+gl_pixbuf_cache_peek_pixbuf (GHashTable *pixbuf_cache,
+			     gchar      *name,
+			     gboolean    decode_flag)
+{
+	CacheRecord *record;
+
+	record = g_hash_table_lookup (pixbuf_cache, name);
+	if (record == NULL) {
+		return NULL;
+	}
+
+	if ( decode_flag ) {
+		record_decode (record);
+	}
+
+	return record->pixbuf;
+}
+
+
+/*****************************************************************************/
+/* Get encoded form of a cached image, if any, without decoding it.          */
+/*****************************************************************************/
+const gchar *
+gl_pixbuf_cache_get_encoded (GHashTable          *pixbuf_cache,
+			     gchar               *name,
+			     glPixbufCacheFormat *format)
+{
+	CacheRecord *record;
+
+	record = g_hash_table_lookup (pixbuf_cache, name);
+	if ( (record == NULL) || (record->encoded == NULL) ) {
+		return NULL;
+	}
+
+	*format = record->format;
+	return record->encoded;
+}
+
+
+/*****************************************************************************/
+/* Get cached image as base64 PNG, compressing it if needed.  The result is  */
+/* kept, so saving the same image again is cheap.  Returns NULL if it cannot */
+/* be converted, its original data is still available from                   */
+/* gl_pixbuf_cache_get_encoded().                                            */
+/*****************************************************************************/
+const gchar *
+gl_pixbuf_cache_get_png (GHashTable *pixbuf_cache,
+			 gchar      *name)
+{
+	CacheRecord *record;
+	gchar       *buffer;
+	gsize        buffer_size;
+
+	record = g_hash_table_lookup (pixbuf_cache, name);
+	if (record == NULL) {
+		return NULL;
+	}
+
+	if ( (record->encoded != NULL) && (record->format == GL_PIXBUF_CACHE_FORMAT_PNG) ) {
+		return record->encoded;
+	}
+
+	record_decode (record);
+	if ( record->pixbuf == NULL ) {
+		return NULL;
+	}
+
+	gl_debug (DEBUG_PIXBUF_CACHE, "compressing %s", record->key);
+
+	if ( !gdk_pixbuf_save_to_buffer (record->pixbuf, &buffer, &buffer_size,
+					 "png", NULL, NULL) ) {
+		return NULL;
+	}
+
+	g_free (record->encoded);
+	record->encoded = g_base64_encode ((guchar *)buffer, buffer_size);
+	record->format  = GL_PIXBUF_CACHE_FORMAT_PNG;
+	g_free (buffer);
+
+	return record->encoded;
+}
+
+
+/*****************************************************************************/
+/* Get pixel size of a cached image.  Undecoded images are sized from their  */
+/* header.                                                                   */
+/*****************************************************************************/
+gboolean
+gl_pixbuf_cache_get_size (GHashTable *pixbuf_cache,
+			  gchar      *name,
+			  gint       *width,
+			  gint       *height)
+{
+	CacheRecord *record;
+
+	record = g_hash_table_lookup (pixbuf_cache, name);
+	if (record == NULL) {
+		return FALSE;
+	}
+
+	if ( record->pixbuf != NULL ) {
+		*width  = gdk_pixbuf_get_width (record->pixbuf);
+		*height = gdk_pixbuf_get_height (record->pixbuf);
+		return TRUE;
+	}
+
+	if ( (record->encoded != NULL) &&
+	     read_header_size (record->encoded, record->format, width, height) ) {
+		return TRUE;
+	}
+
+	/* Corrupt header, fall back to decoding it. */
+	record_decode (record);
+	if ( record->pixbuf != NULL ) {
+		*width  = gdk_pixbuf_get_width (record->pixbuf);
+		*height = gdk_pixbuf_get_height (record->pixbuf);
+		return TRUE;
+	}
+
+	return FALSE;
+}
+
+
+/*****************************************************************************/
+/* Decode all undecoded images of cache in a worker thread.  The pixbufs are */
+/* installed in the cache by gl_pixbuf_cache_decode_finish(), which must be  */
+/* called from callback.  source_object (normally the owning label) is kept  */
+/* alive until then.                                                         */
+/*****************************************************************************/
+void
+gl_pixbuf_cache_decode_async (GHashTable          *pixbuf_cache,
+			      gpointer             source_object,
+			      GCancellable        *cancellable,
+			      GAsyncReadyCallback  callback,
+			      gpointer             user_data)
+{
+	GTask          *task;
+	GPtrArray      *jobs;
+	GHashTableIter  iter;
+	CacheRecord    *record;
+	DecodeJob      *job;
+
+	gl_debug (DEBUG_PIXBUF_CACHE, "START");
+
+	/* The worker only sees private copies, never the cache itself. */
+	jobs = g_ptr_array_new_with_free_func (decode_job_free);
+	g_hash_table_iter_init (&iter, pixbuf_cache);
+	while ( g_hash_table_iter_next (&iter, NULL, (gpointer *)&record) )
+	{
+		if ( record_is_pending (record) )
+		{
+			job = g_new0 (DecodeJob, 1);
+			job->key     = g_strdup (record->key);
+			job->encoded = g_strdup (record->encoded);
+			job->format  = record->format;
+			g_ptr_array_add (jobs, job);
+		}
+	}
+
+	task = g_task_new (source_object, cancellable, callback, user_data);
+	g_task_set_source_tag (task, gl_pixbuf_cache_decode_async);
+	g_task_set_task_data (task, jobs, (GDestroyNotify)g_ptr_array_unref);
+
+	gl_debug (DEBUG_PIXBUF_CACHE, "END %d images", jobs->len);
+
+	if ( jobs->len == 0 )
+	{
+		g_task_return_boolean (task, TRUE);
+	}
+	else
+	{
+		g_task_run_in_thread (task, decode_thread);
+	}
+	g_object_unref (task);
+}
+
+
+/*****************************************************************************/
+/* Finish decoding started with gl_pixbuf_cache_decode_async().  Returns     */
+/* TRUE if any image in the cache was decoded.                               */
+/*****************************************************************************/
+gboolean
+gl_pixbuf_cache_decode_finish (GHashTable    *pixbuf_cache,
+			       gpointer       source_object,
+			       GAsyncResult  *result,
+			       GError       **error)
+{
+	GPtrArray   *jobs;
+	DecodeJob   *job;
+	CacheRecord *record;
+	gboolean     decoded_flag = FALSE;
+	guint        i;
+
+	g_return_val_if_fail (g_task_is_valid (result, source_object), FALSE);
+
+	if ( !g_task_propagate_boolean (G_TASK (result), error) ) {
+		return FALSE;
+	}
+
+	jobs = g_task_get_task_data (G_TASK (result));
+	for ( i = 0; i < jobs->len; i++ )
+	{
+		job = g_ptr_array_index (jobs, i);
+
+		/* Cache may have changed while the worker was running. */
+		record = g_hash_table_lookup (pixbuf_cache, job->key);
+		if ( (record == NULL) ||
+		     !record_is_pending (record) || strcmp (record->encoded, job->encoded) ) {
+			continue;
+		}
+
+		if ( job->pixbuf == NULL ) {
+			record->failed_flag = TRUE;
+			continue;
+		}
+
+		record_set_pixbuf (record, g_object_ref (job->pixbuf));
+
+		decoded_flag = TRUE;
+	}
+
+	return decoded_flag;
+}
+
+
+/*---------------------------------------------------------------------------*/
+/* PRIVATE.  Decode base64 image data.                                       */
+/*---------------------------------------------------------------------------*/
+static GdkPixbuf *
+decode_image (const gchar         *encoded,
+	      glPixbufCacheFormat  format)
+{
+	guchar          *stream;
+	gsize            stream_length;
+	GdkPixdata       pixdata;
+	GdkPixbufLoader *loader;
+	GdkPixbuf       *pixbuf = NULL;
+
+	stream = g_base64_decode (encoded, &stream_length);
+
+	switch (format)
+	{
+
+	case GL_PIXBUF_CACHE_FORMAT_PIXDATA:
+		if ( gdk_pixdata_deserialize (&pixdata, stream_length, stream, NULL) ) {
+			pixbuf = gdk_pixbuf_from_pixdata (&pixdata, TRUE, NULL);
+		}
+		break;
+
+	case GL_PIXBUF_CACHE_FORMAT_PNG:
+		loader = gdk_pixbuf_loader_new_with_type ("png", NULL);
+		if ( loader != NULL ) {
+			if ( gdk_pixbuf_loader_write (loader, stream, stream_length, NULL) &&
+			     gdk_pixbuf_loader_close (loader, NULL) ) {
+				pixbuf = gdk_pixbuf_loader_get_pixbuf (loader);
+				if ( pixbuf ) {
+					g_object_ref (pixbuf);
+				}
+			} else {
+				gdk_pixbuf_loader_close (loader, NULL);
+			}
+			g_object_unref (loader);
+		}
+		break;
+
+	}
+
+	g_free (stream);
+
+	return pixbuf;
+}
+
+
+/*---------------------------------------------------------------------------*/
+/* PRIVATE.  Read image size from header of base64 image data.               */
+/*---------------------------------------------------------------------------*/
+static gboolean
+read_header_size (const gchar         *encoded,
+		  glPixbufCacheFormat  format,
+		  gint                *width,
+		  gint                *height)
+{
+	guchar   header[HEADER_BASE64_LENGTH];
+	gsize    length;
+	gint     state = 0;
+	guint    save  = 0;
+	guint32  magic, w, h;
+
+	length = g_base64_decode_step (encoded,
+				       strnlen (encoded, HEADER_BASE64_LENGTH),
+				       header, &state, &save);
+	if ( length < HEADER_SIZE_OFFSET + 8 ) {
+		return FALSE;
+	}
+
+	switch (format)
+	{
+
+	case GL_PIXBUF_CACHE_FORMAT_PIXDATA:
+		memcpy (&magic, header, 4);
+		if ( GUINT32_FROM_BE (magic) != GDK_PIXBUF_MAGIC_NUMBER ) {
+			return FALSE;
+		}
+		break;
+
+	case GL_PIXBUF_CACHE_FORMAT_PNG:
+		if ( memcmp (header, png_signature, sizeof (png_signature)) ||
+		     memcmp (header + 12, "IHDR", 4) ) {
+			return FALSE;
+		}
+		break;
+
+	default:
+		return FALSE;
+
+	}
+
+	memcpy (&w, header + HEADER_SIZE_OFFSET,     4);
+	memcpy (&h, header + HEADER_SIZE_OFFSET + 4, 4);
+
+	*width  = GUINT32_FROM_BE (w);
+	*height = GUINT32_FROM_BE (h);
+
+	return (*width > 0) && (*height > 0);
+}
+
+
+/*---------------------------------------------------------------------------*/
+/* PRIVATE.  Is record waiting to be decoded?                                */
+/*---------------------------------------------------------------------------*/
+static gboolean
+record_is_pending (CacheRecord *record)
+{
+	return (record->pixbuf == NULL) && (record->encoded != NULL) && !record->failed_flag;
+}
+
+
+/*---------------------------------------------------------------------------*/
+/* PRIVATE.  Install decoded pixbuf (takes ownership).                       */
+/*---------------------------------------------------------------------------*/
+static void
+record_set_pixbuf (CacheRecord *record,
+		   GdkPixbuf   *pixbuf)
+{
+	record->pixbuf = pixbuf;
+
+	if ( record->format != GL_PIXBUF_CACHE_FORMAT_PNG ) {
+		g_free (record->encoded);
+		record->encoded = NULL;
+	}
+}
+
+
+/*---------------------------------------------------------------------------*/
+/* PRIVATE.  Decode record now, if not decoded yet.                          */
+/*---------------------------------------------------------------------------*/
+static void
+record_decode (CacheRecord *record)
+{
+	GdkPixbuf *pixbuf;
+
+	if ( !record_is_pending (record) ) {
+		return;
+	}
+
+	gl_debug (DEBUG_PIXBUF_CACHE, "decoding %s", record->key);
+
+	pixbuf = decode_image (record->encoded, record->format);
+	if ( pixbuf != NULL ) {
+		record_set_pixbuf (record, pixbuf);
+	} else {
+		/* Don't try again, but keep the data so it is saved unchanged. */
+		record->failed_flag = TRUE;
+	}
+}
+
+
+/*---------------------------------------------------------------------------*/
+/* PRIVATE.  Free decode job.                                                */
+/*---------------------------------------------------------------------------*/
+static void
+decode_job_free (gpointer data)
+{
+	DecodeJob *job = (DecodeJob *)data;
+
+	g_free (job->key);
+	g_free (job->encoded);
+	if ( job->pixbuf ) {
+		g_object_unref (job->pixbuf);
+	}
+	g_free (job);
+}
+
+
+/*---------------------------------------------------------------------------*/
+/* PRIVATE.  Worker thread: decode all jobs.                                 */
+/*---------------------------------------------------------------------------*/
+static void
+decode_thread (GTask        *task,
+	       gpointer      source_object,
+	       gpointer      task_data,
+	       GCancellable *cancellable)
+{
+	GPtrArray *jobs = (GPtrArray *)task_data;
+	DecodeJob *job;
+	guint      i;
+
+	for ( i = 0; i < jobs->len; i++ )
+	{
+		if ( g_task_return_error_if_cancelled (task) ) {
+			return;
+		}
+
+		job = g_ptr_array_index (jobs, i);
+		job->pixbuf = decode_image (job->encoded, job->format);
+	}
+
+	g_task_return_boolean (task, TRUE);
+}
+
+
 /*---------------------------------------------------------------------------*/
 /* PRIVATE.  Add a name to a GList while iterating over cache.               */
 /*---------------------------------------------------------------------------*/
@@ -23,9 +23,17 @@
 
 #include <glib.h>
 #include <gdk-pixbuf/gdk-pixbuf.h>
+#include <gio/gio.h>
 
 G_BEGIN_DECLS
 
+/* Encodings of embedded image data. */
+typedef enum {
+        GL_PIXBUF_CACHE_FORMAT_PIXDATA,
+        GL_PIXBUF_CACHE_FORMAT_PNG
+} glPixbufCacheFormat;
+
+
 GHashTable *gl_pixbuf_cache_new            (void);
 
 void        gl_pixbuf_cache_free           (GHashTable *pixbuf_cache);
@@ -40,6 +48,44 @@ GdkPixbuf  *gl_pixbuf_cache_get_pixbuf     (GHashTable *pixbuf_cache,
 void        gl_pixbuf_cache_remove_pixbuf  (GHashTable *pixbuf_cache,
 					    gchar      *name);
 
+void        gl_pixbuf_cache_transfer       (GHashTable *dst_cache,
+					    GHashTable *src_cache);
+
+void        gl_pixbuf_cache_add_encoded    (GHashTable          *pixbuf_cache,
+					    gchar               *name,
+					    const gchar         *encoded,
+					    glPixbufCacheFormat  format);
+
+gboolean    gl_pixbuf_cache_ref_encoded    (GHashTable *pixbuf_cache,
+					    gchar      *name);
+
+GdkPixbuf  *gl_pixbuf_cache_peek_pixbuf    (GHashTable *pixbuf_cache,
+					    gchar      *name,
+					    gboolean    decode_flag);
+
+const gchar *gl_pixbuf_cache_get_encoded   (GHashTable          *pixbuf_cache,
+					    gchar               *name,
+					    glPixbufCacheFormat *format);
+
+const gchar *gl_pixbuf_cache_get_png       (GHashTable *pixbuf_cache,
+					    gchar      *name);
+
+gboolean    gl_pixbuf_cache_get_size       (GHashTable *pixbuf_cache,
+					    gchar      *name,
+					    gint       *width,
+					    gint       *height);
+
+void        gl_pixbuf_cache_decode_async   (GHashTable          *pixbuf_cache,
+					    gpointer             source_object,
+					    GCancellable        *cancellable,
+					    GAsyncReadyCallback  callback,
+					    gpointer             user_data);
+
+gboolean    gl_pixbuf_cache_decode_finish  (GHashTable    *pixbuf_cache,
+					    gpointer       source_object,
+					    GAsyncResult  *result,
+					    GError       **error);
+
 GList      *gl_pixbuf_cache_get_name_list  (GHashTable *pixbuf_cache);
 
 void        gl_pixbuf_cache_free_name_list (GList      *name_list);
@@ -869,6 +869,40 @@ gl_prefs_model_get_max_recents (glPrefsModel     *this)
 }
 
 
+/*****************************************************************************/
+/* Set max undo objects.                                                     */
+/*****************************************************************************/
+void
+gl_prefs_model_set_max_undo_objects (glPrefsModel     *this,
+                                     gint              max_undo_objects)
+{
+        if ( this->priv->ui )
+        {
+	        g_settings_set_int (this->priv->ui,
+	                            "max-undo-objects",
+	                            max_undo_objects);
+        }
+}
+
+
+/*****************************************************************************/
+/* Get max undo objects.                                                     */
+/*****************************************************************************/
+gint
+gl_prefs_model_get_max_undo_objects (glPrefsModel     *this)
+{
+        if ( !this->priv->ui )
+        {
+	        return 10000;
+        }
+
+        gint max_undo_objects = g_settings_get_int (this->priv->ui,
+                                                    "max-undo-objects");
+
+        return max_undo_objects;
+}
+
+
 /*---------------------------------------------------------------------------*/
 /* PRIVATE.  Key changed callback.                                           */
 /*---------------------------------------------------------------------------*/
@@ -169,6 +169,12 @@ void           gl_prefs_model_set_max_recents               (glPrefsModel     *t
 gint           gl_prefs_model_get_max_recents               (glPrefsModel     *this);
 
 
+void           gl_prefs_model_set_max_undo_objects          (glPrefsModel     *this,
+                                                             gint              max_undo_objects);
+
+gint           gl_prefs_model_get_max_undo_objects          (glPrefsModel     *this);
+
+
 G_END_DECLS
 
 #endif /* __PREFS_MODEL_H__ */
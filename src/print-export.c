@@ -0,0 +1,1015 @@
+/*
+ *  print-export.c
+ *  Copyright (C) 2026  agent <agent@local>.
+ *
+ *  This file is part of gLabels.
+ *
+ *  gLabels is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  gLabels is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with gLabels.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <config.h>
+
+#include "print-export.h"
+
+#include <glib/gi18n.h>
+#include <gio/gio.h>
+#include <math.h>
+#include <string.h>
+#include <cairo.h>
+#include <cairo-pdf.h>
+#include <cairo-ps.h>
+#include <cairo-svg.h>
+
+#include <libglabels.h>
+#include "print.h"
+#include "print-raster.h"
+#include "print-zpl.h"
+#include "file-util.h"
+
+#include "debug.h"
+
+
+/*===========================================*/
+/* Private macros and constants.             */
+/*===========================================*/
+
+#define DEFAULT_RESOLUTION 300.0
+#define POINTS_PER_INCH     72.0
+
+
+/*===========================================*/
+/* Private types.                            */
+/*===========================================*/
+
+/* Destination: a file, or a stream if write_func is set. */
+typedef struct {
+        const gchar        *filename;
+        cairo_write_func_t  write_func;
+        void               *closure;
+} Output;
+
+
+/*===========================================*/
+/* Private function prototypes.              */
+/*===========================================*/
+
+static void      draw_sheet         (glLabel               *label,
+                                     cairo_t               *cr,
+                                     gint                   page,
+                                     gboolean               merge_flag,
+                                     glPrintExportSettings *settings,
+                                     glPrintState          *state);
+
+static gboolean  export            (glLabel               *label,
+                                     Output                *output,
+                                     glPrintExportSettings *settings,
+                                     GError               **error);
+
+static gboolean  export_chunks      (glLabel               *label,
+                                     Output                *output,
+                                     gboolean               merge_flag,
+                                     glPrintExportSettings *settings,
+                                     gint                   page_first,
+                                     gint                   page_last,
+                                     GError               **error);
+
+static gboolean  export_sheets      (glLabel               *label,
+                                     Output                *output,
+                                     gboolean               merge_flag,
+                                     glPrintExportSettings *settings,
+                                     gint                   page_first,
+                                     gint                   page_last,
+                                     GError               **error);
+
+static gboolean  export_document    (glLabel               *label,
+                                     Output                *output,
+                                     gboolean               merge_flag,
+                                     glPrintExportSettings *settings,
+                                     gint                   page_first,
+                                     gint                   page_last,
+                                     GError               **error);
+
+static gboolean  export_pages       (glLabel               *label,
+                                     Output                *output,
+                                     gboolean               merge_flag,
+                                     glPrintExportSettings *settings,
+                                     gint                   page_first,
+                                     gint                   page_last,
+                                     GError               **error);
+
+static gboolean  export_raster      (glLabel               *label,
+                                     Output                *output,
+                                     gboolean               merge_flag,
+                                     glPrintExportSettings *settings,
+                                     gint                   page_first,
+                                     gint                   page_last,
+                                     GError               **error);
+
+static void      get_sheet_labels   (glPrintExportSettings *settings,
+                                     gboolean               merge_flag,
+                                     gint                   n_labels_per_page,
+                                     gint                   n_records,
+                                     gint                   page,
+                                     gint                  *i_first,
+                                     gint                  *i_last);
+
+static gboolean  check_status       (cairo_status_t         status,
+                                     const gchar           *filename,
+                                     GError               **error);
+
+
+/*****************************************************************************/
+/* Initialize export settings with defaults for label.                       */
+/*****************************************************************************/
+void
+gl_print_export_settings_init (glPrintExportSettings *settings,
+                               glLabel               *label)
+{
+        const lglTemplate      *template;
+        const lglTemplateFrame *frame;
+
+        g_return_if_fail (settings);
+        g_return_if_fail (label && GL_IS_LABEL (label));
+
+        template = gl_label_get_template (label);
+        frame    = (lglTemplateFrame *)template->frames->data;
+
+        settings->format          = GL_PRINT_EXPORT_FORMAT_PDF;
+        settings->n_sheets        = 1;
+        settings->n_copies        = 1;
+        settings->first           = 1;
+        settings->last            = lgl_template_frame_get_n_labels (frame);
+        settings->collate_flag    = FALSE;
+        settings->outline_flag    = FALSE;
+        settings->reverse_flag    = FALSE;
+        settings->crop_marks_flag = FALSE;
+        settings->sheet_first     = 0;
+        settings->sheet_last      = G_MAXINT;
+        settings->sheet_offset    = 0;
+        settings->resolution      = DEFAULT_RESOLUTION;
+        settings->per_label_flag  = FALSE;
+        settings->n_threads       = 0;
+        settings->mono_flag       = FALSE;
+        settings->dither          = GL_MONO_DITHER_THRESHOLD;
+        settings->chunk_sheets    = 0;
+        settings->chunk_records   = 0;
+        settings->progress_func   = NULL;
+        settings->progress_data   = NULL;
+        settings->checkpoint_func = NULL;
+        settings->checkpoint_data = NULL;
+}
+
+
+/*****************************************************************************/
+/* Guess export format from filename extension, PDF if unknown.              */
+/*****************************************************************************/
+glPrintExportFormat
+gl_print_export_format_from_filename (const gchar *filename)
+{
+        if ( gl_file_util_is_extension (filename, ".ps") )
+        {
+                return GL_PRINT_EXPORT_FORMAT_PS;
+        }
+        else if ( gl_file_util_is_extension (filename, ".svg") )
+        {
+                return GL_PRINT_EXPORT_FORMAT_SVG;
+        }
+        else if ( gl_file_util_is_extension (filename, ".png") )
+        {
+                return GL_PRINT_EXPORT_FORMAT_PNG;
+        }
+        else if ( gl_file_util_is_extension (filename, ".tif") ||
+                  gl_file_util_is_extension (filename, ".tiff") )
+        {
+                return GL_PRINT_EXPORT_FORMAT_TIFF;
+        }
+        else if ( gl_file_util_is_extension (filename, ".pbm") )
+        {
+                return GL_PRINT_EXPORT_FORMAT_PBM;
+        }
+        else if ( gl_file_util_is_extension (filename, ".zpl") )
+        {
+                return GL_PRINT_EXPORT_FORMAT_ZPL;
+        }
+
+        return GL_PRINT_EXPORT_FORMAT_PDF;
+}
+
+
+/*****************************************************************************/
+/* Export format from its name, i.e. its usual extension without the dot,    */
+/* for output that has no filename.  Returns FALSE if name is unknown.       */
+/*****************************************************************************/
+gboolean
+gl_print_export_format_from_name (const gchar         *name,
+                                  glPrintExportFormat *format)
+{
+        static const struct {
+                const gchar         *name;
+                glPrintExportFormat  format;
+        } formats[] = {
+                { "pdf",  GL_PRINT_EXPORT_FORMAT_PDF },
+                { "ps",   GL_PRINT_EXPORT_FORMAT_PS },
+                { "svg",  GL_PRINT_EXPORT_FORMAT_SVG },
+                { "png",  GL_PRINT_EXPORT_FORMAT_PNG },
+                { "tif",  GL_PRINT_EXPORT_FORMAT_TIFF },
+                { "tiff", GL_PRINT_EXPORT_FORMAT_TIFF },
+                { "pbm",  GL_PRINT_EXPORT_FORMAT_PBM },
+                { "zpl",  GL_PRINT_EXPORT_FORMAT_ZPL },
+        };
+        guint i;
+
+        g_return_val_if_fail (name, FALSE);
+        g_return_val_if_fail (format, FALSE);
+
+        for ( i = 0; i < G_N_ELEMENTS (formats); i++ )
+        {
+                if ( g_ascii_strcasecmp (name, formats[i].name) == 0 )
+                {
+                        *format = formats[i].format;
+                        return TRUE;
+                }
+        }
+
+        return FALSE;
+}
+
+
+/*****************************************************************************/
+/* For merge labels, set n_sheets from first, n_copies and the number of     */
+/* selected records.                                                         */
+/*****************************************************************************/
+void
+gl_print_export_settings_count_sheets (glPrintExportSettings *settings,
+                                       glLabel               *label)
+{
+        const lglTemplate      *template;
+        const lglTemplateFrame *frame;
+        glMerge                *merge;
+
+        g_return_if_fail (settings);
+        g_return_if_fail (label && GL_IS_LABEL (label));
+
+        merge = gl_label_get_merge (label);
+        if ( merge == NULL )
+        {
+                return;
+        }
+
+        template = gl_label_get_template (label);
+        frame    = (lglTemplateFrame *)template->frames->data;
+
+        settings->n_sheets = ceil ((double)(settings->first-1 + settings->n_copies * gl_merge_get_record_count (merge))
+                                   / lgl_template_frame_get_n_labels (frame));
+
+        g_object_unref (merge);
+}
+
+
+/*****************************************************************************/
+/* For a merge label that holds only the records following n_records earlier */
+/* records of a whole job, move first to where its first label falls on the  */
+/* sheets of that job.  Returns the number of whole sheets of the job before */
+/* that one: sheet N of this export is sheet N plus that number of the job.  */
+/* Copies must be collated (or single), so that the records' labels follow   */
+/* each other.                                                               */
+/*****************************************************************************/
+gint
+gl_print_export_settings_skip_records (glPrintExportSettings *settings,
+                                       glLabel               *label,
+                                       gint                   n_records)
+{
+        const lglTemplate      *template;
+        const lglTemplateFrame *frame;
+        gint                    n_labels_per_page;
+        gint                    i_label;
+
+        g_return_val_if_fail (settings, 0);
+        g_return_val_if_fail (label && GL_IS_LABEL (label), 0);
+
+        template = gl_label_get_template (label);
+        frame    = (lglTemplateFrame *)template->frames->data;
+        n_labels_per_page = lgl_template_frame_get_n_labels (frame);
+
+        i_label = settings->first-1 + n_records * settings->n_copies;
+
+        settings->first = i_label % n_labels_per_page + 1;
+
+        return i_label / n_labels_per_page;
+}
+
+
+/*****************************************************************************/
+/* Export label to file.  PDF, PostScript and ZPL produce a single document, */
+/* SVG and PNG produce one file per sheet ("name-N.ext") if more than one.   */
+/* With chunks, PDF, PostScript and TIFF produce numbered documents          */
+/* ("name-NNNN.ext"), each finished and closed before the next one starts.   */
+/*****************************************************************************/
+gboolean
+gl_print_export (glLabel               *label,
+                 const gchar           *filename,
+                 glPrintExportSettings *settings,
+                 GError               **error)
+{
+        Output output = { filename, NULL, NULL };
+
+        g_return_val_if_fail (filename, FALSE);
+
+        return export (label, &output, settings, error);
+}
+
+
+/*****************************************************************************/
+/* Export label to a cairo write function.  SVG and PNG sheets are written   */
+/* to the stream one after the other, each as a complete image.              */
+/*****************************************************************************/
+gboolean
+gl_print_export_to_stream (glLabel               *label,
+                           cairo_write_func_t     write_func,
+                           void                  *closure,
+                           glPrintExportSettings *settings,
+                           GError               **error)
+{
+        Output output = { NULL, write_func, closure };
+
+        g_return_val_if_fail (write_func, FALSE);
+
+        return export (label, &output, settings, error);
+}
+
+
+/*****************************************************************************/
+/* Draw a single sheet of the export onto cr, in points.  Sheets may be      */
+/* drawn in any order.                                                       */
+/*****************************************************************************/
+void
+gl_print_export_draw_sheet (glLabel               *label,
+                            cairo_t               *cr,
+                            gint                   sheet,
+                            glPrintExportSettings *settings)
+{
+        glMerge      *merge;
+        glPrintState  state = { 0, NULL, NULL };
+
+        g_return_if_fail (label && GL_IS_LABEL (label));
+        g_return_if_fail (cr);
+        g_return_if_fail (settings);
+
+        merge = gl_label_get_merge (label);
+
+        cairo_save (cr);
+        draw_sheet (label, cr, sheet, (merge != NULL), settings, &state);
+        cairo_restore (cr);
+
+        gl_print_state_clear (&state);
+        if ( merge )
+        {
+                g_object_unref (merge);
+        }
+}
+
+
+/*****************************************************************************/
+/* Filename of given page: "name.ext" -> "name-N.ext" if more than one page. */
+/*****************************************************************************/
+gchar *
+gl_print_export_page_filename (const gchar *filename,
+                               gint         page,
+                               gint         n_pages)
+{
+        const gchar *ext;
+        const gchar *base;
+
+        if ( n_pages <= 1 )
+        {
+                return g_strdup (filename);
+        }
+
+        base = strrchr (filename, G_DIR_SEPARATOR);
+        ext  = strrchr (filename, '.');
+        if ( (ext == NULL) || (base && (ext < base)) )
+        {
+                return g_strdup_printf ("%s-%d", filename, page + 1);
+        }
+
+        return g_strdup_printf ("%.*s-%d%s", (int)(ext - filename), filename, page + 1, ext);
+}
+
+
+/*****************************************************************************/
+/* Filename of given chunk: "name.ext" -> "name-NNNN.ext", from 1.           */
+/*****************************************************************************/
+gchar *
+gl_print_export_chunk_filename (const gchar *filename,
+                                gint         chunk)
+{
+        const gchar *ext;
+        const gchar *base;
+
+        base = strrchr (filename, G_DIR_SEPARATOR);
+        ext  = strrchr (filename, '.');
+        if ( (ext == NULL) || (base && (ext < base)) )
+        {
+                return g_strdup_printf ("%s-%04d", filename, chunk + 1);
+        }
+
+        return g_strdup_printf ("%.*s-%04d%s", (int)(ext - filename), filename, chunk + 1, ext);
+}
+
+
+/*****************************************************************************/
+/* Number of sheets per chunk, 0 if output is not split.  A record count is  */
+/* rounded down to whole sheets of merged labels, so that every chunk starts */
+/* at a sheet boundary of the whole job.                                     */
+/*****************************************************************************/
+gint
+gl_print_export_get_chunk_sheets (glPrintExportSettings *settings,
+                                  glLabel               *label)
+{
+        const lglTemplate      *template;
+        const lglTemplateFrame *frame;
+        glMerge                *merge;
+
+        g_return_val_if_fail (settings, 0);
+        g_return_val_if_fail (label && GL_IS_LABEL (label), 0);
+
+        switch (settings->format)
+        {
+        case GL_PRINT_EXPORT_FORMAT_PDF:
+        case GL_PRINT_EXPORT_FORMAT_PS:
+        case GL_PRINT_EXPORT_FORMAT_TIFF:
+                break;
+        default:
+                return 0;
+        }
+
+        if ( settings->chunk_sheets > 0 )
+        {
+                return settings->chunk_sheets;
+        }
+
+        if ( settings->chunk_records > 0 )
+        {
+                merge = gl_label_get_merge (label);
+                if ( merge == NULL )
+                {
+                        return 0;
+                }
+                g_object_unref (merge);
+
+                template = gl_label_get_template (label);
+                frame    = (lglTemplateFrame *)template->frames->data;
+
+                return MAX (1, settings->chunk_records * settings->n_copies
+                               / lgl_template_frame_get_n_labels (frame));
+        }
+
+        return 0;
+}
+
+
+/*****************************************************************************/
+/* Whether exporting to a file reports checkpoints, i.e. whether sheets end  */
+/* up in files that are finished one after the other: chunks, or one SVG,    */
+/* PNG or PBM file per sheet.  A single document is only complete at its     */
+/* end, and files per label are numbered within this export only.            */
+/*****************************************************************************/
+gboolean
+gl_print_export_can_checkpoint (glPrintExportSettings *settings,
+                                glLabel               *label)
+{
+        g_return_val_if_fail (settings, FALSE);
+        g_return_val_if_fail (label && GL_IS_LABEL (label), FALSE);
+
+        switch (settings->format)
+        {
+        case GL_PRINT_EXPORT_FORMAT_SVG:
+                return TRUE;
+        case GL_PRINT_EXPORT_FORMAT_PNG:
+        case GL_PRINT_EXPORT_FORMAT_PBM:
+                return !settings->per_label_flag;
+        default:
+                return (gl_print_export_get_chunk_sheets (settings, label) > 0);
+        }
+}
+
+
+/*---------------------------------------------------------------------------*/
+/* PRIVATE.  Export label to output.                                         */
+/*---------------------------------------------------------------------------*/
+static gboolean
+export (glLabel               *label,
+        Output                *output,
+        glPrintExportSettings *settings,
+        GError               **error)
+{
+        glMerge  *merge;
+        gboolean  merge_flag;
+        gint      page_first, page_last;
+        gboolean  ret;
+
+        gl_debug (DEBUG_PRINT, "START");
+
+        g_return_val_if_fail (label && GL_IS_LABEL (label), FALSE);
+        g_return_val_if_fail (settings, FALSE);
+
+        merge      = gl_label_get_merge (label);
+        merge_flag = (merge != NULL);
+        if ( merge )
+        {
+                g_object_unref (merge);
+        }
+
+        page_first = CLAMP (settings->sheet_first, 0, settings->n_sheets);
+        page_last  = CLAMP (settings->sheet_last, page_first, settings->n_sheets);
+
+        if ( output->filename && (gl_print_export_get_chunk_sheets (settings, label) > 0) )
+        {
+                ret = export_chunks (label, output, merge_flag, settings,
+                                     page_first, page_last, error);
+        }
+        else
+        {
+                ret = export_sheets (label, output, merge_flag, settings,
+                                     page_first, page_last, error);
+        }
+
+        gl_debug (DEBUG_PRINT, "END");
+
+        return ret;
+}
+
+
+/*---------------------------------------------------------------------------*/
+/* PRIVATE.  Export sheets in numbered files of chunk_sheets each.  Every    */
+/* file is a complete document; earlier files survive a later failure.      */
+/* Chunks are counted from sheet 0 of the whole job, even if page_first is   */
+/* further on.                                                               */
+/*---------------------------------------------------------------------------*/
+static gboolean
+export_chunks (glLabel               *label,
+               Output                *output,
+               gboolean               merge_flag,
+               glPrintExportSettings *settings,
+               gint                   page_first,
+               gint                   page_last,
+               GError               **error)
+{
+        Output    chunk_output = { NULL, NULL, NULL };
+        gchar    *chunk_fn;
+        gint      n_chunk_sheets, offset;
+        gint      chunk, page, chunk_last;
+        gboolean  ret = TRUE;
+
+        n_chunk_sheets = gl_print_export_get_chunk_sheets (settings, label);
+        offset         = settings->sheet_offset;
+
+        for ( chunk = (page_first + offset) / n_chunk_sheets, page = page_first;
+              (page < page_last) && ret;
+              chunk++, page = chunk_last )
+        {
+                chunk_last = MIN ((chunk + 1) * n_chunk_sheets - offset, page_last);
+
+                chunk_fn = gl_print_export_chunk_filename (output->filename, chunk);
+                chunk_output.filename = chunk_fn;
+
+                ret = export_sheets (label, &chunk_output, merge_flag, settings,
+                                     page, chunk_last, error);
+
+                if ( ret && settings->checkpoint_func )
+                {
+                        settings->checkpoint_func (chunk_last + offset,
+                                                   settings->checkpoint_data);
+                }
+
+                g_free (chunk_fn);
+        }
+
+        return ret;
+}
+
+
+/*---------------------------------------------------------------------------*/
+/* PRIVATE.  Export sheets page_first to page_last (exclusive) to output.    */
+/* Sheets keep their numbers and label positions from the whole job.        */
+/*---------------------------------------------------------------------------*/
+static gboolean
+export_sheets (glLabel               *label,
+               Output                *output,
+               gboolean               merge_flag,
+               glPrintExportSettings *settings,
+               gint                   page_first,
+               gint                   page_last,
+               GError               **error)
+{
+        gboolean ret;
+
+        switch (settings->format)
+        {
+
+        case GL_PRINT_EXPORT_FORMAT_SVG:
+                ret = export_pages (label, output, merge_flag, settings,
+                                    page_first, page_last, error);
+                break;
+
+        case GL_PRINT_EXPORT_FORMAT_PNG:
+        case GL_PRINT_EXPORT_FORMAT_TIFF:
+        case GL_PRINT_EXPORT_FORMAT_PBM:
+                ret = export_raster (label, output, merge_flag, settings,
+                                     page_first, page_last, error);
+                break;
+
+        case GL_PRINT_EXPORT_FORMAT_ZPL:
+                ret = gl_print_zpl (label, output->filename,
+                                    output->write_func, output->closure,
+                                    settings, error);
+                break;
+
+        default:
+                ret = export_document (label, output, merge_flag, settings,
+                                       page_first, page_last, error);
+                break;
+
+        }
+
+        return ret;
+}
+
+
+/*---------------------------------------------------------------------------*/
+/* PRIVATE.  Draw one sheet.                                                 */
+/*---------------------------------------------------------------------------*/
+static void
+draw_sheet (glLabel               *label,
+            cairo_t               *cr,
+            gint                   page,
+            gboolean               merge_flag,
+            glPrintExportSettings *settings,
+            glPrintState          *state)
+{
+        if (!merge_flag)
+        {
+                gl_print_simple_sheet (label, cr, page,
+                                       settings->n_sheets,
+                                       settings->first,
+                                       settings->last,
+                                       settings->outline_flag,
+                                       settings->reverse_flag,
+                                       settings->crop_marks_flag);
+        }
+        else if (settings->collate_flag)
+        {
+                gl_print_collated_merge_sheet (label, cr, page,
+                                               settings->n_copies,
+                                               settings->first,
+                                               settings->outline_flag,
+                                               settings->reverse_flag,
+                                               settings->crop_marks_flag,
+                                               state);
+        }
+        else
+        {
+                gl_print_uncollated_merge_sheet (label, cr, page,
+                                                 settings->n_copies,
+                                                 settings->first,
+                                                 settings->outline_flag,
+                                                 settings->reverse_flag,
+                                                 settings->crop_marks_flag,
+                                                 state);
+        }
+}
+
+
+/*---------------------------------------------------------------------------*/
+/* PRIVATE.  Export all sheets as pages of one PDF or PostScript document.   */
+/*---------------------------------------------------------------------------*/
+static gboolean
+export_document (glLabel               *label,
+                 Output                *output,
+                 gboolean               merge_flag,
+                 glPrintExportSettings *settings,
+                 gint                   page_first,
+                 gint                   page_last,
+                 GError               **error)
+{
+        const lglTemplate *template;
+        cairo_surface_t   *surface;
+        cairo_t           *cr;
+        glPrintState       state = { 0, NULL, NULL };
+        cairo_status_t     status;
+        gint               page;
+
+        template = gl_label_get_template (label);
+
+        if ( settings->format == GL_PRINT_EXPORT_FORMAT_PS )
+        {
+                if ( output->write_func )
+                {
+                        surface = cairo_ps_surface_create_for_stream (output->write_func,
+                                                                      output->closure,
+                                                                      template->page_width,
+                                                                      template->page_height);
+                }
+                else
+                {
+                        surface = cairo_ps_surface_create (output->filename,
+                                                           template->page_width,
+                                                           template->page_height);
+                }
+        }
+        else
+        {
+                if ( output->write_func )
+                {
+                        surface = cairo_pdf_surface_create_for_stream (output->write_func,
+                                                                       output->closure,
+                                                                       template->page_width,
+                                                                       template->page_height);
+                }
+                else
+                {
+                        surface = cairo_pdf_surface_create (output->filename,
+                                                            template->page_width,
+                                                            template->page_height);
+                }
+        }
+
+        cr = cairo_create (surface);
+
+        for ( page = page_first; page < page_last; page++ )
+        {
+                cairo_save (cr);
+                draw_sheet (label, cr, page, merge_flag, settings, &state);
+                cairo_restore (cr);
+
+                cairo_show_page (cr);
+
+                if ( settings->progress_func )
+                {
+                        settings->progress_func (page + 1, settings->n_sheets,
+                                                 settings->progress_data);
+                }
+        }
+
+        cairo_destroy (cr);
+        cairo_surface_finish (surface);
+        status = cairo_surface_status (surface);
+        cairo_surface_destroy (surface);
+
+        gl_print_state_clear (&state);
+
+        return check_status (status, output->filename, error);
+}
+
+
+/*---------------------------------------------------------------------------*/
+/* PRIVATE.  Export each sheet to its own SVG file.                          */
+/*---------------------------------------------------------------------------*/
+static gboolean
+export_pages (glLabel               *label,
+              Output                *output,
+              gboolean               merge_flag,
+              glPrintExportSettings *settings,
+              gint                   page_first,
+              gint                   page_last,
+              GError               **error)
+{
+        const lglTemplate *template;
+        cairo_surface_t   *surface;
+        cairo_t           *cr;
+        glPrintState       state = { 0, NULL, NULL };
+        cairo_status_t     status;
+        gint               page;
+        gchar             *page_fn = NULL;
+        gboolean           ret = TRUE;
+
+        template = gl_label_get_template (label);
+
+        for ( page = page_first; (page < page_last) && ret; page++ )
+        {
+                if ( output->write_func )
+                {
+                        surface = cairo_svg_surface_create_for_stream (output->write_func,
+                                                                       output->closure,
+                                                                       template->page_width,
+                                                                       template->page_height);
+                }
+                else
+                {
+                        page_fn = gl_print_export_page_filename (output->filename,
+                                                                 page + settings->sheet_offset,
+                                                                 settings->n_sheets + settings->sheet_offset);
+                        surface = cairo_svg_surface_create (page_fn,
+                                                            template->page_width,
+                                                            template->page_height);
+                }
+
+                cr = cairo_create (surface);
+                draw_sheet (label, cr, page, merge_flag, settings, &state);
+                cairo_destroy (cr);
+
+                cairo_surface_finish (surface);
+                status = cairo_surface_status (surface);
+                cairo_surface_destroy (surface);
+
+                ret = check_status (status, page_fn, error);
+
+                if ( ret && settings->progress_func )
+                {
+                        settings->progress_func (page + 1, settings->n_sheets,
+                                                 settings->progress_data);
+                }
+
+                if ( ret && page_fn && settings->checkpoint_func )
+                {
+                        settings->checkpoint_func (page + 1 + settings->sheet_offset,
+                                                   settings->checkpoint_data);
+                }
+
+                g_free (page_fn);
+                page_fn = NULL;
+        }
+
+        gl_print_state_clear (&state);
+
+        return ret;
+}
+
+
+/*---------------------------------------------------------------------------*/
+/* PRIVATE.  Export PNG, TIFF or PBM images.  Sheets are recorded here, one  */
+/* at a time, and rasterized by a pool of threads: label objects share       */
+/* caches that are not thread safe, a recording only references finished     */
+/* data.  Sheets are recorded in device pixels, so that 1-bit output can be  */
+/* drawn without antialiasing and with barcodes snapped to the pixel grid.   */
+/*---------------------------------------------------------------------------*/
+static gboolean
+export_raster (glLabel               *label,
+               Output                *output,
+               gboolean               merge_flag,
+               glPrintExportSettings *settings,
+               gint                   page_first,
+               gint                   page_last,
+               GError               **error)
+{
+        const lglTemplate      *template;
+        const lglTemplateFrame *frame;
+        glMerge                *merge;
+        glPrintRaster          *raster;
+        cairo_surface_t        *recording;
+        cairo_rectangle_t       extents;
+        cairo_t                *cr;
+        glPrintState            state = { 0, NULL, NULL };
+        gint                    n_labels_per_page, n_records = 0;
+        gint                    first_index, n_images, page;
+        gint                    i_first, i_last;
+        gdouble                 scale;
+        gboolean                mono_flag;
+        gboolean                ok = TRUE;
+
+        template = gl_label_get_template (label);
+        frame    = (lglTemplateFrame *)template->frames->data;
+        n_labels_per_page = lgl_template_frame_get_n_labels (frame);
+
+        mono_flag = settings->mono_flag || (settings->format == GL_PRINT_EXPORT_FORMAT_PBM);
+        scale     = settings->resolution / POINTS_PER_INCH;
+
+        merge = gl_label_get_merge (label);
+        if ( merge )
+        {
+                n_records = gl_merge_get_record_count (merge);
+                g_object_unref (merge);
+        }
+
+        /* Sheet files keep their numbers in the whole job. */
+        first_index = page_first + settings->sheet_offset;
+        n_images    = settings->n_sheets + settings->sheet_offset;
+        if ( settings->per_label_flag )
+        {
+                first_index = 0;
+                n_images    = 0;
+                for ( page = 0; page < page_last; page++ )
+                {
+                        get_sheet_labels (settings, merge_flag, n_labels_per_page, n_records,
+                                          page, &i_first, &i_last);
+                        if ( page == page_first )
+                        {
+                                first_index = n_images;
+                        }
+                        n_images += i_last - i_first;
+                }
+        }
+
+        raster = gl_print_raster_new (label, output->filename,
+                                      output->write_func, output->closure,
+                                      settings, first_index, n_images);
+
+        extents.x      = 0;
+        extents.y      = 0;
+        extents.width  = ceil (scale * template->page_width);
+        extents.height = ceil (scale * template->page_height);
+
+        for ( page = page_first; (page < page_last) && ok; page++ )
+        {
+                recording = cairo_recording_surface_create (CAIRO_CONTENT_COLOR_ALPHA, &extents);
+
+                cr = cairo_create (recording);
+                cairo_scale (cr, scale, scale);
+                if ( mono_flag )
+                {
+                        cairo_set_antialias (cr, CAIRO_ANTIALIAS_NONE);
+                }
+                draw_sheet (label, cr, page, merge_flag, settings, &state);
+                cairo_destroy (cr);
+
+                get_sheet_labels (settings, merge_flag, n_labels_per_page, n_records,
+                                  page, &i_first, &i_last);
+
+                ok = gl_print_raster_add_sheet (raster, recording, page, i_first, i_last);
+        }
+
+        gl_print_state_clear (&state);
+
+        return gl_print_raster_finish (raster, error);
+}
+
+
+/*---------------------------------------------------------------------------*/
+/* PRIVATE.  Range of label positions drawn on page.                         */
+/*---------------------------------------------------------------------------*/
+static void
+get_sheet_labels (glPrintExportSettings *settings,
+                  gboolean               merge_flag,
+                  gint                   n_labels_per_page,
+                  gint                   n_records,
+                  gint                   page,
+                  gint                  *i_first,
+                  gint                  *i_last)
+{
+        gint n_before, n_remaining;
+
+        if ( !merge_flag )
+        {
+                *i_first = settings->first - 1;
+                *i_last  = settings->last;
+                return;
+        }
+
+        *i_first    = (page == 0) ? (settings->first - 1) : 0;
+        n_before    = (page == 0) ? 0 : (page * n_labels_per_page - (settings->first - 1));
+        n_remaining = settings->n_copies * n_records - n_before;
+
+        *i_last = *i_first + CLAMP (n_remaining, 0, n_labels_per_page - *i_first);
+}
+
+
+/*---------------------------------------------------------------------------*/
+/* PRIVATE.  Turn cairo status into GError.                                  */
+/*---------------------------------------------------------------------------*/
+static gboolean
+check_status (cairo_status_t   status,
+              const gchar     *filename,
+              GError         **error)
+{
+        if ( status != CAIRO_STATUS_SUCCESS )
+        {
+                if ( filename )
+                {
+                        g_set_error (error, G_IO_ERROR, G_IO_ERROR_FAILED,
+                                     _("Could not write \"%s\": %s"),
+                                     filename, cairo_status_to_string (status));
+                }
+                else
+                {
+                        g_set_error (error, G_IO_ERROR, G_IO_ERROR_FAILED,
+                                     _("Could not write output: %s"),
+                                     cairo_status_to_string (status));
+                }
+                return FALSE;
+        }
+
+        return TRUE;
+}
+
+
+
+
+/*
+ * Local Variables:       -- emacs
+ * mode: C                -- emacs
+ * c-basic-offset: 8      -- emacs
+ * tab-width: 8           -- emacs
+ * indent-tabs-mode: nil  -- emacs
+ * End:                   -- emacs
+ */
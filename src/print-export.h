@@ -0,0 +1,166 @@
+/*
+ *  print-export.h
+ *  Copyright (C) 2026  agent <agent@local>.
+ *
+ *  This file is part of gLabels.
+ *
+ *  gLabels is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  gLabels is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with gLabels.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef __PRINT_EXPORT_H__
+#define __PRINT_EXPORT_H__
+
+#include <glib.h>
+#include <cairo.h>
+
+#include "label.h"
+#include "mono-bitmap.h"
+
+G_BEGIN_DECLS
+
+
+/*
+ * Headless export straight to cairo surfaces, no GtkPrintOperation.
+ */
+typedef enum {
+        GL_PRINT_EXPORT_FORMAT_PDF,
+        GL_PRINT_EXPORT_FORMAT_PS,
+        GL_PRINT_EXPORT_FORMAT_SVG,
+        GL_PRINT_EXPORT_FORMAT_PNG,
+        GL_PRINT_EXPORT_FORMAT_TIFF,
+        GL_PRINT_EXPORT_FORMAT_PBM,
+        GL_PRINT_EXPORT_FORMAT_ZPL
+} glPrintExportFormat;
+
+
+/*
+ * Called after each sheet has been rendered, sheet counts from 1.
+ */
+typedef void (*glPrintExportProgressFunc) (gint      sheet,
+                                           gint      n_sheets,
+                                           gpointer  user_data);
+
+
+/*
+ * Called once all sheets before next_sheet are in finished output files, so
+ * that an interrupted export can go on from there.  Counts whole job sheets,
+ * i.e. sheet_offset is included.
+ */
+typedef void (*glPrintExportCheckpointFunc) (gint      next_sheet,
+                                             gpointer  user_data);
+
+
+typedef struct {
+        glPrintExportFormat  format;
+
+        gint                 n_sheets;
+        gint                 n_copies;
+        gint                 first;
+        gint                 last;
+
+        gboolean             collate_flag;
+        gboolean             outline_flag;
+        gboolean             reverse_flag;
+        gboolean             crop_marks_flag;
+
+        /* Part of the job only, not ZPL.  Clipped to n_sheets. */
+        gint                 sheet_first;       /* First sheet to export, from 0. */
+        gint                 sheet_last;        /* Sheet after the last one to export. */
+        gint                 sheet_offset;      /* Whole job sheets before sheet 0, numbers files. */
+
+        /* Raster formats (PNG, TIFF, PBM) only, resolution and dither also ZPL. */
+        gdouble              resolution;        /* Pixels per inch. */
+        gboolean             per_label_flag;    /* One image per label, not per sheet. */
+        gint                 n_threads;         /* Rasterizing threads, 0 = one per processor. */
+        gboolean             mono_flag;         /* 1 bit per pixel, always set for PBM. */
+        glMonoDither         dither;
+
+        /* PDF, PostScript and TIFF files only, 0 = everything in one file. */
+        gint                 chunk_sheets;      /* Sheets per numbered file. */
+        gint                 chunk_records;     /* About as many records per file, whole sheets. */
+
+        glPrintExportProgressFunc progress_func;
+        gpointer                  progress_data;
+
+        /* Files only, see gl_print_export_can_checkpoint(). */
+        glPrintExportCheckpointFunc checkpoint_func;
+        gpointer                    checkpoint_data;
+} glPrintExportSettings;
+
+
+void                gl_print_export_settings_init   (glPrintExportSettings *settings,
+                                                     glLabel               *label);
+
+void                gl_print_export_settings_count_sheets
+                                                    (glPrintExportSettings *settings,
+                                                     glLabel               *label);
+
+gint                gl_print_export_settings_skip_records
+                                                    (glPrintExportSettings *settings,
+                                                     glLabel               *label,
+                                                     gint                   n_records);
+
+glPrintExportFormat gl_print_export_format_from_filename
+                                                    (const gchar           *filename);
+
+gboolean            gl_print_export_format_from_name
+                                                    (const gchar           *name,
+                                                     glPrintExportFormat   *format);
+
+gboolean            gl_print_export                 (glLabel               *label,
+                                                     const gchar           *filename,
+                                                     glPrintExportSettings *settings,
+                                                     GError               **error);
+
+gboolean            gl_print_export_to_stream       (glLabel               *label,
+                                                     cairo_write_func_t     write_func,
+                                                     void                  *closure,
+                                                     glPrintExportSettings *settings,
+                                                     GError               **error);
+
+gchar              *gl_print_export_page_filename   (const gchar           *filename,
+                                                     gint                   page,
+                                                     gint                   n_pages);
+
+gchar              *gl_print_export_chunk_filename  (const gchar           *filename,
+                                                     gint                   chunk);
+
+gint                gl_print_export_get_chunk_sheets
+                                                    (glPrintExportSettings *settings,
+                                                     glLabel               *label);
+
+gboolean            gl_print_export_can_checkpoint  (glPrintExportSettings *settings,
+                                                     glLabel               *label);
+
+void                gl_print_export_draw_sheet      (glLabel               *label,
+                                                     cairo_t               *cr,
+                                                     gint                   sheet,
+                                                     glPrintExportSettings *settings);
+
+
+G_END_DECLS
+
+#endif /* __PRINT_EXPORT_H__ */
+
+
+
+
+/*
+ * Local Variables:       -- emacs
+ * mode: C                -- emacs
+ * c-basic-offset: 8      -- emacs
+ * tab-width: 8           -- emacs
+ * indent-tabs-mode: nil  -- emacs
+ * End:                   -- emacs
+ */
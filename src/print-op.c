@@ -149,6 +149,7 @@ gl_print_op_finalize (GObject *object)
 
         g_object_unref (G_OBJECT(op->priv->label));
         g_free (op->priv->filename);
+        gl_print_state_clear (&op->priv->state);
 	g_free (op->priv);
 
 	G_OBJECT_CLASS (gl_print_op_parent_class)->finalize (object);
@@ -0,0 +1,715 @@
+/*
+ *  print-raster.c
+ *  Copyright (C) 2026  agent <agent@local>.
+ *
+ *  This file is part of gLabels.
+ *
+ *  gLabels is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  gLabels is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with gLabels.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <config.h>
+
+#include "print-raster.h"
+
+#include <glib/gi18n.h>
+#include <glib/gstdio.h>
+#include <gio/gio.h>
+#include <stdio.h>
+#include <math.h>
+
+#include <libglabels.h>
+#include "mono-bitmap.h"
+#include "tiff-writer.h"
+
+#include "debug.h"
+
+
+/*===========================================*/
+/* Private macros and constants.             */
+/*===========================================*/
+
+#define POINTS_PER_INCH 72.0
+
+/* Sheets in flight per thread, bounds memory held by recordings and images. */
+#define JOBS_PER_THREAD 2
+
+
+/*===========================================*/
+/* Private types.                            */
+/*===========================================*/
+
+struct _glPrintRaster {
+        glPrintExportFormat        format;
+        gdouble                    resolution;
+        gdouble                    scale;
+        gboolean                   mono_flag;
+        glMonoDither               dither;
+
+        gboolean                   per_label_flag;
+        gdouble                    page_width;
+        gdouble                    page_height;
+        gdouble                    label_width;
+        gdouble                    label_height;
+        lglTemplateOrigin         *origins;
+
+        gint                       n_sheets;
+        gint                       n_images;
+        gint                       next_index;
+
+        glPrintExportProgressFunc  progress_func;
+        gpointer                   progress_data;
+
+        gint                       sheet_offset;
+        glPrintExportCheckpointFunc checkpoint_func;
+        gpointer                   checkpoint_data;
+
+        /* Destination */
+        const gchar               *filename;
+        cairo_write_func_t         write_func;
+        void                      *closure;
+        FILE                      *fp;
+        glTiffWriter              *tiff;
+
+        /* Jobs submitted and not yet written, in sheet order. */
+        GThreadPool               *pool;
+        GQueue                    *jobs;
+        guint                      max_jobs;
+
+        GMutex                     mutex;
+        GCond                      cond;
+
+        cairo_status_t             status;
+        gchar                     *failed_filename;
+};
+
+typedef struct {
+        cairo_surface_t  *recording;
+        gint              sheet;
+        gint              index;          /* Output index of first image. */
+        gint              i_first;        /* Label positions, per label only. */
+        gint              i_last;
+
+        /* Filled in by worker. */
+        GPtrArray        *images;         /* glTiffPage, or PNG/PBM GByteArray. */
+        cairo_status_t    status;
+        gchar            *failed_filename;
+        gboolean          done_flag;      /* Protected by raster->mutex. */
+} Job;
+
+
+/*===========================================*/
+/* Private function prototypes.              */
+/*===========================================*/
+
+static void             rasterize_job    (Job             *job,
+                                          glPrintRaster   *raster);
+
+static cairo_surface_t *render_region    (glPrintRaster   *raster,
+                                          cairo_surface_t *recording,
+                                          gdouble          x,
+                                          gdouble          y,
+                                          gdouble          w,
+                                          gdouble          h);
+
+static gpointer         encode_image     (glPrintRaster   *raster,
+                                          Job             *job,
+                                          cairo_surface_t *surface,
+                                          gint             index);
+
+static cairo_status_t   append_to_buffer (void            *closure,
+                                          const guchar    *data,
+                                          guint            length);
+
+static cairo_status_t   write_to_file    (void            *closure,
+                                          const guchar    *data,
+                                          guint            length);
+
+static void             flush_jobs       (glPrintRaster   *raster,
+                                          guint            max_pending);
+
+static void             write_job        (glPrintRaster   *raster,
+                                          Job             *job);
+
+static void             job_free         (glPrintRaster   *raster,
+                                          Job             *job);
+
+static void             set_failure      (glPrintRaster   *raster,
+                                          cairo_status_t   status,
+                                          const gchar     *filename);
+
+
+/*****************************************************************************/
+/* Create a rasterizer for export settings.  Output goes to filename, or to  */
+/* write_func if set.  Image files are numbered from first_index, and only   */
+/* if n_images, the number of images up to the last one, is more than one.   */
+/*****************************************************************************/
+glPrintRaster *
+gl_print_raster_new (glLabel               *label,
+                     const gchar           *filename,
+                     cairo_write_func_t     write_func,
+                     void                  *closure,
+                     glPrintExportSettings *settings,
+                     gint                   first_index,
+                     gint                   n_images)
+{
+        const lglTemplate      *template;
+        const lglTemplateFrame *frame;
+        glPrintRaster          *raster;
+        gint                    n_threads;
+
+        g_return_val_if_fail (label && GL_IS_LABEL (label), NULL);
+        g_return_val_if_fail (filename || write_func, NULL);
+        g_return_val_if_fail (settings, NULL);
+
+        template = gl_label_get_template (label);
+        frame    = (lglTemplateFrame *)template->frames->data;
+
+        raster = g_new0 (glPrintRaster, 1);
+
+        raster->format         = settings->format;
+        raster->resolution     = settings->resolution;
+        raster->scale          = settings->resolution / POINTS_PER_INCH;
+        raster->mono_flag      = settings->mono_flag || (settings->format == GL_PRINT_EXPORT_FORMAT_PBM);
+        raster->dither         = settings->dither;
+        raster->per_label_flag = settings->per_label_flag;
+        raster->page_width     = template->page_width;
+        raster->page_height    = template->page_height;
+        lgl_template_frame_get_size (frame, &raster->label_width, &raster->label_height);
+        if ( raster->per_label_flag )
+        {
+                raster->origins = lgl_template_frame_get_origins (frame);
+        }
+
+        raster->n_sheets      = settings->n_sheets;
+        raster->n_images      = n_images;
+        raster->next_index    = first_index;
+        raster->progress_func = settings->progress_func;
+        raster->progress_data = settings->progress_data;
+
+        raster->sheet_offset    = settings->sheet_offset;
+        raster->checkpoint_func = settings->checkpoint_func;
+        raster->checkpoint_data = settings->checkpoint_data;
+
+        raster->filename   = write_func ? NULL : filename;
+        raster->write_func = write_func;
+        raster->closure    = closure;
+        raster->status     = CAIRO_STATUS_SUCCESS;
+
+        if ( raster->format == GL_PRINT_EXPORT_FORMAT_TIFF )
+        {
+                /* All pages go into one TIFF file. */
+                if ( raster->filename )
+                {
+                        raster->fp = g_fopen (raster->filename, "wb");
+                        if ( raster->fp == NULL )
+                        {
+                                set_failure (raster, CAIRO_STATUS_WRITE_ERROR, raster->filename);
+                        }
+                        else
+                        {
+                                raster->tiff = gl_tiff_writer_new (write_to_file, raster->fp);
+                        }
+                }
+                else
+                {
+                        raster->tiff = gl_tiff_writer_new (write_func, closure);
+                }
+        }
+
+        n_threads = (settings->n_threads > 0) ? settings->n_threads : (gint)g_get_num_processors ();
+
+        g_mutex_init (&raster->mutex);
+        g_cond_init (&raster->cond);
+
+        raster->jobs     = g_queue_new ();
+        raster->max_jobs = JOBS_PER_THREAD * n_threads;
+        raster->pool     = g_thread_pool_new ((GFunc)rasterize_job, raster,
+                                              n_threads, FALSE, NULL);
+
+        return raster;
+}
+
+
+/*****************************************************************************/
+/* Queue recorded sheet, taking ownership of recording.  The recording is in */
+/* device pixels, i.e. already scaled to the output resolution.  Label       */
+/* positions i_first to i_last-1 are drawn on the sheet.  Blocks while too   */
+/* many sheets are in flight.  Returns FALSE once output has failed.         */
+/*****************************************************************************/
+gboolean
+gl_print_raster_add_sheet (glPrintRaster   *raster,
+                           cairo_surface_t *recording,
+                           gint             sheet,
+                           gint             i_first,
+                           gint             i_last)
+{
+        Job *job;
+
+        g_return_val_if_fail (raster, FALSE);
+        g_return_val_if_fail (recording, FALSE);
+
+        if ( raster->status != CAIRO_STATUS_SUCCESS )
+        {
+                cairo_surface_destroy (recording);
+                return FALSE;
+        }
+
+        job = g_new0 (Job, 1);
+        job->recording = recording;
+        job->sheet     = sheet;
+        job->index     = raster->next_index;
+        job->i_first   = i_first;
+        job->i_last    = MAX (i_first, i_last);
+        job->status    = CAIRO_STATUS_SUCCESS;
+
+        raster->next_index += raster->per_label_flag ? (job->i_last - job->i_first) : 1;
+
+        g_queue_push_tail (raster->jobs, job);
+        g_thread_pool_push (raster->pool, job, NULL);
+
+        flush_jobs (raster, raster->max_jobs);
+
+        return (raster->status == CAIRO_STATUS_SUCCESS);
+}
+
+
+/*****************************************************************************/
+/* Wait for remaining sheets, finish output and free rasterizer.             */
+/*****************************************************************************/
+gboolean
+gl_print_raster_finish (glPrintRaster  *raster,
+                        GError        **error)
+{
+        cairo_status_t status;
+        gboolean       ret = TRUE;
+
+        g_return_val_if_fail (raster, FALSE);
+
+        flush_jobs (raster, 0);
+        g_thread_pool_free (raster->pool, FALSE, TRUE);
+
+        if ( raster->tiff )
+        {
+                status = gl_tiff_writer_finish (raster->tiff);
+                if ( status != CAIRO_STATUS_SUCCESS )
+                {
+                        set_failure (raster, status, raster->filename);
+                }
+        }
+        if ( raster->fp && (fclose (raster->fp) != 0) )
+        {
+                set_failure (raster, CAIRO_STATUS_WRITE_ERROR, raster->filename);
+        }
+
+        if ( raster->status != CAIRO_STATUS_SUCCESS )
+        {
+                if ( raster->failed_filename )
+                {
+                        g_set_error (error, G_IO_ERROR, G_IO_ERROR_FAILED,
+                                     _("Could not write \"%s\": %s"),
+                                     raster->failed_filename,
+                                     cairo_status_to_string (raster->status));
+                }
+                else
+                {
+                        g_set_error (error, G_IO_ERROR, G_IO_ERROR_FAILED,
+                                     _("Could not write output: %s"),
+                                     cairo_status_to_string (raster->status));
+                }
+                ret = FALSE;
+        }
+
+        g_queue_free (raster->jobs);
+        g_mutex_clear (&raster->mutex);
+        g_cond_clear (&raster->cond);
+        g_free (raster->origins);
+        g_free (raster->failed_filename);
+        g_free (raster);
+
+        return ret;
+}
+
+
+/*---------------------------------------------------------------------------*/
+/* PRIVATE.  Worker thread: rasterize and encode the images of one sheet.    */
+/*---------------------------------------------------------------------------*/
+static void
+rasterize_job (Job           *job,
+               glPrintRaster *raster)
+{
+        cairo_surface_t *surface;
+        gpointer         image;
+        gint             n_images, i;
+
+        n_images    = raster->per_label_flag ? (job->i_last - job->i_first) : 1;
+        job->images = g_ptr_array_sized_new (n_images);
+
+        for ( i = 0; (i < n_images) && (job->status == CAIRO_STATUS_SUCCESS); i++ )
+        {
+                if ( raster->per_label_flag )
+                {
+                        surface = render_region (raster, job->recording,
+                                                 raster->origins[job->i_first + i].x,
+                                                 raster->origins[job->i_first + i].y,
+                                                 raster->label_width, raster->label_height);
+                }
+                else
+                {
+                        surface = render_region (raster, job->recording, 0, 0,
+                                                 raster->page_width, raster->page_height);
+                }
+
+                image = encode_image (raster, job, surface, job->index + i);
+                if ( image )
+                {
+                        g_ptr_array_add (job->images, image);
+                }
+
+                cairo_surface_destroy (surface);
+        }
+
+        /* Recording is not needed any more, release it from this thread. */
+        cairo_surface_destroy (job->recording);
+        job->recording = NULL;
+
+        g_mutex_lock (&raster->mutex);
+        job->done_flag = TRUE;
+        g_cond_broadcast (&raster->cond);
+        g_mutex_unlock (&raster->mutex);
+}
+
+
+/*---------------------------------------------------------------------------*/
+/* PRIVATE.  Copy region of recorded sheet, given in points, onto a new      */
+/* image with white background.                                              */
+/*---------------------------------------------------------------------------*/
+static cairo_surface_t *
+render_region (glPrintRaster   *raster,
+               cairo_surface_t *recording,
+               gdouble          x,
+               gdouble          y,
+               gdouble          w,
+               gdouble          h)
+{
+        cairo_surface_t *surface;
+        cairo_t         *cr;
+
+        surface = cairo_image_surface_create (CAIRO_FORMAT_RGB24,
+                                              (gint)ceil (raster->scale * w),
+                                              (gint)ceil (raster->scale * h));
+
+        cr = cairo_create (surface);
+
+        cairo_set_source_rgb (cr, 1.0, 1.0, 1.0);
+        cairo_paint (cr);
+
+        /* Whole pixel offset, keeps snapped barcodes on the grid. */
+        cairo_set_source_surface (cr, recording,
+                                  -floor (raster->scale * x + 0.5),
+                                  -floor (raster->scale * y + 0.5));
+        cairo_paint (cr);
+
+        cairo_destroy (cr);
+
+        return surface;
+}
+
+
+/*---------------------------------------------------------------------------*/
+/* PRIVATE.  Encode image in output format.  Returns a glTiffPage or a       */
+/* GByteArray to be written in order, or NULL if the image was written to    */
+/* its own file here.  Errors are recorded in job.                           */
+/*---------------------------------------------------------------------------*/
+static gpointer
+encode_image (glPrintRaster   *raster,
+              Job             *job,
+              cairo_surface_t *surface,
+              gint             index)
+{
+        glMonoBitmap    *bitmap = NULL;
+        cairo_surface_t *png_surface;
+        GByteArray      *buffer = NULL;
+        gpointer         image = NULL;
+        gchar           *image_fn = NULL;
+
+        if ( raster->mono_flag )
+        {
+                bitmap = gl_mono_bitmap_new_from_surface (surface, raster->dither);
+        }
+
+        if ( raster->filename && (raster->format != GL_PRINT_EXPORT_FORMAT_TIFF) )
+        {
+                image_fn = gl_print_export_page_filename (raster->filename, index, raster->n_images);
+        }
+
+        switch (raster->format)
+        {
+
+        case GL_PRINT_EXPORT_FORMAT_TIFF:
+                if ( bitmap )
+                {
+                        image = gl_tiff_page_new_from_bitmap (bitmap->data,
+                                                              bitmap->width, bitmap->height,
+                                                              bitmap->stride,
+                                                              raster->resolution);
+                }
+                else
+                {
+                        image = gl_tiff_page_new_from_surface (surface, raster->resolution);
+                }
+                break;
+
+        case GL_PRINT_EXPORT_FORMAT_PBM:
+                buffer = g_byte_array_new ();
+                gl_mono_bitmap_append_pbm (bitmap, buffer);
+                if ( image_fn )
+                {
+                        if ( !g_file_set_contents (image_fn, (const gchar *)buffer->data,
+                                                   buffer->len, NULL) )
+                        {
+                                job->status = CAIRO_STATUS_WRITE_ERROR;
+                        }
+                        g_byte_array_unref (buffer);
+                }
+                else
+                {
+                        image = buffer;
+                }
+                break;
+
+        default:
+                png_surface = bitmap ? gl_mono_bitmap_create_surface (bitmap) : cairo_surface_reference (surface);
+                if ( image_fn )
+                {
+                        job->status = cairo_surface_write_to_png (png_surface, image_fn);
+                }
+                else
+                {
+                        buffer = g_byte_array_new ();
+                        job->status = cairo_surface_write_to_png_stream (png_surface,
+                                                                         append_to_buffer,
+                                                                         buffer);
+                        image = buffer;
+                }
+                cairo_surface_destroy (png_surface);
+                break;
+
+        }
+
+        if ( job->status != CAIRO_STATUS_SUCCESS )
+        {
+                job->failed_filename = image_fn;
+        }
+        else
+        {
+                g_free (image_fn);
+        }
+
+        gl_mono_bitmap_free (bitmap);
+
+        return image;
+}
+
+
+/*---------------------------------------------------------------------------*/
+/* PRIVATE.  Cairo write callback: append to GByteArray.                     */
+/*---------------------------------------------------------------------------*/
+static cairo_status_t
+append_to_buffer (void         *closure,
+                  const guchar *data,
+                  guint         length)
+{
+        g_byte_array_append ((GByteArray *)closure, data, length);
+
+        return CAIRO_STATUS_SUCCESS;
+}
+
+
+/*---------------------------------------------------------------------------*/
+/* PRIVATE.  Cairo write callback: write to FILE.                            */
+/*---------------------------------------------------------------------------*/
+static cairo_status_t
+write_to_file (void         *closure,
+               const guchar *data,
+               guint         length)
+{
+        if ( fwrite (data, 1, length, (FILE *)closure) != length )
+        {
+                return CAIRO_STATUS_WRITE_ERROR;
+        }
+
+        return CAIRO_STATUS_SUCCESS;
+}
+
+
+/*---------------------------------------------------------------------------*/
+/* PRIVATE.  Write finished jobs at head of queue, in order.  Waits until no */
+/* more than max_pending jobs remain.                                        */
+/*---------------------------------------------------------------------------*/
+static void
+flush_jobs (glPrintRaster *raster,
+            guint          max_pending)
+{
+        Job *job;
+
+        g_mutex_lock (&raster->mutex);
+
+        while ( (job = g_queue_peek_head (raster->jobs)) != NULL )
+        {
+                if ( !job->done_flag )
+                {
+                        if ( g_queue_get_length (raster->jobs) <= max_pending )
+                        {
+                                break;
+                        }
+                        g_cond_wait (&raster->cond, &raster->mutex);
+                        continue;
+                }
+
+                g_queue_pop_head (raster->jobs);
+
+                g_mutex_unlock (&raster->mutex);
+                write_job (raster, job);
+                job_free (raster, job);
+                g_mutex_lock (&raster->mutex);
+        }
+
+        g_mutex_unlock (&raster->mutex);
+}
+
+
+/*---------------------------------------------------------------------------*/
+/* PRIVATE.  Write images of finished job.                                   */
+/*---------------------------------------------------------------------------*/
+static void
+write_job (glPrintRaster *raster,
+           Job           *job)
+{
+        GByteArray     *buffer;
+        cairo_status_t  status;
+        guint           i;
+
+        if ( raster->status != CAIRO_STATUS_SUCCESS )
+        {
+                return;
+        }
+
+        if ( job->status != CAIRO_STATUS_SUCCESS )
+        {
+                set_failure (raster, job->status, job->failed_filename);
+                return;
+        }
+
+        for ( i = 0; i < job->images->len; i++ )
+        {
+                if ( raster->tiff )
+                {
+                        /* Writer takes ownership of page. */
+                        status = gl_tiff_writer_add_page (raster->tiff, job->images->pdata[i]);
+                        job->images->pdata[i] = NULL;
+                }
+                else
+                {
+                        buffer = job->images->pdata[i];
+                        status = raster->write_func (raster->closure, buffer->data, buffer->len);
+                }
+
+                if ( status != CAIRO_STATUS_SUCCESS )
+                {
+                        set_failure (raster, status, raster->filename);
+                        return;
+                }
+        }
+
+        if ( raster->progress_func )
+        {
+                raster->progress_func (job->sheet + 1, raster->n_sheets, raster->progress_data);
+        }
+
+        /* Files of one sheet each are finished by now. */
+        if ( raster->checkpoint_func && raster->filename &&
+             !raster->tiff && !raster->per_label_flag )
+        {
+                raster->checkpoint_func (job->sheet + 1 + raster->sheet_offset,
+                                         raster->checkpoint_data);
+        }
+}
+
+
+/*---------------------------------------------------------------------------*/
+/* PRIVATE.  Free job and any images not handed on.                          */
+/*---------------------------------------------------------------------------*/
+static void
+job_free (glPrintRaster *raster,
+          Job           *job)
+{
+        guint i;
+
+        if ( job->images )
+        {
+                for ( i = 0; i < job->images->len; i++ )
+                {
+                        if ( job->images->pdata[i] == NULL )
+                        {
+                                continue;
+                        }
+
+                        if ( raster->format == GL_PRINT_EXPORT_FORMAT_TIFF )
+                        {
+                                gl_tiff_page_free (job->images->pdata[i]);
+                        }
+                        else
+                        {
+                                g_byte_array_unref (job->images->pdata[i]);
+                        }
+                }
+                g_ptr_array_free (job->images, TRUE);
+        }
+
+        if ( job->recording )
+        {
+                cairo_surface_destroy (job->recording);
+        }
+
+        g_free (job->failed_filename);
+        g_free (job);
+}
+
+
+/*---------------------------------------------------------------------------*/
+/* PRIVATE.  Record first failure.                                           */
+/*---------------------------------------------------------------------------*/
+static void
+set_failure (glPrintRaster  *raster,
+             cairo_status_t  status,
+             const gchar    *filename)
+{
+        if ( raster->status == CAIRO_STATUS_SUCCESS )
+        {
+                raster->status          = status;
+                raster->failed_filename = g_strdup (filename);
+        }
+}
+
+
+
+
+/*
+ * Local Variables:       -- emacs
+ * mode: C                -- emacs
+ * c-basic-offset: 8      -- emacs
+ * tab-width: 8           -- emacs
+ * indent-tabs-mode: nil  -- emacs
+ * End:                   -- emacs
+ */
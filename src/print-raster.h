@@ -0,0 +1,72 @@
+/*
+ *  print-raster.h
+ *  Copyright (C) 2026  agent <agent@local>.
+ *
+ *  This file is part of gLabels.
+ *
+ *  gLabels is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  gLabels is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with gLabels.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef __PRINT_RASTER_H__
+#define __PRINT_RASTER_H__
+
+#include <glib.h>
+#include <cairo.h>
+
+#include "label.h"
+#include "print-export.h"
+
+G_BEGIN_DECLS
+
+
+/*
+ * Rasterizes recorded sheets to PNG, TIFF or PBM on a pool of threads.  Sheets
+ * are added in order from one thread; output is written in the same order.
+ */
+typedef struct _glPrintRaster glPrintRaster;
+
+
+glPrintRaster *gl_print_raster_new        (glLabel               *label,
+                                           const gchar           *filename,
+                                           cairo_write_func_t     write_func,
+                                           void                  *closure,
+                                           glPrintExportSettings *settings,
+                                           gint                   first_index,
+                                           gint                   n_images);
+
+gboolean       gl_print_raster_add_sheet  (glPrintRaster         *raster,
+                                           cairo_surface_t       *recording,
+                                           gint                   sheet,
+                                           gint                   i_first,
+                                           gint                   i_last);
+
+gboolean       gl_print_raster_finish     (glPrintRaster         *raster,
+                                           GError               **error);
+
+
+G_END_DECLS
+
+#endif /* __PRINT_RASTER_H__ */
+
+
+
+
+/*
+ * Local Variables:       -- emacs
+ * mode: C                -- emacs
+ * c-basic-offset: 8      -- emacs
+ * tab-width: 8           -- emacs
+ * indent-tabs-mode: nil  -- emacs
+ * End:                   -- emacs
+ */
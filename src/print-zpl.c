@@ -0,0 +1,1432 @@
+/*
+ *  print-zpl.c
+ *  Copyright (C) 2026  agent <agent@local>.
+ *
+ *  This file is part of gLabels.
+ *
+ *  gLabels is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  gLabels is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with gLabels.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <config.h>
+
+#include "print-zpl.h"
+
+#include <glib/gi18n.h>
+#include <glib/gstdio.h>
+#include <gio/gio.h>
+#include <stdio.h>
+#include <string.h>
+#include <math.h>
+
+#include <libglabels.h>
+#include "label-text.h"
+#include "label-box.h"
+#include "label-ellipse.h"
+#include "label-line.h"
+#include "label-image.h"
+#include "label-barcode.h"
+#include "bc-backends.h"
+#include "mono-bitmap.h"
+
+#include "debug.h"
+
+
+/*===========================================*/
+/* Private macros and constants.             */
+/*===========================================*/
+
+#define POINTS_PER_INCH 72.0
+
+/* Stored format in printer RAM, recalled by every label. */
+#define FORMAT_NAME "R:GLABELS.ZPL"
+
+/* Lighter colors print white, more transparent colors are not printed. */
+#define LUMINANCE_THRESHOLD 0.5
+#define ALPHA_THRESHOLD     0.5
+
+/* Largest run of ^GF compression, "z" (400) plus "Y" (19). */
+#define MAX_RUN 419
+
+#define EPSILON 1.0e-6
+
+
+/*===========================================*/
+/* Private types.                            */
+/*===========================================*/
+
+typedef enum {
+        OBJECT_STATIC,          /* Drawn once in the stored format. */
+        OBJECT_FIELD,           /* In the stored format, data sent per record. */
+        OBJECT_VARIABLE         /* Drawn again for each record. */
+} ObjectKind;
+
+typedef enum {
+        SYMBOLOGY_NONE,
+        SYMBOLOGY_CODE128,
+        SYMBOLOGY_CODE39,
+        SYMBOLOGY_EAN13,
+        SYMBOLOGY_EAN8,
+        SYMBOLOGY_UPCA,
+        SYMBOLOGY_UPCE,
+        SYMBOLOGY_QR,
+        SYMBOLOGY_DATAMATRIX
+} Symbology;
+
+typedef struct {
+        const gchar *id;
+        Symbology    symbology;
+} SymbologyMap;
+
+typedef struct {
+        glLabel            *label;
+        gdouble             scale;              /* Dots per point. */
+        glMonoDither        dither;
+        gboolean            reverse_flag;
+        gboolean            merge_flag;
+
+        /* Destination */
+        GString            *buffer;
+        cairo_write_func_t  write_func;
+        void               *closure;
+        FILE               *fp;
+        cairo_status_t      status;
+
+        GList              *fields;             /* Objects sent as ^FN data. */
+        GList              *variable;           /* Objects drawn per record. */
+} Zpl;
+
+
+/*===========================================*/
+/* Private globals.                          */
+/*===========================================*/
+
+/* Style ids of any backend that the printer can draw itself. */
+static const SymbologyMap symbologies[] = {
+        { "Code128",  SYMBOLOGY_CODE128 },
+        { "Code39",   SYMBOLOGY_CODE39 },
+        { "EAN-13",   SYMBOLOGY_EAN13 },
+        { "EAN-8",    SYMBOLOGY_EAN8 },
+        { "UPC-A",    SYMBOLOGY_UPCA },
+        { "UPC-E",    SYMBOLOGY_UPCE },
+        { "QR",       SYMBOLOGY_QR },
+        { "IEC18004", SYMBOLOGY_QR },
+        { "DMTX",     SYMBOLOGY_DATAMATRIX },
+        { "IEC16022", SYMBOLOGY_DATAMATRIX },
+        { NULL,       SYMBOLOGY_NONE }
+};
+
+
+/*===========================================*/
+/* Private function prototypes.              */
+/*===========================================*/
+
+static void           write_format        (Zpl                 *zpl,
+                                           glMergeRecord       *sample);
+
+static void           write_label         (Zpl                 *zpl,
+                                           glMergeRecord       *record,
+                                           gint                 quantity);
+
+static ObjectKind     classify_object     (Zpl                 *zpl,
+                                           glLabelObject       *object);
+
+static gboolean       has_field_color     (glLabelObject       *object);
+
+static gboolean       has_field_data      (glLabelObject       *object);
+
+static gboolean       is_native           (glLabelObject       *object);
+
+static void           emit_object         (Zpl                 *zpl,
+                                           glLabelObject       *object,
+                                           glMergeRecord       *record,
+                                           gint                 field);
+
+static void           emit_text           (Zpl                 *zpl,
+                                           glLabelObject       *object,
+                                           glMergeRecord       *record,
+                                           gint                 field);
+
+static void           emit_shape          (Zpl                 *zpl,
+                                           glLabelObject       *object,
+                                           glMergeRecord       *record,
+                                           gboolean             ellipse_flag);
+
+static void           emit_line           (Zpl                 *zpl,
+                                           glLabelObject       *object,
+                                           glMergeRecord       *record);
+
+static void           emit_barcode        (Zpl                 *zpl,
+                                           glLabelObject       *object,
+                                           glMergeRecord       *record,
+                                           gint                 field);
+
+static void           emit_graphic        (Zpl                 *zpl,
+                                           glLabelObject       *object,
+                                           glMergeRecord       *record);
+
+static void           append_data         (Zpl                 *zpl,
+                                           glLabelObject       *object,
+                                           glMergeRecord       *record,
+                                           gint                 field);
+
+static void           append_field_data   (Zpl                 *zpl,
+                                           glLabelObject       *object,
+                                           glMergeRecord       *record);
+
+static void           append_graphic      (GString             *buffer,
+                                           gint                 x,
+                                           gint                 y,
+                                           const glMonoBitmap  *bitmap);
+
+static void           append_row          (GString             *buffer,
+                                           const gchar         *hex,
+                                           gint                 n);
+
+static void           append_run          (GString             *buffer,
+                                           gchar                c,
+                                           gint                 n);
+
+static void           get_barcode_metrics (Zpl                 *zpl,
+                                           glLabelObject       *object,
+                                           glLabelBarcodeStyle *style,
+                                           glMergeRecord       *record,
+                                           gint                *module,
+                                           gint                *height);
+
+static Symbology      get_symbology       (const gchar         *id);
+
+static gboolean       get_orientation     (const cairo_matrix_t *matrix,
+                                           gchar               *orientation);
+
+static gboolean       is_axis_aligned     (const cairo_matrix_t *matrix);
+
+static gchar          get_zpl_color       (guint                color);
+
+static gint           to_dots             (Zpl                 *zpl,
+                                           gdouble              points);
+
+static void           flush_buffer        (Zpl                 *zpl);
+
+static cairo_status_t write_to_file       (void                *closure,
+                                           const guchar        *data,
+                                           guint                length);
+
+static void           report_progress     (glPrintExportSettings *settings,
+                                           gint                 i,
+                                           gint                 n);
+
+
+/*****************************************************************************/
+/* Write label as ZPL II to filename, or to write_func if filename is NULL.  */
+/* Merge records print in the order of the collated or uncollated sheets,    */
+/* positions on a sheet do not apply to a roll printer.                      */
+/*****************************************************************************/
+gboolean
+gl_print_zpl (glLabel               *label,
+              const gchar           *filename,
+              cairo_write_func_t     write_func,
+              void                  *closure,
+              glPrintExportSettings *settings,
+              GError               **error)
+{
+        Zpl            zpl;
+        glMerge       *merge;
+        const GList   *record_list = NULL;
+        const GList   *p;
+        glMergeRecord *record, *sample = NULL;
+        gint           n_records = 0, n_blocks, i_block = 0;
+        gint           i_copy;
+        gboolean       ret = TRUE;
+
+        g_return_val_if_fail (label && GL_IS_LABEL (label), FALSE);
+        g_return_val_if_fail (filename || write_func, FALSE);
+        g_return_val_if_fail (settings, FALSE);
+
+        gl_debug (DEBUG_PRINT, "START");
+
+        zpl.label        = label;
+        zpl.scale        = settings->resolution / POINTS_PER_INCH;
+        zpl.dither       = settings->dither;
+        zpl.reverse_flag = settings->reverse_flag;
+        zpl.buffer       = g_string_new (NULL);
+        zpl.write_func   = write_func;
+        zpl.closure      = closure;
+        zpl.fp           = NULL;
+        zpl.status       = CAIRO_STATUS_SUCCESS;
+        zpl.fields       = NULL;
+        zpl.variable     = NULL;
+
+        if ( filename )
+        {
+                zpl.fp         = g_fopen (filename, "wb");
+                zpl.write_func = write_to_file;
+                zpl.closure    = zpl.fp;
+                if ( zpl.fp == NULL )
+                {
+                        zpl.status = CAIRO_STATUS_WRITE_ERROR;
+                }
+        }
+
+        merge          = gl_label_get_merge (label);
+        zpl.merge_flag = (merge != NULL);
+        if ( merge )
+        {
+                record_list = gl_merge_get_record_list (merge);
+                for ( p = record_list; p != NULL; p = p->next )
+                {
+                        record = (glMergeRecord *)p->data;
+                        if ( record->select_flag )
+                        {
+                                sample = sample ? sample : record;
+                                n_records++;
+                        }
+                }
+        }
+
+        write_format (&zpl, sample);
+
+        if ( !merge )
+        {
+                write_label (&zpl, NULL, settings->n_sheets * (settings->last - settings->first + 1));
+                report_progress (settings, 1, 1);
+        }
+        else if ( settings->collate_flag )
+        {
+                for ( p = record_list; (p != NULL) && (zpl.status == CAIRO_STATUS_SUCCESS); p = p->next )
+                {
+                        record = (glMergeRecord *)p->data;
+                        if ( record->select_flag )
+                        {
+                                write_label (&zpl, record, settings->n_copies);
+                                report_progress (settings, ++i_block, n_records);
+                        }
+                }
+        }
+        else
+        {
+                n_blocks = settings->n_copies * n_records;
+                for ( i_copy = 0; i_copy < settings->n_copies; i_copy++ )
+                {
+                        for ( p = record_list; (p != NULL) && (zpl.status == CAIRO_STATUS_SUCCESS); p = p->next )
+                        {
+                                record = (glMergeRecord *)p->data;
+                                if ( record->select_flag )
+                                {
+                                        write_label (&zpl, record, 1);
+                                        report_progress (settings, ++i_block, n_blocks);
+                                }
+                        }
+                }
+        }
+
+        if ( zpl.fp && (fclose (zpl.fp) != 0) && (zpl.status == CAIRO_STATUS_SUCCESS) )
+        {
+                zpl.status = CAIRO_STATUS_WRITE_ERROR;
+        }
+
+        if ( zpl.status != CAIRO_STATUS_SUCCESS )
+        {
+                if ( filename )
+                {
+                        g_set_error (error, G_IO_ERROR, G_IO_ERROR_FAILED,
+                                     _("Could not write \"%s\": %s"),
+                                     filename, cairo_status_to_string (zpl.status));
+                }
+                else
+                {
+                        g_set_error (error, G_IO_ERROR, G_IO_ERROR_FAILED,
+                                     _("Could not write output: %s"),
+                                     cairo_status_to_string (zpl.status));
+                }
+                ret = FALSE;
+        }
+
+        g_list_free (zpl.fields);
+        g_list_free (zpl.variable);
+        g_string_free (zpl.buffer, TRUE);
+        if ( merge )
+        {
+                g_object_unref (merge);
+        }
+
+        gl_debug (DEBUG_PRINT, "END");
+
+        return ret;
+}
+
+
+/*---------------------------------------------------------------------------*/
+/* PRIVATE.  Write stored format: static objects are drawn, field objects    */
+/* only get their ^FN number.  Sample record sizes field barcodes.           */
+/*---------------------------------------------------------------------------*/
+static void
+write_format (Zpl           *zpl,
+              glMergeRecord *sample)
+{
+        gdouble        w, h;
+        const GList   *p;
+        glLabelObject *object;
+
+        gl_label_get_size (zpl->label, &w, &h);
+
+        g_string_append (zpl->buffer, "^XA\n^DF" FORMAT_NAME "^FS\n");
+        g_string_append_printf (zpl->buffer, "^CI28\n^PW%d\n^LL%d\n^LH0,0\n",
+                                to_dots (zpl, w), to_dots (zpl, h));
+        if ( zpl->reverse_flag )
+        {
+                g_string_append (zpl->buffer, "^PMY\n");
+        }
+
+        for ( p = gl_label_get_object_list (zpl->label); p != NULL; p = p->next )
+        {
+                object = GL_LABEL_OBJECT (p->data);
+
+                switch (classify_object (zpl, object))
+                {
+
+                case OBJECT_FIELD:
+                        zpl->fields = g_list_append (zpl->fields, object);
+                        emit_object (zpl, object, sample, g_list_length (zpl->fields));
+                        break;
+
+                case OBJECT_VARIABLE:
+                        zpl->variable = g_list_append (zpl->variable, object);
+                        break;
+
+                default:
+                        emit_object (zpl, object, NULL, 0);
+                        break;
+
+                }
+        }
+
+        g_string_append (zpl->buffer, "^XZ\n");
+
+        flush_buffer (zpl);
+}
+
+
+/*---------------------------------------------------------------------------*/
+/* PRIVATE.  Write one label recalling the stored format.  Objects drawn per */
+/* record land above all objects of the format.                              */
+/*---------------------------------------------------------------------------*/
+static void
+write_label (Zpl           *zpl,
+             glMergeRecord *record,
+             gint           quantity)
+{
+        GList *p;
+        gint   field = 0;
+
+        g_string_append (zpl->buffer, "^XA\n^CI28\n^XF" FORMAT_NAME "^FS\n");
+
+        for ( p = zpl->fields; p != NULL; p = p->next )
+        {
+                g_string_append_printf (zpl->buffer, "^FN%d", ++field);
+                append_field_data (zpl, GL_LABEL_OBJECT (p->data), record);
+        }
+
+        for ( p = zpl->variable; p != NULL; p = p->next )
+        {
+                emit_object (zpl, GL_LABEL_OBJECT (p->data), record, 0);
+        }
+
+        g_string_append_printf (zpl->buffer, "^PQ%d\n^XZ\n", quantity);
+
+        flush_buffer (zpl);
+}
+
+
+/*---------------------------------------------------------------------------*/
+/* PRIVATE.  How object goes into the stored format.                         */
+/*---------------------------------------------------------------------------*/
+static ObjectKind
+classify_object (Zpl           *zpl,
+                 glLabelObject *object)
+{
+        if ( !zpl->merge_flag )
+        {
+                return OBJECT_STATIC;
+        }
+
+        if ( has_field_color (object) )
+        {
+                return OBJECT_VARIABLE;
+        }
+
+        if ( has_field_data (object) )
+        {
+                return is_native (object) ? OBJECT_FIELD : OBJECT_VARIABLE;
+        }
+
+        return OBJECT_STATIC;
+}
+
+
+/*---------------------------------------------------------------------------*/
+/* PRIVATE.  Does any color of object come from a merge field?               */
+/*---------------------------------------------------------------------------*/
+static gboolean
+has_field_color (glLabelObject *object)
+{
+        glColorNode *color_node;
+        gboolean     field_flag = FALSE;
+
+        if ( gl_label_object_can_line_color (object) )
+        {
+                color_node  = gl_label_object_get_line_color (object);
+                field_flag |= color_node->field_flag;
+                gl_color_node_free (&color_node);
+        }
+
+        if ( gl_label_object_can_fill (object) )
+        {
+                color_node  = gl_label_object_get_fill_color (object);
+                field_flag |= color_node->field_flag;
+                gl_color_node_free (&color_node);
+        }
+
+        if ( gl_label_object_can_text (object) )
+        {
+                color_node  = gl_label_object_get_text_color (object);
+                field_flag |= color_node->field_flag;
+                gl_color_node_free (&color_node);
+        }
+
+        return field_flag;
+}
+
+
+/*---------------------------------------------------------------------------*/
+/* PRIVATE.  Does text, barcode data or image filename use a merge field?    */
+/*---------------------------------------------------------------------------*/
+static gboolean
+has_field_data (glLabelObject *object)
+{
+        GList      *lines, *p_line, *p_node;
+        glTextNode *text_node;
+        gboolean    field_flag = FALSE;
+
+        if ( GL_IS_LABEL_TEXT (object) )
+        {
+                lines = gl_label_text_get_lines (GL_LABEL_TEXT (object));
+                for ( p_line = lines; p_line != NULL; p_line = p_line->next )
+                {
+                        for ( p_node = (GList *)p_line->data; p_node != NULL; p_node = p_node->next )
+                        {
+                                text_node   = (glTextNode *)p_node->data;
+                                field_flag |= text_node->field_flag;
+                        }
+                }
+                gl_text_node_lines_free (&lines);
+        }
+        else if ( GL_IS_LABEL_BARCODE (object) )
+        {
+                text_node  = gl_label_barcode_get_data (GL_LABEL_BARCODE (object));
+                field_flag = text_node->field_flag;
+                gl_text_node_free (&text_node);
+        }
+        else if ( GL_IS_LABEL_IMAGE (object) )
+        {
+                text_node  = gl_label_image_get_filename (GL_LABEL_IMAGE (object));
+                field_flag = text_node->field_flag;
+                gl_text_node_free (&text_node);
+        }
+
+        return field_flag;
+}
+
+
+/*---------------------------------------------------------------------------*/
+/* PRIVATE.  Can object be drawn with ZPL commands, instead of a graphic?    */
+/* Text and barcodes can only be rotated in steps of 90 degrees, not         */
+/* mirrored; shadows and images always need a graphic.                       */
+/*---------------------------------------------------------------------------*/
+static gboolean
+is_native (glLabelObject *object)
+{
+        cairo_matrix_t       matrix;
+        gchar                orientation;
+        glLabelBarcodeStyle *style;
+        Symbology            symbology;
+
+        if ( gl_label_object_get_shadow_state (object) )
+        {
+                return FALSE;
+        }
+
+        gl_label_object_get_matrix (object, &matrix);
+
+        if ( GL_IS_LABEL_TEXT (object) )
+        {
+                return get_orientation (&matrix, &orientation);
+        }
+        else if ( GL_IS_LABEL_BOX (object) || GL_IS_LABEL_ELLIPSE (object) )
+        {
+                return is_axis_aligned (&matrix);
+        }
+        else if ( GL_IS_LABEL_LINE (object) )
+        {
+                return TRUE;
+        }
+        else if ( GL_IS_LABEL_BARCODE (object) )
+        {
+                style     = gl_label_barcode_get_style (GL_LABEL_BARCODE (object));
+                symbology = get_symbology (style->id);
+                gl_label_barcode_style_free (style);
+
+                if ( (symbology == SYMBOLOGY_NONE) || !get_orientation (&matrix, &orientation) )
+                {
+                        return FALSE;
+                }
+
+                /* ^BQ only draws upright QR codes. */
+                return ( (symbology != SYMBOLOGY_QR) || (orientation == 'N') );
+        }
+
+        return FALSE;
+}
+
+
+/*---------------------------------------------------------------------------*/
+/* PRIVATE.  Emit object.  Field is its ^FN number in the stored format, or  */
+/* 0 to send the data of record.                                             */
+/*---------------------------------------------------------------------------*/
+static void
+emit_object (Zpl           *zpl,
+             glLabelObject *object,
+             glMergeRecord *record,
+             gint           field)
+{
+        if ( !is_native (object) )
+        {
+                emit_graphic (zpl, object, record);
+        }
+        else if ( GL_IS_LABEL_TEXT (object) )
+        {
+                emit_text (zpl, object, record, field);
+        }
+        else if ( GL_IS_LABEL_BOX (object) )
+        {
+                emit_shape (zpl, object, record, FALSE);
+        }
+        else if ( GL_IS_LABEL_ELLIPSE (object) )
+        {
+                emit_shape (zpl, object, record, TRUE);
+        }
+        else if ( GL_IS_LABEL_LINE (object) )
+        {
+                emit_line (zpl, object, record);
+        }
+        else if ( GL_IS_LABEL_BARCODE (object) )
+        {
+                emit_barcode (zpl, object, record, field);
+        }
+}
+
+
+/*---------------------------------------------------------------------------*/
+/* PRIVATE.  Emit text as a ^FB block of scalable printer font 0.  ^FB       */
+/* blocks start at the top, only upright text is aligned vertically.         */
+/*---------------------------------------------------------------------------*/
+static void
+emit_text (Zpl           *zpl,
+           glLabelObject *object,
+           glMergeRecord *record,
+           gint           field)
+{
+        glColorNode    *color_node;
+        gchar           zpl_color;
+        cairo_matrix_t  matrix;
+        gchar           orientation;
+        glLabelRegion   region;
+        GList          *lines;
+        gint            n_lines;
+        gdouble         w, h;
+        gdouble         font_size, line_spacing;
+        gdouble         y_offset = 0.0;
+        gint            font_h;
+        gchar           justification;
+
+        color_node = gl_label_object_get_text_color (object);
+        zpl_color  = get_zpl_color (gl_color_node_expand (color_node, record));
+        gl_color_node_free (&color_node);
+        if ( !zpl_color )
+        {
+                return;
+        }
+
+        gl_label_object_get_matrix (object, &matrix);
+        get_orientation (&matrix, &orientation);
+        gl_label_object_get_size (object, &w, &h);
+        gl_label_object_get_extent (object, &region);
+
+        lines   = gl_label_text_get_lines (GL_LABEL_TEXT (object));
+        n_lines = MAX (1, g_list_length (lines));
+        gl_text_node_lines_free (&lines);
+
+        font_size    = gl_label_object_get_font_size (object);
+        line_spacing = gl_label_object_get_text_line_spacing (object);
+        font_h       = MAX (1, to_dots (zpl, font_size));
+
+        switch (gl_label_object_get_text_alignment (object))
+        {
+        case PANGO_ALIGN_CENTER:
+                justification = 'C';
+                break;
+        case PANGO_ALIGN_RIGHT:
+                justification = 'R';
+                break;
+        default:
+                justification = 'L';
+                break;
+        }
+
+        if ( orientation == 'N' )
+        {
+                switch (gl_label_object_get_text_valignment (object))
+                {
+                case GL_VALIGN_VCENTER:
+                        y_offset = (h - 2*GL_LABEL_TEXT_MARGIN - n_lines*font_size*line_spacing) / 2;
+                        break;
+                case GL_VALIGN_BOTTOM:
+                        y_offset = (h - 2*GL_LABEL_TEXT_MARGIN - n_lines*font_size*line_spacing);
+                        break;
+                default:
+                        break;
+                }
+                y_offset = MAX (0.0, y_offset);
+        }
+
+        g_string_append_printf (zpl->buffer, "^FO%d,%d\n^A0%c,%d,%d\n^FB%d,%d,%d,%c,0\n",
+                                to_dots (zpl, region.x1 + GL_LABEL_TEXT_MARGIN),
+                                to_dots (zpl, region.y1 + GL_LABEL_TEXT_MARGIN + y_offset),
+                                orientation, font_h, font_h,
+                                MAX (1, to_dots (zpl, w - 2*GL_LABEL_TEXT_MARGIN)),
+                                n_lines,
+                                (gint)floor (font_h * (line_spacing - 1.0) + 0.5),
+                                justification);
+        if ( zpl_color == 'W' )
+        {
+                g_string_append (zpl->buffer, "^FR");
+        }
+
+        append_data (zpl, object, record, field);
+}
+
+
+/*---------------------------------------------------------------------------*/
+/* PRIVATE.  Emit box (^GB) or ellipse (^GE), fill then outline.  A filled   */
+/* shape is an outline as thick as the shape.                                */
+/*---------------------------------------------------------------------------*/
+static void
+emit_shape (Zpl           *zpl,
+            glLabelObject *object,
+            glMergeRecord *record,
+            gboolean       ellipse_flag)
+{
+        glColorNode   *color_node;
+        gchar          fill_color, line_color;
+        glLabelRegion  region;
+        gdouble        line_w;
+        gint           x, y, w, h, t;
+
+        color_node = gl_label_object_get_fill_color (object);
+        fill_color = get_zpl_color (gl_color_node_expand (color_node, record));
+        gl_color_node_free (&color_node);
+
+        color_node = gl_label_object_get_line_color (object);
+        line_color = get_zpl_color (gl_color_node_expand (color_node, record));
+        gl_color_node_free (&color_node);
+
+        line_w = gl_label_object_get_line_width (object);
+        gl_label_object_get_extent (object, &region);
+
+        if ( fill_color )
+        {
+                x = to_dots (zpl, region.x1 + line_w/2);
+                y = to_dots (zpl, region.y1 + line_w/2);
+                w = to_dots (zpl, region.x2 - line_w/2) - x;
+                h = to_dots (zpl, region.y2 - line_w/2) - y;
+
+                if ( (w > 0) && (h > 0) )
+                {
+                        g_string_append_printf (zpl->buffer, "^FO%d,%d\n^G%c%d,%d,%d,%c^FS\n",
+                                                x, y, ellipse_flag ? 'E' : 'B',
+                                                w, h, MIN (w, h), fill_color);
+                }
+        }
+
+        if ( line_color && (line_w > 0.0) )
+        {
+                x = to_dots (zpl, region.x1);
+                y = to_dots (zpl, region.y1);
+                w = to_dots (zpl, region.x2) - x;
+                h = to_dots (zpl, region.y2) - y;
+                t = CLAMP (to_dots (zpl, line_w), 1, MAX (1, MIN (w, h)));
+
+                if ( (w > 0) && (h > 0) )
+                {
+                        g_string_append_printf (zpl->buffer, "^FO%d,%d\n^G%c%d,%d,%d,%c^FS\n",
+                                                x, y, ellipse_flag ? 'E' : 'B',
+                                                w, h, t, line_color);
+                }
+        }
+}
+
+
+/*---------------------------------------------------------------------------*/
+/* PRIVATE.  Emit line, ^GB if horizontal or vertical, else ^GD.             */
+/*---------------------------------------------------------------------------*/
+static void
+emit_line (Zpl           *zpl,
+           glLabelObject *object,
+           glMergeRecord *record)
+{
+        glColorNode    *color_node;
+        gchar           line_color;
+        cairo_matrix_t  matrix;
+        gdouble         x0, y0, dx, dy;
+        gdouble         xa1 = 0.0, ya1 = 0.0, xa2, ya2;
+        gint            x1, y1, x2, y2, w, h, t;
+
+        color_node = gl_label_object_get_line_color (object);
+        line_color = get_zpl_color (gl_color_node_expand (color_node, record));
+        gl_color_node_free (&color_node);
+        if ( !line_color )
+        {
+                return;
+        }
+
+        gl_label_object_get_position (object, &x0, &y0);
+        gl_label_object_get_size (object, &dx, &dy);
+        gl_label_object_get_matrix (object, &matrix);
+
+        xa2 = dx;
+        ya2 = dy;
+        cairo_matrix_transform_point (&matrix, &xa1, &ya1);
+        cairo_matrix_transform_point (&matrix, &xa2, &ya2);
+
+        x1 = to_dots (zpl, x0 + xa1);
+        y1 = to_dots (zpl, y0 + ya1);
+        x2 = to_dots (zpl, x0 + xa2);
+        y2 = to_dots (zpl, y0 + ya2);
+        w  = ABS (x2 - x1);
+        h  = ABS (y2 - y1);
+        t  = MAX (1, to_dots (zpl, gl_label_object_get_line_width (object)));
+
+        if ( h == 0 )
+        {
+                g_string_append_printf (zpl->buffer, "^FO%d,%d\n^GB%d,%d,%d,%c^FS\n",
+                                        MIN (x1, x2), y1 - t/2, MAX (w, t), t, t, line_color);
+        }
+        else if ( w == 0 )
+        {
+                g_string_append_printf (zpl->buffer, "^FO%d,%d\n^GB%d,%d,%d,%c^FS\n",
+                                        x1 - t/2, MIN (y1, y2), t, MAX (h, t), t, line_color);
+        }
+        else
+        {
+                /* L leans like "\", from top left to bottom right. */
+                g_string_append_printf (zpl->buffer, "^FO%d,%d\n^GD%d,%d,%d,%c,%c^FS\n",
+                                        MIN (x1, x2), MIN (y1, y2), MAX (w, t), MAX (h, t), t, line_color,
+                                        ((x2 - x1) * (y2 - y1) > 0) ? 'L' : 'R');
+        }
+}
+
+
+/*---------------------------------------------------------------------------*/
+/* PRIVATE.  Emit barcode drawn by the printer.  Module width and bar height */
+/* come from the barcode as gLabels would draw it.                           */
+/*---------------------------------------------------------------------------*/
+static void
+emit_barcode (Zpl           *zpl,
+              glLabelObject *object,
+              glMergeRecord *record,
+              gint           field)
+{
+        glLabelBarcodeStyle *style;
+        glColorNode         *color_node;
+        gchar                line_color;
+        cairo_matrix_t       matrix;
+        gchar                orientation;
+        glLabelRegion        region;
+        gint                 module, height;
+        gchar                text;
+
+        color_node = gl_label_object_get_line_color (object);
+        line_color = get_zpl_color (gl_color_node_expand (color_node, record));
+        gl_color_node_free (&color_node);
+        if ( !line_color )
+        {
+                return;
+        }
+
+        style = gl_label_barcode_get_style (GL_LABEL_BARCODE (object));
+
+        gl_label_object_get_matrix (object, &matrix);
+        get_orientation (&matrix, &orientation);
+        gl_label_object_get_extent (object, &region);
+        get_barcode_metrics (zpl, object, style, record, &module, &height);
+
+        text = style->text_flag ? 'Y' : 'N';
+
+        g_string_append_printf (zpl->buffer, "^FO%d,%d\n",
+                                to_dots (zpl, region.x1), to_dots (zpl, region.y1));
+
+        switch (get_symbology (style->id))
+        {
+
+        case SYMBOLOGY_CODE128:
+                g_string_append_printf (zpl->buffer, "^BY%d\n^BC%c,%d,%c,N,N,A\n",
+                                        module, orientation, height, text);
+                break;
+
+        case SYMBOLOGY_CODE39:
+                g_string_append_printf (zpl->buffer, "^BY%d\n^B3%c,%c,%d,%c,N\n",
+                                        module, orientation, style->checksum_flag ? 'Y' : 'N',
+                                        height, text);
+                break;
+
+        case SYMBOLOGY_EAN13:
+                g_string_append_printf (zpl->buffer, "^BY%d\n^BE%c,%d,%c,N\n",
+                                        module, orientation, height, text);
+                break;
+
+        case SYMBOLOGY_EAN8:
+                g_string_append_printf (zpl->buffer, "^BY%d\n^B8%c,%d,%c,N\n",
+                                        module, orientation, height, text);
+                break;
+
+        case SYMBOLOGY_UPCA:
+                g_string_append_printf (zpl->buffer, "^BY%d\n^BU%c,%d,%c,N,Y\n",
+                                        module, orientation, height, text);
+                break;
+
+        case SYMBOLOGY_UPCE:
+                g_string_append_printf (zpl->buffer, "^BY%d\n^B9%c,%d,%c,N,Y\n",
+                                        module, orientation, height, text);
+                break;
+
+        case SYMBOLOGY_QR:
+                /* Model 2, magnification is the module size in dots. */
+                g_string_append_printf (zpl->buffer, "^BQN,2,%d\n", CLAMP (module, 1, 10));
+                break;
+
+        case SYMBOLOGY_DATAMATRIX:
+                /* ECC 200, element height is the module size in dots. */
+                g_string_append_printf (zpl->buffer, "^BX%c,%d,200\n", orientation, module);
+                break;
+
+        default:
+                break;
+
+        }
+
+        if ( line_color == 'W' )
+        {
+                g_string_append (zpl->buffer, "^FR");
+        }
+
+        append_data (zpl, object, record, field);
+
+        gl_label_barcode_style_free (style);
+}
+
+
+/*---------------------------------------------------------------------------*/
+/* PRIVATE.  Emit object as a 1-bit ^GF graphic, drawn without antialiasing  */
+/* at the printer resolution.                                                */
+/*---------------------------------------------------------------------------*/
+static void
+emit_graphic (Zpl           *zpl,
+              glLabelObject *object,
+              glMergeRecord *record)
+{
+        glLabelRegion    region;
+        gdouble          shadow_x, shadow_y;
+        gint             x, y, w, h;
+        cairo_surface_t *surface;
+        cairo_t         *cr;
+        glMonoBitmap    *bitmap;
+
+        gl_label_object_get_extent (object, &region);
+        if ( gl_label_object_get_shadow_state (object) )
+        {
+                gl_label_object_get_shadow_offset (object, &shadow_x, &shadow_y);
+                region.x1 = MIN (region.x1, region.x1 + shadow_x);
+                region.y1 = MIN (region.y1, region.y1 + shadow_y);
+                region.x2 = MAX (region.x2, region.x2 + shadow_x);
+                region.y2 = MAX (region.y2, region.y2 + shadow_y);
+        }
+
+        x = floor (region.x1 * zpl->scale);
+        y = floor (region.y1 * zpl->scale);
+        w = ceil (region.x2 * zpl->scale) - x;
+        h = ceil (region.y2 * zpl->scale) - y;
+        if ( (w <= 0) || (h <= 0) )
+        {
+                return;
+        }
+
+        surface = cairo_image_surface_create (CAIRO_FORMAT_RGB24, w, h);
+
+        cr = cairo_create (surface);
+        cairo_set_source_rgb (cr, 1.0, 1.0, 1.0);
+        cairo_paint (cr);
+        cairo_translate (cr, -x, -y);
+        cairo_scale (cr, zpl->scale, zpl->scale);
+        cairo_set_antialias (cr, CAIRO_ANTIALIAS_NONE);
+        gl_label_object_draw (object, cr, FALSE, record);
+        cairo_destroy (cr);
+
+        bitmap = gl_mono_bitmap_new_from_surface (surface, zpl->dither);
+        cairo_surface_destroy (surface);
+
+        append_graphic (zpl->buffer, MAX (x, 0), MAX (y, 0), bitmap);
+
+        gl_mono_bitmap_free (bitmap);
+}
+
+
+/*---------------------------------------------------------------------------*/
+/* PRIVATE.  Append ^FN number of field, or the data itself.                 */
+/*---------------------------------------------------------------------------*/
+static void
+append_data (Zpl           *zpl,
+             glLabelObject *object,
+             glMergeRecord *record,
+             gint           field)
+{
+        if ( field > 0 )
+        {
+                g_string_append_printf (zpl->buffer, "^FN%d^FS\n", field);
+        }
+        else
+        {
+                append_field_data (zpl, object, record);
+        }
+}
+
+
+/*---------------------------------------------------------------------------*/
+/* PRIVATE.  Append text or barcode data of record as ^FD.  ZPL control      */
+/* characters are sent as ^FH hex escapes.                                   */
+/*---------------------------------------------------------------------------*/
+static void
+append_field_data (Zpl           *zpl,
+                   glLabelObject *object,
+                   glMergeRecord *record)
+{
+        GList               *lines;
+        glTextNode          *text_node;
+        glLabelBarcodeStyle *style;
+        gchar               *data;
+        const gchar         *p;
+        gboolean             block_flag;
+
+        block_flag = GL_IS_LABEL_TEXT (object);
+
+        g_string_append (zpl->buffer, "^FH_^FD");
+
+        if ( block_flag )
+        {
+                lines = gl_label_text_get_lines (GL_LABEL_TEXT (object));
+                data  = gl_text_node_lines_expand (lines, record);
+                gl_text_node_lines_free (&lines);
+        }
+        else
+        {
+                text_node = gl_label_barcode_get_data (GL_LABEL_BARCODE (object));
+                data      = gl_text_node_expand (text_node, record);
+                gl_text_node_free (&text_node);
+
+                style = gl_label_barcode_get_style (GL_LABEL_BARCODE (object));
+                if ( get_symbology (style->id) == SYMBOLOGY_QR )
+                {
+                        /* Error correction level, automatic data mode. */
+                        g_string_append (zpl->buffer, "QA,");
+                }
+                gl_label_barcode_style_free (style);
+        }
+
+        for ( p = data; *p; p++ )
+        {
+                switch (*p)
+                {
+                case '^':
+                        g_string_append (zpl->buffer, "_5E");
+                        break;
+                case '~':
+                        g_string_append (zpl->buffer, "_7E");
+                        break;
+                case '_':
+                        g_string_append (zpl->buffer, "_5F");
+                        break;
+                case '\\':
+                        g_string_append (zpl->buffer, block_flag ? "\\\\" : "\\");
+                        break;
+                case '\n':
+                        g_string_append (zpl->buffer, block_flag ? "\\&" : " ");
+                        break;
+                case '\r':
+                        break;
+                default:
+                        g_string_append_c (zpl->buffer, *p);
+                        break;
+                }
+        }
+
+        g_string_append (zpl->buffer, "^FS\n");
+
+        g_free (data);
+}
+
+
+/*---------------------------------------------------------------------------*/
+/* PRIVATE.  Append bitmap as ^GFA graphic with ZPL ASCII compression.       */
+/*---------------------------------------------------------------------------*/
+static void
+append_graphic (GString            *buffer,
+                gint                x,
+                gint                y,
+                const glMonoBitmap *bitmap)
+{
+        static const gchar  digits[] = "0123456789ABCDEF";
+        gsize               n_bytes;
+        gint                n_hex;
+        gchar              *hex, *prev_hex, *tmp;
+        const guchar       *row;
+        guint32             i_row;
+        gint                i;
+
+        n_bytes = (gsize)bitmap->stride * bitmap->height;
+        n_hex   = 2 * bitmap->stride;
+
+        g_string_append_printf (buffer, "^FO%d,%d\n^GFA,%" G_GSIZE_FORMAT ",%" G_GSIZE_FORMAT ",%d,",
+                                x, y, n_bytes, n_bytes, bitmap->stride);
+
+        hex      = g_new (gchar, n_hex);
+        prev_hex = g_new (gchar, n_hex);
+
+        for ( i_row = 0; i_row < bitmap->height; i_row++ )
+        {
+                row = bitmap->data + (gsize)i_row * bitmap->stride;
+                for ( i = 0; i < bitmap->stride; i++ )
+                {
+                        hex[2*i]     = digits[row[i] >> 4];
+                        hex[2*i + 1] = digits[row[i] & 0x0F];
+                }
+
+                if ( (i_row > 0) && (memcmp (hex, prev_hex, n_hex) == 0) )
+                {
+                        /* Same as previous row. */
+                        g_string_append_c (buffer, ':');
+                }
+                else
+                {
+                        append_row (buffer, hex, n_hex);
+                }
+
+                tmp      = prev_hex;
+                prev_hex = hex;
+                hex      = tmp;
+        }
+
+        g_string_append (buffer, "^FS\n");
+
+        g_free (hex);
+        g_free (prev_hex);
+}
+
+
+/*---------------------------------------------------------------------------*/
+/* PRIVATE.  Append one compressed row of hex digits.  A trailing run of     */
+/* zeros or ones ends the row with "," or "!".                               */
+/*---------------------------------------------------------------------------*/
+static void
+append_row (GString     *buffer,
+            const gchar *hex,
+            gint         n)
+{
+        gint  end, i, run;
+        gchar tail = 0;
+
+        end = n;
+        if ( (hex[n - 1] == '0') || (hex[n - 1] == 'F') )
+        {
+                tail = (hex[n - 1] == '0') ? ',' : '!';
+                while ( (end > 0) && (hex[end - 1] == hex[n - 1]) )
+                {
+                        end--;
+                }
+        }
+
+        for ( i = 0; i < end; i += run )
+        {
+                for ( run = 1; ((i + run) < end) && (hex[i + run] == hex[i]); run++ );
+
+                append_run (buffer, hex[i], run);
+        }
+
+        if ( tail )
+        {
+                g_string_append_c (buffer, tail);
+        }
+}
+
+
+/*---------------------------------------------------------------------------*/
+/* PRIVATE.  Append run of n hex digits c: "g".."z" count multiples of 20,   */
+/* "G".."Y" count 1 to 19.                                                   */
+/*---------------------------------------------------------------------------*/
+static void
+append_run (GString *buffer,
+            gchar    c,
+            gint     n)
+{
+        gint k;
+
+        while ( n > 0 )
+        {
+                k  = MIN (n, MAX_RUN);
+                n -= k;
+
+                if ( k > 1 )
+                {
+                        if ( k >= 20 )
+                        {
+                                g_string_append_c (buffer, 'g' + (k / 20) - 1);
+                        }
+                        if ( (k % 20) != 0 )
+                        {
+                                g_string_append_c (buffer, 'G' + (k % 20) - 1);
+                        }
+                }
+                g_string_append_c (buffer, c);
+        }
+}
+
+
+/*---------------------------------------------------------------------------*/
+/* PRIVATE.  Module width and bar height in dots, from the barcode of record */
+/* (or the object data).  Defaults to 1 dot and the object height if it      */
+/* cannot be encoded.                                                        */
+/*---------------------------------------------------------------------------*/
+static void
+get_barcode_metrics (Zpl                 *zpl,
+                     glLabelObject       *object,
+                     glLabelBarcodeStyle *style,
+                     glMergeRecord       *record,
+                     gint                *module,
+                     gint                *height)
+{
+        glTextNode      *text_node;
+        gchar           *data;
+        gdouble          w, h;
+        lglBarcode      *gbc;
+        GList           *p;
+        lglBarcodeShape *shape;
+        gdouble          module_pts = G_MAXDOUBLE;
+        gdouble          height_pts;
+
+        text_node = gl_label_barcode_get_data (GL_LABEL_BARCODE (object));
+        data      = gl_text_node_expand (text_node, record);
+        gl_text_node_free (&text_node);
+
+        gl_label_object_get_raw_size (object, &w, &h);
+        height_pts = h;
+
+        gbc = gl_barcode_backends_new_barcode (style->backend_id, style->id,
+                                               style->text_flag, style->checksum_flag,
+                                               w, h, data);
+        g_free (data);
+
+        if ( gbc != NULL )
+        {
+                for ( p = gbc->shapes; p != NULL; p = p->next )
+                {
+                        shape = (lglBarcodeShape *)p->data;
+
+                        if ( shape->type == LGL_BARCODE_SHAPE_LINE )
+                        {
+                                module_pts = MIN (module_pts, shape->line.width);
+                                height_pts = MIN (height_pts, shape->line.length);
+                        }
+                        else if ( shape->type == LGL_BARCODE_SHAPE_BOX )
+                        {
+                                module_pts = MIN (module_pts, shape->box.width);
+                        }
+                }
+
+                lgl_barcode_free (gbc);
+        }
+
+        *module = (module_pts == G_MAXDOUBLE) ? 1 : MAX (1, to_dots (zpl, module_pts));
+        *height = MAX (1, to_dots (zpl, height_pts));
+}
+
+
+/*---------------------------------------------------------------------------*/
+/* PRIVATE.  Printer symbology of barcode style id.                          */
+/*---------------------------------------------------------------------------*/
+static Symbology
+get_symbology (const gchar *id)
+{
+        gint i;
+
+        for ( i = 0; (id != NULL) && (symbologies[i].id != NULL); i++ )
+        {
+                if ( g_ascii_strcasecmp (id, symbologies[i].id) == 0 )
+                {
+                        return symbologies[i].symbology;
+                }
+        }
+
+        return SYMBOLOGY_NONE;
+}
+
+
+/*---------------------------------------------------------------------------*/
+/* PRIVATE.  ZPL field orientation of a rotation by a multiple of 90         */
+/* degrees.  FALSE if mirrored or rotated by any other angle.                */
+/*---------------------------------------------------------------------------*/
+static gboolean
+get_orientation (const cairo_matrix_t *matrix,
+                 gchar                *orientation)
+{
+        if ( (matrix->xx * matrix->yy - matrix->xy * matrix->yx) <= 0.0 )
+        {
+                return FALSE;
+        }
+
+        if ( (fabs (matrix->xy) < EPSILON) && (fabs (matrix->yx) < EPSILON) )
+        {
+                *orientation = (matrix->xx > 0.0) ? 'N' : 'I';
+        }
+        else if ( (fabs (matrix->xx) < EPSILON) && (fabs (matrix->yy) < EPSILON) )
+        {
+                *orientation = (matrix->yx > 0.0) ? 'R' : 'B';
+        }
+        else
+        {
+                return FALSE;
+        }
+
+        return TRUE;
+}
+
+
+/*---------------------------------------------------------------------------*/
+/* PRIVATE.  Does matrix keep rectangles axis aligned?                       */
+/*---------------------------------------------------------------------------*/
+static gboolean
+is_axis_aligned (const cairo_matrix_t *matrix)
+{
+        return ( ((fabs (matrix->xy) < EPSILON) && (fabs (matrix->yx) < EPSILON)) ||
+                 ((fabs (matrix->xx) < EPSILON) && (fabs (matrix->yy) < EPSILON)) );
+}
+
+
+/*---------------------------------------------------------------------------*/
+/* PRIVATE.  ZPL color of label color: 'B', 'W' or 0 if not printed.         */
+/*---------------------------------------------------------------------------*/
+static gchar
+get_zpl_color (guint color)
+{
+        gdouble luminance;
+
+        if ( GL_COLOR_F_ALPHA (color) < ALPHA_THRESHOLD )
+        {
+                return 0;
+        }
+
+        luminance = 0.299 * GL_COLOR_F_RED (color) +
+                    0.587 * GL_COLOR_F_GREEN (color) +
+                    0.114 * GL_COLOR_F_BLUE (color);
+
+        return (luminance < LUMINANCE_THRESHOLD) ? 'B' : 'W';
+}
+
+
+/*---------------------------------------------------------------------------*/
+/* PRIVATE.  Points to printer dots.                                         */
+/*---------------------------------------------------------------------------*/
+static gint
+to_dots (Zpl     *zpl,
+         gdouble  points)
+{
+        return (gint) floor (points * zpl->scale + 0.5);
+}
+
+
+/*---------------------------------------------------------------------------*/
+/* PRIVATE.  Write buffered commands.                                        */
+/*---------------------------------------------------------------------------*/
+static void
+flush_buffer (Zpl *zpl)
+{
+        if ( (zpl->status == CAIRO_STATUS_SUCCESS) && (zpl->buffer->len > 0) )
+        {
+                zpl->status = zpl->write_func (zpl->closure,
+                                               (const guchar *)zpl->buffer->str,
+                                               zpl->buffer->len);
+        }
+
+        g_string_truncate (zpl->buffer, 0);
+}
+
+
+/*---------------------------------------------------------------------------*/
+/* PRIVATE.  Write function for output files.                                */
+/*---------------------------------------------------------------------------*/
+static cairo_status_t
+write_to_file (void         *closure,
+               const guchar *data,
+               guint         length)
+{
+        if ( fwrite (data, 1, length, (FILE *)closure) != length )
+        {
+                return CAIRO_STATUS_WRITE_ERROR;
+        }
+
+        return CAIRO_STATUS_SUCCESS;
+}
+
+
+/*---------------------------------------------------------------------------*/
+/* PRIVATE.  Report progress, i of n labels written.                         */
+/*---------------------------------------------------------------------------*/
+static void
+report_progress (glPrintExportSettings *settings,
+                 gint                   i,
+                 gint                   n)
+{
+        if ( settings->progress_func )
+        {
+                settings->progress_func (i, n, settings->progress_data);
+        }
+}
+
+
+
+
+/*
+ * Local Variables:       -- emacs
+ * mode: C                -- emacs
+ * c-basic-offset: 8      -- emacs
+ * tab-width: 8           -- emacs
+ * indent-tabs-mode: nil  -- emacs
+ * End:                   -- emacs
+ */
@@ -0,0 +1,59 @@
+/*
+ *  print-zpl.h
+ *  Copyright (C) 2026  agent <agent@local>.
+ *
+ *  This file is part of gLabels.
+ *
+ *  gLabels is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  gLabels is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with gLabels.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef __PRINT_ZPL_H__
+#define __PRINT_ZPL_H__
+
+#include <glib.h>
+#include <cairo.h>
+
+#include "label.h"
+#include "print-export.h"
+
+G_BEGIN_DECLS
+
+
+/*
+ * Translates label objects to ZPL II for Zebra label printers.  Static objects
+ * are sent once as a stored format, merge records only send their field data.
+ */
+gboolean gl_print_zpl (glLabel               *label,
+                       const gchar           *filename,
+                       cairo_write_func_t     write_func,
+                       void                  *closure,
+                       glPrintExportSettings *settings,
+                       GError               **error);
+
+
+G_END_DECLS
+
+#endif /* __PRINT_ZPL_H__ */
+
+
+
+
+/*
+ * Local Variables:       -- emacs
+ * mode: C                -- emacs
+ * c-basic-offset: 8      -- emacs
+ * tab-width: 8           -- emacs
+ * indent-tabs-mode: nil  -- emacs
+ * End:                   -- emacs
+ */
@@ -150,7 +150,6 @@ gl_print_collated_merge_sheet   (glLabel          *label,
                                  gboolean          crop_marks_flag,
                                  glPrintState     *state)
 {
-	glMerge                   *merge;
 	const GList               *record_list;
 	PrintInfo                 *pi;
 	const lglTemplateFrame    *frame;
@@ -161,8 +160,11 @@ gl_print_collated_merge_sheet   (glLabel          *label,
 
 	gl_debug (DEBUG_PRINT, "START");
 
-	merge = gl_label_get_merge (label);
-	record_list = gl_merge_get_record_list (merge);
+        if ( (page == 0) || (state->merge == NULL) )
+        {
+                gl_print_state_seek (state, label, page, n_copies, first, TRUE);
+        }
+	record_list = gl_merge_get_record_list (state->merge);
 
 	pi = print_info_new (cr, label);
         frame = (lglTemplateFrame *)pi->template->frames->data;
@@ -174,17 +176,7 @@ gl_print_collated_merge_sheet   (glLabel          *label,
                 print_crop_marks (pi);
         }
 
-        if (page == 0)
-        {
-                state->i_copy  = 0;
-                state->p_record = (GList *)record_list;
-
-                i_label = first - 1;
-        }
-        else
-        {
-                i_label = 0;
-        }
+        i_label = (page == 0) ? (first - 1) : 0;
 
 
 	for ( p=(GList *)state->p_record; p!=NULL; p=p->next ) {
@@ -242,7 +234,6 @@ gl_print_uncollated_merge_sheet (glLabel          *label,
                                  gboolean          crop_marks_flag,
                                  glPrintState     *state)
 {
-	glMerge                   *merge;
 	const GList               *record_list;
 	PrintInfo                 *pi;
 	const lglTemplateFrame    *frame;
@@ -253,8 +244,11 @@ gl_print_uncollated_merge_sheet (glLabel          *label,
 
 	gl_debug (DEBUG_PRINT, "START");
 
-	merge = gl_label_get_merge (label);
-	record_list = gl_merge_get_record_list (merge);
+        if ( (page == 0) || (state->merge == NULL) )
+        {
+                gl_print_state_seek (state, label, page, n_copies, first, FALSE);
+        }
+	record_list = gl_merge_get_record_list (state->merge);
 
 	pi = print_info_new (cr, label);
         frame = (lglTemplateFrame *)pi->template->frames->data;
@@ -266,17 +260,7 @@ gl_print_uncollated_merge_sheet (glLabel          *label,
                 print_crop_marks (pi);
         }
 
-        if (page == 0)
-        {
-                state->i_copy  = 0;
-                state->p_record = (GList *)record_list;
-
-                i_label = first - 1;
-        }
-        else
-        {
-                i_label = 0;
-        }
+        i_label = (page == 0) ? (first - 1) : 0;
 
 	for (i_copy = state->i_copy; i_copy < n_copies; i_copy++) {
 
@@ -322,6 +306,95 @@ gl_print_uncollated_merge_sheet (glLabel          *label,
 }
 
 
+/*****************************************************************************/
+/* Position state at the start of page, as if all previous pages had been    */
+/* printed.  Page 0 starts with label "first", later pages with label 1.     */
+/*****************************************************************************/
+void
+gl_print_state_seek (glPrintState     *state,
+                     glLabel          *label,
+                     gint              page,
+                     gint              n_copies,
+                     gint              first,
+                     gboolean          collate_flag)
+{
+	const lglTemplate      *template;
+	const lglTemplateFrame *frame;
+	GList                  *p;
+	glMergeRecord          *record;
+	gint                    n_labels_per_page, n_records;
+	gint                    i_label, i_record;
+
+	gl_debug (DEBUG_PRINT, "START");
+
+        gl_print_state_clear (state);
+
+        state->merge = gl_label_get_merge (label);
+        if ( (state->merge == NULL) || (n_copies < 1) )
+        {
+                return;
+        }
+
+	template = gl_label_get_template (label);
+        frame = (lglTemplateFrame *)template->frames->data;
+	n_labels_per_page = lgl_template_frame_get_n_labels (frame);
+
+        /* Number of merge labels printed on previous pages. */
+        i_label = MAX (page * n_labels_per_page - (first - 1), 0);
+
+        n_records = gl_merge_get_record_count (state->merge);
+        if ( n_records == 0 )
+        {
+                return;
+        }
+
+        if (collate_flag)
+        {
+                i_record      = i_label / n_copies;
+                state->i_copy = i_label % n_copies;
+        }
+        else
+        {
+                i_record      = i_label % n_records;
+                state->i_copy = i_label / n_records;
+        }
+
+        for ( p = (GList *)gl_merge_get_record_list (state->merge); p != NULL; p = p->next )
+        {
+		record = (glMergeRecord *)p->data;
+
+                if ( record->select_flag )
+                {
+                        if ( i_record == 0 )
+                        {
+                                break;
+                        }
+                        i_record--;
+                }
+        }
+        state->p_record = p;
+
+	gl_debug (DEBUG_PRINT, "END");
+}
+
+
+/*****************************************************************************/
+/* Release merge records held by state.                                      */
+/*****************************************************************************/
+void
+gl_print_state_clear (glPrintState     *state)
+{
+        if ( state->merge )
+        {
+                g_object_unref (state->merge);
+        }
+
+        state->i_copy   = 0;
+        state->p_record = NULL;
+        state->merge    = NULL;
+}
+
+
 /*---------------------------------------------------------------------------*/
 /* PRIVATE.  new print info structure                                        */
 /*---------------------------------------------------------------------------*/
@@ -27,11 +27,25 @@
 
 G_BEGIN_DECLS
 
+/*
+ * Position of a merge print run.  merge holds the records p_record points
+ * into; release it with gl_print_state_clear() once the run is done.
+ */
 typedef struct {
-	gint   i_copy;
-	GList *p_record;
+	gint     i_copy;
+	GList   *p_record;
+	glMerge *merge;
 } glPrintState;
 
+void gl_print_state_seek             (glPrintState     *state,
+				      glLabel          *label,
+				      gint              page,
+				      gint              n_copies,
+				      gint              first,
+				      gboolean          collate_flag);
+
+void gl_print_state_clear            (glPrintState     *state);
+
 void gl_print_simple_sheet           (glLabel          *label,
 				      cairo_t          *cr,
 				      gint              page,
@@ -0,0 +1,426 @@
+/*
+ *  spatial-index.c
+ *  Copyright (C) 2026  agent <agent@local>.
+ *
+ *  This file is part of gLabels.
+ *
+ *  gLabels is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  gLabels is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with gLabels.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <config.h>
+
+#include "spatial-index.h"
+
+#include <math.h>
+
+#include "debug.h"
+
+
+/*========================================================*/
+/* Private macros and constants.                          */
+/*========================================================*/
+
+/* Items (or queries) spanning more cells are handled without the grid. */
+#define MAX_CELLS 64
+
+#define CELL_KEY(cx,cy) ( ((gint64)(cx) << 32) | (guint32)(cy) )
+
+
+/*========================================================*/
+/* Private types.                                         */
+/*========================================================*/
+
+struct _glSpatialIndex {
+        gdouble     cell_size;
+
+        GHashTable *cells;      /* CELL_KEY -> GPtrArray of items */
+        GHashTable *items;      /* item -> Entry */
+        GHashTable *large;      /* Items not stored in cells */
+};
+
+typedef struct {
+        gdouble     x1, y1, x2, y2;
+        gint        cx1, cy1, cx2, cy2;
+        gboolean    large_flag;
+} Entry;
+
+
+/*========================================================*/
+/* Private function prototypes.                           */
+/*========================================================*/
+
+static void     get_cell_range   (glSpatialIndex *index,
+                                  gdouble         x1,
+                                  gdouble         y1,
+                                  gdouble         x2,
+                                  gdouble         y2,
+                                  gint           *cx1,
+                                  gint           *cy1,
+                                  gint           *cx2,
+                                  gint           *cy2);
+
+static gboolean is_large         (gint            cx1,
+                                  gint            cy1,
+                                  gint            cx2,
+                                  gint            cy2);
+
+static void     add_to_cells     (glSpatialIndex *index,
+                                  gpointer        item,
+                                  Entry          *entry);
+
+static void     remove_from_cells(glSpatialIndex *index,
+                                  gpointer        item,
+                                  Entry          *entry);
+
+static gboolean entry_intersects (Entry          *entry,
+                                  gdouble         x1,
+                                  gdouble         y1,
+                                  gdouble         x2,
+                                  gdouble         y2);
+
+
+/*****************************************************************************/
+/* Create a new spatial index.                                               */
+/*****************************************************************************/
+glSpatialIndex *
+gl_spatial_index_new (gdouble cell_size)
+{
+        glSpatialIndex *index;
+
+        g_return_val_if_fail (cell_size > 0.0, NULL);
+
+        index = g_new0 (glSpatialIndex, 1);
+
+        index->cell_size = cell_size;
+        index->cells     = g_hash_table_new_full (g_int64_hash, g_int64_equal,
+                                                  g_free,
+                                                  (GDestroyNotify)g_ptr_array_unref);
+        index->items     = g_hash_table_new_full (g_direct_hash, g_direct_equal,
+                                                  NULL, g_free);
+        index->large     = g_hash_table_new (g_direct_hash, g_direct_equal);
+
+        return index;
+}
+
+
+/*****************************************************************************/
+/* Free spatial index.                                                       */
+/*****************************************************************************/
+void
+gl_spatial_index_free (glSpatialIndex *index)
+{
+        if ( index )
+        {
+                g_hash_table_destroy (index->cells);
+                g_hash_table_destroy (index->items);
+                g_hash_table_destroy (index->large);
+                g_free (index);
+        }
+}
+
+
+/*****************************************************************************/
+/* Insert item, or update its bounding box.                                  */
+/*****************************************************************************/
+void
+gl_spatial_index_set (glSpatialIndex *index,
+                      gpointer        item,
+                      gdouble         x1,
+                      gdouble         y1,
+                      gdouble         x2,
+                      gdouble         y2)
+{
+        Entry *entry;
+        gint   cx1, cy1, cx2, cy2;
+
+        g_return_if_fail (index);
+
+        get_cell_range (index, x1, y1, x2, y2, &cx1, &cy1, &cx2, &cy2);
+
+        entry = g_hash_table_lookup (index->items, item);
+        if ( entry == NULL )
+        {
+                entry = g_new0 (Entry, 1);
+                g_hash_table_insert (index->items, item, entry);
+        }
+        else if ( (cx1 != entry->cx1) || (cy1 != entry->cy1) ||
+                  (cx2 != entry->cx2) || (cy2 != entry->cy2) )
+        {
+                remove_from_cells (index, item, entry);
+        }
+        else
+        {
+                /* Same cells, only the exact box changes. */
+                entry->x1 = x1;
+                entry->y1 = y1;
+                entry->x2 = x2;
+                entry->y2 = y2;
+                return;
+        }
+
+        entry->x1  = x1;
+        entry->y1  = y1;
+        entry->x2  = x2;
+        entry->y2  = y2;
+        entry->cx1 = cx1;
+        entry->cy1 = cy1;
+        entry->cx2 = cx2;
+        entry->cy2 = cy2;
+
+        add_to_cells (index, item, entry);
+}
+
+
+/*****************************************************************************/
+/* Remove item.                                                              */
+/*****************************************************************************/
+void
+gl_spatial_index_remove (glSpatialIndex *index,
+                         gpointer        item)
+{
+        Entry *entry;
+
+        g_return_if_fail (index);
+
+        entry = g_hash_table_lookup (index->items, item);
+        if ( entry )
+        {
+                remove_from_cells (index, item, entry);
+                g_hash_table_remove (index->items, item);
+        }
+}
+
+
+/*****************************************************************************/
+/* Get set of items whose bounding box intersects the given box.  The        */
+/* returned hash table is used as a set and must be freed with               */
+/* g_hash_table_destroy().                                                   */
+/*****************************************************************************/
+GHashTable *
+gl_spatial_index_query (glSpatialIndex *index,
+                        gdouble         x1,
+                        gdouble         y1,
+                        gdouble         x2,
+                        gdouble         y2)
+{
+        GHashTable     *result;
+        GHashTableIter  iter;
+        gpointer        item;
+        Entry          *entry;
+        GPtrArray      *cell;
+        gint            cx1, cy1, cx2, cy2;
+        gint            cx, cy;
+        gint64          key;
+        guint           i;
+
+        g_return_val_if_fail (index, NULL);
+
+        result = g_hash_table_new (g_direct_hash, g_direct_equal);
+
+        get_cell_range (index, x1, y1, x2, y2, &cx1, &cy1, &cx2, &cy2);
+
+        if ( is_large (cx1, cy1, cx2, cy2) )
+        {
+                /* Query covers much of the label anyway, just scan every item. */
+                g_hash_table_iter_init (&iter, index->items);
+                while ( g_hash_table_iter_next (&iter, &item, (gpointer *)&entry) )
+                {
+                        if ( entry_intersects (entry, x1, y1, x2, y2) )
+                        {
+                                g_hash_table_add (result, item);
+                        }
+                }
+
+                return result;
+        }
+
+        for ( cy = cy1; cy <= cy2; cy++ )
+        {
+                for ( cx = cx1; cx <= cx2; cx++ )
+                {
+                        key  = CELL_KEY (cx, cy);
+                        cell = g_hash_table_lookup (index->cells, &key);
+                        if ( cell == NULL )
+                        {
+                                continue;
+                        }
+
+                        for ( i = 0; i < cell->len; i++ )
+                        {
+                                item  = g_ptr_array_index (cell, i);
+                                entry = g_hash_table_lookup (index->items, item);
+
+                                if ( entry_intersects (entry, x1, y1, x2, y2) )
+                                {
+                                        g_hash_table_add (result, item);
+                                }
+                        }
+                }
+        }
+
+        g_hash_table_iter_init (&iter, index->large);
+        while ( g_hash_table_iter_next (&iter, &item, NULL) )
+        {
+                entry = g_hash_table_lookup (index->items, item);
+
+                if ( entry_intersects (entry, x1, y1, x2, y2) )
+                {
+                        g_hash_table_add (result, item);
+                }
+        }
+
+        return result;
+}
+
+
+/*---------------------------------------------------------------------------*/
+/* PRIVATE.  Get range of cells covered by box.                              */
+/*---------------------------------------------------------------------------*/
+static void
+get_cell_range (glSpatialIndex *index,
+                gdouble         x1,
+                gdouble         y1,
+                gdouble         x2,
+                gdouble         y2,
+                gint           *cx1,
+                gint           *cy1,
+                gint           *cx2,
+                gint           *cy2)
+{
+        *cx1 = floor (MIN (x1, x2) / index->cell_size);
+        *cy1 = floor (MIN (y1, y2) / index->cell_size);
+        *cx2 = floor (MAX (x1, x2) / index->cell_size);
+        *cy2 = floor (MAX (y1, y2) / index->cell_size);
+}
+
+
+/*---------------------------------------------------------------------------*/
+/* PRIVATE.  Does cell range span too many cells?                            */
+/*---------------------------------------------------------------------------*/
+static gboolean
+is_large (gint cx1,
+          gint cy1,
+          gint cx2,
+          gint cy2)
+{
+        return ( ((gint64)(cx2 - cx1 + 1) * (gint64)(cy2 - cy1 + 1)) > MAX_CELLS );
+}
+
+
+/*---------------------------------------------------------------------------*/
+/* PRIVATE.  Add item to the cells covered by its entry.                     */
+/*---------------------------------------------------------------------------*/
+static void
+add_to_cells (glSpatialIndex *index,
+              gpointer        item,
+              Entry          *entry)
+{
+        GPtrArray *cell;
+        gint       cx, cy;
+        gint64     key;
+        gint64    *new_key;
+
+        entry->large_flag = is_large (entry->cx1, entry->cy1, entry->cx2, entry->cy2);
+        if ( entry->large_flag )
+        {
+                g_hash_table_add (index->large, item);
+                return;
+        }
+
+        for ( cy = entry->cy1; cy <= entry->cy2; cy++ )
+        {
+                for ( cx = entry->cx1; cx <= entry->cx2; cx++ )
+                {
+                        key  = CELL_KEY (cx, cy);
+                        cell = g_hash_table_lookup (index->cells, &key);
+                        if ( cell == NULL )
+                        {
+                                cell     = g_ptr_array_new ();
+                                new_key  = g_new (gint64, 1);
+                                *new_key = key;
+                                g_hash_table_insert (index->cells, new_key, cell);
+                        }
+
+                        g_ptr_array_add (cell, item);
+                }
+        }
+}
+
+
+/*---------------------------------------------------------------------------*/
+/* PRIVATE.  Remove item from the cells covered by its entry.                */
+/*---------------------------------------------------------------------------*/
+static void
+remove_from_cells (glSpatialIndex *index,
+                   gpointer        item,
+                   Entry          *entry)
+{
+        GPtrArray *cell;
+        gint       cx, cy;
+        gint64     key;
+
+        if ( entry->large_flag )
+        {
+                g_hash_table_remove (index->large, item);
+                return;
+        }
+
+        for ( cy = entry->cy1; cy <= entry->cy2; cy++ )
+        {
+                for ( cx = entry->cx1; cx <= entry->cx2; cx++ )
+                {
+                        key  = CELL_KEY (cx, cy);
+                        cell = g_hash_table_lookup (index->cells, &key);
+                        if ( cell == NULL )
+                        {
+                                continue;
+                        }
+
+                        g_ptr_array_remove_fast (cell, item);
+                        if ( cell->len == 0 )
+                        {
+                                g_hash_table_remove (index->cells, &key);
+                        }
+                }
+        }
+}
+
+
+/*---------------------------------------------------------------------------*/
+/* PRIVATE.  Does entry's box intersect the given box?                       */
+/*---------------------------------------------------------------------------*/
+static gboolean
+entry_intersects (Entry   *entry,
+                  gdouble  x1,
+                  gdouble  y1,
+                  gdouble  x2,
+                  gdouble  y2)
+{
+        return ( (MIN (entry->x1, entry->x2) <= MAX (x1, x2)) &&
+                 (MAX (entry->x1, entry->x2) >= MIN (x1, x2)) &&
+                 (MIN (entry->y1, entry->y2) <= MAX (y1, y2)) &&
+                 (MAX (entry->y1, entry->y2) >= MIN (y1, y2)) );
+}
+
+
+
+
+/*
+ * Local Variables:       -- emacs
+ * mode: C                -- emacs
+ * c-basic-offset: 8      -- emacs
+ * tab-width: 8           -- emacs
+ * indent-tabs-mode: nil  -- emacs
+ * End:                   -- emacs
+ */
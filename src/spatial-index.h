@@ -0,0 +1,68 @@
+/*
+ *  spatial-index.h
+ *  Copyright (C) 2026  agent <agent@local>.
+ *
+ *  This file is part of gLabels.
+ *
+ *  gLabels is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  gLabels is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with gLabels.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef __SPATIAL_INDEX_H__
+#define __SPATIAL_INDEX_H__
+
+#include <glib.h>
+
+G_BEGIN_DECLS
+
+/*
+ * Uniform grid of bounding boxes, used to narrow down hit-tests.
+ */
+typedef struct _glSpatialIndex glSpatialIndex;
+
+
+glSpatialIndex *gl_spatial_index_new     (gdouble         cell_size);
+
+void            gl_spatial_index_free    (glSpatialIndex *index);
+
+void            gl_spatial_index_set     (glSpatialIndex *index,
+                                          gpointer        item,
+                                          gdouble         x1,
+                                          gdouble         y1,
+                                          gdouble         x2,
+                                          gdouble         y2);
+
+void            gl_spatial_index_remove  (glSpatialIndex *index,
+                                          gpointer        item);
+
+GHashTable     *gl_spatial_index_query   (glSpatialIndex *index,
+                                          gdouble         x1,
+                                          gdouble         y1,
+                                          gdouble         x2,
+                                          gdouble         y2);
+
+G_END_DECLS
+
+#endif /*__SPATIAL_INDEX_H__ */
+
+
+
+
+/*
+ * Local Variables:       -- emacs
+ * mode: C                -- emacs
+ * c-basic-offset: 8      -- emacs
+ * tab-width: 8           -- emacs
+ * indent-tabs-mode: nil  -- emacs
+ * End:                   -- emacs
+ */
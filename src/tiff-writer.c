@@ -0,0 +1,485 @@
+/*
+ *  tiff-writer.c
+ *  Copyright (C) 2026  agent <agent@local>.
+ *
+ *  This file is part of gLabels.
+ *
+ *  gLabels is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  gLabels is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with gLabels.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <config.h>
+
+#include "tiff-writer.h"
+
+#include "debug.h"
+
+
+/*===========================================*/
+/* Private macros and constants.             */
+/*===========================================*/
+
+#define TIFF_SHORT              3
+#define TIFF_LONG               4
+#define TIFF_RATIONAL           5
+
+#define TAG_IMAGE_WIDTH         256
+#define TAG_IMAGE_LENGTH        257
+#define TAG_BITS_PER_SAMPLE     258
+#define TAG_COMPRESSION         259
+#define TAG_PHOTOMETRIC         262
+#define TAG_STRIP_OFFSETS       273
+#define TAG_SAMPLES_PER_PIXEL   277
+#define TAG_ROWS_PER_STRIP      278
+#define TAG_STRIP_BYTE_COUNTS   279
+#define TAG_X_RESOLUTION        282
+#define TAG_Y_RESOLUTION        283
+#define TAG_RESOLUTION_UNIT     296
+
+#define N_TAGS                  12
+
+#define COMPRESSION_PACKBITS    32773
+#define PHOTOMETRIC_MINISWHITE  0
+#define PHOTOMETRIC_RGB         2
+#define RESOLUTION_UNIT_INCH    2
+
+#define HEADER_SIZE             8
+#define IFD_SIZE                (2 + 12*N_TAGS + 4)
+
+#define MAX_PACKBITS_RUN        128
+
+
+/*===========================================*/
+/* Private types.                            */
+/*===========================================*/
+
+struct _glTiffPage {
+        guint32     width;
+        guint32     height;
+        guint16     samples_per_pixel;
+        guint16     bits_per_sample;
+        guint16     photometric;
+        gdouble     resolution;
+
+        GByteArray *data;       /* PackBits, one strip */
+};
+
+struct _glTiffWriter {
+        cairo_write_func_t  write_func;
+        void               *closure;
+
+        guint64             offset;
+        glTiffPage         *pending;    /* Held back until next IFD offset is known */
+
+        cairo_status_t      status;
+};
+
+
+/*===========================================*/
+/* Private function prototypes.              */
+/*===========================================*/
+
+static void packbits_row   (GByteArray     *out,
+                            const guchar   *row,
+                            gint            n);
+
+static void put16          (GByteArray     *out,
+                            guint16         value);
+
+static void put32          (GByteArray     *out,
+                            guint32         value);
+
+static void put_entry      (GByteArray     *out,
+                            guint16         tag,
+                            guint16         type,
+                            guint32         count,
+                            guint32         value);
+
+static void write_bytes    (glTiffWriter   *writer,
+                            const guchar   *data,
+                            guint           length);
+
+static void write_page     (glTiffWriter   *writer,
+                            glTiffPage     *page,
+                            gboolean        more_flag);
+
+
+/*****************************************************************************/
+/* Encode an opaque ARGB32 or RGB24 image surface as an RGB page.            */
+/*****************************************************************************/
+glTiffPage *
+gl_tiff_page_new_from_surface (cairo_surface_t *surface,
+                               gdouble          resolution)
+{
+        glTiffPage    *page;
+        const guchar  *data;
+        const guint32 *pixel;
+        guchar        *row;
+        gint           stride;
+        guint32        x, y;
+
+        g_return_val_if_fail (surface, NULL);
+        g_return_val_if_fail (cairo_surface_get_type (surface) == CAIRO_SURFACE_TYPE_IMAGE, NULL);
+
+        cairo_surface_flush (surface);
+
+        page = g_new0 (glTiffPage, 1);
+        page->width             = cairo_image_surface_get_width (surface);
+        page->height            = cairo_image_surface_get_height (surface);
+        page->samples_per_pixel = 3;
+        page->bits_per_sample   = 8;
+        page->photometric       = PHOTOMETRIC_RGB;
+        page->resolution        = resolution;
+        page->data              = g_byte_array_new ();
+
+        data   = cairo_image_surface_get_data (surface);
+        stride = cairo_image_surface_get_stride (surface);
+        row    = g_new (guchar, 3*page->width);
+
+        for ( y = 0; y < page->height; y++ )
+        {
+                pixel = (const guint32 *)(data + y*stride);
+                for ( x = 0; x < page->width; x++ )
+                {
+                        row[3*x]   = (pixel[x] >> 16) & 0xff;
+                        row[3*x+1] = (pixel[x] >> 8)  & 0xff;
+                        row[3*x+2] =  pixel[x]        & 0xff;
+                }
+
+                /* PackBits runs must not cross rows. */
+                packbits_row (page->data, row, 3*page->width);
+        }
+
+        g_free (row);
+
+        return page;
+}
+
+
+/*****************************************************************************/
+/* Encode a packed 1-bit image, most significant bit first, 1 = black, as a  */
+/* bilevel page.                                                             */
+/*****************************************************************************/
+glTiffPage *
+gl_tiff_page_new_from_bitmap (const guchar *data,
+                              guint32       width,
+                              guint32       height,
+                              gint          stride,
+                              gdouble       resolution)
+{
+        glTiffPage *page;
+        guint32     y;
+
+        g_return_val_if_fail (data, NULL);
+
+        page = g_new0 (glTiffPage, 1);
+        page->width             = width;
+        page->height            = height;
+        page->samples_per_pixel = 1;
+        page->bits_per_sample   = 1;
+        page->photometric       = PHOTOMETRIC_MINISWHITE;
+        page->resolution        = resolution;
+        page->data              = g_byte_array_new ();
+
+        for ( y = 0; y < height; y++ )
+        {
+                packbits_row (page->data, data + y*stride, (width + 7) / 8);
+        }
+
+        return page;
+}
+
+
+/*****************************************************************************/
+/* Free page.                                                                */
+/*****************************************************************************/
+void
+gl_tiff_page_free (glTiffPage *page)
+{
+        if ( page )
+        {
+                g_byte_array_unref (page->data);
+                g_free (page);
+        }
+}
+
+
+/*****************************************************************************/
+/* Create a writer and emit the TIFF header.                                 */
+/*****************************************************************************/
+glTiffWriter *
+gl_tiff_writer_new (cairo_write_func_t  write_func,
+                    void               *closure)
+{
+        glTiffWriter *writer;
+        GByteArray   *header;
+
+        g_return_val_if_fail (write_func, NULL);
+
+        writer = g_new0 (glTiffWriter, 1);
+        writer->write_func = write_func;
+        writer->closure    = closure;
+        writer->status     = CAIRO_STATUS_SUCCESS;
+
+        header = g_byte_array_sized_new (HEADER_SIZE);
+        g_byte_array_append (header, (const guchar *)"II", 2);
+        put16 (header, 42);
+        put32 (header, HEADER_SIZE);
+        write_bytes (writer, header->data, header->len);
+        g_byte_array_unref (header);
+
+        return writer;
+}
+
+
+/*****************************************************************************/
+/* Append page, taking ownership.  Pages are written one step behind, once   */
+/* it is known whether another page follows.                                 */
+/*****************************************************************************/
+cairo_status_t
+gl_tiff_writer_add_page (glTiffWriter *writer,
+                         glTiffPage   *page)
+{
+        g_return_val_if_fail (writer, CAIRO_STATUS_NULL_POINTER);
+        g_return_val_if_fail (page, CAIRO_STATUS_NULL_POINTER);
+
+        if ( writer->pending )
+        {
+                write_page (writer, writer->pending, TRUE);
+                gl_tiff_page_free (writer->pending);
+        }
+        writer->pending = page;
+
+        return writer->status;
+}
+
+
+/*****************************************************************************/
+/* Write last page and free writer.                                          */
+/*****************************************************************************/
+cairo_status_t
+gl_tiff_writer_finish (glTiffWriter *writer)
+{
+        cairo_status_t status;
+
+        g_return_val_if_fail (writer, CAIRO_STATUS_NULL_POINTER);
+
+        if ( writer->pending )
+        {
+                write_page (writer, writer->pending, FALSE);
+                gl_tiff_page_free (writer->pending);
+        }
+
+        status = writer->status;
+        g_free (writer);
+
+        return status;
+}
+
+
+/*---------------------------------------------------------------------------*/
+/* PRIVATE.  PackBits encode one row.                                        */
+/*---------------------------------------------------------------------------*/
+static void
+packbits_row (GByteArray   *out,
+              const guchar *row,
+              gint          n)
+{
+        gint   i = 0;
+        gint   run, start;
+        guchar header;
+
+        while ( i < n )
+        {
+                for ( run = 1; (i+run < n) && (run < MAX_PACKBITS_RUN) && (row[i+run] == row[i]); run++ );
+
+                if ( run > 1 )
+                {
+                        /* Replicate run: -(run-1), byte. */
+                        header = (guchar)(1 - run);
+                        g_byte_array_append (out, &header, 1);
+                        g_byte_array_append (out, &row[i], 1);
+                        i += run;
+                }
+                else
+                {
+                        /* Literal run, up to the next run of three. */
+                        start = i;
+                        while ( (i < n) && (i - start < MAX_PACKBITS_RUN) )
+                        {
+                                if ( (i+2 < n) && (row[i] == row[i+1]) && (row[i] == row[i+2]) )
+                                {
+                                        break;
+                                }
+                                i++;
+                        }
+                        header = (guchar)(i - start - 1);
+                        g_byte_array_append (out, &header, 1);
+                        g_byte_array_append (out, &row[start], i - start);
+                }
+        }
+}
+
+
+/*---------------------------------------------------------------------------*/
+/* PRIVATE.  Append little endian values.                                    */
+/*---------------------------------------------------------------------------*/
+static void
+put16 (GByteArray *out,
+       guint16     value)
+{
+        guint16 le = GUINT16_TO_LE (value);
+
+        g_byte_array_append (out, (const guchar *)&le, 2);
+}
+
+
+static void
+put32 (GByteArray *out,
+       guint32     value)
+{
+        guint32 le = GUINT32_TO_LE (value);
+
+        g_byte_array_append (out, (const guchar *)&le, 4);
+}
+
+
+/*---------------------------------------------------------------------------*/
+/* PRIVATE.  Append IFD entry.  A single SHORT is left justified.            */
+/*---------------------------------------------------------------------------*/
+static void
+put_entry (GByteArray *out,
+           guint16     tag,
+           guint16     type,
+           guint32     count,
+           guint32     value)
+{
+        put16 (out, tag);
+        put16 (out, type);
+        put32 (out, count);
+
+        if ( (type == TIFF_SHORT) && (count == 1) )
+        {
+                put16 (out, value);
+                put16 (out, 0);
+        }
+        else
+        {
+                put32 (out, value);
+        }
+}
+
+
+/*---------------------------------------------------------------------------*/
+/* PRIVATE.  Write to output, remembering the first error.                   */
+/*---------------------------------------------------------------------------*/
+static void
+write_bytes (glTiffWriter *writer,
+             const guchar *data,
+             guint         length)
+{
+        if ( (writer->status == CAIRO_STATUS_SUCCESS) && (length > 0) )
+        {
+                writer->status  = writer->write_func (writer->closure, data, length);
+                writer->offset += length;
+        }
+}
+
+
+/*---------------------------------------------------------------------------*/
+/* PRIVATE.  Write IFD, its out-of-line values and strip of page.            */
+/*---------------------------------------------------------------------------*/
+static void
+write_page (glTiffWriter *writer,
+            glTiffPage   *page,
+            gboolean      more_flag)
+{
+        GByteArray *ifd;
+        guint64     bps_offset, xres_offset, yres_offset, data_offset, end;
+        guint32     resolution;
+        guint       pad;
+        gint        i;
+
+        bps_offset  = writer->offset + IFD_SIZE;
+        xres_offset = bps_offset + ((page->samples_per_pixel > 1) ? 2*page->samples_per_pixel : 0);
+        yres_offset = xres_offset + 8;
+        data_offset = yres_offset + 8;
+        pad         = page->data->len % 2;
+        end         = data_offset + page->data->len + pad;
+
+        if ( end > G_MAXUINT32 )
+        {
+                /* Classic TIFF is limited to 4 GiB. */
+                writer->status = CAIRO_STATUS_WRITE_ERROR;
+                return;
+        }
+
+        resolution = (page->resolution > 0) ? (guint32)(page->resolution * 1000 + 0.5) : 72000;
+
+        ifd = g_byte_array_sized_new (data_offset - writer->offset);
+
+        put16 (ifd, N_TAGS);
+        put_entry (ifd, TAG_IMAGE_WIDTH,       TIFF_LONG,  1, page->width);
+        put_entry (ifd, TAG_IMAGE_LENGTH,      TIFF_LONG,  1, page->height);
+        if ( page->samples_per_pixel > 1 )
+        {
+                put_entry (ifd, TAG_BITS_PER_SAMPLE, TIFF_SHORT, page->samples_per_pixel, bps_offset);
+        }
+        else
+        {
+                put_entry (ifd, TAG_BITS_PER_SAMPLE, TIFF_SHORT, 1, page->bits_per_sample);
+        }
+        put_entry (ifd, TAG_COMPRESSION,       TIFF_SHORT, 1, COMPRESSION_PACKBITS);
+        put_entry (ifd, TAG_PHOTOMETRIC,       TIFF_SHORT, 1, page->photometric);
+        put_entry (ifd, TAG_STRIP_OFFSETS,     TIFF_LONG,  1, data_offset);
+        put_entry (ifd, TAG_SAMPLES_PER_PIXEL, TIFF_SHORT, 1, page->samples_per_pixel);
+        put_entry (ifd, TAG_ROWS_PER_STRIP,    TIFF_LONG,  1, page->height);
+        put_entry (ifd, TAG_STRIP_BYTE_COUNTS, TIFF_LONG,  1, page->data->len);
+        put_entry (ifd, TAG_X_RESOLUTION,      TIFF_RATIONAL, 1, xres_offset);
+        put_entry (ifd, TAG_Y_RESOLUTION,      TIFF_RATIONAL, 1, yres_offset);
+        put_entry (ifd, TAG_RESOLUTION_UNIT,   TIFF_SHORT, 1, RESOLUTION_UNIT_INCH);
+        put32 (ifd, more_flag ? end : 0);
+
+        if ( page->samples_per_pixel > 1 )
+        {
+                for ( i = 0; i < page->samples_per_pixel; i++ )
+                {
+                        put16 (ifd, page->bits_per_sample);
+                }
+        }
+        put32 (ifd, resolution);
+        put32 (ifd, 1000);
+        put32 (ifd, resolution);
+        put32 (ifd, 1000);
+
+        write_bytes (writer, ifd->data, ifd->len);
+        write_bytes (writer, page->data->data, page->data->len);
+        if ( pad )
+        {
+                write_bytes (writer, (const guchar *)"", 1);
+        }
+
+        g_byte_array_unref (ifd);
+}
+
+
+
+
+/*
+ * Local Variables:       -- emacs
+ * mode: C                -- emacs
+ * c-basic-offset: 8      -- emacs
+ * tab-width: 8           -- emacs
+ * indent-tabs-mode: nil  -- emacs
+ * End:                   -- emacs
+ */
@@ -0,0 +1,74 @@
+/*
+ *  tiff-writer.h
+ *  Copyright (C) 2026  agent <agent@local>.
+ *
+ *  This file is part of gLabels.
+ *
+ *  gLabels is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  gLabels is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with gLabels.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef __TIFF_WRITER_H__
+#define __TIFF_WRITER_H__
+
+#include <glib.h>
+#include <cairo.h>
+
+G_BEGIN_DECLS
+
+
+/*
+ * Minimal streaming writer for multi-page baseline TIFF, PackBits compressed.
+ * Pages are encoded independently (e.g. in worker threads) and then added
+ * to the writer in order.  The output never needs to be seekable.
+ */
+typedef struct _glTiffPage   glTiffPage;
+typedef struct _glTiffWriter glTiffWriter;
+
+
+glTiffPage     *gl_tiff_page_new_from_surface (cairo_surface_t    *surface,
+                                               gdouble             resolution);
+
+glTiffPage     *gl_tiff_page_new_from_bitmap  (const guchar       *data,
+                                               guint32             width,
+                                               guint32             height,
+                                               gint                stride,
+                                               gdouble             resolution);
+
+void            gl_tiff_page_free             (glTiffPage         *page);
+
+
+glTiffWriter   *gl_tiff_writer_new            (cairo_write_func_t  write_func,
+                                               void               *closure);
+
+cairo_status_t  gl_tiff_writer_add_page       (glTiffWriter       *writer,
+                                               glTiffPage         *page);
+
+cairo_status_t  gl_tiff_writer_finish         (glTiffWriter       *writer);
+
+
+G_END_DECLS
+
+#endif /* __TIFF_WRITER_H__ */
+
+
+
+
+/*
+ * Local Variables:       -- emacs
+ * mode: C                -- emacs
+ * c-basic-offset: 8      -- emacs
+ * tab-width: 8           -- emacs
+ * indent-tabs-mode: nil  -- emacs
+ * End:                   -- emacs
+ */
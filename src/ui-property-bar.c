@@ -83,6 +83,9 @@ struct _glUIPropertyBarPrivate {
 
         /* Prevent recursion */
 	gboolean    stop_signals;
+
+        /* Deferred update after label changes */
+        guint       update_idle_id;
 };
 
 
@@ -102,6 +105,11 @@ static void     gl_ui_property_bar_construct     (glUIPropertyBar      *this);
 static void     selection_changed_cb             (glUIPropertyBar      *this,
                                                   glLabel              *label);
 
+static void     label_changed_cb                 (glUIPropertyBar      *this,
+                                                  glLabel              *label);
+
+static gboolean update_idle_cb                   (glUIPropertyBar      *this);
+
 static void     font_family_changed_cb           (GtkComboBox          *combo,
 						  glUIPropertyBar      *this);
 
@@ -196,6 +204,10 @@ gl_ui_property_bar_finalize (GObject *object)
 	g_return_if_fail (object != NULL);
 	g_return_if_fail (GL_IS_UI_PROPERTY_BAR (object));
 
+        if (this->priv->update_idle_id)
+        {
+                g_source_remove (this->priv->update_idle_id);
+        }
 	if (this->priv->label)
         {
 		g_object_unref (G_OBJECT(this->priv->label));
@@ -469,7 +481,7 @@ gl_ui_property_bar_set_label (glUIPropertyBar *this,
 				  G_CALLBACK(selection_changed_cb), this);
 
 	g_signal_connect_swapped (G_OBJECT(label), "changed",
-				  G_CALLBACK(selection_changed_cb), this);
+				  G_CALLBACK(label_changed_cb), this);
 
 	gl_debug (DEBUG_PROPERTY_BAR, "END");
 }
@@ -893,6 +905,43 @@ selection_changed_cb (glUIPropertyBar *this,
 }
 
 
+/*---------------------------------------------------------------------------*/
+/* PRIVATE.  Label "changed" callback.                                       */
+/*                                                                           */
+/* The label can change many times per frame while objects are dragged, so  */
+/* the bar is only updated from an idle handler, after the canvas has been   */
+/* repainted.                                                                */
+/*---------------------------------------------------------------------------*/
+static void
+label_changed_cb (glUIPropertyBar *this,
+                  glLabel         *label)
+{
+	if (this->priv->stop_signals) return;
+
+        if (this->priv->update_idle_id == 0)
+        {
+                this->priv->update_idle_id = g_idle_add ((GSourceFunc)update_idle_cb, this);
+        }
+}
+
+
+/*---------------------------------------------------------------------------*/
+/* PRIVATE.  Deferred update.                                                */
+/*---------------------------------------------------------------------------*/
+static gboolean
+update_idle_cb (glUIPropertyBar *this)
+{
+        this->priv->update_idle_id = 0;
+
+        if (this->priv->label)
+        {
+                selection_changed_cb (this, this->priv->label);
+        }
+
+        return G_SOURCE_REMOVE;
+}
+
+
 /*--------------------------------------------------------------------------*/
 /* PRIVATE.  Font family entry changed.                                     */
 /*--------------------------------------------------------------------------*/
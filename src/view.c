@@ -71,6 +71,12 @@
 
 #define POINTS_PER_MM    2.83464566929
 
+/* Extra damage around objects, covers selection handles. */
+#define DAMAGE_PAD_PIXELS  8
+
+/* Larger object rasters are replayed from their recording instead. */
+#define MAX_CACHED_OBJECT_PIXELS (1024*1024)
+
 
 /*==========================================================================*/
 /* Private types.                                                           */
@@ -85,6 +91,25 @@ enum {
 	LAST_SIGNAL
 };
 
+typedef struct {
+        guint            generation;
+
+        /* Key of cached raster */
+        guint            version;
+        gdouble          scale;
+        gdouble          x0, y0;
+
+        /* Raster, positioned at (surface_x, surface_y) in canvas pixels */
+        cairo_surface_t *surface;
+        gdouble          surface_x, surface_y;
+
+        /* Canvas area covered by object, its shadow and its handles */
+        GdkRectangle     damage;
+
+        gint             index;
+        gboolean         selected_flag;
+} ObjectCache;
+
 
 /*==========================================================================*/
 /* Private globals                                                          */
@@ -137,11 +162,32 @@ static void       screen_changed_cb               (glView         *view);
 
 static void       label_changed_cb                (glView         *view);
 
+static void       label_objects_changed_cb        (glView         *view,
+                                                   GList          *changed,
+                                                   GList          *deleted);
+
 static void       label_resized_cb                (glView         *view);
 
 static void       draw_layers                     (glView         *view,
                                                    cairo_t        *cr);
 
+static void       draw_static_layers              (glView         *view,
+                                                   cairo_t        *cr);
+static void       invalidate_static_layers        (glView         *view);
+
+static void       object_cache_free               (ObjectCache    *entry);
+static void       sync_object_cache               (glView         *view,
+                                                   gboolean        damage_flag);
+static ObjectCache *sync_object                   (glView         *view,
+                                                   glLabelObject  *object,
+                                                   gint            index,
+                                                   gboolean        damage_flag);
+static void       render_object                   (glView         *view,
+                                                   ObjectCache    *entry,
+                                                   glLabelObject  *object);
+static void       damage_rect                     (glView         *view,
+                                                   GdkRectangle   *rect);
+
 static void       draw_bg_layer                   (glView         *view,
                                                    cairo_t        *cr);
 static void       draw_grid_layer                 (glView         *view,
@@ -185,6 +231,17 @@ static gboolean   button_release_event_cb         (glView            *view,
 static gboolean   key_press_event_cb              (glView            *view,
                                                    GdkEventKey       *event);
 
+static void       queue_manipulation              (glView            *view,
+                                                   gdouble            x_pixels,
+                                                   gdouble            y_pixels,
+                                                   GdkModifierType    state);
+
+static gboolean   frame_tick_cb                   (GtkWidget         *widget,
+                                                   GdkFrameClock     *frame_clock,
+                                                   glView            *view);
+
+static void       flush_manipulation              (glView            *view);
+
 static void       move_event                      (glView            *view,
                                                    gdouble            x,
                                                    gdouble            y,
@@ -286,6 +343,10 @@ gl_view_init (glView *view)
 	view->mode                 = GL_VIEW_MODE_ARROW;
 	view->zoom                 = 1.0;
 	view->home_scale           = get_home_scale (view);
+	view->static_surface       = NULL;
+	view->object_cache         = g_hash_table_new_full (g_direct_hash, g_direct_equal,
+	                                                    g_object_unref,
+	                                                    (GDestroyNotify)object_cache_free);
 
         /*
          * Canvas
@@ -357,6 +418,9 @@ gl_view_finalize (GObject *object)
         g_signal_handlers_disconnect_by_func (G_OBJECT (gl_prefs),
                                               G_CALLBACK (prefs_changed_cb), view);
 
+        invalidate_static_layers (view);
+        g_hash_table_destroy (view->object_cache);
+
 	G_OBJECT_CLASS (gl_view_parent_class)->finalize (object);
 
 	gl_debug (DEBUG_VIEW, "END");
@@ -402,6 +466,8 @@ gl_view_construct (glView  *view,
                                   G_CALLBACK (label_changed_cb), view);
 	g_signal_connect_swapped (G_OBJECT (view->label), "changed",
                                   G_CALLBACK (label_changed_cb), view);
+	g_signal_connect_swapped (G_OBJECT (view->label), "objects_changed",
+                                  G_CALLBACK (label_objects_changed_cb), view);
 	g_signal_connect_swapped (G_OBJECT (view->label), "size_changed",
                                   G_CALLBACK (label_resized_cb), view);
 
@@ -472,6 +538,7 @@ prefs_changed_cb (glView         *view)
         units = gl_prefs_model_get_units (gl_prefs);
 	view->grid_spacing = gl_units_util_get_grid_size (units);
 
+        invalidate_static_layers (view);
         gl_view_update (view);
 }
 
@@ -523,7 +590,7 @@ gl_view_update_region (glView        *view,
 
 	gl_debug (DEBUG_VIEW, "START");
 
-	window = gtk_widget_get_window (GTK_WIDGET (view->canvas));
+	window = gtk_layout_get_bin_window (GTK_LAYOUT (view->canvas));
 
 	if (!window) return;
 
@@ -668,7 +735,66 @@ label_changed_cb (glView  *view)
 
 	gl_debug (DEBUG_VIEW, "START");
 
-        gl_view_update (view);
+        if ( view->objects_synced_flag )
+        {
+                /* Already done by label_objects_changed_cb(). */
+                view->objects_synced_flag = FALSE;
+        }
+        else if ( !view->update_scheduled_flag )
+        {
+                /* Only repaint objects that changed, unless a full repaint is pending. */
+                sync_object_cache (view, TRUE);
+        }
+
+	gl_debug (DEBUG_VIEW, "END");
+}
+
+
+/*---------------------------------------------------------------------------*/
+/* PRIVATE.  Handle label "objects_changed" signal.  Only the listed objects */
+/* are refreshed, and the "changed" that follows is not looked at again.     */
+/*---------------------------------------------------------------------------*/
+static void
+label_objects_changed_cb (glView  *view,
+                          GList   *changed,
+                          GList   *deleted)
+{
+        GList       *p;
+        ObjectCache *entry;
+        gboolean     damage_flag;
+
+	g_return_if_fail (view && GL_IS_VIEW (view));
+
+	gl_debug (DEBUG_VIEW, "START");
+
+        view->objects_synced_flag = TRUE;
+
+        if ( view->update_scheduled_flag )
+        {
+                /* Everything is repainted anyway. */
+                return;
+        }
+
+        damage_flag = (gtk_layout_get_bin_window (GTK_LAYOUT (view->canvas)) != NULL);
+
+        for ( p = changed; p != NULL; p = p->next )
+        {
+                /* Stacking position unknown, leave it to the next full sync. */
+                sync_object (view, GL_LABEL_OBJECT (p->data), -1, damage_flag);
+        }
+
+        for ( p = deleted; p != NULL; p = p->next )
+        {
+                entry = g_hash_table_lookup (view->object_cache, p->data);
+                if ( entry != NULL )
+                {
+                        if ( damage_flag )
+                        {
+                                damage_rect (view, &entry->damage);
+                        }
+                        g_hash_table_remove (view->object_cache, p->data);
+                }
+        }
 
 	gl_debug (DEBUG_VIEW, "END");
 }
@@ -693,6 +819,7 @@ label_resized_cb (glView  *view)
         g_signal_emit_by_name (hadjustment, "changed");
         g_signal_emit_by_name (vadjustment, "changed");
 
+        invalidate_static_layers (view);
         gl_view_update (view);
 
 	gl_debug (DEBUG_VIEW, "END");
@@ -738,9 +865,7 @@ draw_layers (glView  *view,
         cairo_scale (cr, scale, scale);
         cairo_translate (cr, view->x0, view->y0);
 
-	draw_bg_layer (view, cr);
-	draw_grid_layer (view, cr);
-	draw_markup_layer (view, cr);
+	draw_static_layers (view, cr);
 	draw_objects_layer (view, cr);
 	draw_fg_layer (view, cr);
 	draw_highlight_layer (view, cr);
@@ -753,6 +878,305 @@ draw_layers (glView  *view,
 }
 
 
+/*---------------------------------------------------------------------------*/
+/* PRIVATE.  Draw background, grid and markup layers.                        */
+/*                                                                           */
+/* These only depend on the template, the zoom level and the canvas origin,  */
+/* so they are rendered once into a surface and then simply painted.         */
+/*---------------------------------------------------------------------------*/
+static void
+draw_static_layers (glView  *view,
+                    cairo_t *cr)
+{
+        gdouble  scale;
+        gint     x2, y2;
+        cairo_t *surface_cr;
+
+        scale = view->home_scale * view->zoom;
+
+        if ( (view->static_surface == NULL) ||
+             (view->static_scale != scale) ||
+             (view->static_x0 != view->x0) || (view->static_y0 != view->y0) )
+        {
+                invalidate_static_layers (view);
+
+                view->static_x     = floor (view->x0*scale) - 1;
+                view->static_y     = floor (view->y0*scale) - 1;
+                x2                 = ceil ((view->x0 + view->w)*scale) + SHADOW_OFFSET_PIXELS + 1;
+                y2                 = ceil ((view->y0 + view->h)*scale) + SHADOW_OFFSET_PIXELS + 1;
+                view->static_scale = scale;
+                view->static_x0    = view->x0;
+                view->static_y0    = view->y0;
+
+                view->static_surface = cairo_surface_create_similar (cairo_get_target (cr),
+                                                                     CAIRO_CONTENT_COLOR_ALPHA,
+                                                                     x2 - view->static_x,
+                                                                     y2 - view->static_y);
+
+                surface_cr = cairo_create (view->static_surface);
+                cairo_translate (surface_cr, -view->static_x, -view->static_y);
+                cairo_scale (surface_cr, scale, scale);
+                cairo_translate (surface_cr, view->x0, view->y0);
+
+                draw_bg_layer (view, surface_cr);
+                draw_grid_layer (view, surface_cr);
+                draw_markup_layer (view, surface_cr);
+
+                cairo_destroy (surface_cr);
+        }
+
+        cairo_save (cr);
+        cairo_identity_matrix (cr);
+        cairo_set_source_surface (cr, view->static_surface, view->static_x, view->static_y);
+        cairo_paint (cr);
+        cairo_restore (cr);
+}
+
+
+/*---------------------------------------------------------------------------*/
+/* PRIVATE.  Discard cached background, grid and markup layers.              */
+/*---------------------------------------------------------------------------*/
+static void
+invalidate_static_layers (glView  *view)
+{
+        if ( view->static_surface )
+        {
+                cairo_surface_destroy (view->static_surface);
+                view->static_surface = NULL;
+        }
+}
+
+
+/*---------------------------------------------------------------------------*/
+/* PRIVATE.  Free object cache entry.                                        */
+/*---------------------------------------------------------------------------*/
+static void
+object_cache_free (ObjectCache *entry)
+{
+        if ( entry->surface )
+        {
+                cairo_surface_destroy (entry->surface);
+        }
+        g_free (entry);
+}
+
+
+/*---------------------------------------------------------------------------*/
+/* PRIVATE.  Bring object cache up to date with label.                       */
+/*                                                                           */
+/* Objects are compared against their cache entry by version, stacking order */
+/* and selection state.  Stale rasters are re-rendered and, if damage_flag   */
+/* is set, both their old and new canvas areas are invalidated.              */
+/*---------------------------------------------------------------------------*/
+static void
+sync_object_cache (glView   *view,
+                   gboolean  damage_flag)
+{
+        const GList    *p;
+        ObjectCache    *entry;
+        GHashTableIter  iter;
+        guint           generation;
+        gint            i;
+
+        if ( damage_flag && !gtk_layout_get_bin_window (GTK_LAYOUT (view->canvas)) )
+        {
+                return;
+        }
+
+        generation = ++view->object_cache_generation;
+
+        for ( p = gl_label_get_object_list (view->label), i = 0; p != NULL; p = p->next, i++ )
+        {
+                entry = sync_object (view, GL_LABEL_OBJECT (p->data), i, damage_flag);
+                entry->generation = generation;
+        }
+
+        /* Drop objects that are no longer part of the label. */
+        g_hash_table_iter_init (&iter, view->object_cache);
+        while ( g_hash_table_iter_next (&iter, NULL, (gpointer *)&entry) )
+        {
+                if ( entry->generation != generation )
+                {
+                        if ( damage_flag )
+                        {
+                                damage_rect (view, &entry->damage);
+                        }
+                        g_hash_table_iter_remove (&iter);
+                }
+        }
+}
+
+
+/*---------------------------------------------------------------------------*/
+/* PRIVATE.  Bring cache entry of object, at stacking position index (-1 if  */
+/* unknown), up to date.                                                     */
+/*---------------------------------------------------------------------------*/
+static ObjectCache *
+sync_object (glView        *view,
+             glLabelObject *object,
+             gint           index,
+             gboolean       damage_flag)
+{
+        ObjectCache    *entry;
+        gdouble         scale;
+        guint           version;
+        gboolean        selected_flag;
+        gboolean        stale_flag;
+
+        scale         = view->home_scale * view->zoom;
+        version       = gl_label_object_get_version (object);
+        selected_flag = gl_label_object_is_selected (object);
+
+        entry = g_hash_table_lookup (view->object_cache, object);
+        if ( entry == NULL )
+        {
+                entry = g_new0 (ObjectCache, 1);
+                entry->index = -1;
+                g_hash_table_insert (view->object_cache, g_object_ref (object), entry);
+
+                stale_flag = TRUE;
+        }
+        else
+        {
+                stale_flag = (entry->version != version) ||
+                        (entry->scale != scale) ||
+                        (entry->x0 != view->x0) || (entry->y0 != view->y0);
+        }
+
+        if ( stale_flag || (index < 0) || (entry->index != index) ||
+             (entry->selected_flag != selected_flag) )
+        {
+                if ( damage_flag )
+                {
+                        damage_rect (view, &entry->damage);
+                }
+                if ( stale_flag )
+                {
+                        render_object (view, entry, object);
+                }
+                if ( damage_flag )
+                {
+                        damage_rect (view, &entry->damage);
+                }
+        }
+
+        if ( index >= 0 )
+        {
+                entry->index = index;
+        }
+        entry->selected_flag = selected_flag;
+
+        return entry;
+}
+
+
+/*---------------------------------------------------------------------------*/
+/* PRIVATE.  Render object into its cache entry.                             */
+/*                                                                           */
+/* The object is first recorded, which yields its exact ink extents (text    */
+/* may overflow its box), then rasterized at canvas resolution.              */
+/*---------------------------------------------------------------------------*/
+static void
+render_object (glView        *view,
+               ObjectCache   *entry,
+               glLabelObject *object)
+{
+        gdouble          scale;
+        cairo_surface_t *recording;
+        cairo_t         *cr;
+        gdouble          x, y, w, h;
+        glLabelRegion    extent;
+        GdkRectangle     ink, handles;
+
+        scale = view->home_scale * view->zoom;
+
+        if ( entry->surface )
+        {
+                cairo_surface_destroy (entry->surface);
+                entry->surface = NULL;
+        }
+
+        entry->version = gl_label_object_get_version (object);
+        entry->scale   = scale;
+        entry->x0      = view->x0;
+        entry->y0      = view->y0;
+
+        recording = cairo_recording_surface_create (CAIRO_CONTENT_COLOR_ALPHA, NULL);
+        cr = cairo_create (recording);
+        cairo_scale (cr, scale, scale);
+        cairo_translate (cr, view->x0, view->y0);
+        gl_label_object_draw (object, cr, TRUE, NULL);
+        cairo_destroy (cr);
+
+        cairo_recording_surface_ink_extents (recording, &x, &y, &w, &h);
+        ink.x      = floor (x);
+        ink.y      = floor (y);
+        ink.width  = ceil (x + w) - ink.x;
+        ink.height = ceil (y + h) - ink.y;
+
+        if ( (w <= 0) || (h <= 0) )
+        {
+                ink.width  = 0;
+                ink.height = 0;
+                cairo_surface_destroy (recording);
+        }
+        else if ( ink.width*ink.height > MAX_CACHED_OBJECT_PIXELS )
+        {
+                entry->surface   = recording;
+                entry->surface_x = 0;
+                entry->surface_y = 0;
+        }
+        else
+        {
+                entry->surface   = cairo_image_surface_create (CAIRO_FORMAT_ARGB32,
+                                                               ink.width, ink.height);
+                entry->surface_x = ink.x;
+                entry->surface_y = ink.y;
+
+                cr = cairo_create (entry->surface);
+                cairo_set_source_surface (cr, recording, -ink.x, -ink.y);
+                cairo_paint (cr);
+                cairo_destroy (cr);
+
+                cairo_surface_destroy (recording);
+        }
+
+        /* Handles are drawn around the object's nominal extent. */
+        gl_label_object_get_extent (object, &extent);
+        handles.x      = floor ((extent.x1 + view->x0)*scale) - DAMAGE_PAD_PIXELS;
+        handles.y      = floor ((extent.y1 + view->y0)*scale) - DAMAGE_PAD_PIXELS;
+        handles.width  = ceil ((extent.x2 + view->x0)*scale) + DAMAGE_PAD_PIXELS - handles.x;
+        handles.height = ceil ((extent.y2 + view->y0)*scale) + DAMAGE_PAD_PIXELS - handles.y;
+
+        if ( ink.width > 0 )
+        {
+                gdk_rectangle_union (&ink, &handles, &entry->damage);
+        }
+        else
+        {
+                entry->damage = handles;
+        }
+}
+
+
+/*---------------------------------------------------------------------------*/
+/* PRIVATE.  Invalidate canvas rectangle (in canvas pixels).                 */
+/*---------------------------------------------------------------------------*/
+static void
+damage_rect (glView       *view,
+             GdkRectangle *rect)
+{
+        GdkWindow *bin_window;
+
+        bin_window = gtk_layout_get_bin_window (GTK_LAYOUT (view->canvas));
+
+        if ( bin_window && (rect->width > 0) && (rect->height > 0) )
+        {
+                gdk_window_invalidate_rect (bin_window, rect, TRUE);
+        }
+}
+
+
 /*---------------------------------------------------------------------------*/
 /* PRIVATE.  Draw background                                                 */
 /*---------------------------------------------------------------------------*/
@@ -914,7 +1338,32 @@ static void
 draw_objects_layer (glView  *view,
                     cairo_t *cr)
 {
-        gl_label_draw (view->label, cr, TRUE, NULL);
+        const GList    *p;
+        ObjectCache    *entry;
+        gdouble         x1, y1, x2, y2;
+
+        sync_object_cache (view, FALSE);
+
+        cairo_save (cr);
+        cairo_identity_matrix (cr);
+        cairo_clip_extents (cr, &x1, &y1, &x2, &y2);
+
+        for ( p = gl_label_get_object_list (view->label); p != NULL; p = p->next )
+        {
+                entry = g_hash_table_lookup (view->object_cache, p->data);
+
+                if ( (entry->surface == NULL) ||
+                     (entry->damage.x > x2) || (entry->damage.x + entry->damage.width < x1) ||
+                     (entry->damage.y > y2) || (entry->damage.y + entry->damage.height < y1) )
+                {
+                        continue;
+                }
+
+                cairo_set_source_surface (cr, entry->surface, entry->surface_x, entry->surface_y);
+                cairo_paint (cr);
+        }
+
+        cairo_restore (cr);
 }
 
 
@@ -1020,6 +1469,7 @@ gl_view_show_grid (glView *view)
 	g_return_if_fail (view && GL_IS_VIEW (view));
 
         view->grid_visible = TRUE;
+        invalidate_static_layers (view);
         gl_view_update (view);
 }
 
@@ -1033,6 +1483,7 @@ gl_view_hide_grid (glView *view)
 	g_return_if_fail (view && GL_IS_VIEW (view));
 
         view->grid_visible = FALSE;
+        invalidate_static_layers (view);
         gl_view_update (view);
 }
 
@@ -1046,6 +1497,7 @@ gl_view_show_markup (glView *view)
 	g_return_if_fail (view && GL_IS_VIEW (view));
 
         view->markup_visible = TRUE;
+        invalidate_static_layers (view);
         gl_view_update (view);
 }
 
@@ -1059,6 +1511,7 @@ gl_view_hide_markup (glView *view)
 	g_return_if_fail (view && GL_IS_VIEW (view));
 
         view->markup_visible = FALSE;
+        invalidate_static_layers (view);
         gl_view_update (view);
 }
 
@@ -1459,24 +1912,15 @@ motion_notify_event_cb (glView            *view,
                         break;
 
                 case GL_VIEW_ARROW_SELECT_REGION:
-#ifdef CLIP_UPDATES                                
                         gl_view_update_region (view, cr, &view->select_region);
-#endif
                         view->select_region.x2 = x;
                         view->select_region.y2 = y;
-#ifdef CLIP_UPDATES                                
                         gl_view_update_region (view, cr, &view->select_region);
-#else
-                        gl_view_update (view);
-#endif
                         break;
 
                 case GL_VIEW_ARROW_MOVE:
-                        move_event (view, x, y, event->state & GDK_SHIFT_MASK);
-                        break;
-
                 case GL_VIEW_ARROW_RESIZE:
-                        resize_event (view, cr, event->x, event->y, event->state & GDK_CONTROL_MASK, event->state & GDK_SHIFT_MASK);
+                        queue_manipulation (view, event->x, event->y, event->state);
                         break;
 
                 default:
@@ -1739,6 +2183,10 @@ button_release_event_cb (glView            *view,
         case 1:
                 view->grabbed_flag = FALSE;
                 gdk_pointer_ungrab (event->time);
+
+                /* Apply any motion still waiting for the next frame. */
+                flush_manipulation (view);
+
                 /*
                  * Handle event as appropriate for mode
                  */
@@ -1754,11 +2202,7 @@ button_release_event_cb (glView            *view,
                                 break;
 
                         case GL_VIEW_ARROW_SELECT_REGION:
-#ifdef CLIP_UPDATES                                
                                 gl_view_update_region (view, cr, &view->select_region);
-#else
-                                gl_view_update (view);
-#endif
 
                                 view->select_region_visible = FALSE;
                                 view->select_region.x2 = x;
@@ -1876,6 +2320,106 @@ key_press_event_cb (glView            *view,
 }
 
 
+/*---------------------------------------------------------------------------*/
+/* PRIVATE.  Queue pointer position for move or resize.                      */
+/*                                                                           */
+/* Motion events can arrive much faster than the display refreshes, so only  */
+/* the latest position is kept and applied once per frame.  Since moves are  */
+/* relative to the last applied position, intermediate deltas accumulate.    */
+/*---------------------------------------------------------------------------*/
+static void
+queue_manipulation (glView          *view,
+                    gdouble          x_pixels,
+                    gdouble          y_pixels,
+                    GdkModifierType  state)
+{
+        view->motion_x            = x_pixels;
+        view->motion_y            = y_pixels;
+        view->motion_state        = state;
+        view->motion_pending_flag = TRUE;
+
+        if ( view->tick_id == 0 )
+        {
+                view->tick_id = gtk_widget_add_tick_callback (view->canvas,
+                                                              (GtkTickCallback)frame_tick_cb,
+                                                              view, NULL);
+        }
+}
+
+
+/*---------------------------------------------------------------------------*/
+/* PRIVATE.  Frame clock tick callback.                                      */
+/*---------------------------------------------------------------------------*/
+static gboolean
+frame_tick_cb (GtkWidget     *widget,
+               GdkFrameClock *frame_clock,
+               glView        *view)
+{
+        view->tick_id = 0;
+
+        flush_manipulation (view);
+
+        return G_SOURCE_REMOVE;
+}
+
+
+/*---------------------------------------------------------------------------*/
+/* PRIVATE.  Apply queued pointer position.                                  */
+/*---------------------------------------------------------------------------*/
+static void
+flush_manipulation (glView *view)
+{
+        GdkWindow *bin_window;
+        cairo_t   *cr;
+        gdouble    scale;
+        gdouble    x, y;
+
+        if ( view->tick_id )
+        {
+                gtk_widget_remove_tick_callback (view->canvas, view->tick_id);
+                view->tick_id = 0;
+        }
+
+        if ( !view->motion_pending_flag )
+        {
+                return;
+        }
+        view->motion_pending_flag = FALSE;
+
+        bin_window = gtk_layout_get_bin_window (GTK_LAYOUT (view->canvas));
+
+	cr = gdk_cairo_create (bin_window);
+
+        scale = view->zoom * view->home_scale;
+        cairo_scale (cr, scale, scale);
+        cairo_translate (cr, view->x0, view->y0);
+
+        x = view->motion_x;
+        y = view->motion_y;
+        cairo_device_to_user (cr, &x, &y);
+
+        switch (view->state)
+        {
+
+        case GL_VIEW_ARROW_MOVE:
+                move_event (view, x, y, view->motion_state & GDK_SHIFT_MASK);
+                break;
+
+        case GL_VIEW_ARROW_RESIZE:
+                resize_event (view, cr, view->motion_x, view->motion_y,
+                              view->motion_state & GDK_CONTROL_MASK,
+                              view->motion_state & GDK_SHIFT_MASK);
+                break;
+
+        default:
+                break;
+
+        }
+
+	cairo_destroy (cr);
+}
+
+
 /*---------------------------------------------------------------------------*/
 /* PRIVATE.  Move object.                                                    */
 /*---------------------------------------------------------------------------*/
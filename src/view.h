@@ -93,10 +93,27 @@ struct _glView {
 	gdouble             saved_w;
 	gdouble             saved_h;
 
+	/* Pointer motion applied on next frame (GL_VIEW_ARROW_MOVE and RESIZE) */
+	guint               tick_id;
+	gboolean            motion_pending_flag;
+	gdouble             motion_x, motion_y;
+	GdkModifierType     motion_state;
+
 	/* GL_VIEW_CREATE_DRAG state */
 	glLabelObject      *create_object;
 	gdouble             create_x0;
 	gdouble             create_y0;
+
+	/* Cached background, grid and markup layers */
+	cairo_surface_t    *static_surface;
+	gint                static_x, static_y;
+	gdouble             static_scale;
+	gdouble             static_x0, static_y0;
+
+	/* Cached object rasters and extents, keyed by object */
+	GHashTable         *object_cache;
+	guint               object_cache_generation;
+	gboolean            objects_synced_flag;  /* Next label "changed" already handled */
 };
 
 struct _glViewClass {
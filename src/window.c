@@ -331,6 +331,7 @@ gl_window_new_from_file (const gchar *filename)
 
 	if (label) {
 		gl_window_set_label (window, label);
+		gl_label_decode_images (label);
 	}
 
 	gl_debug (DEBUG_WINDOW, "END");
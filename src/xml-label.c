@@ -27,7 +27,7 @@
 #include <libxml/tree.h>
 #include <libxml/parser.h>
 #include <libxml/xinclude.h>
-#include <gdk-pixbuf/gdk-pixdata.h>
+#include <libxml/xmlreader.h>
 
 #include <libglabels.h>
 #include "label.h"
@@ -59,6 +59,13 @@
 /* Private types.                                         */
 /*========================================================*/
 
+/* Result of streaming a label file: the document, minus embedded images,
+   which have been moved to a pixbuf cache as they were read. */
+typedef struct {
+	xmlDocPtr   doc;
+	GHashTable *pixbuf_cache;
+} StreamResult;
+
 
 /*========================================================*/
 /* Private globals.                                       */
@@ -69,10 +76,21 @@
 /* Private function prototypes.                           */
 /*========================================================*/
 
+static void           xml_read_thread          (GTask            *task,
+						gpointer          source_object,
+						gpointer          task_data,
+						GCancellable     *cancellable);
+
+static StreamResult  *xml_read_stream          (const gchar      *filename);
+
+static void           xml_stream_result_free   (StreamResult     *result);
+
 static glLabel       *xml_doc_to_label         (xmlDocPtr         doc,
+						GHashTable       *pixbuf_cache,
 						glXMLLabelStatus *status);
 
 static glLabel       *xml_parse_label          (xmlNodePtr        root,
+						GHashTable       *pixbuf_cache,
 						glXMLLabelStatus *status);
 
 static void           xml_parse_objects        (xmlNodePtr        node,
@@ -103,10 +121,17 @@ static void           xml_parse_data           (xmlNodePtr        node,
 						glLabel          *label);
 
 static void           xml_parse_pixdata        (xmlNodePtr        node,
-						glLabel          *label);
+						GHashTable       *pixbuf_cache);
 
 static void           xml_parse_file_node      (xmlNodePtr        node,
-						glLabel          *label);
+						glLabel          *label,
+						GHashTable       *hashes);
+
+static void           xml_parse_file_png       (xmlNodePtr        node,
+						GHashTable       *pixbuf_cache,
+						GHashTable       *hashes);
+
+static gboolean       xml_is_embedded_image    (xmlNodePtr        node);
 
 static void           xml_parse_toplevel_span  (xmlNodePtr        node,
 						glLabelObject    *object);
@@ -157,10 +182,11 @@ static void           xml_create_data          (xmlDocPtr         doc,
 						xmlNsPtr          ns,
 						glLabel          *label);
 
-static void           xml_create_pixdata       (xmlNodePtr        parent,
+static void           xml_create_file_png      (xmlNodePtr        parent,
 						xmlNsPtr          ns,
 						glLabel          *label,
-						gchar            *name);
+						gchar            *name,
+						GHashTable       *hashes);
 
 static void           xml_create_file_svg      (xmlDocPtr         doc,
                                                 xmlNodePtr        parent,
@@ -186,28 +212,25 @@ glLabel *
 gl_xml_label_open (const gchar      *utf8_filename,
 		   glXMLLabelStatus *status)
 {
-	xmlDocPtr  doc;
-	glLabel   *label;
-	gchar 	  *filename;
+	StreamResult *result;
+	glLabel      *label;
+	gchar 	     *filename;
 
 	gl_debug (DEBUG_XML, "START");
 
 	filename = g_filename_from_utf8 (utf8_filename, -1, NULL, NULL, NULL);
 	g_return_val_if_fail (filename, NULL);
 
-        doc = xmlReadFile (filename, NULL, XML_PARSE_HUGE);
-	if (!doc) {
-		g_message ("xmlParseFile error");
+	result = xml_read_stream (filename);
+	if (!result) {
 		*status = XML_LABEL_ERROR_OPEN_PARSE;
+		g_free (filename);
 		return NULL;
 	}
 
-	xmlXIncludeProcess (doc);
-	xmlReconciliateNs (doc, xmlDocGetRootElement (doc));
-
-	label = xml_doc_to_label (doc, status);
+	label = xml_doc_to_label (result->doc, result->pixbuf_cache, status);
 
-	xmlFreeDoc (doc);
+	xml_stream_result_free (result);
 
 	if (label) {
 		gl_label_set_filename (label, utf8_filename);
@@ -221,6 +244,245 @@ gl_xml_label_open (const gchar      *utf8_filename,
 }
 
 
+/****************************************************************************/
+/* Open and read label from xml file without blocking.  The file is read    */
+/* and parsed in a worker thread, the label itself is built in             */
+/* gl_xml_label_open_finish().  Embedded images are left encoded.           */
+/****************************************************************************/
+void
+gl_xml_label_open_async (const gchar         *utf8_filename,
+			 GCancellable        *cancellable,
+			 GAsyncReadyCallback  callback,
+			 gpointer             user_data)
+{
+	GTask *task;
+
+	gl_debug (DEBUG_XML, "START");
+
+	task = g_task_new (NULL, cancellable, callback, user_data);
+	g_task_set_source_tag (task, gl_xml_label_open_async);
+	g_task_set_task_data (task, g_strdup (utf8_filename), g_free);
+
+	g_task_run_in_thread (task, xml_read_thread);
+	g_object_unref (task);
+
+	gl_debug (DEBUG_XML, "END");
+}
+
+
+/****************************************************************************/
+/* Finish reading label started with gl_xml_label_open_async().             */
+/****************************************************************************/
+glLabel *
+gl_xml_label_open_finish (GAsyncResult     *result,
+			  glXMLLabelStatus *status)
+{
+	StreamResult *stream;
+	glLabel      *label;
+	const gchar  *utf8_filename;
+
+	gl_debug (DEBUG_XML, "START");
+
+	g_return_val_if_fail (g_task_is_valid (result, NULL), NULL);
+
+	stream = g_task_propagate_pointer (G_TASK (result), NULL);
+	if (!stream) {
+		*status = XML_LABEL_ERROR_OPEN_PARSE;
+		return NULL;
+	}
+
+	label = xml_doc_to_label (stream->doc, stream->pixbuf_cache, status);
+
+	xml_stream_result_free (stream);
+
+	if (label) {
+		utf8_filename = g_task_get_task_data (G_TASK (result));
+		gl_label_set_filename (label, utf8_filename);
+		gl_label_clear_modified (label);
+	}
+
+	gl_debug (DEBUG_XML, "END");
+
+	return label;
+}
+
+
+/*--------------------------------------------------------------------------*/
+/* PRIVATE.  Worker thread: read and parse xml file.                        */
+/*--------------------------------------------------------------------------*/
+static void
+xml_read_thread (GTask        *task,
+		 gpointer      source_object,
+		 gpointer      task_data,
+		 GCancellable *cancellable)
+{
+	const gchar  *utf8_filename = (const gchar *)task_data;
+	gchar        *filename;
+	StreamResult *result;
+
+	filename = g_filename_from_utf8 (utf8_filename, -1, NULL, NULL, NULL);
+	if (!filename) {
+		g_task_return_new_error (task, G_IO_ERROR, G_IO_ERROR_INVALID_FILENAME,
+					 "Invalid filename");
+		return;
+	}
+
+	result = xml_read_stream (filename);
+	g_free (filename);
+	if (!result) {
+		g_task_return_new_error (task, G_IO_ERROR, G_IO_ERROR_FAILED,
+					 "Parse error");
+		return;
+	}
+
+	if ( g_task_return_error_if_cancelled (task) ) {
+		xml_stream_result_free (result);
+		return;
+	}
+
+	g_task_return_pointer (task, result, (GDestroyNotify)xml_stream_result_free);
+}
+
+
+/*--------------------------------------------------------------------------*/
+/* PRIVATE.  Read xml file with a streaming reader.  Embedded images go      */
+/* straight into a new pixbuf cache, still encoded, and their nodes are      */
+/* dropped as soon as they have been read.  Everything else is kept in the   */
+/* returned document.  Safe to call from a worker thread.                    */
+/*--------------------------------------------------------------------------*/
+static StreamResult *
+xml_read_stream (const gchar *filename)
+{
+	xmlTextReaderPtr  reader;
+	StreamResult     *result;
+	GHashTable       *hashes;
+	xmlNodePtr        node;
+	gboolean          in_data = FALSE;
+	gint              ret;
+
+	gl_debug (DEBUG_XML, "START");
+
+	reader = xmlReaderForFile (filename, NULL,
+				   XML_PARSE_HUGE | XML_PARSE_XINCLUDE | XML_PARSE_NOXINCNODE);
+	if (!reader) {
+		g_message ("xmlReaderForFile error");
+		return NULL;
+	}
+
+	result = g_new0 (StreamResult, 1);
+	result->pixbuf_cache = gl_pixbuf_cache_new ();
+
+	/* Content hash -> name of embedded images seen so far. */
+	hashes = g_hash_table_new_full (g_str_hash, g_str_equal, g_free, g_free);
+
+	ret = xmlTextReaderRead (reader);
+	while ( ret == 1 )
+	{
+		if ( xmlTextReaderNodeType (reader) != XML_READER_TYPE_ELEMENT )
+		{
+			ret = xmlTextReaderRead (reader);
+			continue;
+		}
+
+		switch ( xmlTextReaderDepth (reader) )
+		{
+
+		case 0:
+			/* Root, keep going into its children. */
+			ret = xmlTextReaderRead (reader);
+			break;
+
+		case 1:
+			in_data = xmlStrEqual (xmlTextReaderConstLocalName (reader),
+					       (xmlChar *)"Data");
+			if ( in_data )
+			{
+				/* Visit children one at a time. */
+				ret = xmlTextReaderRead (reader);
+			}
+			else
+			{
+				/* Small, keep the whole subtree for the DOM parser. */
+				if ( !xmlTextReaderExpand (reader) ) {
+					ret = -1;
+					break;
+				}
+				xmlTextReaderPreserve (reader);
+				ret = xmlTextReaderNext (reader);
+			}
+			break;
+
+		case 2:
+			if ( !in_data )
+			{
+				ret = xmlTextReaderRead (reader);
+				break;
+			}
+			node = xmlTextReaderExpand (reader);
+			if ( !node ) {
+				ret = -1;
+				break;
+			}
+			if ( lgl_xml_is_node (node, "Pixdata") )
+			{
+				xml_parse_pixdata (node, result->pixbuf_cache);
+			}
+			else if ( xml_is_embedded_image (node) )
+			{
+				xml_parse_file_png (node, result->pixbuf_cache, hashes);
+			}
+			else
+			{
+				/* Other embedded files are left to xml_parse_data(). */
+				xmlTextReaderPreserve (reader);
+			}
+			ret = xmlTextReaderNext (reader);
+			break;
+
+		default:
+			ret = xmlTextReaderRead (reader);
+			break;
+
+		}
+	}
+
+	g_hash_table_destroy (hashes);
+
+	if ( ret == 0 )
+	{
+		result->doc = xmlTextReaderCurrentDoc (reader);
+	}
+	xmlFreeTextReader (reader);
+
+	if ( (ret != 0) || !result->doc || !xmlDocGetRootElement (result->doc) )
+	{
+		g_message ("xmlTextReaderRead error");
+		xml_stream_result_free (result);
+		return NULL;
+	}
+
+	xmlReconciliateNs (result->doc, xmlDocGetRootElement (result->doc));
+
+	gl_debug (DEBUG_XML, "END");
+
+	return result;
+}
+
+
+/*--------------------------------------------------------------------------*/
+/* PRIVATE.  Free result of xml_read_stream().                              */
+/*--------------------------------------------------------------------------*/
+static void
+xml_stream_result_free (StreamResult *result)
+{
+	if ( result->doc ) {
+		xmlFreeDoc (result->doc);
+	}
+	gl_pixbuf_cache_free (result->pixbuf_cache);
+	g_free (result);
+}
+
+
 /****************************************************************************/
 /* Read label from xml buffer.                                              */
 /****************************************************************************/
@@ -240,7 +502,7 @@ gl_xml_label_open_buffer (const gchar      *buffer,
 		return NULL;
 	}
 
-	label = xml_doc_to_label (doc, status);
+	label = xml_doc_to_label (doc, NULL, status);
 
 	xmlFreeDoc (doc);
 
@@ -259,6 +521,7 @@ gl_xml_label_open_buffer (const gchar      *buffer,
 /*--------------------------------------------------------------------------*/
 static glLabel *
 xml_doc_to_label (xmlDocPtr         doc,
+		  GHashTable       *pixbuf_cache,
 		  glXMLLabelStatus *status)
 {
 	xmlNodePtr  root;
@@ -303,7 +566,7 @@ xml_doc_to_label (xmlDocPtr         doc,
                            LGL_XML_NAME_SPACE);
         }
 
-        label = xml_parse_label (root, status);
+        label = xml_parse_label (root, pixbuf_cache, status);
         if (label)
         {
                 gl_label_set_compression (label, xmlGetDocCompressMode (doc));
@@ -320,6 +583,7 @@ xml_doc_to_label (xmlDocPtr         doc,
 /*--------------------------------------------------------------------------*/
 static glLabel *
 xml_parse_label (xmlNodePtr        root,
+		 GHashTable       *pixbuf_cache,
 		 glXMLLabelStatus *status)
 {
 	xmlNodePtr   child_node;
@@ -338,6 +602,11 @@ xml_parse_label (xmlNodePtr        root,
 
 	label = GL_LABEL(gl_label_new ());
 
+	/* Images already read by xml_read_stream(). */
+	if (pixbuf_cache) {
+		gl_pixbuf_cache_transfer (gl_label_get_pixbuf_cache (label), pixbuf_cache);
+	}
+
 	/* Pass 1, extract data nodes to pre-load cache. */
 	for (child_node = root->xmlChildrenNode; child_node != NULL; child_node = child_node->next) {
 		if (lgl_xml_is_node (child_node, "Data")) {
@@ -878,15 +1147,19 @@ xml_parse_data (xmlNodePtr  node,
 		glLabel    *label)
 {
 	xmlNodePtr  child;
+	GHashTable *hashes;
 
 	gl_debug (DEBUG_XML, "START");
 
+	/* Content hash -> name of embedded images seen so far. */
+	hashes = g_hash_table_new_full (g_str_hash, g_str_equal, g_free, g_free);
+
 	for (child = node->xmlChildrenNode; child != NULL; child = child->next) {
 
 		if (lgl_xml_is_node (child, "Pixdata")) {
-			xml_parse_pixdata (child, label);
+			xml_parse_pixdata (child, gl_label_get_pixbuf_cache (label));
 		} else if (lgl_xml_is_node (child, "File")) {
-			xml_parse_file_node (child, label);
+			xml_parse_file_node (child, label, hashes);
 		} else {
 			if (!xmlNodeIsText (child)) {
 				g_message ("bad node in Data node =  \"%s\"",
@@ -895,6 +1168,8 @@ xml_parse_data (xmlNodePtr  node,
 		}
 	}
 
+	g_hash_table_destroy (hashes);
+
 	gl_debug (DEBUG_XML, "END");
 }
 
@@ -904,38 +1179,24 @@ xml_parse_data (xmlNodePtr  node,
 /*--------------------------------------------------------------------------*/
 static void
 xml_parse_pixdata (xmlNodePtr  node,
-		   glLabel    *label)
+		   GHashTable *pixbuf_cache)
 {
 	gchar      *name, *base64;
-	guchar     *stream;
-	gsize       stream_length;
-	gboolean    ret;
-	GdkPixdata *pixdata;
-	GdkPixbuf  *pixbuf;
-	GHashTable *pixbuf_cache;
 
 	gl_debug (DEBUG_XML, "START");
 
 	name = lgl_xml_get_prop_string (node, "name", NULL);
 	base64 = lgl_xml_get_node_content (node);
 
-	stream = g_base64_decode ((gchar *)base64, &stream_length);
-	pixdata = g_new0 (GdkPixdata, 1);
-	ret = gdk_pixdata_deserialize (pixdata, stream_length, stream, NULL);
-
-	if (ret) {
-		pixbuf = gdk_pixbuf_from_pixdata (pixdata, TRUE, NULL);
-
-		pixbuf_cache = gl_label_get_pixbuf_cache (label);
-		gl_pixbuf_cache_add_pixbuf (pixbuf_cache, (gchar *)name, pixbuf);
+	/* Keep it encoded, it is decoded when first needed. */
+	if ( name && base64 ) {
+		gl_pixbuf_cache_add_encoded (pixbuf_cache, name, base64,
+					     GL_PIXBUF_CACHE_FORMAT_PIXDATA);
 	}
 
 	g_free (name);
 	g_free (base64);
 
-	g_free (stream);
-	g_free (pixdata);
-
 	gl_debug (DEBUG_XML, "END");
 }
 
@@ -945,7 +1206,8 @@ xml_parse_pixdata (xmlNodePtr  node,
 /*--------------------------------------------------------------------------*/
 static void
 xml_parse_file_node (xmlNodePtr  node,
-                     glLabel    *label)
+                     glLabel    *label,
+                     GHashTable *hashes)
 {
 	gchar      *name, *format;
         gchar      *content;
@@ -963,6 +1225,10 @@ xml_parse_file_node (xmlNodePtr  node,
 
                 g_free (content);
         }
+        else if ( format && (lgl_str_utf8_casecmp (format, "PNG") == 0) )
+        {
+                xml_parse_file_png (node, gl_label_get_pixbuf_cache (label), hashes);
+        }
         else
         {
                 g_message ("Unknown embedded file format: \"%s\"", format);
@@ -974,6 +1240,77 @@ xml_parse_file_node (xmlNodePtr  node,
 }
 
 
+/*--------------------------------------------------------------------------*/
+/* PRIVATE.  Parse XML embedded PNG File node.  An empty node refers to an  */
+/* earlier node with the same content hash.                                 */
+/*--------------------------------------------------------------------------*/
+static void
+xml_parse_file_png (xmlNodePtr  node,
+		    GHashTable *pixbuf_cache,
+		    GHashTable *hashes)
+{
+	gchar               *name, *hash, *content;
+	gchar               *first_name;
+	const gchar         *encoded = NULL;
+	glPixbufCacheFormat  format = GL_PIXBUF_CACHE_FORMAT_PNG;
+
+	name    = lgl_xml_get_prop_string (node, "name", NULL);
+	hash    = lgl_xml_get_prop_string (node, "hash", NULL);
+	content = lgl_xml_get_node_content (node);
+
+	if ( (content == NULL) || (*g_strstrip (content) == '\0') )
+	{
+		/* Same image as an earlier node. */
+		first_name = hash ? g_hash_table_lookup (hashes, hash) : NULL;
+		if ( first_name ) {
+			encoded = gl_pixbuf_cache_get_encoded (pixbuf_cache, first_name, &format);
+		}
+	}
+	else
+	{
+		encoded = content;
+		if ( hash && name ) {
+			g_hash_table_insert (hashes, g_strdup (hash), g_strdup (name));
+		}
+	}
+
+	if ( name && encoded )
+	{
+		/* Keep it compressed, it is decoded when first needed. */
+		gl_pixbuf_cache_add_encoded (pixbuf_cache, name, encoded, format);
+	}
+	else
+	{
+		g_message ("Missing embedded image data: \"%s\"", name);
+	}
+
+	g_free (name);
+	g_free (hash);
+	g_free (content);
+}
+
+
+/*--------------------------------------------------------------------------*/
+/* PRIVATE.  Is node an embedded image File node?                           */
+/*--------------------------------------------------------------------------*/
+static gboolean
+xml_is_embedded_image (xmlNodePtr node)
+{
+	gchar    *format;
+	gboolean  ret;
+
+	if ( !lgl_xml_is_node (node, "File") ) {
+		return FALSE;
+	}
+
+	format = lgl_xml_get_prop_string (node, "format", NULL);
+	ret = format && (lgl_str_utf8_casecmp (format, "PNG") == 0);
+	g_free (format);
+
+	return ret;
+}
+
+
 /*--------------------------------------------------------------------------*/
 /* PRIVATE.  Parse top-level Span tag.                                      */
 /*--------------------------------------------------------------------------*/
@@ -1716,6 +2053,7 @@ xml_create_data (xmlDocPtr   doc,
 {
 	xmlNodePtr  node;
 	GHashTable *cache;
+	GHashTable *hashes;
 	GList      *name_list, *p;
 
 	gl_debug (DEBUG_XML, "START");
@@ -1725,9 +2063,11 @@ xml_create_data (xmlDocPtr   doc,
 	cache = gl_label_get_pixbuf_cache (label);
 	name_list = gl_pixbuf_cache_get_name_list (cache);
 
+	hashes = g_hash_table_new_full (g_str_hash, g_str_equal, g_free, NULL);
 	for (p = name_list; p != NULL; p=p->next) {
-		xml_create_pixdata (node, ns, label, p->data);
+		xml_create_file_png (node, ns, label, p->data, hashes);
 	}
+	g_hash_table_destroy (hashes);
 
 	gl_pixbuf_cache_free_name_list (name_list);
 
@@ -1747,43 +2087,62 @@ xml_create_data (xmlDocPtr   doc,
 
 
 /*--------------------------------------------------------------------------*/
-/* PRIVATE.  Add XML Label Data embedded Pixdata Node                       */
+/* PRIVATE.  Add XML Label Data embedded PNG file Node.  Images are keyed   */
+/* by content hash, identical images after the first are stored as a       */
+/* reference only.                                                          */
 /*--------------------------------------------------------------------------*/
 static void
-xml_create_pixdata (xmlNodePtr  parent,
-		    xmlNsPtr    ns,
-		    glLabel    *label,
-		    gchar      *name)
+xml_create_file_png (xmlNodePtr  parent,
+		     xmlNsPtr    ns,
+		     glLabel    *label,
+		     gchar      *name,
+		     GHashTable *hashes)
 {
-	xmlNodePtr  node;
-	GHashTable *pixbuf_cache;
-	GdkPixbuf  *pixbuf;
-	GdkPixdata *pixdata;
-	guchar     *stream;
-	guint       stream_length;
-	gchar      *base64;
+	xmlNodePtr   node;
+	GHashTable  *pixbuf_cache;
+	const gchar         *base64;
+	glPixbufCacheFormat  format;
+	gchar               *hash;
+	gboolean             duplicate_flag;
 
 	gl_debug (DEBUG_XML, "START");
 
 	pixbuf_cache = gl_label_get_pixbuf_cache (label);
 
-	pixbuf = gl_pixbuf_cache_get_pixbuf (pixbuf_cache, name);
-	if ( pixbuf != NULL ) {
+	base64 = gl_pixbuf_cache_get_png (pixbuf_cache, name);
+	if ( base64 != NULL ) {
+
+		hash = g_compute_checksum_for_string (G_CHECKSUM_MD5, base64, -1);
 
-		pixdata = g_new0 (GdkPixdata, 1);
-		gdk_pixdata_from_pixbuf (pixdata, pixbuf, FALSE);
-		stream = gdk_pixdata_serialize (pixdata, &stream_length);
-		base64 = g_base64_encode (stream, stream_length);
+		duplicate_flag = g_hash_table_contains (hashes, hash);
 
-		node = xmlNewChild (parent, ns, (xmlChar *)"Pixdata", (xmlChar *)base64);
+		node = xmlNewChild (parent, ns, (xmlChar *)"File",
+				    duplicate_flag ? NULL : (xmlChar *)base64);
 		lgl_xml_set_prop_string (node, "name", name);
+		lgl_xml_set_prop_string (node, "format", "PNG");
 		lgl_xml_set_prop_string (node, "encoding", "Base64");
+		lgl_xml_set_prop_string (node, "hash", hash);
+
+		if ( duplicate_flag ) {
+			g_free (hash);
+		} else {
+			g_hash_table_add (hashes, hash);
+		}
+
+	} else {
 
-		gl_pixbuf_cache_remove_pixbuf (pixbuf_cache, name);
+		/* Could not be converted to PNG, write the original data back
+		   rather than dropping the image. */
+		base64 = gl_pixbuf_cache_get_encoded (pixbuf_cache, name, &format);
+		if ( (base64 != NULL) && (format == GL_PIXBUF_CACHE_FORMAT_PIXDATA) ) {
+			node = xmlNewChild (parent, ns, (xmlChar *)"Pixdata",
+					    (xmlChar *)base64);
+			lgl_xml_set_prop_string (node, "name", name);
+			lgl_xml_set_prop_string (node, "encoding", "Base64");
+		} else {
+			g_warning ("Cannot save embedded image \"%s\"", name);
+		}
 
-		g_free (pixdata);
-		g_free (stream);
-		g_free (base64);
 	}
 
 
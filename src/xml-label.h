@@ -21,6 +21,7 @@
 #ifndef __XML_LABEL_H__
 #define __XML_LABEL_H__
 
+#include <gio/gio.h>
 #include "label.h"
 
 G_BEGIN_DECLS
@@ -36,6 +37,12 @@ typedef enum {
 
 extern glLabel      *gl_xml_label_open          (const gchar * filename,
 						 glXMLLabelStatus *status);
+extern void          gl_xml_label_open_async    (const gchar * filename,
+						 GCancellable *cancellable,
+						 GAsyncReadyCallback callback,
+						 gpointer user_data);
+extern glLabel      *gl_xml_label_open_finish   (GAsyncResult * result,
+						 glXMLLabelStatus *status);
 extern glLabel      *gl_xml_label_open_buffer   (const gchar * buffer,
 						 glXMLLabelStatus *status);
 